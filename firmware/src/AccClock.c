@@ -0,0 +1,193 @@
+/*
+--------------------------------------------------------
+ Fichier : AccClock.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Datation des echantillons de l'accelerometre sur la base de temps IC
+--------------------------------------------------------
+*/
+// Inclusion du header horloge accelerometre
+#include "AccClock.h" // Prototypes de la datation
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+
+static uint32_t obsN[ACCCLOCK_OBS]; // Numero du dernier echantillon de chaque lecture
+static uint32_t obsT[ACCCLOCK_OBS]; // Instant de chaque lecture [ticks IC]
+static uint16_t obsHead = 0; // Prochaine case ecrite
+static uint16_t obsCount = 0; // Lectures retenues
+static uint32_t total = 0; // Numero du prochain echantillon lu
+static uint32_t epochStart = 0; // Premier echantillon de l'epoque courante
+static double nominal = 0.0; // Ts nominale [ticks IC]
+static bool valid = false; // Droite calee
+static uint32_t baseN = 0; // Echantillon de reference de la droite
+static uint32_t baseT = 0; // Instant de reference de la droite [ticks IC]
+static double offset = 0.0; // Instant de baseN par rapport a baseT [ticks IC]
+static double slope = 0.0; // Ts estimee [ticks IC]
+
+/**
+ * @brief Oublie les lectures et ouvre une nouvelle epoque.
+ *
+ * @param sampleHz Frequence d'echantillonnage nominale [Hz]
+ * @return Aucun retour.
+ */
+void AccClock_Reset(float sampleHz)
+{
+    nominal = (double) RPMCALC_TIMER_FREQ / (double) sampleHz;
+    obsHead = 0;
+    obsCount = 0;
+    epochStart = total; // Les numeros restent croissants
+    valid = false;
+}
+
+/**
+ * @brief Abscisse et ordonnee relatives d'une lecture.
+ *
+ * @param i Index de lecture (0 = plus ancienne)
+ * @param x Numero relatif a baseN
+ * @param y Instant relatif a baseT [ticks IC]
+ * @return Aucun retour.
+ */
+static void AccClock_Point(uint16_t i, double *x, double *y)
+{
+    uint16_t k = (uint16_t) ((obsHead + ACCCLOCK_OBS - obsCount + i) % ACCCLOCK_OBS); // Case dans l'anneau
+
+    *x = (double) (obsN[k] - baseN);
+    *y = (double) (int32_t) (obsT[k] - baseT);
+}
+
+/**
+ * @brief Ajuste la droite numero -> instant sur les lectures retenues.
+ *
+ * @details
+ * Toutes les lectures sont au-dessus de la vraie droite, a moins de Ts.
+ * La droite retenue est l'arete de l'enveloppe convexe basse qui encadre
+ * le numero moyen : c'est la droite sous tous les points la plus proche
+ * d'eux en moyenne. Son erreur decroit en Ts / n, contre Ts / sqrt(n)
+ * pour des moindres carres. L'ecart moyen restant, Ts / (n + 1), est
+ * retire de l'ordonnee. Calcul en double (FPU double precision du PIC32MZ
+ * EF), relatif a la plus ancienne lecture : aucun debordement du timer.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void AccClock_Fit(void)
+{
+    uint16_t hull[ACCCLOCK_OBS]; // Enveloppe basse (index de lecture)
+    uint16_t nh = 0; // Points de l'enveloppe
+    uint16_t i; // Index de lecture
+    double x0, y0, x1, y1, x2, y2; // Points compares
+    double xMean = 0.0; // Numero moyen
+    double s; // Pente
+    double tol = nominal * (ACCCLOCK_TOL_PCT / 100.0); // Ecart admis
+    uint16_t k = (uint16_t) ((obsHead + ACCCLOCK_OBS - obsCount) % ACCCLOCK_OBS); // Plus ancienne lecture
+
+    valid = false;
+    if (obsCount < ACCCLOCK_MIN_OBS) {
+        return;
+    }
+    baseN = obsN[k];
+    baseT = obsT[k];
+
+    // Enveloppe basse (chaine monotone : les numeros sont croissants)
+    for (i = 0; i < obsCount; i++) {
+        AccClock_Point(i, &x2, &y2);
+        xMean += x2;
+        while (nh >= 2) {
+            AccClock_Point(hull[nh - 2], &x0, &y0);
+            AccClock_Point(hull[nh - 1], &x1, &y1);
+            if (((x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0)) > 0.0) {
+                break; // Virage a gauche : le point du milieu reste
+            }
+            nh--;
+        }
+        hull[nh++] = i;
+    }
+    xMean /= (double) obsCount;
+
+    // Arete qui encadre le numero moyen
+    for (i = 0; (i + 2) < nh; i++) {
+        AccClock_Point(hull[i + 1], &x1, &y1);
+        if (x1 >= xMean) {
+            break;
+        }
+    }
+    if (nh < 2) {
+        return; // Toutes les lectures sur le meme echantillon
+    }
+    AccClock_Point(hull[i], &x0, &y0);
+    AccClock_Point(hull[i + 1], &x1, &y1);
+    if (x1 <= x0) {
+        return;
+    }
+    s = (y1 - y0) / (x1 - x0);
+    if ((s < (nominal - tol)) || (s > (nominal + tol))) {
+        return; // Lectures incoherentes (timer arrete, FIFO relue)
+    }
+    slope = s;
+    offset = (y0 - s * x0) - (s / ((double) obsCount + 1.0)); // Ecart moyen retire
+    valid = true;
+}
+
+/**
+ * @brief Enregistre une lecture de la FIFO.
+ *
+ * @param stamp Timer T2/T3 lu juste apres FIFO_SRC [ticks IC]
+ * @param nb Echantillons lus
+ * @param lost true si des echantillons ont pu etre perdus (FIFO pleine)
+ * @return Numero du premier echantillon lu
+ */
+uint32_t AccClock_Observe(uint32_t stamp, uint8_t nb, bool lost)
+{
+    uint32_t first; // Premier echantillon de la lecture
+
+    if (lost) {
+        obsHead = 0; // Numerotation rompue : nouvelle epoque
+        obsCount = 0;
+        epochStart = total;
+        valid = false;
+    }
+    first = total;
+    if (nb == 0) {
+        return first;
+    }
+    total += nb;
+
+    obsN[obsHead] = total - 1; // Echantillon le plus recent
+    obsT[obsHead] = stamp;
+    obsHead = (uint16_t) ((obsHead + 1) % ACCCLOCK_OBS);
+    if (obsCount < ACCCLOCK_OBS) {
+        obsCount++;
+    }
+    AccClock_Fit();
+    return first;
+}
+
+/**
+ * @brief Instant d'un echantillon.
+ *
+ * @param index Numero de l'echantillon
+ * @param ticks Instant sur la base de temps IC [ticks IC]
+ * @return false si l'horloge n'est pas encore calee ou l'echantillon
+ *         d'une epoque precedente
+ */
+bool AccClock_SampleTime(uint32_t index, uint32_t *ticks)
+{
+    double dt; // Instant relatif a baseT [ticks IC]
+
+    if (!valid || ((int32_t) (index - epochStart) < 0)) {
+        return false;
+    }
+    dt = offset + slope * (double) (int32_t) (index - baseN);
+    *ticks = baseT + (uint32_t) (int32_t) ((dt >= 0.0) ? (dt + 0.5) : (dt - 0.5));
+    return true;
+}
+
+/**
+ * @brief Periode d'echantillonnage estimee.
+ *
+ * @return Ts [ticks IC], 0 si l'horloge n'est pas calee
+ */
+float AccClock_Period(void)
+{
+    return valid ? (float) slope : 0.0f;
+}
@@ -0,0 +1,72 @@
+/*
+--------------------------------------------------------
+ Fichier : AccClock.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Datation des echantillons de l'accelerometre sur la base de temps IC
+--------------------------------------------------------*/
+
+#ifndef _ACCCLOCK_H_
+#define _ACCCLOCK_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Le LIS2HH12 echantillonne sur son propre oscillateur et sa broche INT
+ * n'est pas cablee : l'instant de chaque echantillon est reconstruit a
+ * partir des lectures de la FIFO.
+ *
+ * A chaque lecture, le timer 32 bits T2/T3 de la capture IR (10 MHz) est
+ * lu juste apres FIFO_SRC. Le plus recent des echantillons comptes a ete
+ * produit dans la periode d'echantillonnage qui precede : l'ecart lecture -
+ * echantillon est dans [0, Ts[ (plus le court delai FIFO_SRC -> timer). L'enveloppe basse des ACCCLOCK_OBS
+ * dernieres lectures (numero d'echantillon -> ticks) donne la periode
+ * reelle Ts et l'instant de chaque echantillon, a quelques Ts / ACCCLOCK_OBS
+ * pres. Les echantillons et les reperes IR sont alors dates sur la
+ * meme base de temps.
+ *
+ * Une FIFO pleine peut avoir perdu des echantillons : la numerotation
+ * repart (nouvelle epoque) et les echantillons anterieurs ne sont plus
+ * datables.
+ */
+
+#define ACCCLOCK_OBS        128 // Lectures retenues pour l'ajustement (~5,6 s)
+#define ACCCLOCK_MIN_OBS    8   // Lectures avant la premiere datation
+#define ACCCLOCK_TOL_PCT    10  // Ecart admis de Ts au nominal [%]
+
+/**
+ * @brief Oublie les lectures et ouvre une nouvelle epoque.
+ *
+ * @param sampleHz Frequence d'echantillonnage nominale [Hz]
+ */
+void AccClock_Reset(float sampleHz);
+
+/**
+ * @brief Enregistre une lecture de la FIFO.
+ *
+ * @param stamp Timer T2/T3 lu juste apres FIFO_SRC [ticks IC]
+ * @param nb Echantillons lus
+ * @param lost true si des echantillons ont pu etre perdus (FIFO pleine)
+ * @return Numero du premier echantillon lu
+ */
+uint32_t AccClock_Observe(uint32_t stamp, uint8_t nb, bool lost);
+
+/**
+ * @brief Instant d'un echantillon.
+ *
+ * @param index Numero de l'echantillon
+ * @param ticks Instant sur la base de temps IC [ticks IC]
+ * @return false si l'horloge n'est pas encore calee ou l'echantillon
+ *         d'une epoque precedente
+ */
+bool AccClock_SampleTime(uint32_t index, uint32_t *ticks);
+
+/**
+ * @brief Periode d'echantillonnage estimee.
+ *
+ * @return Ts [ticks IC], 0 si l'horloge n'est pas calee
+ */
+float AccClock_Period(void);
+
+#endif
@@ -0,0 +1,315 @@
+/*
+--------------------------------------------------------
+ Fichier : Balance.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Equilibrage dynamique de l'helice : vibration 1x et masse de correction
+--------------------------------------------------------
+*/
+// Inclusion du header equilibrage
+#include "Balance.h" // Prototypes de l'equilibrage
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaines IR et vibration
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Sensibilite de l'accelerometre
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+#include <math.h> // Pour cosf, sinf, sqrtf, atan2f
+#include <string.h> // Pour memset
+
+#define BALANCE_PI 3.14159265358979f // Pi en simple precision
+
+/**
+ * @brief Sommes des moindres carres d'un run (modele c0 + A cos + B sin).
+ */
+typedef struct {
+    double n, c, s; // Nombre, somme des cos, somme des sin
+    double cc, ss, cs; // Sommes des produits de la base
+    double a[3], ac[3], as[3]; // Par axe : somme, projections sur cos et sin
+    double rpmSum; // Somme des regimes des tours integres
+    uint16_t revs; // Tours integres
+} Balance_Acc;
+
+static uint8_t state = BALANCE_IDLE; // Etape courante
+static uint8_t flags = 0; // Indicateurs
+static uint8_t axis = 0; // Axe retenu au run de reference
+static Balance_Acc acc; // Run en cours
+static Balance_Run runs[2]; // Reference et essai termines
+static float corrRatio = 0.0f; // Masse de correction / masse d'essai
+static float corrDeg = 0.0f; // Angle de correction [deg]
+static uint32_t revMin = 0; // Premier tour du run (numero de capture IC3)
+static uint32_t lastRev = 0; // Dernier tour integre
+static uint32_t lostSeen = 0; // Pertes RevSync au debut du run
+
+/**
+ * @brief Integre un echantillon a l'angle theta.
+ *
+ * @param xyz Axes bruts
+ * @param theta Angle dans le tour [rad]
+ * @return Aucun retour.
+ */
+static void Balance_Accumulate(const int16_t *xyz, float theta)
+{
+    double c = (double) cosf(theta); // Base cosinus
+    double s = (double) sinf(theta); // Base sinus
+    uint8_t k; // Axe
+
+    acc.n += 1.0;
+    acc.c += c;
+    acc.s += s;
+    acc.cc += c * c;
+    acc.ss += s * s;
+    acc.cs += c * s;
+    for (k = 0; k < 3; k++) {
+        double a = (double) xyz[k];
+
+        acc.a[k] += a;
+        acc.ac[k] += a * c;
+        acc.as[k] += a * s;
+    }
+}
+
+/**
+ * @brief Composante 1x des sommes d'un run.
+ *
+ * @details
+ * Resolution du systeme normal 3 x 3 par Cramer pour chaque axe. Le
+ * signal A cos(theta) + B sin(theta) s'ecrit R cos(theta + phi) : phi
+ * croit avec l'avance d'un balourd dans le sens de rotation.
+ *
+ * @param a Sommes du run
+ * @param out Amplitude et phase par axe
+ * @return Aucun retour.
+ */
+static void Balance_Solve(const Balance_Acc *a, Balance_Run *out)
+{
+    double m00 = a->n, m01 = a->c, m02 = a->s; // Matrice normale
+    double m11 = a->cc, m12 = a->cs, m22 = a->ss;
+    double det = m00 * (m11 * m22 - m12 * m12) - m01 * (m01 * m22 - m12 * m02) + m02 * (m01 * m12 - m11 * m02);
+    uint8_t k; // Axe
+
+    memset(out, 0, sizeof(*out));
+    out->revs = a->revs;
+    if (a->revs > 0) {
+        out->rpm = (float) (a->rpmSum / (double) a->revs);
+    }
+    if ((a->n < 3.0) || (det <= 0.0)) {
+        return; // Pas assez d'angles differents
+    }
+    for (k = 0; k < 3; k++) {
+        double r0 = a->a[k], r1 = a->ac[k], r2 = a->as[k]; // Second membre
+        double ca = (m00 * (r1 * m22 - m12 * r2) - r0 * (m01 * m22 - m12 * m02) + m02 * (m01 * r2 - r1 * m02)) / det;
+        double cb = (m00 * (m11 * r2 - r1 * m12) - m01 * (m01 * r2 - r1 * m02) + r0 * (m01 * m12 - m11 * m02)) / det;
+        float deg = atan2f((float) -cb, (float) ca) * (180.0f / BALANCE_PI);
+
+        out->ampMg[k] = sqrtf((float) (ca * ca + cb * cb)) * LIS2HH12_MG_PER_LSB;
+        out->phaseDeg[k] = (deg < 0.0f) ? (deg + 360.0f) : deg;
+    }
+}
+
+/**
+ * @brief Masse de correction a partir des deux runs, sur l'axe retenu.
+ *
+ * @details
+ * W = -V0 / (V1 - V0) en nombres complexes (V = R e^(j phi)).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Balance_Correct(void)
+{
+    float r0 = runs[0].ampMg[axis], p0 = runs[0].phaseDeg[axis] * (BALANCE_PI / 180.0f);
+    float r1 = runs[1].ampMg[axis], p1 = runs[1].phaseDeg[axis] * (BALANCE_PI / 180.0f);
+    float v0r = r0 * cosf(p0), v0i = r0 * sinf(p0); // Reference
+    float dr = r1 * cosf(p1) - v0r, di = r1 * sinf(p1) - v0i; // Effet de la masse d'essai
+    float d2 = dr * dr + di * di; // |V1 - V0|^2
+    float wr, wi; // Correction / masse d'essai
+    float deg; // Angle de correction
+
+    if (d2 < (0.01f * r0 * r0)) {
+        flags |= BALANCE_FLAG_NO_EFFECT; // Effet inferieur a 10 % de la vibration
+    }
+    if (d2 <= 0.0f) {
+        corrRatio = 0.0f;
+        corrDeg = 0.0f;
+        return;
+    }
+    wr = -(v0r * dr + v0i * di) / d2;
+    wi = -(v0i * dr - v0r * di) / d2;
+    corrRatio = sqrtf(wr * wr + wi * wi);
+    deg = atan2f(wi, wr) * (180.0f / BALANCE_PI);
+    corrDeg = (deg < 0.0f) ? (deg + 360.0f) : deg;
+
+    if (fabsf(runs[1].rpm - runs[0].rpm) > (runs[0].rpm * (BALANCE_RPM_TOL_PCT / 100.0f))) {
+        flags |= BALANCE_FLAG_RPM_MISMATCH;
+    }
+}
+
+/**
+ * @brief Axe de plus forte vibration 1x d'un run.
+ *
+ * @param r Run
+ * @return Axe (0 = X, 1 = Y, 2 = Z)
+ */
+static uint8_t Balance_MaxAxis(const Balance_Run *r)
+{
+    uint8_t best = 0; // Axe retenu
+    uint8_t k; // Axe
+
+    for (k = 1; k < 3; k++) {
+        if (r->ampMg[k] > r->ampMg[best]) {
+            best = k;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Demarre un run : sommes a zero, tours a partir de maintenant.
+ *
+ * @param next Etape du run (BALANCE_REF ou BALANCE_TRIAL)
+ * @return Aucun retour.
+ */
+static void Balance_StartRun(uint8_t next)
+{
+    memset(&acc, 0, sizeof(acc));
+    revMin = RevSync_MarkerNow(); // Tours ouverts a partir de maintenant
+    lastRev = revMin - 1;
+    lostSeen = RevSync_LostCount();
+    state = next;
+}
+
+/**
+ * @brief Termine le run en cours.
+ *
+ * @details
+ * Reference : retient l'axe le plus sensible au balourd. Essai : calcule
+ * la correction.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Balance_Finish(void)
+{
+    if (state == BALANCE_REF) {
+        Balance_Solve(&acc, &runs[0]);
+        axis = Balance_MaxAxis(&runs[0]); // Axe le plus sensible au balourd
+        state = BALANCE_WAIT_TRIAL;
+    } else {
+        Balance_Solve(&acc, &runs[1]);
+        Balance_Correct();
+        state = BALANCE_DONE;
+    }
+}
+
+/**
+ * @brief Passe a l'etape suivante (bouton OK ou commande).
+ *
+ * @param Aucun parametre.
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool Balance_Next(void)
+{
+    if (!MesureEngine_IsRunning(MESURE_PIPE_IR) || !MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        flags |= BALANCE_FLAG_NO_SENSOR;
+        return false;
+    }
+
+    switch (state) {
+        case BALANCE_IDLE:
+        case BALANCE_DONE:
+            flags = 0;
+            memset(runs, 0, sizeof(runs));
+            corrRatio = 0.0f;
+            corrDeg = 0.0f;
+            Balance_StartRun(BALANCE_REF);
+            break;
+
+        case BALANCE_WAIT_TRIAL:
+            Balance_StartRun(BALANCE_TRIAL);
+            break;
+
+        default:
+            break; // Run en cours
+    }
+    return true;
+}
+
+/**
+ * @brief Abandonne l'equilibrage (retour a IDLE).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Balance_Cancel(void)
+{
+    state = BALANCE_IDLE;
+    flags = 0;
+}
+
+/**
+ * @brief Indique si un run attend des echantillons.
+ *
+ * @return true pendant BALANCE_REF et BALANCE_TRIAL
+ */
+bool Balance_IsRunning(void)
+{
+    return (state == BALANCE_REF) || (state == BALANCE_TRIAL);
+}
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @details
+ * Les tours ouverts avant le debut du run sont ignores : la masse d'essai
+ * est en place pour tout le run d'essai.
+ *
+ * @param smp Echantillon date
+ * @return Aucun retour.
+ */
+void Balance_Add(const RevSync_Sample *smp)
+{
+    if (!Balance_IsRunning() || ((int32_t) (smp->rev - revMin) < 0)) {
+        return;
+    }
+    if (RevSync_LostCount() != lostSeen) {
+        flags |= BALANCE_FLAG_LOST;
+    }
+    if (smp->rev != lastRev) {
+        if (acc.revs >= BALANCE_REVS) {
+            Balance_Finish(); // Tours du run complets
+            return;
+        }
+        acc.revs++; // Nouveau tour integre
+        acc.rpmSum += (60.0 * (double) RPMCALC_TIMER_FREQ) / (double) smp->period;
+        lastRev = smp->rev;
+    }
+    Balance_Accumulate(smp->xyz, 2.0f * BALANCE_PI * smp->turn);
+}
+
+/**
+ * @brief Copie de l'etat et des resultats (runs en cours inclus).
+ *
+ * @details
+ * Pendant le run de reference, l'axe rapporte est celui qui domine
+ * l'estimation partielle.
+ *
+ * @param out Copie des resultats
+ * @return Aucun retour.
+ */
+void Balance_Get(Balance_Result *out)
+{
+    out->state = state;
+    out->flags = flags;
+    out->axis = axis;
+    out->ref = runs[0];
+    out->trial = runs[1];
+    if (state == BALANCE_REF) {
+        Balance_Solve(&acc, &out->ref); // Estimation partielle
+        out->axis = Balance_MaxAxis(&out->ref);
+    } else if (state == BALANCE_TRIAL) {
+        Balance_Solve(&acc, &out->trial);
+    }
+    out->corrRatio = corrRatio;
+    out->corrDeg = corrDeg;
+}
@@ -0,0 +1,112 @@
+/*
+--------------------------------------------------------
+ Fichier : Balance.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Equilibrage dynamique de l'helice : vibration 1x et masse de correction
+--------------------------------------------------------*/
+
+#ifndef _BALANCE_H_
+#define _BALANCE_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "RevSync.h" // Echantillons dates dans leur tour
+
+/*
+ * Les echantillons arrivent dates dans leur tour (RevSync : un repere
+ * reflechissant, theta = 2 pi turn). Par axe, un accumulateur
+ * de moindres carres a n + a.cos(theta) + b.sin(theta) (9 sommes, O(1) par
+ * echantillon) donne la composante 1x moyennee sur BALANCE_REVS tours :
+ * les vibrations non synchrones du tour s'annulent, la gravite tombe dans
+ * le terme constant.
+ *
+ * Methode a une masse d'essai (un plan) :
+ *   1. run de reference : vibration V0 ;
+ *   2. masse d'essai fixee sur la pale du repere, run d'essai : V1 ;
+ *   3. correction = -V0 / (V1 - V0) fois la masse d'essai, angle compte
+ *      depuis la masse d'essai dans le sens de rotation.
+ * Les retards constants (filtre du capteur, position du capteur IR) se
+ * retrouvent dans V0 et V1 et s'eliminent, a condition que les deux runs
+ * tournent au meme regime (BALANCE_FLAG_RPM_MISMATCH sinon).
+ */
+
+#define BALANCE_REVS            64      // Tours moyennes par run
+#define BALANCE_RPM_TOL_PCT     5       // Ecart de regime admis entre les runs [%]
+
+// Etapes de l'equilibrage
+typedef enum {
+    BALANCE_IDLE = 0,       // Rien en cours
+    BALANCE_REF,            // Run de reference en cours
+    BALANCE_WAIT_TRIAL,     // Reference prise, fixer la masse d'essai
+    BALANCE_TRIAL,          // Run d'essai en cours
+    BALANCE_DONE            // Correction disponible
+} BALANCE_STATE;
+
+// Indicateurs (bits de flags)
+#define BALANCE_FLAG_NO_SENSOR      0x01 // Chaine IR ou vibration arretee
+#define BALANCE_FLAG_RPM_MISMATCH   0x02 // Regimes des deux runs trop differents
+#define BALANCE_FLAG_NO_EFFECT      0x04 // La masse d'essai ne change pas la vibration
+#define BALANCE_FLAG_LOST           0x08 // Reperes ou echantillons perdus pendant le run
+
+/**
+ * @brief Composante 1x d'un run.
+ */
+typedef struct {
+    float ampMg[3];         // Amplitude par axe [mg]
+    float phaseDeg[3];      // Phase par axe, 0-360 depuis le repere [deg]
+    float rpm;              // Regime moyen du run
+    uint16_t revs;          // Tours integres
+} Balance_Run;
+
+/**
+ * @brief Etat de l'equilibrage et correction.
+ */
+typedef struct {
+    uint8_t state;          // Etape (BALANCE_STATE)
+    uint8_t flags;          // Indicateurs (BALANCE_FLAG_xxx)
+    uint8_t axis;           // Axe retenu (0 = X, 1 = Y, 2 = Z)
+    Balance_Run ref;        // Run de reference (partiel pendant BALANCE_REF)
+    Balance_Run trial;      // Run d'essai (partiel pendant BALANCE_TRIAL)
+    float corrRatio;        // Masse de correction / masse d'essai
+    float corrDeg;          // Angle de correction, 0-360 [deg]
+} Balance_Result;
+
+/**
+ * @brief Passe a l'etape suivante (bouton OK ou commande).
+ *
+ * @details
+ * IDLE ou DONE : lance le run de reference. WAIT_TRIAL : lance le run
+ * d'essai. Pendant un run : sans effet.
+ *
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool Balance_Next(void);
+
+/**
+ * @brief Abandonne l'equilibrage (retour a IDLE).
+ */
+void Balance_Cancel(void);
+
+/**
+ * @brief Indique si un run attend des echantillons.
+ *
+ * @return true pendant BALANCE_REF et BALANCE_TRIAL
+ */
+bool Balance_IsRunning(void);
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @param smp Echantillon date
+ */
+void Balance_Add(const RevSync_Sample *smp);
+
+/**
+ * @brief Copie de l'etat et des resultats (runs en cours inclus).
+ *
+ * @param out Copie des resultats
+ */
+void Balance_Get(Balance_Result *out);
+
+#endif
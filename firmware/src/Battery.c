@@ -0,0 +1,228 @@
+/*
+--------------------------------------------------------
+ Fichier : Battery.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Mesure de la tension batterie en tache de fond (ADC4 / AN4)
+--------------------------------------------------------
+*/
+// Inclusion du header batterie
+#include "Battery.h" // Prototypes de la mesure batterie
+// Inclusion du header application
+#include "app.h" // Base de temps
+// Inclusion de la configuration systeme
+#include "system_config.h" // Configuration systeme (broches)
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Definitions systeme (SFR)
+
+// Nombre maximal de tours d'attente pendant l'init de l'ADC
+#define BATTERY_INIT_TIMEOUT    100000
+// Nombre de points de la courbe de decharge
+#define BATTERY_CURVE_POINTS    11
+
+// Etats de la mesure
+typedef enum {
+    BATTERY_IDLE = 0,   // Attente de la prochaine mesure
+    BATTERY_SETTLE,     // Pont alimente, stabilisation de la tension
+    BATTERY_SAMPLING    // Rafale de conversions en cours
+} BATTERY_STATE;
+
+// Courbe de decharge d'un element Li-ion : tension [mV] a 0, 10, ..., 100 %
+static const uint16_t dischargeCurve[BATTERY_CURVE_POINTS] = {
+    3300, 3600, 3690, 3740, 3770, 3800, 3840, 3900, 3970, 4060, 4200
+};
+
+static BATTERY_STATE state = BATTERY_IDLE; // Etat de la mesure
+static bool adcReady = false; // ADC4 pret a convertir
+static bool valid = false; // Au moins une mesure disponible
+static uint32_t lastMeasureMs = 0; // Debut de la derniere mesure
+static uint32_t accumulator = 0; // Somme des conversions de la rafale
+static uint8_t nbSamples = 0; // Conversions deja accumulees
+static uint32_t filteredQ = 0; // Tension filtree [mV << BATTERY_IIR_SHIFT]
+static uint16_t millivolts = 0; // Tension filtree [mV]
+static uint8_t percent = 0; // Etat de charge [%]
+
+/**
+ * @brief Convertit une tension en etat de charge.
+ *
+ * @details
+ * Interpolation lineaire entre les points de la courbe de decharge.
+ *
+ * @param mv Tension batterie [mV]
+ * @return Pourcentage 0..100
+ */
+static uint8_t Battery_PercentFromMv(uint16_t mv)
+{
+    uint8_t i;
+
+    if (mv <= dischargeCurve[0]) {
+        return 0; // Batterie vide
+    }
+    for (i = 1; i < BATTERY_CURVE_POINTS; i++) {
+        if (mv < dischargeCurve[i]) {
+            uint16_t span = dischargeCurve[i] - dischargeCurve[i - 1]; // Largeur du segment
+            uint16_t pos = mv - dischargeCurve[i - 1]; // Position dans le segment
+            return (uint8_t) (((i - 1) * 10) + ((pos * 10) / span)); // Interpolation
+        }
+    }
+    return 100; // Batterie pleine
+}
+
+/**
+ * @brief Termine une mesure : decimation, filtrage et etat de charge.
+ *
+ * @details
+ * La somme de 16 conversions 12 bits, decalee de 2, donne une valeur sur
+ * 14 bits. Le filtre IIR travaille en virgule fixe pour ne rien perdre.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Battery_Process(void)
+{
+    uint32_t raw14 = accumulator >> 2; // Decimation : 16 x 12 bits -> 14 bits
+    uint32_t mv; // Tension batterie instantanee [mV]
+
+    mv = (raw14 * BATTERY_VREF_MV * BATTERY_DIVIDER_NUM) / (16384UL * BATTERY_DIVIDER_DEN);
+
+    if (!valid) {
+        filteredQ = mv << BATTERY_IIR_SHIFT; // Premiere mesure : pas de transitoire
+        valid = true;
+    } else {
+        filteredQ = filteredQ + mv - (filteredQ >> BATTERY_IIR_SHIFT); // y += (x - y) / 2^n
+    }
+    millivolts = (uint16_t) (filteredQ >> BATTERY_IIR_SHIFT); // Valeur filtree
+    percent = Battery_PercentFromMv(millivolts); // Etat de charge
+}
+
+/**
+ * @brief Initialise ADC4 pour la conversion de AN4.
+ *
+ * @details
+ * ADC4 : 12 bits, TQ = 50 MHz, declenchement logiciel global, pas
+ * d'interruption. Les attentes de la reference et du reveil de l'ADC sont
+ * bornees : en cas d'echec la mesure reste simplement invalide.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Battery_Init(void)
+{
+    uint32_t timeout; // Compteur d'attente
+
+    BAT_SENS_EN_On(); // Pont diviseur coupe (actif bas)
+    adcReady = false;
+    valid = false;
+    state = BATTERY_IDLE;
+
+    ADCCON1 = 0; // ADC a l'arret
+    ADCCON2 = 0;
+    ADCCON3 = 0;
+    ADC4CFG = DEVADC4; // Calibration usine de ADC4
+    ADCCON1bits.SELRES = 3; // 12 bits
+    ADCCON3bits.ADCSEL = 1; // Horloge SYSCLK
+    ADCCON3bits.CONCLKDIV = SYS_CLK_FREQ / 100000000UL; // TQ = 50 MHz quel que soit le profil
+    ADCCON3bits.VREFSEL = 0; // AVDD / AVSS
+    ADC4TIMEbits.SELRES = 3; // 12 bits
+    ADC4TIMEbits.ADCDIV = 2; // TAD = 4 * TQ
+    ADC4TIMEbits.SAMC = 100; // Echantillonnage long : pont a forte impedance
+    ADCTRG2bits.TRGSRC4 = 1; // Declenchement logiciel global
+    ADCANCONbits.WKUPCLKCNT = 5; // Temps de reveil : 32 TQ
+
+    ADCCON1bits.ON = 1; // Active l'ADC
+    for (timeout = 0; (timeout < BATTERY_INIT_TIMEOUT) && !ADCCON2bits.BGVRRDY; timeout++) {
+        // Attente de la reference de tension
+    }
+    ADCANCONbits.ANEN4 = 1; // Alimente ADC4
+    for (; (timeout < BATTERY_INIT_TIMEOUT) && !ADCANCONbits.WKRDY4; timeout++) {
+        // Attente du reveil de ADC4
+    }
+    ADCCON3bits.DIGEN4 = 1; // Active la partie numerique de ADC4
+
+    adcReady = (timeout < BATTERY_INIT_TIMEOUT); // ADC utilisable
+    lastMeasureMs = appData.tickMs - BATTERY_PERIOD_MS; // Premiere mesure immediate
+}
+
+/**
+ * @brief Tache non bloquante de mesure (creneau lent de l'application).
+ *
+ * @details
+ * Une seule conversion est lancee par appel et lue a l'appel suivant : la
+ * tache ne fait jamais d'attente active et n'utilise aucune interruption,
+ * la capture IR n'est donc pas perturbee.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Battery_Task(void)
+{
+    if (!adcReady) {
+        return; // ADC non disponible
+    }
+
+    switch (state) {
+        case BATTERY_IDLE:
+            if ((uint32_t) (appData.tickMs - lastMeasureMs) >= BATTERY_PERIOD_MS) {
+                lastMeasureMs = appData.tickMs; // Debut de la mesure
+                BAT_SENS_EN_Off(); // Alimente le pont diviseur
+                state = BATTERY_SETTLE; // Stabilisation jusqu'au prochain appel
+            }
+            break;
+
+        case BATTERY_SETTLE:
+            accumulator = 0; // Nouvelle rafale
+            nbSamples = 0;
+            ADCCON3bits.GSWTRG = 1; // Lance la premiere conversion
+            state = BATTERY_SAMPLING;
+            break;
+
+        case BATTERY_SAMPLING:
+            if (!ADCDSTAT1bits.ARDY4) {
+                break; // Conversion pas encore terminee
+            }
+            accumulator += ADCDATA4; // Accumule (lecture = acquittement)
+            nbSamples++;
+            if (nbSamples < BATTERY_OVERSAMPLING) {
+                ADCCON3bits.GSWTRG = 1; // Conversion suivante
+            } else {
+                BAT_SENS_EN_On(); // Coupe le pont diviseur
+                Battery_Process(); // Decimation et filtrage
+                state = BATTERY_IDLE;
+            }
+            break;
+
+        default:
+            state = BATTERY_IDLE;
+            break;
+    }
+}
+
+/**
+ * @brief Tension batterie filtree.
+ *
+ * @return Tension en mV (0 tant qu'aucune mesure n'est disponible)
+ */
+uint16_t Battery_GetMillivolts(void)
+{
+    return millivolts;
+}
+
+/**
+ * @brief Etat de charge estime.
+ *
+ * @return Pourcentage 0..100
+ */
+uint8_t Battery_GetPercent(void)
+{
+    return percent;
+}
+
+/**
+ * @brief Indique si au moins une mesure complete est disponible.
+ *
+ * @return true si les valeurs retournees sont valides
+ */
+bool Battery_IsValid(void)
+{
+    return valid;
+}
@@ -0,0 +1,69 @@
+/*
+--------------------------------------------------------
+ Fichier : Battery.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations pour la mesure de la tension batterie
+--------------------------------------------------------*/
+
+#ifndef _BATTERY_H_
+#define _BATTERY_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * La tension batterie arrive sur AN4 (RB4, BAT_SENSOR_) a travers un pont
+ * diviseur alimente par BAT_SENS_EN_ (RE2, actif bas). AN4 est une entree
+ * de classe 1 : elle est convertie par l'ADC dedie ADC4, sans interruption.
+ *
+ * Une mesure = BATTERY_OVERSAMPLING conversions, une par appel de
+ * Battery_Task. Le pont n'est alimente que pendant la rafale.
+ */
+
+// Periode entre deux mesures [ms]
+#define BATTERY_PERIOD_MS       1000
+// Conversions 12 bits par mesure (16 -> 2 bits de plus par decimation)
+#define BATTERY_OVERSAMPLING    16
+// Constante du filtre IIR : y += (x - y) / 2^BATTERY_IIR_SHIFT
+#define BATTERY_IIR_SHIFT       3
+// Reference de l'ADC (AVDD) [mV]
+#define BATTERY_VREF_MV         3300
+// Rapport du pont diviseur (Vbat / Vadc), a ajuster selon le schema
+#define BATTERY_DIVIDER_NUM     2
+#define BATTERY_DIVIDER_DEN     1
+
+/**
+ * @brief Initialise ADC4 pour la conversion de AN4.
+ */
+void Battery_Init(void);
+
+/**
+ * @brief Tache non bloquante de mesure (creneau lent de l'application).
+ *
+ * @pre Battery_Init doit avoir ete appelee.
+ */
+void Battery_Task(void);
+
+/**
+ * @brief Tension batterie filtree.
+ *
+ * @return Tension en mV (0 tant qu'aucune mesure n'est disponible)
+ */
+uint16_t Battery_GetMillivolts(void);
+
+/**
+ * @brief Etat de charge estime.
+ *
+ * @return Pourcentage 0..100
+ */
+uint8_t Battery_GetPercent(void);
+
+/**
+ * @brief Indique si au moins une mesure complete est disponible.
+ *
+ * @return true si les valeurs retournees sont valides
+ */
+bool Battery_IsValid(void);
+
+#endif
@@ -0,0 +1,479 @@
+/*
+--------------------------------------------------------
+ Fichier : Bench.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Banc de performance du profil d'horloge (FFT, estimateur, latence)
+--------------------------------------------------------
+*/
+// Inclusion du header banc de performance
+#include "Bench.h" // Prototypes du banc
+// Inclusion du header application
+#include "app.h" // Base de temps en ms
+// Inclusion du header base de temps
+#include "Timebase.h" // Horodatage Core Timer
+// Inclusion du header FFT
+#include "Fft.h" // FFT mesuree
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Estimateur mesure
+// Inclusion du header priorites
+#include "IsrPrio.h" // Niveau de la capture IR
+// Inclusion du header delais
+#include "Mc32Delays.h" // delay_usCt mesure
+// Inclusion du header formatage
+#include "Fmt.h" // Formatage compare a sprintf
+// Inclusion du header suivi d'ordres
+#include "OrderTrack.h" // Suivi d'ordres mesure
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Frequence d'echantillonnage
+// Inclusion de la configuration systeme
+#include "system_config.h" // Profil et frequences
+// Inclusion des definitions systeme
+#include "system_definitions.h" // PLIB interruptions et SFR
+#include <math.h> // Pour sinf, cosf, floor
+#include <string.h> // Pour memset
+#include <stdio.h> // Pour sprintf (reference du formatage)
+
+// Etapes du banc
+typedef enum {
+    BENCH_STEP_COMPUTE = 0, // Mesures de calcul (une passe)
+    BENCH_STEP_TICK_END     // Fenetre Timer1 / Core Timer ouverte
+} BENCH_STEP;
+
+static Bench_Result result; // Derniers resultats
+static uint8_t step = BENCH_STEP_COMPUTE; // Etape courante
+static uint32_t tickStartMs = 0; // Debut de la fenetre [ms Timer1]
+static uint32_t tickStartCore = 0; // Debut de la fenetre [ticks Core Timer]
+static Fft_Cplx fftBuf[FFT_MAX_N]; // Echantillons de la FFT mesuree
+
+// Interruption logicielle
+static volatile bool swDone = false; // Callback execute
+static volatile uint32_t swEntry = 0; // Entree du callback [ticks Core Timer]
+
+/**
+ * @brief Etats d'attente flash necessaires a une frequence SYSCLK.
+ *
+ * @param sysclk SYSCLK [Hz]
+ * @return Nombre d'etats d'attente (fiche technique PIC32MZ EF)
+ */
+static uint8_t Bench_RequiredWaitStates(uint32_t sysclk)
+{
+    if (sysclk <= 74000000UL) {
+        return 0;
+    }
+    if (sysclk <= 140000000UL) {
+        return 1;
+    }
+    return 2;
+}
+
+/**
+ * @brief Ecart relatif entre une duree mesuree et sa valeur attendue.
+ *
+ * @param measured Duree mesuree
+ * @param expected Duree attendue (non nulle)
+ * @return Ecart en ppm
+ */
+static int32_t Bench_ErrPpm(uint32_t measured, uint32_t expected)
+{
+    return (int32_t) ((((int64_t) measured - (int64_t) expected) * 1000000LL) / (int64_t) expected);
+}
+
+/**
+ * @brief Valeur absolue d'un ecart.
+ *
+ * @param v Ecart signe
+ * @return Ecart non signe
+ */
+static uint32_t Bench_Abs(int32_t v)
+{
+    return (v < 0) ? (uint32_t) -v : (uint32_t) v;
+}
+
+/**
+ * @brief Attend le prochain tick Timer1 et date son arrivee.
+ *
+ * @param ms Valeur de la base de temps apres le tick
+ * @return Core Timer lu juste apres le tick
+ */
+static uint32_t Bench_WaitTickEdge(uint32_t *ms)
+{
+    uint32_t t = appData.tickMs; // Tick courant
+
+    while (appData.tickMs == t) {
+        // Attente du prochain tick (au plus 1 ms)
+    }
+    *ms = appData.tickMs;
+    return Timebase_Now();
+}
+
+/**
+ * @brief Cycles CPU d'une FFT (minimum de BENCH_FFT_RUNS).
+ *
+ * @param n Taille de la FFT
+ * @return Cycles CPU
+ */
+static uint32_t Bench_FftCycles(uint16_t n)
+{
+    uint32_t best = 0xFFFFFFFFUL; // Meilleur temps
+    uint32_t start, ticks; // Mesure
+    uint16_t i;
+    uint8_t run;
+
+    for (run = 0; run < BENCH_FFT_RUNS; run++) {
+        for (i = 0; i < n; i++) {
+            fftBuf[i].re = sinf((float) i * 0.3f); // Signal quelconque
+            fftBuf[i].im = 0.0f;
+        }
+        start = Timebase_Now();
+        (void) Fft_Forward(fftBuf, n);
+        ticks = Timebase_Now() - start;
+        if (ticks < best) {
+            best = ticks; // Run le moins perturbe par les ISR
+        }
+    }
+    return best * 2; // Core Timer = SYSCLK / 2
+}
+
+/**
+ * @brief Cycles CPU moyens de l'estimateur RPM (boucle comprise).
+ *
+ * @return Cycles CPU par estimation
+ */
+static uint32_t Bench_EstimatorCycles(void)
+{
+    volatile uint32_t sink = 0; // Empeche l'elimination du calcul
+    uint32_t delta = 100000; // Periode simulee (6000 RPM a 10 MHz)
+    uint32_t prev = delta; // Periode precedente
+    uint32_t start, ticks; // Mesure
+    uint8_t run;
+
+    start = Timebase_Now();
+    for (run = 0; run < BENCH_EST_RUNS; run++) {
+        sink += RpmCalc_FromPeriod(delta, 2);
+        sink += RpmCalc_Confidence(delta, prev);
+        prev = delta;
+        delta += (run & 1) ? 37 : -29; // Periode legerement variable
+    }
+    ticks = Timebase_Now() - start;
+    (void) sink;
+    return (ticks * 2) / BENCH_EST_RUNS;
+}
+
+/**
+ * @brief Cycles CPU de la ligne RPM de la mesure visuelle.
+ *
+ * @details
+ * Meme texte que l'ecran : sprintf dans un buffer, puis Fmt directement
+ * dans un buffer de la taille d'une ligne. Minimum sur BENCH_FMT_RUNS
+ * valeurs de 1 a 5 chiffres.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Bench_FmtCycles(void)
+{
+    static const uint32_t values[BENCH_FMT_RUNS] = {
+        0, 7, 42, 99, 360, 999, 1500, 2400, 6000, 9999, 12000, 18000, 24000, 30000, 45000, 65535
+    }; // RPM formates
+    static char line[24]; // Ligne formatee (static : pas dans la pile mesuree)
+    uint32_t start, ticks; // Mesure
+    char *d; // Position d'ecriture
+    uint8_t run;
+
+    result.sprintfCycles = 0xFFFFFFFFUL;
+    result.fmtCycles = 0xFFFFFFFFUL;
+    for (run = 0; run < BENCH_FMT_RUNS; run++) {
+        start = Timebase_Now();
+        sprintf(line, "Visuel : %5u RPM", (unsigned int) values[run]);
+        ticks = Timebase_Now() - start;
+        if (ticks < result.sprintfCycles) {
+            result.sprintfCycles = ticks;
+        }
+        start = Timebase_Now();
+        d = Fmt_Str(line, "Visuel : ", 0);
+        d = Fmt_Uint(d, values[run], 5);
+        (void) Fmt_Str(d, " RPM", 0);
+        ticks = Timebase_Now() - start;
+        if (ticks < result.fmtCycles) {
+            result.fmtCycles = ticks;
+        }
+    }
+    result.sprintfCycles *= 2; // Core Timer = SYSCLK / 2
+    result.fmtCycles *= 2;
+}
+
+/**
+ * @brief Angle de la montee en regime de synthese.
+ *
+ * @param t Temps depuis le debut de la montee [s]
+ * @return Angle [tours]
+ */
+static double Bench_OtTurns(double t)
+{
+    return ((double) BENCH_OT_RPM0 * t + 0.5 * (double) BENCH_OT_RATE * t * t) / 60.0;
+}
+
+/**
+ * @brief Echantillon de la montee en regime de synthese.
+ *
+ * @param turns Angle [tours]
+ * @return Signal de l'ordre BENCH_OT_ORDER [LSB]
+ */
+static float Bench_OtSignal(double turns)
+{
+    float frac = (float) (turns - floor(turns)); // Position dans le tour
+
+    return BENCH_OT_AMP * sinf(2.0f * 3.14159265f * (float) BENCH_OT_ORDER * frac);
+}
+
+/**
+ * @brief Part de la puissance dans la raie dominante et ses deux voisines.
+ *
+ * @param n Taille de la FFT contenue dans fftBuf
+ * @return Part [%]
+ */
+static uint8_t Bench_PeakPct(uint16_t n)
+{
+    float p[3] = {0.0f, 0.0f, 0.0f}; // Raies k - 1, k, k + 1
+    float best = 0.0f; // Meilleure somme de trois raies
+    float sum = 0.0f; // Puissance totale
+    uint16_t k; // Index de raie
+
+    for (k = 1; k < (n / 2); k++) {
+        p[0] = p[1];
+        p[1] = p[2];
+        p[2] = (fftBuf[k].re * fftBuf[k].re) + (fftBuf[k].im * fftBuf[k].im);
+        sum += p[2];
+        if ((p[0] + p[1] + p[2]) > best) {
+            best = p[0] + p[1] + p[2];
+        }
+    }
+    return (sum > 0.0f) ? (uint8_t) ((100.0f * best) / sum) : 0;
+}
+
+/**
+ * @brief Suivi d'ordres compare a une FFT en temps sur une montee en regime.
+ *
+ * @details
+ * Le suivi d'ordres est vide avant et apres le banc : aucun spectre de
+ * synthese ne reste lisible.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Bench_OrderTrack(void)
+{
+    const double ts = 1.0 / (double) LIS2HH12_ODR_HZ; // Periode d'echantillonnage [s]
+    float xyz[3] = {0.0f, 0.0f, 0.0f}; // Axes de synthese (X seul)
+    OrderTrack_Result r; // Spectre d'ordres
+    uint32_t start, ticks = 0; // Mesure
+    bool ready = false; // Premier spectre calcule
+    uint16_t i; // Echantillon
+
+    if (OrderTrack_IsRunning()) {
+        return; // Mesure reelle en cours
+    }
+
+    for (i = 0; i < 256; i++) {
+        float hannK = 0.5f - 0.5f * cosf((2.0f * 3.14159265f * (float) i) / 256.0f); // Fenetre de Hann
+
+        fftBuf[i].re = Bench_OtSignal(Bench_OtTurns((double) i * ts)) * hannK;
+        fftBuf[i].im = 0.0f;
+    }
+    (void) Fft_Forward(fftBuf, 256);
+    result.fftPeakPct = Bench_PeakPct(256);
+
+    OrderTrack_Reset();
+    for (i = 0; (i < BENCH_OT_MAX_SAMPLES) && !ready; i++) {
+        double t = (double) i * ts; // Instant de l'echantillon [s]
+        double turns = Bench_OtTurns(t); // Angle [tours]
+        float rpm = (float) BENCH_OT_RPM0 + (float) BENCH_OT_RATE * (float) t; // Regime instantane
+
+        xyz[0] = Bench_OtSignal(turns);
+        start = Timebase_Now();
+        ready = OrderTrack_Feed(xyz, turns, rpm, true);
+        ticks += Timebase_Now() - start;
+    }
+    OrderTrack_Get(&r);
+    result.otCycles = ready ? ((ticks * 2) / i) : 0; // Core Timer = SYSCLK / 2
+    result.otPeakPct = r.peakPct;
+    OrderTrack_Reset();
+}
+
+/**
+ * @brief Latence de l'interruption logicielle CS0 au niveau de la capture IR.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Bench_IsrLatency(void)
+{
+    const IsrPrio_Config *prio = IsrPrio_Get(IsrPrio_Current()); // Niveaux actifs
+    uint32_t sum = 0; // Somme des latences
+    uint32_t start, lat; // Mesure
+    uint8_t run;
+
+    result.isrLatMin = 0xFFFFFFFFUL;
+    result.isrLatMax = 0;
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_CS0, (INT_PRIORITY_LEVEL) prio->ic3);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_SOFTWARE_0);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_SOFTWARE_0);
+    for (run = 0; run < BENCH_ISR_RUNS; run++) {
+        swDone = false;
+        start = Timebase_Now();
+        PLIB_INT_SourceFlagSet(INT_ID_0, INT_SOURCE_SOFTWARE_0); // Demande
+        while (!swDone && ((Timebase_Now() - start) < (1000 * Timebase_TicksPerUs()))) {
+            // Attente du callback (au plus 1 ms)
+        }
+        lat = (swEntry - start) * 2; // Cycles CPU
+        if (!swDone) {
+            lat = 0xFFFFFFFFUL; // Interruption jamais servie
+        }
+        if (lat < result.isrLatMin) {
+            result.isrLatMin = lat;
+        }
+        if (lat > result.isrLatMax) {
+            result.isrLatMax = lat;
+        }
+        sum += swDone ? lat : 0;
+    }
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_SOFTWARE_0);
+    result.isrLatAvg = sum / BENCH_ISR_RUNS;
+}
+
+/**
+ * @brief Verifications statiques et mesures de calcul.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Bench_Compute(void)
+{
+    uint32_t start, ticks; // Mesure de delay_usCt
+    unsigned int status; // Etat des interruptions
+
+    result.profile = PERF_PROFILE;
+    result.sysclkMHz = (uint16_t) (SYS_CLK_FREQ / 1000000UL);
+    result.waitStates = PRECONbits.PFMWS;
+    result.prefetch = PRECONbits.PREFEN;
+    result.cacheK0 = (uint8_t) (_CP0_GET_CONFIG() & 0x7);
+
+    if ((Timebase_TicksPerUs() * 2000000UL) != SYS_CLK_FREQ) {
+        result.failMask |= BENCH_FAIL_TIMEBASE;
+    }
+    if (((SYS_CLK_FREQ / (PB1DIVbits.PBDIV + 1)) != SYS_CLK_BUS_PERIPHERAL_1)
+        || ((SYS_CLK_FREQ / (PB2DIVbits.PBDIV + 1)) != SYS_CLK_BUS_PERIPHERAL_2)
+        || ((SYS_CLK_FREQ / (PB3DIVbits.PBDIV + 1)) != SYS_CLK_BUS_PERIPHERAL_3)) {
+        result.failMask |= BENCH_FAIL_PBCLK;
+    }
+    if (result.waitStates < Bench_RequiredWaitStates(SYS_CLK_FREQ)) {
+        result.failMask |= BENCH_FAIL_WAIT_STATES;
+    }
+
+    status = __builtin_disable_interrupts(); // Delai mesure sans ISR
+    start = Timebase_Now();
+    delay_usCt(BENCH_DELAY_US);
+    ticks = Timebase_Now() - start;
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+    result.delayErrPpm = Bench_ErrPpm(ticks, BENCH_DELAY_US * Timebase_TicksPerUs());
+    if (Bench_Abs(result.delayErrPpm) > BENCH_DELAY_TOL_PPM) {
+        result.failMask |= BENCH_FAIL_DELAY;
+    }
+
+    result.fft256Cycles = Bench_FftCycles(256);
+    result.fft1024Cycles = Bench_FftCycles(1024);
+    if ((result.fft1024Cycles / (SYS_CLK_FREQ / 1000000UL)) > BENCH_FFT_BUDGET_US) {
+        result.failMask |= BENCH_FAIL_FFT_BUDGET;
+    }
+    result.estimatorCycles = Bench_EstimatorCycles();
+    Bench_FmtCycles();
+    Bench_OrderTrack();
+    Bench_IsrLatency();
+}
+
+/**
+ * @brief Lance le banc.
+ *
+ * @param Aucun parametre.
+ * @return false si un banc est deja en cours
+ */
+bool Bench_Start(void)
+{
+    if (result.state == BENCH_RUNNING) {
+        return false; // Fenetre Timer1 en cours
+    }
+    memset(&result, 0, sizeof(result));
+    Fft_Init(); // Table des facteurs de rotation
+    step = BENCH_STEP_COMPUTE;
+    result.state = BENCH_RUNNING;
+    return true;
+}
+
+/**
+ * @brief Tache lente : mesures de calcul puis fenetre Timer1 / Core Timer.
+ *
+ * @details
+ * La fenetre est alignee sur les fronts de Timer1 aux deux bouts : l'attente
+ * d'un front coute au plus 1 ms par appel.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Bench_Task(void)
+{
+    uint32_t ms, core; // Front de Timer1
+
+    if (result.state != BENCH_RUNNING) {
+        return;
+    }
+    switch (step) {
+        case BENCH_STEP_COMPUTE:
+            Bench_Compute();
+            tickStartCore = Bench_WaitTickEdge(&tickStartMs);
+            step = BENCH_STEP_TICK_END;
+            break;
+
+        case BENCH_STEP_TICK_END:
+            if ((appData.tickMs - tickStartMs) < BENCH_TICK_WINDOW_MS) {
+                break; // Fenetre encore ouverte
+            }
+            core = Bench_WaitTickEdge(&ms);
+            result.tickErrPpm = Bench_ErrPpm(core - tickStartCore,
+                                             (ms - tickStartMs) * 1000 * Timebase_TicksPerUs());
+            if (Bench_Abs(result.tickErrPpm) > BENCH_TICK_TOL_PPM) {
+                result.failMask |= BENCH_FAIL_TICK;
+            }
+            result.state = BENCH_DONE;
+            break;
+
+        default:
+            result.state = BENCH_DONE;
+            break;
+    }
+}
+
+/**
+ * @brief Copie des resultats.
+ *
+ * @param out Copie des resultats
+ * @return Aucun retour.
+ */
+void Bench_GetResult(Bench_Result *out)
+{
+    *out = result;
+}
+
+/**
+ * @brief Callback de l'interruption logicielle CS0.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Bench_SwIsrCallback(void)
+{
+    swEntry = Timebase_Now(); // Entree du callback
+    swDone = true;
+}
@@ -0,0 +1,124 @@
+/*
+--------------------------------------------------------
+ Fichier : Bench.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Banc de performance du profil d'horloge (FFT, estimateur, latence)
+--------------------------------------------------------*/
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Le banc mesure le profil de performance courant (PERF_PROFILE) et verifie
+ * que les constantes de temps du firmware restent justes :
+ *   - cycles d'une FFT 256 et 1024 points (minimum de BENCH_FFT_RUNS)
+ *   - cycles de l'estimateur RPM (RpmCalc, moyenne de BENCH_EST_RUNS)
+ *   - latence d'interruption : interruption logicielle CS0 au niveau de
+ *     priorite de IC3, de la demande a l'entree du callback
+ *   - Timer1 (PBCLK3) compare au Core Timer (SYSCLK / 2) sur
+ *     BENCH_TICK_WINDOW_MS : valide les diviseurs PBCLK
+ *   - delay_usCt(BENCH_DELAY_US) mesure au Core Timer
+ *   - ligne "Visuel : %5u RPM" formatee par sprintf puis par Fmt
+ *     (minimum de BENCH_FMT_RUNS valeurs)
+ *   - suivi d'ordres sur une montee en regime de synthese (ordre
+ *     BENCH_OT_ORDER, BENCH_OT_RPM0 + BENCH_OT_RATE x t) : cycles par
+ *     echantillon d'OrderTrack_Feed (FFT comprises) et part de la
+ *     puissance dans la raie dominante et ses voisines, pour le spectre
+ *     d'ordres et pour une FFT 256 points en temps des memes echantillons.
+ *     Saute si le suivi d'ordres est en cours.
+ *
+ * Les mesures de calcul tournent en une passe dans le creneau lent ; la
+ * fenetre Timer1 / Core Timer s'etend ensuite sur plusieurs creneaux.
+ */
+
+// Repetitions des mesures
+#define BENCH_FFT_RUNS          4
+#define BENCH_EST_RUNS          64
+#define BENCH_ISR_RUNS          32
+#define BENCH_FMT_RUNS          16
+// Fenetre de comparaison Timer1 / Core Timer [ms]
+#define BENCH_TICK_WINDOW_MS    200
+// Tolerance sur Timer1 [ppm]
+#define BENCH_TICK_TOL_PPM      1000
+// Delai mesure et tolerance [us] / [ppm]
+#define BENCH_DELAY_US          100
+#define BENCH_DELAY_TOL_PPM     20000
+// Montee en regime de synthese du suivi d'ordres
+#define BENCH_OT_RPM0           1800    // Regime de depart
+#define BENCH_OT_RATE           6000    // Acceleration [RPM/s]
+#define BENCH_OT_ORDER          2       // Ordre du signal
+#define BENCH_OT_AMP            1000.0f // Amplitude [LSB]
+#define BENCH_OT_MAX_SAMPLES    1024    // Echantillons fournis au plus
+// Budget d'une FFT 1024 points dans le creneau de 11 ms [us]
+#define BENCH_FFT_BUDGET_US     2000
+
+// Etat du banc
+typedef enum {
+    BENCH_IDLE = 0,         // Jamais lance
+    BENCH_RUNNING,          // Fenetre Timer1 en cours
+    BENCH_DONE              // Resultats disponibles
+} BENCH_STATE;
+
+// Verifications en echec (bits de failMask)
+#define BENCH_FAIL_TIMEBASE     0x01 // Core Timer different de SYS_CLK_FREQ / 2
+#define BENCH_FAIL_PBCLK        0x02 // Diviseur PBCLK1..3 different de system_config.h
+#define BENCH_FAIL_WAIT_STATES  0x04 // Etats d'attente flash insuffisants pour SYSCLK
+#define BENCH_FAIL_TICK         0x08 // Timer1 hors tolerance
+#define BENCH_FAIL_DELAY        0x10 // delay_usCt hors tolerance
+#define BENCH_FAIL_FFT_BUDGET   0x20 // FFT 1024 points trop lente
+
+/**
+ * @brief Resultats du banc.
+ */
+typedef struct {
+    uint8_t state;              // Etat (BENCH_STATE)
+    uint8_t profile;            // Profil mesure (PERF_PROFILE)
+    uint16_t sysclkMHz;         // SYSCLK [MHz]
+    uint8_t waitStates;         // Etats d'attente flash (PRECON.PFMWS)
+    uint8_t prefetch;           // Prefetch (PRECON.PREFEN)
+    uint8_t cacheK0;            // Mode du cache L1 (Config.K0)
+    uint8_t failMask;           // Verifications en echec (BENCH_FAIL_xxx)
+    uint32_t fft256Cycles;      // FFT 256 points [cycles CPU]
+    uint32_t fft1024Cycles;     // FFT 1024 points [cycles CPU]
+    uint32_t estimatorCycles;   // RpmCalc_FromPeriod + Confidence [cycles CPU]
+    uint32_t isrLatMin;         // Latence d'interruption min [cycles CPU]
+    uint32_t isrLatMax;         // Latence d'interruption max [cycles CPU]
+    uint32_t isrLatAvg;         // Latence d'interruption moyenne [cycles CPU]
+    int32_t tickErrPpm;         // Ecart Timer1 / Core Timer [ppm]
+    int32_t delayErrPpm;        // Ecart de delay_usCt [ppm]
+    uint32_t sprintfCycles;     // Ligne RPM par sprintf [cycles CPU]
+    uint32_t fmtCycles;         // Ligne RPM par Fmt [cycles CPU]
+    uint32_t otCycles;          // OrderTrack_Feed par echantillon [cycles CPU]
+    uint8_t otPeakPct;          // Raie dominante du spectre d'ordres [% de la puissance]
+    uint8_t fftPeakPct;         // Raie dominante de la FFT en temps [% de la puissance]
+} Bench_Result;
+
+/**
+ * @brief Lance le banc.
+ *
+ * @return false si un banc est deja en cours
+ */
+bool Bench_Start(void);
+
+/**
+ * @brief Tache lente (creneau SERVICE_TASKS) : mesures et fenetre Timer1.
+ */
+void Bench_Task(void);
+
+/**
+ * @brief Copie des resultats.
+ *
+ * @param out Copie des resultats
+ */
+void Bench_GetResult(Bench_Result *out);
+
+/**
+ * @brief Callback de l'interruption logicielle CS0 (appele par l'ISR).
+ */
+void Bench_SwIsrCallback(void);
+
+#endif
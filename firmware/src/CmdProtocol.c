@@ -0,0 +1,597 @@
+/*
+--------------------------------------------------------
+ Fichier : CmdProtocol.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Protocole commande / reponse pour la configuration a distance
+--------------------------------------------------------
+*/
+// Inclusion du header du protocole
+#include "CmdProtocol.h" // Codes de commande et prototypes
+// Inclusion du header de tramage
+#include "SerialFrame.h" // Decodeur de trames
+// Inclusion du header RS485
+#include "Rs485.h" // Reception et emission
+// Inclusion du header telemetrie
+#include "Telemetry.h" // Periode d'emission
+// Inclusion du header application
+#include "app.h" // Donnees de l'application
+// Inclusion du header menu
+#include "menu.h" // Changement d'ecran
+// Inclusion du header stockage profil
+#include "ProfilStorage.h" // Lecture / ecriture des profils
+// Inclusion du header potentiometre
+#include "PotControl.h" // Ecriture des wipers
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Reconfiguration du SPI apres un acces pot
+// Inclusion du header gestion d'energie
+#include "PowerMgr.h" // Compteurs d'energie
+// Inclusion du header profiler
+#include "Profiler.h" // Statistiques des sondes
+// Inclusion du header banc de latence
+#include "LatBench.h" // Latence de la capture IR
+// Inclusion du header mesure
+#include "Mesure.h" // Instantane de mesure
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaines de mesure en fond
+// Inclusion du header equilibrage
+#include "Balance.h" // Equilibrage de l'helice
+// Inclusion du header moyenne synchrone
+#include "Tsa.h" // Spectre d'ordres
+// Inclusion du header suivi d'ordres
+#include "OrderTrack.h" // Spectre en ordres pendant les variations de regime
+// Inclusion du header zoom FFT
+#include "Zoom.h" // Bande fine autour de la raie attendue
+// Inclusion du header impulsions IR
+#include "IrPulse.h" // Largeur et qualite des impulsions
+// Inclusion du header compteur IR
+#include "IrCounter.h" // Mode deux fronts actif
+// Inclusion du header calibration IR
+#include "IrCalib.h" // Balayage du seuil IR
+// Inclusion du header banc de performance
+#include "Bench.h" // Mesures du profil d'horloge
+#include <string.h> // Pour memcpy
+
+// Taille maximale d'une reponse (statut compris)
+#define CMD_RESPONSE_MAX    (1 + FRAME_MAX_RX_PAYLOAD)
+
+static SerialFrame_Decoder decoder; // Decodeur des trames recues
+static uint8_t response[CMD_RESPONSE_MAX]; // Reponse en attente d'emission
+static uint16_t responseLen = 0; // Taille de la reponse
+static uint8_t responseType = 0; // Type de la reponse
+static bool responsePending = false; // Reponse a emettre
+static uint32_t commandsExecuted = 0; // Nombre de commandes traitees
+
+/**
+ * @brief Ecran associe a un mode de mesure.
+ *
+ * @param mode Mode demande (MESURE_MODE)
+ * @param menu Pointeur de reception de l'ecran
+ * @return true si le mode est connu
+ */
+static bool CmdProtocol_ModeToMenu(uint8_t mode, MenuState *menu)
+{
+    switch (mode) {
+        case MESURE_MODE_AUCUNE: *menu = MENU_CHOIX_PROFIL; return true; // Retour a l'accueil
+        case MESURE_MODE_VISUEL: *menu = MENU_MESURE_VISUEL; return true; // Mesure IR
+        case MESURE_MODE_AUDIO: *menu = MENU_MESURE_AUDIO; return true; // Mesure micro
+        case MESURE_MODE_VIBRATION: *menu = MENU_MESURE_VIBRATION; return true; // Mesure accelerometre
+        default: return false; // Mode inconnu
+    }
+}
+
+/**
+ * @brief Execute une commande et prepare sa reponse.
+ *
+ * @param type Code de la commande
+ * @param p Payload de la commande
+ * @param len Taille du payload
+ * @return Aucun retour.
+ */
+static void CmdProtocol_Execute(uint8_t type, const uint8_t *p, uint16_t len)
+{
+    uint8_t *data = &response[1]; // Donnees apres le statut
+    uint16_t dataLen = 0; // Taille des donnees
+    uint8_t status = CMD_STATUS_OK; // Statut par defaut
+
+    switch (type) {
+        case CMD_PING:
+            memcpy(data, p, len); // Echo du payload
+            dataLen = len;
+            break;
+
+        case CMD_GET_PROFIL:
+        {
+            Profil *prof; // Profil demande
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            prof = Profils_Get(p[0]); // Recupere le profil
+            if (prof == 0) {
+                status = CMD_STATUS_BAD_ARG; // Index hors limites
+                break;
+            }
+            data[0] = p[0]; // Index
+            data[1] = prof->nbBlades; // Nombre de pales
+            data[2] = prof->nbCylindres; // Nombre de cylindres
+            data[3] = (prof->validFlag == PROFIL_VALID_FLAG) ? 1 : 0; // Profil valide
+            dataLen = 4;
+            break;
+        }
+
+        case CMD_SET_PROFIL:
+            if (len != 3) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if ((p[0] >= NB_PROFILS) || (p[1] == 0) || (p[1] > MENU_MAX_PALES)
+                || (p[2] == 0) || (p[2] > MENU_MAX_CYLINDRES)) {
+                status = CMD_STATUS_BAD_ARG; // Index, nombre de pales ou de cylindres invalide
+            } else {
+                Profils_SaveToNVM(p[0], p[1], p[2]); // Ecriture en NVM
+            }
+            break;
+
+        case CMD_SET_MODE:
+        {
+            MenuState menu; // Ecran correspondant
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (!CmdProtocol_ModeToMenu(p[0], &menu)) {
+                status = CMD_STATUS_BAD_ARG; // Mode inconnu
+            } else {
+                Menu_GoTo(menu); // La mesure demarre au prochain Menu_Task
+            }
+            break;
+        }
+
+        case CMD_GET_MESURE:
+        {
+            Mesure_Snapshot m; // Mesure courante coherente
+            Mesure_Get(&m);
+            SerialFrame_PutU32(&data[0], m.timestampMs); // Horodatage
+            SerialFrame_PutU32(&data[4], m.rpm); // RPM
+            data[8] = m.confidence; // Confiance
+            data[9] = m.mode; // Mode
+            SerialFrame_PutU32(&data[10], m.rpmFiltered); // RPM filtre
+            SerialFrame_PutU32(&data[14], (uint32_t) m.rpmRate); // Derivee [RPM/s]
+            dataLen = 18;
+            break;
+        }
+
+        case CMD_SET_POT:
+            if (len != 2) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] >= POT_TOTAL) {
+                status = CMD_STATUS_BAD_ARG; // Wiper inconnu
+            } else {
+                SPI_ConfigurePot(); // Le SPI1 est partage avec l'accelerometre
+                Pot_Write(p[0], p[1]); // Ecrit le wiper
+                if (MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+                    SPI_ConfigureAcc(); // Rend le SPI a l'accelerometre
+                }
+            }
+            break;
+
+        case CMD_GET_STATS:
+        {
+            const Rs485_Stats *st = Rs485_GetStats(); // Compteurs de la liaison
+            SerialFrame_PutU32(&data[0], appData.tickMs); // Temps depuis le demarrage
+            SerialFrame_PutU32(&data[4], st->framesSent); // Trames emises
+            SerialFrame_PutU32(&data[8], st->bytesSent); // Octets emis
+            SerialFrame_PutU32(&data[12], st->framesDropped); // Trames refusees
+            SerialFrame_PutU32(&data[16], st->bytesReceived); // Octets recus
+            SerialFrame_PutU32(&data[20], st->rxOverflows); // Octets perdus
+            SerialFrame_PutU32(&data[24], decoder.framesOk); // Trames valides
+            SerialFrame_PutU32(&data[28], decoder.crcErrors); // Erreurs CRC
+            SerialFrame_PutU32(&data[32], decoder.lengthErrors); // Erreurs de longueur
+            SerialFrame_PutU32(&data[36], commandsExecuted); // Commandes traitees
+            dataLen = 40;
+            break;
+        }
+
+        case CMD_SET_TELEMETRY:
+            if (len != 2) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else {
+                Telemetry_SetPeriod(SerialFrame_GetU16(p)); // Nouvelle periode
+            }
+            break;
+
+        case CMD_GET_POWER:
+        {
+            const PowerMgr_Stats *pw = PowerMgr_GetStats(); // Estimation d'energie
+            SerialFrame_PutU32(&data[0], pw->averageUa); // Courant moyen
+            SerialFrame_PutU32(&data[4], pw->chargeUah); // Charge consommee
+            data[8] = pw->idlePercent; // Temps en IDLE
+            data[9] = pw->backlight; // Niveau du retroeclairage
+            dataLen = 10;
+            break;
+        }
+
+        case CMD_GET_PROFILE:
+        {
+            Profiler_Site site; // Copie des statistiques
+            uint8_t i;
+            if ((len != 1) && (len != 2)) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            if (!Profiler_Snapshot(p[0], &site)) {
+                status = CMD_STATUS_BAD_ARG; // Sonde inconnue
+                break;
+            }
+            if ((len == 2) && (p[1] != 0)) {
+                Profiler_Clear(p[0]); // Nouvelle fenetre de mesure
+            }
+            data[0] = p[0]; // Sonde
+            data[1] = (uint8_t) Timebase_TicksPerUs(); // Unite des durees
+            SerialFrame_PutU32(&data[2], site.count); // Nombre de mesures
+            SerialFrame_PutU32(&data[6], (site.count != 0) ? site.min : 0); // Minimum
+            SerialFrame_PutU32(&data[10], site.max); // Maximum
+            SerialFrame_PutU32(&data[14], (site.count != 0) ? (uint32_t) (site.sum / site.count) : 0); // Moyenne
+            dataLen = 18;
+            for (i = 0; i < PROF_HIST_BUCKETS; i++) {
+                SerialFrame_PutU16(&data[dataLen], site.hist[i]); // Classe i
+                dataLen += 2;
+            }
+            break;
+        }
+
+        case CMD_LATBENCH:
+            if (len != 2) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else {
+                MesureEngine_Release(MESURE_PIPE_IR); // Le banc prend la capture, la chaine IR repart apres
+                if (!LatBench_Start(SerialFrame_GetU16(p))) {
+                    status = CMD_STATUS_BAD_ARG; // Frequence hors limites
+                }
+            }
+            break;
+
+        case CMD_GET_LATBENCH:
+        {
+            LatBench_Result res; // Copie des resultats
+            const IsrPrio_Config *prio; // Niveaux de la configuration
+            uint16_t freqHz; // Frequence du balayage
+            uint8_t i;
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            prio = IsrPrio_Get(p[0]);
+            if ((prio == 0) || !LatBench_GetResult(p[0], &res)) {
+                status = CMD_STATUS_BAD_ARG; // Configuration inconnue
+                break;
+            }
+            data[0] = p[0]; // Configuration
+            data[1] = LatBench_GetState(&freqHz); // Etat du banc
+            SerialFrame_PutU16(&data[2], freqHz); // Frequence du signal
+            data[4] = prio->timer1; // Niveaux de priorite
+            data[5] = prio->ic3;
+            data[6] = prio->com;
+            data[7] = (uint8_t) Timebase_TicksPerUs(); // Unite de la gigue
+            SerialFrame_PutU32(&data[8], res.edges); // Fronts captures
+            SerialFrame_PutU32(&data[12], res.missed); // Fronts perdus
+            SerialFrame_PutU16(&data[16], (res.edges != 0) ? res.latMin : 0); // Latence min
+            SerialFrame_PutU16(&data[18], res.latMax); // Latence max
+            SerialFrame_PutU16(&data[20], (res.edges != 0) ? (uint16_t) (res.latSum / res.edges) : 0); // Latence moyenne
+            SerialFrame_PutU32(&data[22], res.jitterMax); // Gigue max
+            SerialFrame_PutU32(&data[26], (res.jitterSamples != 0) ? (res.jitterSum / res.jitterSamples) : 0); // Gigue moyenne
+            SerialFrame_PutU32(&data[30], res.rpmSamples); // Calculs RPM verifies
+            SerialFrame_PutU32(&data[34], res.rpmErrMaxPpm); // Erreur RPM max
+            SerialFrame_PutU32(&data[38], (res.rpmSamples != 0) ? (res.e2eSumUs / res.rpmSamples) : 0); // Capture -> RPM moyenne
+            SerialFrame_PutU32(&data[42], res.e2eMaxUs); // Capture -> RPM max
+            dataLen = 46;
+            for (i = 0; i < LATBENCH_HIST_BUCKETS; i++) {
+                SerialFrame_PutU16(&data[dataLen], res.latHist[i]); // Classe i
+                dataLen += 2;
+            }
+            break;
+        }
+
+        case CMD_BENCH:
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (!Bench_Start()) {
+                status = CMD_STATUS_BAD_ARG; // Banc deja en cours
+            }
+            break;
+
+        case CMD_GET_BENCH:
+        {
+            Bench_Result res; // Copie des resultats
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            Bench_GetResult(&res);
+            data[0] = res.state; // Etat du banc
+            data[1] = res.profile; // Profil de performance
+            SerialFrame_PutU16(&data[2], res.sysclkMHz); // SYSCLK
+            data[4] = res.waitStates; // Etats d'attente flash
+            data[5] = res.prefetch; // Prefetch
+            data[6] = res.cacheK0; // Mode du cache
+            data[7] = res.failMask; // Verifications en echec
+            SerialFrame_PutU32(&data[8], res.fft256Cycles); // FFT 256 points
+            SerialFrame_PutU32(&data[12], res.fft1024Cycles); // FFT 1024 points
+            SerialFrame_PutU32(&data[16], res.estimatorCycles); // Estimateur RPM
+            SerialFrame_PutU32(&data[20], res.isrLatMin); // Latence ISR min
+            SerialFrame_PutU32(&data[24], res.isrLatMax); // Latence ISR max
+            SerialFrame_PutU32(&data[28], res.isrLatAvg); // Latence ISR moyenne
+            SerialFrame_PutU32(&data[32], (uint32_t) res.tickErrPpm); // Ecart Timer1
+            SerialFrame_PutU32(&data[36], (uint32_t) res.delayErrPpm); // Ecart delay_usCt
+            SerialFrame_PutU32(&data[40], res.sprintfCycles); // Ligne RPM par sprintf
+            SerialFrame_PutU32(&data[44], res.fmtCycles); // Ligne RPM par Fmt
+            SerialFrame_PutU32(&data[48], res.otCycles); // Suivi d'ordres par echantillon
+            data[52] = res.otPeakPct; // Raie dominante du spectre d'ordres
+            data[53] = res.fftPeakPct; // Raie dominante de la FFT en temps
+            dataLen = 54;
+            break;
+        }
+
+        case CMD_BALANCE:
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] == 0) {
+                Balance_Cancel(); // Abandon
+            } else if ((p[0] != 1) || !Balance_Next()) {
+                status = CMD_STATUS_BAD_ARG; // Action inconnue ou capteurs arretes
+            }
+            break;
+
+        case CMD_GET_BALANCE:
+        {
+            Balance_Result b; // Copie des resultats
+            const Balance_Run *run[2]; // Reference et essai
+            uint8_t i; // Run
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            Balance_Get(&b);
+            run[0] = &b.ref;
+            run[1] = &b.trial;
+            data[0] = b.state; // Etape
+            data[1] = b.flags; // Indicateurs
+            data[2] = b.axis; // Axe retenu
+            dataLen = 3;
+            for (i = 0; i < 2; i++) {
+                SerialFrame_PutU16(&data[dataLen], run[i]->revs); // Tours integres
+                SerialFrame_PutU32(&data[dataLen + 2], (uint32_t) (run[i]->rpm + 0.5f)); // Regime moyen
+                SerialFrame_PutU32(&data[dataLen + 6], (uint32_t) (run[i]->ampMg[b.axis] * 100.0f + 0.5f)); // Amplitude 1x
+                SerialFrame_PutU16(&data[dataLen + 10], (uint16_t) (run[i]->phaseDeg[b.axis] * 10.0f + 0.5f)); // Phase
+                dataLen += 12;
+            }
+            SerialFrame_PutU16(&data[dataLen], (b.corrRatio < 655.0f) ? (uint16_t) (b.corrRatio * 100.0f + 0.5f) : 0xFFFF); // Masse de correction
+            SerialFrame_PutU16(&data[dataLen + 2], (uint16_t) (b.corrDeg * 10.0f + 0.5f)); // Angle de correction
+            dataLen += 4;
+            break;
+        }
+
+        case CMD_TSA:
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] == 0) {
+                Tsa_Stop(); // Fige la revolution moyenne
+            } else if ((p[0] != 1) || !Tsa_Start()) {
+                status = CMD_STATUS_BAD_ARG; // Action inconnue ou capteurs arretes
+            }
+            break;
+
+        case CMD_GET_TSA:
+        {
+            Tsa_Orders o; // Spectre d'ordres
+            uint8_t i; // Ordre
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            if (p[0] > 2) {
+                status = CMD_STATUS_BAD_ARG; // Axe inconnu
+                break;
+            }
+            Tsa_GetOrders(&o);
+            data[0] = o.valid ? 1 : 0; // Tous les angles remplis
+            SerialFrame_PutU16(&data[1], o.revs); // Tours moyennes
+            SerialFrame_PutU32(&data[3], (uint32_t) (o.rpm + 0.5f)); // Regime du dernier tour
+            dataLen = 7;
+            for (i = 0; i < TSA_ORDERS; i++) {
+                float a = o.ampMg[p[0]][i] * 100.0f; // Amplitude [0,01 mg]
+
+                SerialFrame_PutU16(&data[dataLen], (a < 65535.0f) ? (uint16_t) (a + 0.5f) : 0xFFFF);
+                dataLen += 2;
+            }
+            break;
+        }
+
+        case CMD_ORDERTRACK:
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] == 0) {
+                OrderTrack_Stop(); // Fige le dernier spectre
+            } else if ((p[0] != 1) || !OrderTrack_Start()) {
+                status = CMD_STATUS_BAD_ARG; // Action inconnue ou capteurs arretes
+            }
+            break;
+
+        case CMD_GET_ORDERTRACK:
+        {
+            OrderTrack_Result o; // Dernier spectre
+            uint8_t i; // Ordre
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            OrderTrack_Get(&o);
+            data[0] = o.valid ? 1 : 0; // Raie dominante retenue
+            data[1] = o.peakPct; // Part de la raie dominante
+            SerialFrame_PutU16(&data[2], (uint16_t) (o.peakOrder * 100.0f + 0.5f)); // Ordre dominant
+            SerialFrame_PutU16(&data[4], (o.ratio < 65535.0f) ? (uint16_t) (o.ratio + 0.5f) : 0xFFFF); // Rapport
+            SerialFrame_PutU32(&data[6], (uint32_t) (o.rpmMin + 0.5f)); // Regime min de la fenetre
+            SerialFrame_PutU32(&data[10], (uint32_t) (o.rpmMax + 0.5f)); // Regime max de la fenetre
+            SerialFrame_PutU32(&data[14], o.frames); // Spectres calcules
+            dataLen = 18;
+            for (i = 0; i < ORDERTRACK_ORDERS; i++) {
+                float a = o.ampMg[i] * 100.0f; // Amplitude [0,01 mg]
+
+                SerialFrame_PutU16(&data[dataLen], (a < 65535.0f) ? (uint16_t) (a + 0.5f) : 0xFFFF);
+                dataLen += 2;
+            }
+            break;
+        }
+
+        case CMD_ZOOM:
+            if (len != 4) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] == 0) {
+                Zoom_Stop(); // Fige le dernier spectre
+            } else if ((p[0] != 1) || !Zoom_Start(p[1], SerialFrame_GetU16(&p[2]))) {
+                status = CMD_STATUS_BAD_ARG; // Action ou raie inconnue, bande hors plage
+            }
+            break;
+
+        case CMD_GET_ZOOM:
+        {
+            Zoom_Result z; // Dernier spectre
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            Zoom_Get(&z);
+            data[0] = z.valid ? 1 : 0; // Raie retenue
+            data[1] = z.line; // Raie suivie
+            SerialFrame_PutU32(&data[2], (uint32_t) (z.centerHz * 1000.0f + 0.5f)); // Centre
+            SerialFrame_PutU32(&data[6], (uint32_t) (z.freqHz * 1000.0f + 0.5f)); // Raie retenue
+            SerialFrame_PutU32(&data[10], (uint32_t) (z.rpm * 10.0f + 0.5f)); // Regime
+            SerialFrame_PutU16(&data[14], (uint16_t) (z.rpmPerBin * 100.0f + 0.5f)); // Resolution
+            SerialFrame_PutU16(&data[16], (z.snr < 655.0f) ? (uint16_t) (z.snr * 100.0f + 0.5f) : 0xFFFF); // SNR
+            dataLen = 18;
+            break;
+        }
+
+        case CMD_GET_IRPULSE:
+        {
+            IrPulse_Stats s; // Statistiques des impulsions
+            uint8_t b; // Pale
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            IrPulse_Get(&s);
+            data[0] = s.quality; // Qualite du signal
+            data[1] = s.blades; // Pales suivies
+            data[2] = IrCounter_DualEdge() ? 1 : 0; // Statistiques a jour (mode front a front)
+            SerialFrame_PutU32(&data[3], s.pulses); // Impulsions valides
+            SerialFrame_PutU32(&data[7], s.glitches); // Parasites rejetes
+            SerialFrame_PutU32(&data[11], s.dropouts); // Trous combles
+            SerialFrame_PutU32(&data[15], s.resyncs); // Fronts manques
+            dataLen = 19;
+            for (b = 0; b < s.blades; b++) {
+                SerialFrame_PutU16(&data[dataLen], s.widthUs[b]); // Largeur lissee
+                SerialFrame_PutU16(&data[dataLen + 2], s.dutyPermille[b]); // Rapport cyclique lisse
+                dataLen += 4;
+            }
+            break;
+        }
+
+        case CMD_IRCALIB:
+            if (len != 1) {
+                status = CMD_STATUS_BAD_LENGTH;
+            } else if (p[0] == 0) {
+                IrCalib_Cancel(); // Abandon, wiper precedent
+            } else if ((p[0] != 1) || !IrCalib_Start()) {
+                status = CMD_STATUS_BAD_ARG; // Action inconnue ou chaine IR arretee
+            }
+            break;
+
+        case CMD_GET_IRCALIB:
+        {
+            IrCalib_Result r; // Derniere calibration
+            if (len != 0) {
+                status = CMD_STATUS_BAD_LENGTH;
+                break;
+            }
+            IrCalib_Get(&r);
+            data[0] = r.state; // Etat
+            data[1] = r.profil; // Profil calibre
+            data[2] = r.wiper; // Wiper retenu
+            data[3] = r.previous; // Wiper avant la calibration
+            data[4] = r.points; // Positions ecoutees
+            SerialFrame_PutU16(&data[5], r.elapsedMs); // Duree du balayage
+            SerialFrame_PutU32(&data[7], (uint32_t) (r.rateHz * 1000.0f + 0.5f)); // Debit de fronts
+            SerialFrame_PutU16(&data[11], (r.cv < 6.5f) ? (uint16_t) (r.cv * 10000.0f + 0.5f) : 0xFFFF); // Dispersion des periodes
+            SerialFrame_PutU32(&data[13], (uint32_t) (r.score * 1000.0f + 0.5f)); // Score
+            dataLen = 17;
+            break;
+        }
+
+        default:
+            status = CMD_STATUS_UNKNOWN; // Commande inconnue
+            break;
+    }
+
+    commandsExecuted++; // Compte la commande
+    response[0] = status; // Statut en tete de reponse
+    responseLen = (uint16_t) (1 + dataLen); // Statut + donnees
+    responseType = (uint8_t) (type | CMD_RESPONSE_FLAG); // Type de la reponse
+    responsePending = true; // A emettre
+}
+
+/**
+ * @brief Emet la reponse en attente si l'emetteur est libre.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void CmdProtocol_FlushResponse(void)
+{
+    if (responsePending && !Rs485_IsBusy()) {
+        if (Rs485_SendFrame(responseType, response, responseLen)) {
+            responsePending = false; // Reponse partie
+        }
+    }
+}
+
+/**
+ * @brief Initialise le decodeur de commandes.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void CmdProtocol_Init(void)
+{
+    SerialFrame_DecoderInit(&decoder); // Attente de synchro
+    responsePending = false; // Pas de reponse en attente
+    commandsExecuted = 0;
+}
+
+/**
+ * @brief Tache non bloquante : decode les octets recus et execute les commandes.
+ *
+ * @details
+ * La reponse precedente est d'abord emise si l'emetteur est libre. Une seule
+ * commande est executee par appel, les octets suivants restent dans le
+ * buffer de reception.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void CmdProtocol_Task(void)
+{
+    uint8_t b; // Octet recu
+    uint8_t count = 0; // Octets traites pendant cet appel
+
+    CmdProtocol_FlushResponse(); // Reponse precedente
+    if (responsePending) {
+        return; // Emetteur occupe, on reessaie au prochain appel
+    }
+
+    while ((count < CMD_MAX_BYTES_PER_TASK) && Rs485_ReadByte(&b)) {
+        count++;
+        if (SerialFrame_DecodeByte(&decoder, b)) {
+            CmdProtocol_Execute(decoder.type, decoder.payload, decoder.len); // Trame complete
+            CmdProtocol_FlushResponse(); // Reponse immediate si possible
+            return; // Une commande par appel
+        }
+    }
+}
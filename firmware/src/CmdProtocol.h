@@ -0,0 +1,155 @@
+/*
+--------------------------------------------------------
+ Fichier : CmdProtocol.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations du protocole commande / reponse sur la liaison serie
+--------------------------------------------------------*/
+
+#ifndef _CMDPROTOCOL_H_
+#define _CMDPROTOCOL_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Les commandes et les reponses utilisent le tramage de SerialFrame.
+ * Une reponse porte le type de la commande avec le bit 7 a 1 ; son premier
+ * octet de payload est un statut (CMD_STATUS_xxx).
+ *
+ *   Commande            Payload commande        Payload reponse (apres statut)
+ *   CMD_PING            octets quelconques      echo des octets
+ *   CMD_GET_PROFIL      idx                     idx, pales, cylindres, valide
+ *   CMD_SET_PROFIL      idx, pales (1-4),       -
+ *                       cylindres (1-7)
+ *   CMD_SET_MODE        mode (MESURE_MODE)      -
+ *   CMD_GET_MESURE      -                       t ms (u32), rpm (u32), conf, mode,
+ *                                               rpm filtre (u32), derivee (i32, RPM/s)
+ *   CMD_SET_POT         index, valeur           -
+ *   CMD_GET_STATS       -                       compteurs (u32, voir .c)
+ *   CMD_SET_TELEMETRY   periode ms (u16)        -
+ *   CMD_GET_POWER       -                       courant uA (u32), charge uAh (u32),
+ *                                               idle %, retroeclairage
+ *   CMD_GET_PROFILE     site [, effacer]        site, ticks/us, nb (u32), min, max,
+ *                                               moyenne (u32, ticks), histogramme
+ *                                               log2 (PROF_HIST_BUCKETS x u16)
+ *   CMD_LATBENCH        frequence Hz (u16)      -  (lance le balayage des priorites)
+ *   CMD_GET_LATBENCH    config                  config, etat, frequence (u16), niveaux
+ *                                               T1 / IC3 / com, ticks/us, fronts (u32),
+ *                                               perdus (u32), latence min, max, moy
+ *                                               (u16, ticks IC 100 ns), gigue max, moy
+ *                                               (u32, ticks Core Timer), calculs RPM
+ *                                               (u32), erreur RPM max (u32, ppm),
+ *                                               capture -> RPM moy, max (u32, us),
+ *                                               histogramme log2 des latences
+ *                                               (LATBENCH_HIST_BUCKETS x u16)
+ *   CMD_BENCH           -                       -  (lance le banc de performance)
+ *   CMD_GET_BENCH       -                       etat, profil, SYSCLK MHz (u16), etats
+ *                                               d'attente, prefetch, cache K0, echecs
+ *                                               (BENCH_FAIL_xxx), cycles FFT 256, FFT
+ *                                               1024, estimateur, latence ISR min, max,
+ *                                               moy (u32, cycles CPU), ecart Timer1,
+ *                                               ecart delay_usCt (i32, ppm), ligne
+ *                                               RPM sprintf, Fmt (u32, cycles CPU),
+ *                                               suivi d'ordres par echantillon (u32,
+ *                                               cycles CPU), raie dominante du
+ *                                               spectre d'ordres, de la FFT en
+ *                                               temps (u8, %)
+ *   CMD_BALANCE         action (0 abandon,      -  (refus si chaine IR ou vibration
+ *                       1 etape suivante)          arretee)
+ *   CMD_GET_BALANCE     -                       etape, flags, axe, puis pour la
+ *                                               reference et l'essai : tours (u16),
+ *                                               RPM (u32), amplitude 1x (u32, 0,01 mg),
+ *                                               phase (u16, 0,1 deg) ; correction
+ *                                               (u16, % de la masse d'essai), angle
+ *                                               (u16, 0,1 deg)
+ *   CMD_TSA             action (0 arret,        -  (refus si chaine IR ou vibration
+ *                       1 nouvelle moyenne)        arretee)
+ *   CMD_GET_TSA         axe (0 X, 1 Y, 2 Z)     valide (u8), tours (u16), RPM (u32),
+ *                                               ordres 1 a TSA_ORDERS de l'axe
+ *                                               (u16, 0,01 mg)
+ *   CMD_ORDERTRACK      action (0 arret,        -  (refus si chaine IR ou vibration
+ *                       1 demarrage)               arretee)
+ *   CMD_GET_ORDERTRACK  -                       valide, part de la raie dominante
+ *                                               (u8, %), ordre dominant (u16, 0,01),
+ *                                               rapport (u16), RPM min, max, spectres
+ *                                               (u32), ordres 1 a ORDERTRACK_ORDERS
+ *                                               (u16, 0,01 mg)
+ *   CMD_ZOOM            action (0 arret,        -  (refus si chaine vibration
+ *                       1 demarrage), raie         arretee ou raie hors de la
+ *                       (0 pales, 1 allumage),     plage analysable)
+ *                       RPM du centre (u16,
+ *                       0 = suit la fusion)
+ *   CMD_GET_ZOOM        -                       valide, raie, centre, raie retenue
+ *                                               (u32, mHz), RPM (u32, 0,1 RPM),
+ *                                               RPM par raie (u16, 0,01 RPM),
+ *                                               SNR (u16, 0,01)
+ *   CMD_GET_IRPULSE     -                       qualite %, pales, deux fronts actifs,
+ *                                               impulsions, parasites, trous, fronts
+ *                                               manques (u32), par pale : largeur
+ *                                               (u16, us), rapport cyclique (u16, 1/1000)
+ *   CMD_IRCALIB         action (0 abandon,      -  (refus si chaine IR arretee)
+ *                       1 demarrage)
+ *   CMD_GET_IRCALIB     -                       etat, profil, wiper retenu, wiper
+ *                                               precedent, positions, duree (u16, ms),
+ *                                               debit (u32, mHz), ecart type relatif
+ *                                               des periodes (u16, 1/10000), score
+ *                                               (u32, mHz)
+ */
+
+// Codes de commande
+#define CMD_PING            0x10 // Test de la liaison
+#define CMD_GET_PROFIL      0x11 // Lecture d'un profil
+#define CMD_SET_PROFIL      0x12 // Ecriture d'un profil en NVM
+#define CMD_SET_MODE        0x13 // Changement de mode de mesure
+#define CMD_GET_MESURE      0x14 // Lecture de la mesure courante
+#define CMD_SET_POT         0x15 // Ecriture d'un potentiometre
+#define CMD_GET_STATS       0x16 // Lecture des compteurs
+#define CMD_SET_TELEMETRY   0x17 // Periode de la telemetrie
+#define CMD_GET_POWER       0x18 // Estimation de la consommation
+#define CMD_GET_PROFILE     0x19 // Statistiques d'une sonde de temps
+#define CMD_LATBENCH        0x1A // Lancement du banc de latence
+#define CMD_GET_LATBENCH    0x1B // Resultats du banc de latence
+#define CMD_BENCH           0x1C // Lancement du banc de performance
+#define CMD_GET_BENCH       0x1D // Resultats du banc de performance
+#define CMD_BALANCE         0x1E // Etape de l'equilibrage
+#define CMD_GET_BALANCE     0x1F // Resultats de l'equilibrage
+#define CMD_TSA             0x20 // Demarrage / arret de la moyenne synchrone
+#define CMD_GET_TSA         0x21 // Spectre d'ordres de la moyenne synchrone
+#define CMD_ORDERTRACK      0x22 // Demarrage / arret du suivi d'ordres
+#define CMD_GET_ORDERTRACK  0x23 // Spectre du suivi d'ordres
+#define CMD_ZOOM            0x24 // Demarrage / arret du zoom FFT
+#define CMD_GET_ZOOM        0x25 // Spectre zoome
+#define CMD_GET_IRPULSE     0x26 // Largeur et qualite des impulsions IR
+#define CMD_IRCALIB         0x27 // Lancement / abandon de la calibration du seuil IR
+#define CMD_GET_IRCALIB     0x28 // Resultat de la calibration du seuil IR
+// Bit ajoute au type pour les reponses
+#define CMD_RESPONSE_FLAG   0x80
+
+// Statuts de reponse
+#define CMD_STATUS_OK           0x00 // Commande executee
+#define CMD_STATUS_BAD_LENGTH   0x01 // Longueur de payload incorrecte
+#define CMD_STATUS_BAD_ARG      0x02 // Argument hors limites
+#define CMD_STATUS_UNKNOWN      0x03 // Commande inconnue
+
+// Nombre maximal d'octets traites par appel de la tache
+#define CMD_MAX_BYTES_PER_TASK  64
+
+/**
+ * @brief Initialise le decodeur de commandes.
+ */
+void CmdProtocol_Init(void);
+
+/**
+ * @brief Tache non bloquante : decode les octets recus et execute les commandes.
+ *
+ * @details
+ * Traite au plus CMD_MAX_BYTES_PER_TASK octets par appel. Tant qu'une
+ * reponse n'a pas pu etre emise, les nouveaux octets restent dans le
+ * buffer de reception.
+ *
+ * @pre Rs485_Init doit avoir ete appelee.
+ */
+void CmdProtocol_Task(void);
+
+#endif
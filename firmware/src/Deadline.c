@@ -0,0 +1,86 @@
+/*
+--------------------------------------------------------
+ Fichier : Deadline.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Echeances et reprises differees sur la base de temps 64 bits
+--------------------------------------------------------
+*/
+// Inclusion du header echeances
+#include "Deadline.h" // Prototypes des echeances
+// Inclusion du header base de temps
+#include "Timebase.h" // Horodatage 64 bits
+
+/**
+ * @brief Echeance dans un nombre de microsecondes.
+ *
+ * @param us Delai en us
+ * @return Instant absolu de l'echeance
+ */
+Deadline Deadline_InUs(uint32_t us)
+{
+    return Timebase_Now64() + ((uint64_t) us * Timebase_TicksPerUs());
+}
+
+/**
+ * @brief Echeance dans un nombre de millisecondes.
+ *
+ * @param ms Delai en ms
+ * @return Instant absolu de l'echeance
+ */
+Deadline Deadline_InMs(uint32_t ms)
+{
+    return Timebase_Now64() + ((uint64_t) ms * 1000 * Timebase_TicksPerUs());
+}
+
+/**
+ * @brief Indique si l'echeance est atteinte.
+ *
+ * @param d Echeance
+ * @return true si l'instant est depasse
+ */
+bool Deadline_Expired(Deadline d)
+{
+    return (Timebase_Now64() >= d);
+}
+
+/**
+ * @brief Temps restant avant l'echeance.
+ *
+ * @param d Echeance
+ * @return Temps restant en us (0 si atteinte)
+ */
+uint32_t Deadline_RemainingUs(Deadline d)
+{
+    uint64_t now = Timebase_Now64(); // Instant courant
+
+    if (now >= d) {
+        return 0; // Echeance atteinte
+    }
+    return (uint32_t) ((d - now) / Timebase_TicksPerUs());
+}
+
+/**
+ * @brief Programme la reprise d'une machine d'etat.
+ *
+ * @param r Point de reprise
+ * @param step Etape a executer a la reprise
+ * @param us Delai avant la reprise en us
+ * @return Aucun retour.
+ */
+void Deadline_ResumeAfterUs(Deadline_Resume *r, uint8_t step, uint32_t us)
+{
+    r->step = step; // Etape suivante
+    r->resumeAt = Deadline_InUs(us); // Instant de reprise
+}
+
+/**
+ * @brief Indique si la machine d'etat peut reprendre.
+ *
+ * @param r Point de reprise
+ * @return true si le delai est ecoule
+ */
+bool Deadline_CanResume(const Deadline_Resume *r)
+{
+    return Deadline_Expired(r->resumeAt);
+}
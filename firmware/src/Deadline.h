@@ -0,0 +1,89 @@
+/*
+--------------------------------------------------------
+ Fichier : Deadline.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Echeances et reprises differees pour les machines d'etat
+--------------------------------------------------------*/
+
+#ifndef _DEADLINE_H_
+#define _DEADLINE_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Une echeance est un instant absolu sur la base de temps 64 bits
+ * (Timebase_Now64). Elle ne deborde jamais : la comparaison est directe.
+ *
+ * Attente bornee :
+ *     Deadline dl = Deadline_InUs(100);
+ *     while (!Pret() && !Deadline_Expired(dl)) { }
+ *
+ * Reprise differee d'une machine d'etat (sans bloquer le CPU) :
+ *     Deadline_ResumeAfterUs(&r, ETAPE_SUIVANTE, 2000);
+ *     ...
+ *     if (Deadline_CanResume(&r)) { switch (r.step) { ... } }
+ */
+
+// Instant absolu en ticks du Core Timer
+typedef uint64_t Deadline;
+
+/**
+ * @brief Point de reprise d'une machine d'etat.
+ */
+typedef struct {
+    Deadline resumeAt;  // Instant de reprise
+    uint8_t step;       // Etape a executer a la reprise
+} Deadline_Resume;
+
+/**
+ * @brief Echeance dans un nombre de microsecondes.
+ *
+ * @param us Delai en us
+ * @return Instant absolu de l'echeance
+ */
+Deadline Deadline_InUs(uint32_t us);
+
+/**
+ * @brief Echeance dans un nombre de millisecondes.
+ *
+ * @param ms Delai en ms
+ * @return Instant absolu de l'echeance
+ */
+Deadline Deadline_InMs(uint32_t ms);
+
+/**
+ * @brief Indique si l'echeance est atteinte.
+ *
+ * @param d Echeance
+ * @return true si l'instant est depasse
+ */
+bool Deadline_Expired(Deadline d);
+
+/**
+ * @brief Temps restant avant l'echeance.
+ *
+ * @param d Echeance
+ * @return Temps restant en us (0 si atteinte)
+ */
+uint32_t Deadline_RemainingUs(Deadline d);
+
+/**
+ * @brief Programme la reprise d'une machine d'etat.
+ *
+ * @param r Point de reprise
+ * @param step Etape a executer a la reprise
+ * @param us Delai avant la reprise en us
+ */
+void Deadline_ResumeAfterUs(Deadline_Resume *r, uint8_t step, uint32_t us);
+
+/**
+ * @brief Indique si la machine d'etat peut reprendre.
+ *
+ * @param r Point de reprise
+ * @return true si le delai est ecoule
+ */
+bool Deadline_CanResume(const Deadline_Resume *r);
+
+#endif
@@ -0,0 +1,192 @@
+/*
+--------------------------------------------------------
+ Fichier : Fft.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : FFT complexe radix-2 en virgule flottante (FPU du PIC32MZ EF)
+--------------------------------------------------------
+*/
+// Inclusion du header FFT
+#include "Fft.h" // Prototypes de la FFT
+#include <math.h> // Pour sinf / cosf / sqrtf
+
+#define FFT_PI 3.14159265358979f // Pi en simple precision
+
+static float twCos[FFT_MAX_N / 2]; // cos(2 pi k / FFT_MAX_N)
+static float twSin[FFT_MAX_N / 2]; // -sin(2 pi k / FFT_MAX_N)
+static bool twReady = false; // Table calculee
+
+/**
+ * @brief Calcule la table des facteurs de rotation (FFT_MAX_N / 2 points).
+ *
+ * @details
+ * Une seule table pour toutes les tailles : une FFT de taille n lit un
+ * point sur FFT_MAX_N / n.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Fft_Init(void)
+{
+    uint16_t k; // Index de la table
+
+    for (k = 0; k < (FFT_MAX_N / 2); k++) {
+        float a = (2.0f * FFT_PI * (float) k) / (float) FFT_MAX_N; // Angle
+        twCos[k] = cosf(a);
+        twSin[k] = -sinf(a); // Transformee directe : exp(-j a)
+    }
+    twReady = true;
+}
+
+/**
+ * @brief FFT directe en place.
+ *
+ * @details
+ * Permutation bit-reverse puis papillons radix-2 (decimation temporelle).
+ * Pas de normalisation : la raie k d'une sinusoide d'amplitude A vaut
+ * A * n / 2.
+ *
+ * @param x Echantillons, remplaces par le spectre
+ * @param n Taille (puissance de 2, 2 a FFT_MAX_N)
+ * @return false si la taille n'est pas supportee
+ */
+bool Fft_Forward(Fft_Cplx *x, uint16_t n)
+{
+    uint16_t i, j, bit; // Index de la permutation
+    uint16_t len, half, step, k; // Etage de papillons
+
+    if ((n < 2) || (n > FFT_MAX_N) || ((n & (n - 1)) != 0)) {
+        return false; // Taille non puissance de 2
+    }
+    if (!twReady) {
+        Fft_Init(); // Table calculee au premier appel
+    }
+
+    // Permutation bit-reverse
+    for (i = 1, j = 0; i < n; i++) {
+        for (bit = n >> 1; (j & bit) != 0; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            Fft_Cplx t = x[i]; // Echange
+            x[i] = x[j];
+            x[j] = t;
+        }
+    }
+
+    // Papillons
+    for (len = 2; len <= n; len <<= 1) {
+        half = len >> 1;
+        step = FFT_MAX_N / len; // Pas dans la table
+        for (i = 0; i < n; i += len) {
+            for (k = 0; k < half; k++) {
+                float wr = twCos[k * step]; // Facteur de rotation
+                float wi = twSin[k * step];
+                Fft_Cplx *a = &x[i + k];
+                Fft_Cplx *b = &x[i + k + half];
+                float tr = (b->re * wr) - (b->im * wi); // b * w
+                float ti = (b->re * wi) + (b->im * wr);
+                b->re = a->re - tr;
+                b->im = a->im - ti;
+                a->re += tr;
+                a->im += ti;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Module au carre des premieres raies du spectre.
+ *
+ * @param x Spectre
+ * @param power Puissance par raie
+ * @param bins Nombre de raies (n / 2 pour un signal reel)
+ * @return Aucun retour.
+ */
+void Fft_Power(const Fft_Cplx *x, float *power, uint16_t bins)
+{
+    uint16_t k; // Index de raie
+
+    for (k = 0; k < bins; k++) {
+        power[k] = (x[k].re * x[k].re) + (x[k].im * x[k].im);
+    }
+}
+
+/**
+ * @brief Puissance moyenne du bruit par raie, estimee par la mediane.
+ *
+ * @details
+ * Selection rapide (Hoare) en place sur les parties reelles : O(n) en
+ * moyenne, sans tableau supplementaire.
+ *
+ * @param scratch Puissances dans les parties reelles (ordre detruit)
+ * @param n Nombre de raies
+ * @param dof Degres de liberte d'une raie de bruit
+ * @return Puissance moyenne du bruit
+ */
+float Fft_NoiseFloor(Fft_Cplx *scratch, uint16_t n, float dof)
+{
+    uint16_t lo = 0; // Debut de la partition
+    uint16_t hi; // Fin de la partition
+    uint16_t mid = n / 2; // Rang de la mediane
+    float v = 2.0f / (9.0f * dof); // Terme de Wilson-Hilferty
+    float shrink; // Mediane / moyenne du chi-deux
+
+    if (n == 0) {
+        return 0.0f;
+    }
+    hi = n - 1;
+    while (lo < hi) {
+        float pivot = scratch[(lo + hi) / 2].re; // Valeur centrale
+        uint16_t i = lo; // Curseur bas
+        uint16_t j = hi; // Curseur haut
+
+        while (i <= j) {
+            while (scratch[i].re < pivot) {
+                i++;
+            }
+            while (scratch[j].re > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                float t = scratch[i].re; // Echange
+
+                scratch[i].re = scratch[j].re;
+                scratch[j].re = t;
+                i++;
+                if (j == 0) {
+                    break;
+                }
+                j--;
+            }
+        }
+        if (mid <= j) {
+            hi = j; // Mediane a gauche
+        } else if (mid >= i) {
+            lo = i; // Mediane a droite
+        } else {
+            break; // Entre les deux : egale au pivot
+        }
+    }
+
+    shrink = 1.0f - v;
+    shrink = shrink * shrink * shrink;
+    return scratch[mid].re / shrink;
+}
+
+/**
+ * @brief Seuil raie / bruit pour une probabilite de fausse alarme donnee.
+ *
+ * @param dof Degres de liberte d'une raie de bruit
+ * @param z Ecart normal du quantile
+ * @return Seuil sur le rapport raie / puissance moyenne du bruit
+ */
+float Fft_SnrThreshold(float dof, float z)
+{
+    float v = 2.0f / (9.0f * dof); // Terme de Wilson-Hilferty
+    float q = 1.0f - v + z * sqrtf(v); // Quantile de la racine cubique
+
+    return q * q * q;
+}
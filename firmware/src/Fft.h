@@ -0,0 +1,79 @@
+/*
+--------------------------------------------------------
+ Fichier : Fft.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : FFT complexe radix-2 en virgule flottante (FPU du PIC32MZ EF)
+--------------------------------------------------------*/
+
+#ifndef _FFT_H_
+#define _FFT_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+// Taille maximale de transformee (puissance de 2)
+#define FFT_MAX_N   1024
+
+/**
+ * @brief Echantillon complexe.
+ */
+typedef struct {
+    float re;   // Partie reelle
+    float im;   // Partie imaginaire
+} Fft_Cplx;
+
+/**
+ * @brief Calcule la table des facteurs de rotation (FFT_MAX_N / 2 points).
+ */
+void Fft_Init(void);
+
+/**
+ * @brief FFT directe en place.
+ *
+ * @param x Echantillons, remplaces par le spectre
+ * @param n Taille (puissance de 2, 2 a FFT_MAX_N)
+ * @return false si la taille n'est pas supportee
+ */
+bool Fft_Forward(Fft_Cplx *x, uint16_t n);
+
+/**
+ * @brief Module au carre des premieres raies du spectre.
+ *
+ * @param x Spectre
+ * @param power Puissance par raie
+ * @param bins Nombre de raies (n / 2 pour un signal reel)
+ */
+void Fft_Power(const Fft_Cplx *x, float *power, uint16_t bins);
+
+/**
+ * @brief Puissance moyenne du bruit par raie, estimee par la mediane.
+ *
+ * @details
+ * Une raie de bruit suit un chi-deux a dof degres de liberte (2 par
+ * spectre complexe somme ou moyenne). Sa mediane vaut la moyenne fois
+ * (1 - 2 / (9 dof))^3 (Wilson-Hilferty) et ne bouge pas pour quelques
+ * raies de signal, contrairement a la moyenne.
+ *
+ * @param scratch Puissances dans les parties reelles (ordre detruit)
+ * @param n Nombre de raies
+ * @param dof Degres de liberte d'une raie de bruit
+ * @return Puissance moyenne du bruit
+ */
+float Fft_NoiseFloor(Fft_Cplx *scratch, uint16_t n, float dof);
+
+/**
+ * @brief Seuil raie / bruit pour une probabilite de fausse alarme donnee.
+ *
+ * @details
+ * Quantile du chi-deux normalise (Wilson-Hilferty) : z = 3,7 donne une
+ * fausse alarme de 1e-4 par raie. Le seuil baisse quand la moyenne
+ * porte sur plus de spectres.
+ *
+ * @param dof Degres de liberte d'une raie de bruit
+ * @param z Ecart normal du quantile
+ * @return Seuil sur le rapport raie / puissance moyenne du bruit
+ */
+float Fft_SnrThreshold(float dof, float z);
+
+#endif
@@ -0,0 +1,154 @@
+/*
+--------------------------------------------------------
+ Fichier : Fmt.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Formatage de nombres a largeur fixe sans sprintf ni allocation
+--------------------------------------------------------
+*/
+// Inclusion du header formatage
+#include "Fmt.h" // Prototypes du formatage
+
+// Texte le plus long : '-' + 10 chiffres + '.' + decimales
+#define FMT_TMP_LEN     (12 + FMT_MAX_DECIMALS)
+
+// Puissances de 10 des decimales
+static const uint32_t fmtPow10[FMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+/**
+ * @brief Chiffres decimaux d'une valeur, du poids faible au poids fort.
+ *
+ * @param tmp Destination (chiffres inverses)
+ * @param v Valeur
+ * @param minDigits Nombre minimal de chiffres (zeros de tete)
+ * @return Nombre de chiffres ecrits
+ */
+static uint8_t Fmt_Digits(char *tmp, uint32_t v, uint8_t minDigits)
+{
+    uint8_t n = 0; // Chiffres ecrits
+
+    do {
+        tmp[n++] = (char) ('0' + (v % 10)); // Division par constante : pas d'appel de bibliotheque
+        v /= 10;
+    } while ((v != 0) || (n < minDigits));
+    return n;
+}
+
+/**
+ * @brief Copie un texte inverse dans un champ aligne a droite.
+ *
+ * @param dst Destination
+ * @param tmp Texte inverse
+ * @param len Longueur du texte
+ * @param width Largeur du champ (0 = len)
+ * @return Adresse qui suit le champ
+ */
+static char *Fmt_EmitRight(char *dst, const char *tmp, uint8_t len, uint8_t width)
+{
+    if (dst == 0) {
+        return 0; // Position hors ecran
+    }
+    if (width == 0) {
+        width = len; // Champ a la taille du texte
+    }
+    if (len > width) {
+        while (width-- != 0) {
+            *dst++ = '*'; // Depassement visible
+        }
+        return dst;
+    }
+    for (width -= len; width != 0; width--) {
+        *dst++ = ' '; // Alignement a droite
+    }
+    while (len != 0) {
+        *dst++ = tmp[--len]; // Poids fort en premier
+    }
+    return dst;
+}
+
+/**
+ * @brief Entier non signe aligne a droite.
+ *
+ * @param dst Destination
+ * @param v Valeur
+ * @param width Largeur du champ (0 = nombre de chiffres)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Uint(char *dst, uint32_t v, uint8_t width)
+{
+    char tmp[FMT_TMP_LEN]; // Texte inverse
+
+    return Fmt_EmitRight(dst, tmp, Fmt_Digits(tmp, v, 1), width);
+}
+
+/**
+ * @brief Entier signe aligne a droite ('-' colle aux chiffres).
+ *
+ * @param dst Destination
+ * @param v Valeur
+ * @param width Largeur du champ (0 = signe + nombre de chiffres)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Int(char *dst, int32_t v, uint8_t width)
+{
+    return Fmt_Fixed(dst, v, 0, width);
+}
+
+/**
+ * @brief Nombre a virgule fixe aligne a droite.
+ *
+ * @param dst Destination
+ * @param v Valeur entiere mise a l'echelle (10^-decimals)
+ * @param decimals Chiffres apres le point (0 a FMT_MAX_DECIMALS)
+ * @param width Largeur du champ (0 = place du texte)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Fixed(char *dst, int32_t v, uint8_t decimals, uint8_t width)
+{
+    char tmp[FMT_TMP_LEN]; // Texte inverse
+    uint32_t mag = (v < 0) ? (0U - (uint32_t) v) : (uint32_t) v; // Valeur absolue (INT32_MIN compris)
+    uint8_t len = 0; // Longueur du texte
+
+    if (decimals > FMT_MAX_DECIMALS) {
+        decimals = FMT_MAX_DECIMALS;
+    }
+    if (decimals != 0) {
+        len = Fmt_Digits(tmp, mag % fmtPow10[decimals], decimals); // Decimales, zeros compris
+        tmp[len++] = '.';
+        mag /= fmtPow10[decimals]; // Partie entiere
+    }
+    len += Fmt_Digits(&tmp[len], mag, 1);
+    if (v < 0) {
+        tmp[len++] = '-';
+    }
+    return Fmt_EmitRight(dst, tmp, len, width);
+}
+
+/**
+ * @brief Chaine alignee a gauche, completee par des espaces ou coupee.
+ *
+ * @param dst Destination
+ * @param s Chaine terminee par '\0'
+ * @param width Largeur du champ (0 = longueur de la chaine)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Str(char *dst, const char *s, uint8_t width)
+{
+    if (dst == 0) {
+        return 0; // Position hors ecran
+    }
+    if (width == 0) {
+        while (*s != '\0') {
+            *dst++ = *s++; // Champ a la taille de la chaine
+        }
+        return dst;
+    }
+    while ((width != 0) && (*s != '\0')) {
+        *dst++ = *s++;
+        width--;
+    }
+    while (width-- != 0) {
+        *dst++ = ' '; // Complete a droite
+    }
+    return dst;
+}
@@ -0,0 +1,77 @@
+/*
+--------------------------------------------------------
+ Fichier : Fmt.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Formatage de nombres a largeur fixe sans sprintf ni allocation
+--------------------------------------------------------*/
+
+#ifndef _FMT_H_
+#define _FMT_H_
+
+#include <stdint.h> // Types entiers standard
+
+/*
+ * Remplace sprintf sur le chemin d'affichage : les champs sont ecrits
+ * directement a l'adresse donnee (typiquement lcd_frame_at()), sans '\0'.
+ * Chaque fonction retourne l'adresse qui suit le champ pour enchainer les
+ * champs d'une ligne.
+ *
+ * width = 0 : le champ prend exactement la place du texte.
+ * width > 0 : nombres alignes a droite, chaines a gauche, completes par
+ *             des espaces ; un nombre trop long remplit le champ de '*'
+ *             (jamais de chiffre tronque a l'ecran).
+ *
+ * dst = 0 est accepte (position hors ecran) : rien n'est ecrit et 0 est
+ * retourne, ce qui neutralise le reste de la chaine d'appels.
+ */
+
+// Nombre maximal de decimales de Fmt_Fixed
+#define FMT_MAX_DECIMALS    4
+
+/**
+ * @brief Entier non signe aligne a droite.
+ *
+ * @param dst Destination
+ * @param v Valeur
+ * @param width Largeur du champ (0 = nombre de chiffres)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Uint(char *dst, uint32_t v, uint8_t width);
+
+/**
+ * @brief Entier signe aligne a droite ('-' colle aux chiffres).
+ *
+ * @param dst Destination
+ * @param v Valeur
+ * @param width Largeur du champ (0 = signe + nombre de chiffres)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Int(char *dst, int32_t v, uint8_t width);
+
+/**
+ * @brief Nombre a virgule fixe aligne a droite.
+ *
+ * @details
+ * v est exprime en 10^-decimals : Fmt_Fixed(d, -1234, 2, 7) ecrit
+ * " -12.34".
+ *
+ * @param dst Destination
+ * @param v Valeur entiere mise a l'echelle
+ * @param decimals Chiffres apres le point (0 a FMT_MAX_DECIMALS)
+ * @param width Largeur du champ (0 = place du texte)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Fixed(char *dst, int32_t v, uint8_t decimals, uint8_t width);
+
+/**
+ * @brief Chaine alignee a gauche, completee par des espaces ou coupee.
+ *
+ * @param dst Destination
+ * @param s Chaine terminee par '\0'
+ * @param width Largeur du champ (0 = longueur de la chaine)
+ * @return Adresse qui suit le champ
+ */
+char *Fmt_Str(char *dst, const char *s, uint8_t width);
+
+#endif
@@ -1,155 +1,240 @@
 // GestBtn.c
 #include "peripheral/ports/plib_ports.h" // Inclusion des fonctions de gestion des ports
 #include "system_config.h" // Inclusion de la configuration systeme
+#include "system_definitions.h" // Inclusion des definitions systeme (PLIB interruptions)
 #include "GestBtn.h" // Inclusion du header de gestion des boutons
+#include "app.h" // Inclusion de la base de temps ms
 
-// --- Parametres internes de debounce ---
-static const uint8_t kMaxDebounceCount = 5; // Nombre d'iterations pour valider un changement
-
-typedef enum {
-    DebounceWaitChange, // Attente d'un changement d'etat
-    DebounceWaitStable  // Attente de la stabilite de l'etat
-} E_DebounceState;
+#define GESTBTN_NB          2 // Boutons geres
+#define GESTBTN_PORT_MASK   0x0003u // RE0 = OK, RE1 = SELECT (actifs a 0)
 
+// Etat d'un bouton
 typedef struct {
-    E_DebounceState state; // etat du mecanisme d'antirebond
-    uint8_t         counter; // Compteur d'iterations
-    struct {
-        uint8_t pressed : 1;  // evenement presse detecte
-        uint8_t prev    : 1;  // Derniere valeur brute lue
-        uint8_t value   : 1;  // Valeur stable apres antirebond
-    } bits;
-} S_Switch;
-
-// Descripteurs pour OK et SELECT
-static S_Switch swOK, swSelect;
+    uint8_t mask;           // Masque du bouton (GESTBTN_OK ou GESTBTN_SELECT)
+    bool down;              // Etat valide (true = appuye)
+    bool reported;          // PRESS (ou accord) deja emis pour cet appui
+    bool longDone;          // LONG deja emis pour cet appui
+    uint32_t downMs;        // Date de l'appui valide [ms]
+    uint32_t nextRepeatMs;  // Prochaine repetition [ms]
+} S_Button;
+
+static S_Button buttons[GESTBTN_NB] = {
+    { GESTBTN_OK, false, false, false, 0, 0 },
+    { GESTBTN_SELECT, false, false, false, 0, 0 }
+};
+static volatile uint32_t edgeMs[GESTBTN_NB]; // Date du dernier front (ISR)
+static volatile bool edgeSeen = false; // Front vu par l'ISR depuis le dernier passage
+static bool chord = false; // Accord en cours
+
+static GestBtn_Event queue[GESTBTN_QUEUE_LEN]; // File des evenements
+static uint8_t qHead = 0; // Plus ancien evenement
+static uint8_t qCount = 0; // Evenements en attente
+static uint32_t dropped = 0; // Evenements perdus
 
 /**
- * @brief  Mecanisme de debounce, a appeler chaque tick (~1 ms).
+ * @brief  Etat brut des boutons (bit a 1 = appuye).
  *
- * @details
- * Cette fonction gere l'antirebond logiciel d'un bouton. Elle doit etre appelee
- * a chaque tick (environ 1 ms) pour chaque bouton a surveiller.
+ * @param Aucun parametre.
+ * @return Masque GESTBTN_OK | GESTBTN_SELECT
+ */
+static uint8_t GestBtn_ReadRaw(void)
+{
+    // 1 = relache, 0 = appuye
+    return (uint8_t) (~PLIB_PORTS_Read(PORTS_ID_0, PORT_CHANNEL_E) & GESTBTN_PORT_MASK);
+}
+
+/**
+ * @brief  Ajoute un evenement a la file.
  *
- * @param sw   pointeur sur le descripteur du bouton
- * @param raw  etat brut (1 = relche, 0 = appuye)
+ * @param type Type (GESTBTN_EVENT_TYPE)
+ * @param mask Bouton(s)
+ * @param timeMs Date de l'appui [ms]
  * @return Aucun retour.
- *
- * @pre Le descripteur doit etre initialise.
- * @post L'etat stable du bouton est mis a jour.
  */
-static void debounce_switch(S_Switch *sw, bool raw)
+static void GestBtn_Push(uint8_t type, uint8_t mask, uint32_t timeMs)
 {
-    switch (sw->state) {
-        case DebounceWaitChange:
-            if (raw != sw->bits.prev) {
-                sw->bits.prev = raw; // Met a jour la valeur precedente
-                sw->state      = DebounceWaitStable; // Passe a l'attente de stabilite
-            }
-            break;
-
-        case DebounceWaitStable:
-            if (raw == sw->bits.prev) {
-                if (++sw->counter >= kMaxDebounceCount) {
-                    sw->bits.value   = raw; // Met a jour la valeur stable
-                    if (!raw)        // front descendant = appui
-                        sw->bits.pressed = 1; // Note l'appui
-                    sw->state        = DebounceWaitChange; // Retour a l'attente de changement
-                    sw->counter      = 0; // Reinitialise le compteur
-                }
-            } else {
-                sw->counter   = 0; // Reinitialise le compteur
-                sw->bits.prev = raw; // Met a jour la valeur precedente
-            }
-            break;
+    GestBtn_Event *ev; // Place dans la file
+
+    if (qCount >= GESTBTN_QUEUE_LEN) {
+        dropped++; // File pleine : le menu ne lit plus
+        return;
     }
+    ev = &queue[(qHead + qCount) % GESTBTN_QUEUE_LEN];
+    ev->type = type;
+    ev->buttons = mask;
+    ev->timeMs = timeMs;
+    qCount++;
 }
 
 /**
- * @brief  Initialise l'etat interne du debounce.
- *
- * @details
- * Cette fonction initialise les variables internes utilisees pour l'antirebond des boutons.
+ * @brief  Initialise le service et la detection de changement des boutons.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
- *
- * @pre Aucun prerequis specifique.
- * @post Les variables internes de detection de bouton sont initialisees.
  */
 void GestBtn_Init(void)
 {
-    // Initialisation interne uniquement
-    swOK.state        = DebounceWaitChange; // etat initial
-    swOK.counter      = 0; // Compteur a zero
-    swOK.bits.prev    = 1; // Valeur precedente relchee
-    swOK.bits.value   = 1; // Valeur stable relchee
-    swOK.bits.pressed = 0; // Aucun appui detecte
-
-    swSelect.state        = DebounceWaitChange; // etat initial
-    swSelect.counter      = 0; // Compteur a zero
-    swSelect.bits.prev    = 1; // Valeur precedente relchee
-    swSelect.bits.value   = 1; // Valeur stable relchee
-    swSelect.bits.pressed = 0; // Aucun appui detecte
+    uint8_t i;
+
+    for (i = 0; i < GESTBTN_NB; i++) {
+        buttons[i].down = false; // Relache
+        buttons[i].reported = false;
+        buttons[i].longDone = false;
+    }
+    chord = false;
+    qHead = 0;
+    qCount = 0;
+
+    PLIB_PORTS_PinChangeNoticePerPortEnable(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_0); // OK
+    PLIB_PORTS_PinChangeNoticePerPortEnable(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_1); // SELECT
+    (void) PLIB_PORTS_Read(PORTS_ID_0, PORT_CHANNEL_E); // Reference de la non-concordance
+    edgeSeen = true; // Premier passage : lit l'etat reel
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_CHANGE_NOTICE_E, INT_PRIORITY_LEVEL1);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_CHANGE_NOTICE_E);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_CHANGE_NOTICE_E);
 }
 
 /**
- * @brief  Doit etre appelee toutes les ~1 ms pour actualiser le debounce.
+ * @brief  Suivi d'un bouton appuye : PRESS differe, LONG et REPEAT.
  *
- * @details
- * Cette fonction lit l'etat brut des boutons OK et SELECT, puis appelle le mecanisme
- * d'antirebond logiciel pour chacun.
+ * @param b Bouton
+ * @param nowMs Base de temps [ms]
+ * @return Aucun retour.
+ */
+static void GestBtn_Held(S_Button *b, uint32_t nowMs)
+{
+    uint32_t held = nowMs - b->downMs; // Duree de l'appui
+
+    if (chord) {
+        return; // L'accord remplace les evenements individuels
+    }
+    if (!b->reported && (held >= GESTBTN_CHORD_MS)) {
+        b->reported = true; // Plus d'accord possible
+        GestBtn_Push(GESTBTN_EV_PRESS, b->mask, b->downMs);
+    }
+    if (!b->longDone && (held >= GESTBTN_LONG_MS)) {
+        b->longDone = true;
+        b->nextRepeatMs = nowMs + GESTBTN_REPEAT_MS;
+        GestBtn_Push(GESTBTN_EV_LONG, b->mask, b->downMs);
+    } else if (b->longDone && ((int32_t) (nowMs - b->nextRepeatMs) >= 0)) {
+        b->nextRepeatMs += GESTBTN_REPEAT_MS;
+        GestBtn_Push(GESTBTN_EV_REPEAT, b->mask, b->downMs);
+    }
+}
+
+/**
+ * @brief  Antirebond et production des evenements (boucle principale).
  *
  * @param Aucun parametre.
  * @return Aucun retour.
- *
- * @pre GestBtn_Init doit avoir ete appelee.
- * @post L'etat des boutons est mis a jour.
  */
-void GestBtn_Update(void)
+void GestBtn_Task(void)
 {
-    // 1 = relche, 0 = appuye
-    uint8_t okState     = PB_OK_StateGet(); // Lecture de l'etat du bouton OK
-    uint8_t selectState = PB_SELECT_StateGet(); // Lecture de l'etat du bouton SELECT
-    bool rawOK     = false; // etat brut du bouton OK
-    bool rawSelect = false; // etat brut du bouton SELECT
-    
-    if (okState == 0u) {
-        rawOK = true; // Bouton OK appuye
+    uint32_t nowMs = appData.tickMs; // Base de temps
+    S_Button *b, *other; // Bouton traite et l'autre
+    uint8_t raw; // Etat brut
+    bool busy = false; // Un bouton reste a suivre
+    uint8_t i;
+
+    if (!edgeSeen && !buttons[0].down && !buttons[1].down) {
+        return; // Rien ne bouge : pas de lecture des broches
+    }
+    edgeSeen = false; // Un front apres cette ligne relancera le suivi
+    raw = GestBtn_ReadRaw();
+
+    for (i = 0; i < GESTBTN_NB; i++) {
+        b = &buttons[i];
+        other = &buttons[1 - i];
+        if (((raw & b->mask) != 0) != b->down) {
+            if ((nowMs - edgeMs[i]) < GESTBTN_DEBOUNCE_MS) {
+                busy = true; // Rebond en cours
+                continue;
+            }
+            b->down = !b->down; // Etat valide
+            if (b->down) {
+                b->downMs = nowMs;
+                b->reported = false;
+                b->longDone = false;
+                if (other->down && !other->reported && !chord
+                    && ((nowMs - other->downMs) < GESTBTN_CHORD_MS)) {
+                    chord = true; // Deux appuis rapproches
+                    b->reported = true;
+                    other->reported = true;
+                    GestBtn_Push(GESTBTN_EV_CHORD, GESTBTN_OK | GESTBTN_SELECT, other->downMs);
+                }
+            } else {
+                if (!b->reported && !chord) {
+                    GestBtn_Push(GESTBTN_EV_PRESS, b->mask, b->downMs); // Appui court relache
+                }
+                if (!other->down) {
+                    chord = false; // Les deux sont relaches
+                }
+            }
+        }
+        if (b->down) {
+            GestBtn_Held(b, nowMs);
+            busy = true;
+        }
+    }
+    if (busy) {
+        edgeSeen = true; // Passage suivant necessaire (rebond ou appui tenu)
     }
+}
 
-    if (selectState == 0u) {
-        rawSelect = true; // Bouton SELECT appuye
+/**
+ * @brief  Retire le plus ancien evenement de la file.
+ *
+ * @param ev Evenement retire
+ * @return false si la file est vide.
+ */
+bool GestBtn_GetEvent(GestBtn_Event *ev)
+{
+    if (qCount == 0) {
+        return false;
     }
+    *ev = queue[qHead];
+    qHead = (uint8_t) ((qHead + 1) % GESTBTN_QUEUE_LEN);
+    qCount--;
+    return true;
+}
 
-    debounce_switch(&swOK,     rawOK); // Antirebond pour OK
-    debounce_switch(&swSelect, rawSelect); // Antirebond pour SELECT
+/**
+ * @brief  Nombre d'evenements perdus (file pleine).
+ *
+ * @param Aucun parametre.
+ * @return Compteur d'evenements perdus.
+ */
+uint32_t GestBtn_GetDropped(void)
+{
+    return dropped;
 }
 
 /**
- * @brief  Renvoie le masque des boutons presses depuis le dernier appel,
- *         et reinitialise leur flag  pressed .
+ * @brief  Callback de l'interruption CN du port E.
  *
  * @details
- * Cette fonction retourne un masque indiquant quels boutons ont ete presses
- * depuis le dernier appel, puis reinitialise leur etat interne.
+ * La lecture du port termine la non-concordance : sans elle, le drapeau
+ * se releverait aussitot efface.
  *
  * @param Aucun parametre.
- * @return combinaison de GESTBTN_OK | GESTBTN_SELECT
- *
- * @pre GestBtn_Update doit etre appelee regulierement.
- * @post Les flags internes des boutons sont reinitialises.
+ * @return Aucun retour.
  */
-uint8_t GestBtn_Scan(void)
+void GestBtn_ChangeIsr(void)
 {
-    uint8_t mask = GESTBTN_NONE; // Masque de retour
-    if (swOK.bits.pressed) {
-        mask |= GESTBTN_OK; // Ajoute OK si appuye
-        swOK.bits.pressed = 0; // Reinitialise le flag
+    static uint8_t last = 0; // Etat brut precedent
+    uint8_t raw = GestBtn_ReadRaw(); // Lit le port (fin de non-concordance)
+    uint8_t changed = (uint8_t) (raw ^ last); // Broches qui ont bouge
+
+    last = raw;
+    if (changed == 0) {
+        changed = GESTBTN_OK | GESTBTN_SELECT; // Aller-retour entre deux ISR : rebond des deux
+    }
+    if (changed & GESTBTN_OK) {
+        edgeMs[0] = appData.tickMs; // Date du front OK
     }
-    if (swSelect.bits.pressed) {
-        mask |= GESTBTN_SELECT; // Ajoute SELECT si appuye
-        swSelect.bits.pressed = 0; // Reinitialise le flag
+    if (changed & GESTBTN_SELECT) {
+        edgeMs[1] = appData.tickMs; // Date du front SELECT
     }
-    return mask; // Retourne le masque
+    edgeSeen = true;
 }
@@ -5,56 +5,104 @@
 #include <stdint.h> // Inclusion des definitions de types entiers standard
 #include <stdbool.h> // Inclusion du type booleen standard
 
-/** Masques de retour de GestBtn_Scan() **/
+/*
+ * Les boutons OK (RE0) et SELECT (RE1) levent une interruption de
+ * changement d'etat (CN port E) : le CPU est reveille de l'IDLE par un
+ * appui et GestBtn_Task() ne lit les broches que tant qu'un bouton bouge
+ * ou reste appuye. Au repos, le service ne coute rien.
+ *
+ * L'ISR date chaque front (base de temps ms). Un etat est valide quand la
+ * broche n'a plus change depuis GESTBTN_DEBOUNCE_MS. Les evenements
+ * produits vont dans une file de GESTBTN_QUEUE_LEN :
+ *
+ *   PRESS   appui court ; emis au relacher ou apres GESTBTN_CHORD_MS
+ *           d'appui seul (le temps de reconnaitre un accord)
+ *   LONG    bouton tenu GESTBTN_LONG_MS
+ *   REPEAT  puis toutes les GESTBTN_REPEAT_MS tant qu'il reste tenu
+ *   CHORD   les deux boutons appuyes a moins de GESTBTN_CHORD_MS d'ecart ;
+ *           plus aucun evenement jusqu'au relacher des deux
+ */
+
+/** Masques des boutons **/
 #define GESTBTN_NONE    0x00u // Aucun bouton
 #define GESTBTN_OK      0x01u // bit 0 : bouton OK
 #define GESTBTN_SELECT  0x02u // bit 1 : bouton SELECT
 
+// Temps du service [ms]
+#define GESTBTN_DEBOUNCE_MS     5   // Broche stable depuis ce delai
+#define GESTBTN_CHORD_MS        80  // Ecart maximal des appuis d'un accord
+#define GESTBTN_LONG_MS         600 // Appui long
+#define GESTBTN_REPEAT_MS       120 // Periode de repetition apres l'appui long
+#define GESTBTN_QUEUE_LEN       8   // Evenements en attente au plus
+
+// Types d'evenement
+typedef enum {
+    GESTBTN_EV_PRESS = 1,   // Appui court
+    GESTBTN_EV_LONG,        // Appui long
+    GESTBTN_EV_REPEAT,      // Repetition pendant l'appui long
+    GESTBTN_EV_CHORD        // Deux boutons ensemble
+} GESTBTN_EVENT_TYPE;
+
+/**
+ * @brief Evenement bouton.
+ */
+typedef struct {
+    uint8_t type;       // Type (GESTBTN_EVENT_TYPE)
+    uint8_t buttons;    // Bouton(s) concerne(s) (GESTBTN_OK | GESTBTN_SELECT)
+    uint32_t timeMs;    // Date de l'appui [ms]
+} GestBtn_Event;
+
 /**
- * @brief  Initialise l'etat interne du debounce.
- *         *Ne touche pas a la config des broches !*
+ * @brief  Initialise le service et la detection de changement des boutons.
  *
  * @details
- * Cette fonction initialise les variables internes utilisees pour l'antirebond des boutons.
- * Elle ne modifie pas la configuration materielle des broches.
+ * Vide la file, active la detection de changement sur RE0 et RE1 et
+ * autorise l'interruption CN du port E. Ne modifie pas la direction des
+ * broches (Harmony).
  *
  * @param Aucun parametre.
  * @return Aucun retour.
  *
- * @pre Aucun prerequis specifique.
- * @post Les variables internes de detection de bouton sont initialisees.
+ * @pre Les ports doivent etre initialises (SYS_PORTS_Initialize).
+ * @post Un appui leve l'interruption CN.
  */
 void GestBtn_Init(void);
 
 /**
- * @brief  Doit etre appelee toutes les ~1 ms pour actualiser le debounce.
+ * @brief  Antirebond et production des evenements (boucle principale).
  *
  * @details
- * Cette fonction doit etre appelee periodiquement (toutes les 1 ms) pour assurer
- * la detection fiable des appuis sur les boutons via l'antirebond logiciel.
+ * Retourne immediatement tant qu'aucun front n'a ete vu et qu'aucun
+ * bouton n'est appuye.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
  *
  * @pre GestBtn_Init doit avoir ete appelee.
- * @post L'etat des boutons est mis a jour.
  */
-void GestBtn_Update(void);
+void GestBtn_Task(void);
 
 /**
- * @brief  Renvoie le masque des boutons presses depuis le dernier appel,
- *         et reinitialise leur flag  pressed .
+ * @brief  Retire le plus ancien evenement de la file.
  *
- * @details
- * Cette fonction retourne un masque indiquant quels boutons ont ete presses
- * depuis le dernier appel, puis reinitialise leur etat interne.
+ * @param ev Evenement retire
+ * @return false si la file est vide.
+ */
+bool GestBtn_GetEvent(GestBtn_Event *ev);
+
+/**
+ * @brief  Nombre d'evenements perdus (file pleine).
  *
- * @param Aucun parametre.
- * @return combinaison de GESTBTN_OK | GESTBTN_SELECT
+ * @return Compteur d'evenements perdus.
+ */
+uint32_t GestBtn_GetDropped(void);
+
+/**
+ * @brief  Callback de l'interruption CN du port E (appele par l'ISR).
  *
- * @pre GestBtn_Update doit etre appelee regulierement.
- * @post Les flags internes des boutons sont reinitialises.
+ * @details
+ * Lit le port (fin de la non-concordance) et date les fronts.
  */
-uint8_t GestBtn_Scan(void);
+void GestBtn_ChangeIsr(void);
 
 #endif // GESTBTN_H
@@ -0,0 +1,401 @@
+/*
+--------------------------------------------------------
+ Fichier : IrCalib.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Auto-calibration du seuil IR par balayage du potentiometre
+--------------------------------------------------------
+*/
+// Inclusion du header calibration IR
+#include "IrCalib.h" // Prototypes de la calibration
+// Inclusion du header compteur IR
+#include "IrCounter.h" // Mode front a front
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaines IR et vibration demarrees
+// Inclusion du header potentiometre
+#include "PotControl.h" // Ecriture du wiper de seuil
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Reconfiguration du SPI apres un acces pot
+// Inclusion du header profils
+#include "ProfilStorage.h" // Seuil sauvegarde par profil
+// Inclusion du header application
+#include "app.h" // Anneau des captures IR et profil actif
+#include <string.h> // Pour memset
+#include <math.h> // Pour sqrtf
+
+#define IRCALIB_POT POT_INDEX_U3_WIPER0 // Wiper du seuil du comparateur IR
+
+static IrCalib_Result result; // Derniere calibration
+static uint32_t startMs = 0; // Debut du balayage [ms]
+static bool savePending = false; // Seuil retenu pas encore ecrit en NVM
+static uint8_t saveProfil = 0; // Profil a sauvegarder
+static uint8_t saveWiper = 0; // Seuil a sauvegarder
+
+// Recherche
+static bool coarse = true; // Recherche grossiere en cours
+static uint8_t step = IRCALIB_COARSE_STEP; // Pas courant
+static uint8_t center = 0; // Centre du pas fin courant
+static uint8_t side = 0; // Voisins du centre deja ecoutes
+static uint8_t wiper = 0; // Position ecoutee
+static float bestScore = 0.0f; // Meilleur score
+
+// Ecoute d'une position
+static bool listening = false; // Une position est ecoutee
+static uint32_t pointMs = 0; // Debut de l'ecoute [ms]
+static uint32_t capSeen = 0; // Captures IC3 deja lues
+static uint32_t edges = 0; // Fronts captures pendant l'ecoute
+static bool prevValid = false; // prevCap valide
+static uint32_t prevCap = 0; // Capture precedente [ticks IC]
+static uint16_t periods = 0; // Periodes accumulees
+static float mean = 0.0f; // Periode moyenne [ticks IC]
+static float m2 = 0.0f; // Somme des carres des ecarts a la moyenne
+
+/**
+ * @brief Ecrit le wiper de seuil.
+ *
+ * @details Le SPI1 est partage avec l'accelerometre.
+ *
+ * @param value Position du wiper
+ * @return Aucun retour.
+ */
+static void IrCalib_WritePot(uint8_t value)
+{
+    SPI_ConfigurePot(); // SPI1 pour le potentiometre
+    Pot_Write(IRCALIB_POT, value); // Ecrit le wiper
+    if (MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        SPI_ConfigureAcc(); // Rend le SPI a l'accelerometre
+    }
+}
+
+/**
+ * @brief Ecrit une position et commence son ecoute.
+ *
+ * @details
+ * Les captures anterieures a l'ecriture sont ignorees : la premiere
+ * periode commence a la premiere capture qui suit.
+ *
+ * @param value Position du wiper
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void IrCalib_Listen(uint8_t value, uint32_t nowMs)
+{
+    uint8_t index; // Index de l'anneau (inutilise)
+
+    wiper = value;
+    IrCalib_WritePot(value);
+    capSeen = APP_CaptureCount(&index);
+    edges = 0;
+    prevValid = false;
+    periods = 0;
+    mean = 0.0f;
+    m2 = 0.0f;
+    pointMs = nowMs;
+    listening = true;
+    result.points++;
+}
+
+/**
+ * @brief Accumule les periodes des nouvelles captures IC3.
+ *
+ * @details
+ * Moyenne et variance par la methode de Welford. Si l'anneau a tourne
+ * entre deux lectures, la periode qui enjambe le trou est ignoree.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void IrCalib_Pull(void)
+{
+    uint8_t index; // Prochain emplacement ecrit par l'ISR
+    uint32_t count = APP_CaptureCount(&index); // Captures depuis le demarrage
+    uint32_t fresh = count - capSeen; // Nouvelles captures
+    uint32_t c; // Capture lue
+
+    edges += fresh;
+    if (fresh >= RPM_CAPTURE_BUFFER_SIZE) {
+        prevValid = false; // Captures perdues
+        fresh = RPM_CAPTURE_BUFFER_SIZE - 1;
+    }
+    for (c = fresh; c > 0; c--) {
+        uint32_t cap = appData.captureBuffer[(index + RPM_CAPTURE_BUFFER_SIZE - c) % RPM_CAPTURE_BUFFER_SIZE];
+
+        if (prevValid) {
+            float x = (float) (cap - prevCap); // Periode [ticks IC]
+            float d = x - mean; // Ecart a l'ancienne moyenne
+
+            periods++;
+            mean += d / (float) periods;
+            m2 += d * (x - mean);
+        }
+        prevCap = cap;
+        prevValid = true;
+    }
+    capSeen = count;
+}
+
+/**
+ * @brief Note la position ecoutee et retient la meilleure.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void IrCalib_Score(uint32_t nowMs)
+{
+    float rate; // Debit de fronts [Hz]
+    float cv2; // Variance relative des periodes
+    float score; // Score de la position
+
+    listening = false;
+    if ((periods < IRCALIB_MIN_PERIODS) || (mean <= 0.0f)) {
+        return; // Flux inexploitable : score nul
+    }
+    rate = (1000.0f * (float) edges) / (float) (nowMs - pointMs);
+    cv2 = m2 / ((float) periods * mean * mean);
+    score = rate / (1.0f + IRCALIB_CV2_WEIGHT * cv2);
+    if (score > bestScore) {
+        bestScore = score;
+        result.wiper = wiper;
+        result.rateHz = rate;
+        result.cv = sqrtf(cv2);
+        result.score = score;
+    }
+}
+
+/**
+ * @brief Position suivante de la recherche.
+ *
+ * @details
+ * Grossiere : de IRCALIB_WIPER_MIN a IRCALIB_WIPER_MAX par pas de
+ * IRCALIB_COARSE_STEP. Fine : les deux voisins de la meilleure position a
+ * +/- step, puis step / 2 autour de la nouvelle meilleure position,
+ * jusqu'a IRCALIB_FINE_STEP. Les voisins hors course sont sautes.
+ *
+ * @param next Position suivante
+ * @return false si la recherche est terminee
+ */
+static bool IrCalib_Next(uint8_t *next)
+{
+    if (coarse) {
+        if (wiper < IRCALIB_WIPER_MAX) {
+            uint16_t w = (uint16_t) wiper + IRCALIB_COARSE_STEP; // Position grossiere suivante
+
+            *next = (w < IRCALIB_WIPER_MAX) ? (uint8_t) w : IRCALIB_WIPER_MAX;
+            return true;
+        }
+        if (bestScore <= 0.0f) {
+            return false; // Aucun flux sur toute la course
+        }
+        coarse = false;
+        step = IRCALIB_COARSE_STEP / 2;
+        center = result.wiper;
+        side = 0;
+    }
+    while (step >= IRCALIB_FINE_STEP) {
+        while (side < 2) {
+            int16_t w = (side == 0) ? ((int16_t) center - step) : ((int16_t) center + step); // Voisin
+
+            side++;
+            if ((w >= IRCALIB_WIPER_MIN) && (w <= IRCALIB_WIPER_MAX)) {
+                *next = (uint8_t) w;
+                return true;
+            }
+        }
+        step /= 2;
+        center = result.wiper; // Meilleure position apres ce pas
+        side = 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Applique et publie la meilleure position, ou remet la precedente.
+ *
+ * @details
+ * L'ecriture NVM (effacement de page) est seulement demandee : elle se fait
+ * dans IrCalib_SaveTask, hors du balayage.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void IrCalib_Finish(uint32_t nowMs)
+{
+    listening = false;
+    result.elapsedMs = (uint16_t) (nowMs - startMs);
+    if ((bestScore > 0.0f) && (result.cv <= IRCALIB_MAX_CV)) {
+        IrCalib_WritePot(result.wiper); // Meilleure position
+        saveProfil = result.profil;
+        saveWiper = result.wiper;
+        savePending = true; // Sauvegarde au prochain creneau SERVICE_TASKS
+        result.state = IRCALIB_DONE;
+    } else {
+        IrCalib_WritePot(result.previous); // Seuil d'avant la calibration
+        result.wiper = result.previous;
+        result.state = IRCALIB_FAILED;
+    }
+}
+
+/**
+ * @brief Lance la calibration du seuil IR pour le profil actif.
+ *
+ * @details
+ * Le wiper courant est relu sur le MCP4231 (il a pu etre change par
+ * CMD_SET_POT). Le balayage commence des que la chaine IR a remis le
+ * compteur en front a front.
+ *
+ * @param Aucun parametre.
+ * @return false si la chaine IR est arretee
+ */
+bool IrCalib_Start(void)
+{
+    uint8_t current; // Wiper courant
+
+    if (!MesureEngine_IsRunning(MESURE_PIPE_IR)) {
+        return false; // Pas de flux de captures
+    }
+    if (result.state == IRCALIB_RUNNING) {
+        current = result.previous; // Relance : garde le wiper d'origine
+    } else {
+        SPI_ConfigurePot(); // SPI1 pour le potentiometre
+        if (!Pot_Read(IRCALIB_POT, &current) || (current > IRCALIB_WIPER_MAX)) {
+            current = IrCalib_Wiper(appData.selectedProfil); // Lecture impossible : seuil du profil
+        }
+        if (MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+            SPI_ConfigureAcc(); // Rend le SPI a l'accelerometre
+        }
+    }
+    memset(&result, 0, sizeof(result));
+    result.state = IRCALIB_RUNNING;
+    result.profil = appData.selectedProfil;
+    result.previous = current;
+    coarse = true;
+    step = IRCALIB_COARSE_STEP;
+    bestScore = 0.0f;
+    listening = false;
+    startMs = appData.tickMs;
+    return true;
+}
+
+/**
+ * @brief Abandonne la calibration et remet le wiper precedent.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCalib_Cancel(void)
+{
+    if (result.state != IRCALIB_RUNNING) {
+        return; // Rien en cours
+    }
+    bestScore = 0.0f; // Rien n'est retenu
+    IrCalib_Finish(appData.tickMs);
+}
+
+/**
+ * @brief Indique si un balayage est en cours.
+ *
+ * @param Aucun parametre.
+ * @return true entre IrCalib_Start et la fin du balayage
+ */
+bool IrCalib_IsActive(void)
+{
+    return (result.state == IRCALIB_RUNNING);
+}
+
+/**
+ * @brief Avance le balayage (chaque passage de la boucle principale).
+ *
+ * @details
+ * Hors du creneau budgete de la chaine IR : les ecritures SPI du
+ * potentiometre n'entrent pas dans son budget et la duree d'ecoute ne
+ * depend pas de sa periode. Tant que IrCounter_Task n'a pas remis le
+ * compteur en front a front, l'anneau IC3 ne recoit rien et l'ecoute
+ * attend.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+void IrCalib_Task(uint32_t nowMs)
+{
+    uint8_t next; // Position suivante
+
+    if ((result.state != IRCALIB_RUNNING) || !IrCounter_PerEdge()) {
+        return;
+    }
+    if (!listening) {
+        if (result.points == 0) {
+            IrCalib_Listen(IRCALIB_WIPER_MIN, nowMs); // Premiere position grossiere
+        }
+        return;
+    }
+    IrCalib_Pull();
+    if ((nowMs - pointMs) < IRCALIB_DWELL_MS) {
+        if ((nowMs - startMs) >= IRCALIB_TIMEOUT_MS) {
+            IrCalib_Finish(nowMs); // Pas retardes : meilleure position jusque-la
+        }
+        return;
+    }
+    IrCalib_Score(nowMs);
+    if (((nowMs - startMs) < IRCALIB_TIMEOUT_MS) && IrCalib_Next(&next)) {
+        IrCalib_Listen(next, nowMs);
+    } else {
+        IrCalib_Finish(nowMs);
+    }
+}
+
+/**
+ * @brief Ecrit en NVM le seuil retenu par la derniere calibration.
+ *
+ * @details
+ * Creneau SERVICE_TASKS, apres la publication du resultat : l'effacement
+ * de page bloque la boucle une seule fois par calibration.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCalib_SaveTask(void)
+{
+    if (!savePending) {
+        return; // Rien a sauvegarder
+    }
+    savePending = false;
+    Profils_SaveIrSeuil(saveProfil, saveWiper); // Seuil du profil
+}
+
+/**
+ * @brief Copie du resultat de la derniere calibration.
+ *
+ * @param out Copie du resultat
+ * @return Aucun retour.
+ */
+void IrCalib_Get(IrCalib_Result *out)
+{
+    *out = result;
+}
+
+/**
+ * @brief Seuil IR a appliquer pour un profil.
+ *
+ * @param profil Indice du profil
+ * @return Wiper calibre, IRCALIB_DEFAULT_WIPER si le profil n'est pas calibre
+ */
+uint8_t IrCalib_Wiper(uint8_t profil)
+{
+    Profil *p = Profils_Get(profil); // Profil demande
+
+    if ((p == 0) || (p->irSeuil < IRCALIB_WIPER_MIN) || (p->irSeuil > IRCALIB_WIPER_MAX)) {
+        return IRCALIB_DEFAULT_WIPER; // Jamais calibre
+    }
+    return p->irSeuil;
+}
+
+/**
+ * @brief Ecrit le seuil IR du profil actif sur le potentiometre.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCalib_Apply(void)
+{
+    IrCalib_WritePot(IrCalib_Wiper(appData.selectedProfil));
+}
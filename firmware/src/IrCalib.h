@@ -0,0 +1,141 @@
+/*
+--------------------------------------------------------
+ Fichier : IrCalib.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Auto-calibration du seuil IR par balayage du potentiometre
+--------------------------------------------------------*/
+
+#ifndef _IRCALIB_H_
+#define _IRCALIB_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Le seuil du comparateur IR est le wiper 0 de U3 (MCP4231, 129
+ * positions) ; le gain (U5 W0) et U3 W1 restent aux valeurs fixes de
+ * APP_Tasks.
+ *
+ * La calibration se fait helice en rotation, chaine IR demarree. Chaque
+ * position du wiper est ecoutee pendant IRCALIB_DWELL_MS sur l'anneau des
+ * captures IC3 (compteur IR force en front a front) : debit de fronts r et
+ * variance relative des periodes cv2 = var / moyenne^2. Score :
+ *
+ *     score = r / (1 + IRCALIB_CV2_WEIGHT * cv2)
+ *
+ * Un seuil trop bas ajoute des fronts parasites (debit plus haut mais
+ * periodes dispersees), un seuil trop haut perd des reflexions (debit plus
+ * bas, periodes simples et doubles melangees) : le flux le plus regulier
+ * gagne. Moins de IRCALIB_MIN_PERIODS periodes = score nul. Si la meilleure
+ * position garde un ecart type relatif au-dela de IRCALIB_MAX_CV (plage
+ * stable plus etroite que le pas grossier, signal trop bruite), la
+ * calibration echoue plutot que de sauver un seuil instable.
+ *
+ * Recherche grossiere puis fine : pas de IRCALIB_COARSE_STEP sur toute la
+ * course (5 positions), puis de part et d'autre de la meilleure position
+ * avec un pas divise par deux jusqu'a IRCALIB_FINE_STEP (8 positions).
+ * IrCalib_Task tourne a chaque passage de la boucle principale, hors du
+ * creneau budgete de la chaine IR : chaque position dure IRCALIB_DWELL_MS
+ * a un tick pres, soit 13 x 51 ms = 660 ms ; IRCALIB_TIMEOUT_MS borne la
+ * duree si la boucle est retardee (meilleure position trouvee jusque-la).
+ * Il faut au moins IRCALIB_MIN_PERIODS + 1 fronts par ecoute, soit un
+ * debit de 80 Hz (2400 RPM a 2 pales).
+ *
+ * Le wiper retenu est applique et publie a la fin du balayage, puis ecrit
+ * dans le profil actif (champ irSeuil) par IrCalib_SaveTask au creneau
+ * SERVICE_TASKS suivant ; il est reapplique au demarrage et au chargement
+ * du profil. Un profil jamais
+ * calibre (0xFF apres effacement, 0 des anciens profils) garde
+ * IRCALIB_DEFAULT_WIPER. En cas d'echec ou d'abandon, le wiper d'avant la
+ * calibration est remis.
+ */
+
+#define IRCALIB_WIPER_MIN       1       // Plus petite position calibree (0 = profil non calibre)
+#define IRCALIB_WIPER_MAX       128     // Pleine echelle du MCP4231
+#define IRCALIB_DEFAULT_WIPER   30      // Seuil d'un profil non calibre
+#define IRCALIB_COARSE_STEP     32      // Pas de la recherche grossiere
+#define IRCALIB_FINE_STEP       2       // Dernier pas de la recherche fine
+#define IRCALIB_DWELL_MS        50      // Ecoute d'une position [ms]
+#define IRCALIB_TIMEOUT_MS      950     // Duree maximale de la calibration [ms]
+#define IRCALIB_MIN_PERIODS     3       // Periodes minimales d'une position exploitable
+#define IRCALIB_CV2_WEIGHT      100.0f  // Poids de la variance relative des periodes
+#define IRCALIB_MAX_CV          0.15f   // Ecart type relatif maximal (pales inegales et regime compris)
+
+// Etat de la calibration
+typedef enum {
+    IRCALIB_IDLE = 0,       // Jamais lancee
+    IRCALIB_RUNNING,        // Balayage en cours
+    IRCALIB_DONE,           // Seuil retenu (sauvegarde au creneau suivant)
+    IRCALIB_FAILED          // Aucun flux stable ou abandon
+} IRCALIB_STATE;
+
+/**
+ * @brief Resultat de la derniere calibration.
+ */
+typedef struct {
+    uint8_t state;          // Etat (IRCALIB_STATE)
+    uint8_t profil;         // Profil calibre
+    uint8_t wiper;          // Wiper retenu
+    uint8_t previous;       // Wiper avant la calibration
+    uint8_t points;         // Positions ecoutees
+    uint16_t elapsedMs;     // Duree du balayage [ms]
+    float rateHz;           // Debit de fronts a la position retenue [Hz]
+    float cv;               // Ecart type relatif des periodes a la position retenue
+    float score;            // Score de la position retenue
+} IrCalib_Result;
+
+/**
+ * @brief Lance la calibration du seuil IR pour le profil actif.
+ *
+ * @return false si la chaine IR est arretee
+ */
+bool IrCalib_Start(void);
+
+/**
+ * @brief Abandonne la calibration et remet le wiper precedent.
+ */
+void IrCalib_Cancel(void);
+
+/**
+ * @brief Indique si un balayage est en cours (compteur IR force en front a front).
+ *
+ * @return true entre IrCalib_Start et la fin du balayage
+ */
+bool IrCalib_IsActive(void);
+
+/**
+ * @brief Avance le balayage (chaque passage de la boucle principale).
+ *
+ * @param nowMs Temps courant [ms]
+ */
+void IrCalib_Task(uint32_t nowMs);
+
+/**
+ * @brief Ecrit en NVM le seuil retenu par la derniere calibration (creneau SERVICE_TASKS).
+ */
+void IrCalib_SaveTask(void);
+
+/**
+ * @brief Copie du resultat de la derniere calibration.
+ *
+ * @param out Copie du resultat
+ */
+void IrCalib_Get(IrCalib_Result *out);
+
+/**
+ * @brief Seuil IR a appliquer pour un profil.
+ *
+ * @param profil Indice du profil
+ * @return Wiper calibre, IRCALIB_DEFAULT_WIPER si le profil n'est pas calibre
+ */
+uint8_t IrCalib_Wiper(uint8_t profil);
+
+/**
+ * @brief Ecrit le seuil IR du profil actif sur le potentiometre.
+ *
+ * @details Le SPI1 est rendu a l'accelerometre si la chaine vibration tourne.
+ */
+void IrCalib_Apply(void);
+
+#endif
@@ -0,0 +1,198 @@
+/*
+--------------------------------------------------------
+ Fichier : IrCounter.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Compteur IR hybride : periode front a front ou porte reciproque
+--------------------------------------------------------
+*/
+// Inclusion du header compteur IR
+#include "IrCounter.h" // Prototypes du compteur
+// Inclusion du header mesure
+#include "Mesure.h" // Debit de fronts courant
+// Inclusion du header impulsions IR
+#include "IrPulse.h" // Alternance des fronts
+// Inclusion du header decoupage en tours
+#include "RevSync.h" // Consommateur de chaque front
+// Inclusion du header flux USB
+#include "UsbStream.h" // Captures brutes vers le PC
+// Inclusion du header calibration IR
+#include "IrCalib.h" // Balayage du seuil sur l'anneau des captures
+// Inclusion des definitions systeme
+#include "system_definitions.h" // SFR IC3 / T6 et interruptions
+
+#define IRCOUNTER_ICM_RISING 3 // Mode ICM : chaque front montant (banc de latence)
+
+// Mode ICM d'IC3, fronts par capture et interruptions pour 16 fronts de chaque mode
+static const uint8_t icMode[IRCOUNTER_MODE_COUNT] = { 6, 4, 5 }; // Deux fronts, 1 sur 4, 1 sur 16
+static const uint16_t perCapture[IRCOUNTER_MODE_COUNT] = { 1, 4, 16 };
+static const uint16_t irqPer16[IRCOUNTER_MODE_COUNT] = { 32, 4, 1 };
+
+static volatile uint8_t mode = IRCOUNTER_EDGE; // Mode courant
+static volatile bool dual = false; // Deux fronts en mode front a front (chaine IR demarree)
+static volatile bool synced = false; // Une capture sert de reference
+static uint16_t lastCount = 0; // TMR6 au front de la derniere capture (ecrit par l'ISR)
+
+/**
+ * @brief Change le mode d'IC3.
+ *
+ * @details
+ * IC3 est coupe pendant le changement : sa FIFO et son prediviseur
+ * repartent de zero, et en mode deux fronts la premiere capture est un
+ * front montant (FEDGE). L'interruption est masquee pour que l'ISR ne
+ * voie pas un mode et un prediviseur differents.
+ *
+ * @param m Nouveau mode (IRCOUNTER_MODE)
+ * @return Aucun retour.
+ */
+static void IrCounter_Apply(uint8_t m)
+{
+    bool on = (IC3CONbits.ON != 0); // Capture en cours
+
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_INPUT_CAPTURE_3);
+    IC3CONbits.ON = 0; // Vide la FIFO
+    IC3CONbits.FEDGE = 1; // Premier front montant
+    IC3CONbits.ICM = ((m == IRCOUNTER_EDGE) && !dual) ? IRCOUNTER_ICM_RISING : icMode[m];
+    IC3CONbits.ON = on ? 1 : 0;
+    mode = m;
+    synced = false; // La capture suivante n'a pas de front de reference
+    IrPulse_Resync(); // Alternance des fronts recalee
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_INPUT_CAPTURE_3);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_INPUT_CAPTURE_3);
+}
+
+/**
+ * @brief Demarre le comptage T6 et les impulsions, IC3 sur les deux fronts.
+ *
+ * @details
+ * T6 : horloge externe T6CK (remappee sur RPF4 comme IC3), 16 bits,
+ * prediviseur 1, periode maximale. Le compteur n'est jamais remis a zero :
+ * seules les differences servent.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCounter_Start(void)
+{
+    T6CON = 0; // Arret, 16 bits, prediviseur 1
+    T6CONbits.TCS = 1; // Horloge externe T6CK
+    PR6 = 0xFFFF; // Compte libre
+    TMR6 = 0;
+    T6CONbits.ON = 1;
+    IrPulse_Start(); // Statistiques des impulsions a zero
+    dual = true;
+    IrCounter_Apply(IRCOUNTER_EDGE);
+}
+
+/**
+ * @brief Arrete T6 et remet IC3 sur les fronts montants (banc de latence).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCounter_Stop(void)
+{
+    T6CONbits.ON = 0;
+    dual = false;
+    IrCounter_Apply(IRCOUNTER_EDGE);
+}
+
+/**
+ * @brief Fronts couverts par la capture lue (appelee par l'ISR IC3).
+ *
+ * @details
+ * Front a front : une capture publiee = un front (les parasites sont deja
+ * rejetes par IrPulse, T6 les compterait). En mode porte, TMR6 est lu
+ * juste apres la capture : il peut deja compter un front suivant.
+ * La porte est donc arrondie au multiple du prediviseur, et lastCount
+ * avance du compte arrondi (pas de derive). La FIFO d'IC3 est testee
+ * apres la lecture de TMR6 : si d'autres captures attendent, TMR6 a pu
+ * compter leurs fronts et la capture lue couvre exactement un
+ * prediviseur.
+ *
+ * @param Aucun parametre.
+ * @return Fronts depuis la capture precedente, 0 sans reference
+ */
+uint16_t IrCounter_CaptureIsr(void)
+{
+    uint16_t count; // Fronts comptes depuis le demarrage (modulo 2^16)
+    bool pending; // Captures suivantes deja dans la FIFO
+    uint16_t per = perCapture[mode]; // Fronts par capture
+    uint16_t edges; // Fronts de la porte
+
+    if (mode == IRCOUNTER_EDGE) {
+        edges = synced ? 1 : 0;
+        synced = true;
+        return edges;
+    }
+    count = TMR6;
+    pending = !DRV_IC0_BufferIsEmpty();
+    if (!synced) {
+        lastCount = count;
+        synced = true;
+        return 0; // Premiere porte ouverte
+    }
+    if (pending) {
+        edges = per;
+    } else {
+        edges = (uint16_t) (((uint16_t) (count - lastCount) + (per / 2)) / per) * per;
+        if (edges == 0) {
+            edges = per; // Au moins la capture elle-meme
+        }
+    }
+    lastCount += edges;
+    return edges;
+}
+
+/**
+ * @brief Indique si chaque front est capture.
+ *
+ * @return true en mode IRCOUNTER_EDGE
+ */
+bool IrCounter_PerEdge(void)
+{
+    return (mode == IRCOUNTER_EDGE);
+}
+
+/**
+ * @brief Indique si les deux fronts sont captures (captures a passer a IrPulse).
+ *
+ * @return true en mode IRCOUNTER_EDGE entre IrCounter_Start et IrCounter_Stop
+ */
+bool IrCounter_DualEdge(void)
+{
+    return dual && (mode == IRCOUNTER_EDGE);
+}
+
+/**
+ * @brief Choisit le mode selon le debit de fronts (creneau de la chaine IR).
+ *
+ * @details
+ * Le debit vient de l'instantane de mesure (RPM x pales / 60). Sans signal
+ * (RPM nul apres MESURE_IR_LOST_MS), on revient front a front.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrCounter_Task(void)
+{
+    Mesure_Snapshot m; // Dernier instantane
+    uint8_t next = mode; // Mode retenu
+    uint32_t edgeHz60; // Debit de fronts x 60
+
+    Mesure_Get(&m);
+    edgeHz60 = m.rpm * m.nbBlades;
+
+    if (RevSync_IsActive() || UsbStream_IsActive() || IrCalib_IsActive()) {
+        next = IRCOUNTER_EDGE; // Chaque front est attendu
+    } else if ((next + 1 < IRCOUNTER_MODE_COUNT)
+        && ((edgeHz60 * irqPer16[next]) > (16UL * 60UL * IRCOUNTER_MAX_IRQ_HZ))) {
+        next++; // Trop d'interruptions : porte plus longue
+    } else if ((next > IRCOUNTER_EDGE)
+        && ((edgeHz60 * irqPer16[next - 1]) < (8UL * 60UL * IRCOUNTER_MAX_IRQ_HZ))) {
+        next--; // Le mode inferieur reste sous la moitie du plafond
+    }
+    if (next != mode) {
+        IrCounter_Apply(next);
+    }
+}
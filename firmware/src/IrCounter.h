@@ -0,0 +1,96 @@
+/*
+--------------------------------------------------------
+ Fichier : IrCounter.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Compteur IR hybride : periode front a front ou porte reciproque
+--------------------------------------------------------*/
+
+#ifndef _IRCOUNTER_H_
+#define _IRCOUNTER_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Le signal IR (RF4 / RPF4) attaque deux peripheriques :
+ *   - IC3, qui date les fronts sur T2/T3 (10 MHz) ;
+ *   - T6, horloge externe T6CK sur la meme broche, qui compte tous les
+ *     fronts montants (16 bits, libre).
+ *
+ * Mode front a front : IC3 capture les deux fronts (deux interruptions
+ * par impulsion), IrPulse en deduit la largeur et rejette les parasites ;
+ * seul le front montant d'une impulsion valide est publie.
+ * Modes a porte : le prediviseur d'IC3 ne capture qu'un front sur 4 ou
+ * sur 16. Chaque capture ouvre et ferme la porte sur un front reel ; le
+ * nombre de fronts de la porte est lu sur T6 et arrondi au multiple du
+ * prediviseur (un front arrive entre la capture et la lecture de TMR6 est
+ * rendu a la porte suivante). Une capture perdue donne une porte de
+ * plusieurs fois le prediviseur, toujours exacte : f = fronts / duree.
+ *
+ * IrCounter_Task choisit le mode sur le debit de fronts de la mesure :
+ * on monte d'un cran au-dela de IRCOUNTER_MAX_IRQ_HZ interruptions par
+ * seconde, on redescend quand le mode inferieur resterait sous la moitie.
+ * Les interruptions IC3 restent sous IRCOUNTER_MAX_IRQ_HZ jusqu'a 4 kHz
+ * de fronts et chaque porte dure au moins 4 ms : la resolution reste
+ * meilleure que 1 tick IC sur 4 ms (25 ppm) quel que soit le regime.
+ * Les parasites ne sont rejetes qu'en mode front a front (en mode porte,
+ * le prediviseur d'IC3 et T6 les comptent).
+ *
+ * Les consommateurs qui ont besoin de chaque front (decoupage en tours,
+ * flux brut vers le PC, calibration du seuil) forcent le mode front a front ; seules les
+ * captures front a front entrent dans l'anneau appData.captureBuffer.
+ */
+
+#define IRCOUNTER_MAX_IRQ_HZ    250     // Interruptions IC3 par seconde au-dela desquelles on monte d'un cran
+
+// Mode de comptage
+typedef enum {
+    IRCOUNTER_EDGE = 0,     // Deux fronts captures par impulsion
+    IRCOUNTER_GATE4,        // Porte de 4 fronts
+    IRCOUNTER_GATE16,       // Porte de 16 fronts
+    IRCOUNTER_MODE_COUNT
+} IRCOUNTER_MODE;
+
+/**
+ * @brief Demarre le comptage T6 et les impulsions, IC3 sur les deux fronts.
+ *
+ * @details A appeler avant DRV_IC0_Start.
+ */
+void IrCounter_Start(void);
+
+/**
+ * @brief Arrete T6 et remet IC3 sur les fronts montants (banc de latence).
+ */
+void IrCounter_Stop(void);
+
+/**
+ * @brief Fronts couverts par la capture lue (appelee par l'ISR IC3).
+ *
+ * @details A appeler juste apres la lecture de la capture.
+ *
+ * @return Fronts depuis la capture precedente, 0 sans reference
+ *         (premiere capture apres un demarrage ou un changement de mode)
+ */
+uint16_t IrCounter_CaptureIsr(void);
+
+/**
+ * @brief Indique si chaque front est capture.
+ *
+ * @return true en mode IRCOUNTER_EDGE
+ */
+bool IrCounter_PerEdge(void);
+
+/**
+ * @brief Indique si les deux fronts sont captures (captures a passer a IrPulse).
+ *
+ * @return true en mode IRCOUNTER_EDGE entre IrCounter_Start et IrCounter_Stop
+ */
+bool IrCounter_DualEdge(void);
+
+/**
+ * @brief Choisit le mode selon le debit de fronts (creneau de la chaine IR).
+ */
+void IrCounter_Task(void);
+
+#endif
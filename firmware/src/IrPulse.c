@@ -0,0 +1,304 @@
+/*
+--------------------------------------------------------
+ Fichier : IrPulse.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Largeur des impulsions IR, rapport cyclique et rejet des parasites
+--------------------------------------------------------
+*/
+// Inclusion du header impulsions IR
+#include "IrPulse.h" // Prototypes des impulsions
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+// Inclusion du header application
+#include "app.h" // Nombre de pales du profil
+// Inclusion des definitions systeme
+#include "system_definitions.h" // FIFO d'IC3 et broche RF4
+#include <string.h> // Pour memset
+
+#define IRPULSE_ALPHA       0.125f  // Poids d'une impulsion dans le lissage par pale
+
+/**
+ * @brief Impulsion valide transmise a la tache.
+ */
+typedef struct {
+    uint32_t rise;  // Front montant [ticks IC]
+    uint32_t width; // Largeur [ticks IC]
+} IrPulse_Edge;
+
+// Etat de l'ISR
+static volatile bool nextRising = true; // Type du prochain front capture
+static bool riseValid = false; // Un front montant ouvre l'impulsion courante
+static bool merging = false; // Le front montant courant prolonge l'impulsion precedente
+static bool haveFall = false; // lastFall valide
+static uint32_t rise = 0; // Debut de l'impulsion courante [ticks IC]
+static uint32_t lastFall = 0; // Fin de la derniere impulsion valide [ticks IC]
+static bool pending = false; // Impulsion terminee, encore prolongeable par un trou
+static uint32_t pendWidth = 0; // Largeur de l'impulsion terminee [ticks IC]
+static volatile IrPulse_Edge ring[IRPULSE_RING]; // Impulsions en attente
+static volatile uint32_t head = 0; // Impulsions ecrites (= impulsions valides)
+static volatile uint32_t glitches = 0; // Parasites rejetes
+static volatile uint32_t dropouts = 0; // Trous combles
+static volatile uint32_t resyncs = 0; // Fronts manques
+
+// Etat de la tache
+static uint32_t tail = 0; // Impulsions lues
+static bool prevValid = false; // prevRise valide
+static uint32_t prevRise = 0; // Front montant precedent [ticks IC]
+static uint8_t blades = 1; // Pales suivies
+static float widthEma[IRPULSE_MAX_BLADES]; // Largeur lissee [ticks IC]
+static float dutyEma[IRPULSE_MAX_BLADES]; // Rapport cyclique lisse
+static bool emaReady[IRPULSE_MAX_BLADES]; // Premiere valeur recue
+static uint16_t winPulses = 0; // Impulsions de la fenetre courante
+static uint16_t winGood = 0; // Bonnes impulsions de la fenetre
+static uint32_t winBad0 = 0; // Parasites, trous et fronts manques au debut de la fenetre
+static uint8_t quality = 0; // Qualite de la derniere fenetre [%]
+
+/**
+ * @brief Mauvais evenements depuis le demarrage.
+ *
+ * @return Parasites + trous + fronts manques
+ */
+static uint32_t IrPulse_BadCount(void)
+{
+    return glitches + dropouts + resyncs;
+}
+
+/**
+ * @brief Oublie le lissage par pale (nombre de pales change).
+ *
+ * @param n Pales suivies
+ * @return Aucun retour.
+ */
+static void IrPulse_ResetBlades(uint8_t n)
+{
+    blades = n;
+    memset(emaReady, 0, sizeof(emaReady));
+    memset(widthEma, 0, sizeof(widthEma));
+    memset(dutyEma, 0, sizeof(dutyEma));
+}
+
+/**
+ * @brief Remet les statistiques et l'alternance des fronts a zero.
+ *
+ * @details A appeler capture arretee.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrPulse_Start(void)
+{
+    pending = false; // L'anneau repart de zero
+    IrPulse_Resync();
+    head = 0;
+    glitches = 0;
+    dropouts = 0;
+    resyncs = 0;
+    tail = 0;
+    prevValid = false;
+    winPulses = 0;
+    winGood = 0;
+    winBad0 = 0;
+    quality = 0;
+    IrPulse_ResetBlades(1);
+}
+
+/**
+ * @brief Ecrit l'impulsion terminee dans l'anneau.
+ *
+ * @details Appelee quand aucun trou ne peut plus la prolonger.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void IrPulse_Commit(void)
+{
+    if (pending) {
+        volatile IrPulse_Edge *e = &ring[head % IRPULSE_RING]; // Case ecrite
+
+        e->rise = rise;
+        e->width = pendWidth;
+        head++;
+        pending = false;
+    }
+}
+
+/**
+ * @brief Recale l'alternance apres une reprogrammation d'IC3.
+ *
+ * @details L'impulsion terminee ne peut plus etre prolongee : elle est ecrite.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrPulse_Resync(void)
+{
+    IrPulse_Commit(); // Largeur definitive
+    nextRising = true; // Premier front capture : montant (FEDGE)
+    riseValid = false;
+    merging = false;
+    haveFall = false;
+}
+
+/**
+ * @brief Traite un front capture (appelee par l'ISR IC3 en mode deux fronts).
+ *
+ * @details
+ * Quelques comparaisons sur 32 bits, sans division. Le niveau de RF4 est
+ * lu avant de tester la FIFO : si un front arrive entre les deux, sa
+ * capture est deja dans la FIFO et l'alternance n'est pas touchee.
+ * Le front montant est publie des le front descendant (il ne change pas
+ * si un trou prolonge l'impulsion) ; l'impulsion n'entre dans l'anneau
+ * qu'au front montant suivant hors trou, avec sa largeur definitive.
+ *
+ * @param cap Front capture [ticks IC], remplace par le front montant publie
+ * @return true si une impulsion valide se termine : *cap est a publier
+ */
+bool IrPulse_EdgeIsr(uint32_t *cap)
+{
+    uint32_t t = *cap; // Instant du front
+    bool publish = false; // Impulsion a publier
+    bool high; // Niveau de RF4 apres le front
+
+    if (nextRising) {
+        if (haveFall && ((t - lastFall) < IRPULSE_MIN_WIDTH_TICKS)) {
+            merging = true; // Creux trop court : l'impulsion precedente continue
+        } else {
+            merging = false;
+            IrPulse_Commit(); // Plus de trou possible : largeur definitive
+            rise = t;
+        }
+        riseValid = true;
+    } else if (riseValid) {
+        riseValid = false;
+        if (merging) {
+            dropouts++;
+            lastFall = t; // Fin reelle de l'impulsion prolongee
+            if (pending) {
+                pendWidth = t - rise; // Largeur avec le trou comble
+            }
+        } else if ((t - rise) < IRPULSE_MIN_WIDTH_TICKS) {
+            glitches++; // Impulsion trop courte : ignoree
+        } else {
+            pendWidth = t - rise;
+            pending = true; // Ecrite au prochain front montant hors trou
+            lastFall = t;
+            haveFall = true;
+            *cap = rise;
+            publish = true;
+        }
+    }
+    nextRising = !nextRising;
+
+    high = PLIB_PORTS_PinGet(PORTS_ID_0, PORT_CHANNEL_F, PORTS_BIT_POS_4); // Niveau de RF4
+    if (DRV_IC0_BufferIsEmpty() && (nextRising == high)) {
+        resyncs++; // Front manque : le prochain front est l'inverse du niveau actuel
+        nextRising = !high;
+        riseValid = false; // Impulsion en cours eventuelle : debut inconnu, ignoree
+        merging = false;
+    }
+    return publish;
+}
+
+/**
+ * @brief Attribue les impulsions aux pales et evalue la qualite.
+ *
+ * @details
+ * La pale est le rang de l'impulsion modulo le nombre de pales : des
+ * impulsions perdues (anneau deborde) gardent leur rang. L'ISR reecrit
+ * la case de l'impulsion tail en ecrivant l'impulsion tail + IRPULSE_RING :
+ * head est relu apres la copie et une case rattrapee est abandonnee.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void IrPulse_Task(void)
+{
+    uint8_t n = appData.nbBlades; // Pales du profil
+    uint32_t h = head; // Impulsions ecrites
+
+    if ((n == 0) || (n > IRPULSE_MAX_BLADES)) {
+        n = 1; // Pas de suivi par pale
+    }
+    if (n != blades) {
+        IrPulse_ResetBlades(n);
+    }
+    if ((h - tail) > IRPULSE_RING) {
+        tail = h - IRPULSE_RING; // Tache en retard : les plus anciennes sont perdues
+        prevValid = false;
+    }
+
+    while (tail != h) {
+        IrPulse_Edge e; // Copie de l'impulsion lue
+        uint8_t b = (uint8_t) (tail % blades); // Pale de l'impulsion
+        float duty = -1.0f; // Rapport cyclique (inconnu sans impulsion precedente)
+
+        e.rise = ring[tail % IRPULSE_RING].rise;
+        e.width = ring[tail % IRPULSE_RING].width;
+        h = head; // Relu apres la copie
+        if ((h - tail) > IRPULSE_RING) {
+            tail = h - IRPULSE_RING; // Case reecrite pendant la copie
+            prevValid = false;
+            continue;
+        }
+        if (prevValid && (e.rise != prevRise)) {
+            duty = (float) e.width / (float) (e.rise - prevRise);
+        }
+        if (!emaReady[b]) {
+            widthEma[b] = (float) e.width;
+            if (duty >= 0.0f) {
+                dutyEma[b] = duty;
+                emaReady[b] = true;
+            }
+        } else {
+            widthEma[b] += IRPULSE_ALPHA * ((float) e.width - widthEma[b]);
+            if (duty >= 0.0f) {
+                dutyEma[b] += IRPULSE_ALPHA * (duty - dutyEma[b]);
+            }
+        }
+        if (duty >= ((float) IRPULSE_GOOD_PERMILLE / 1000.0f)) {
+            winGood++;
+        }
+        prevRise = e.rise;
+        prevValid = true;
+        tail++;
+
+        if (winPulses == 0) {
+            winBad0 = IrPulse_BadCount();
+        }
+        winPulses++;
+        if (winPulses >= IRPULSE_WINDOW) {
+            uint32_t bad = IrPulse_BadCount() - winBad0; // Mauvais evenements de la fenetre
+
+            quality = (uint8_t) ((100UL * winGood) / (winPulses + bad));
+            winPulses = 0;
+            winGood = 0;
+        }
+    }
+}
+
+/**
+ * @brief Copie des statistiques.
+ *
+ * @param out Copie des statistiques
+ * @return Aucun retour.
+ */
+void IrPulse_Get(IrPulse_Stats *out)
+{
+    uint8_t b; // Pale
+
+    memset(out, 0, sizeof(*out));
+    out->pulses = head;
+    out->glitches = glitches;
+    out->dropouts = dropouts;
+    out->resyncs = resyncs;
+    out->quality = quality;
+    out->blades = blades;
+    for (b = 0; b < blades; b++) {
+        float us = widthEma[b] * (1000000.0f / (float) RPMCALC_TIMER_FREQ); // Largeur [us]
+        float pm = dutyEma[b] * 1000.0f; // Rapport cyclique [1/1000]
+
+        out->widthUs[b] = (us < 65535.0f) ? (uint16_t) (us + 0.5f) : 0xFFFF;
+        out->dutyPermille[b] = (uint16_t) (pm + 0.5f);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+--------------------------------------------------------
+ Fichier : IrPulse.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Largeur des impulsions IR, rapport cyclique et rejet des parasites
+--------------------------------------------------------*/
+
+#ifndef _IRPULSE_H_
+#define _IRPULSE_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * En mode front a front, IC3 capture les deux fronts (premier front
+ * montant puis chaque front) : le type du front se deduit de l'alternance,
+ * recalee sur le niveau de RF4 quand la FIFO est vide (front manque).
+ *
+ * Dans l'ISR, une impulsion plus courte que IRPULSE_MIN_WIDTH_TICKS est
+ * un parasite : ses deux fronts sont ignores. Un creux plus court que
+ * cette meme duree est un trou de reflexion : l'impulsion continue. Le
+ * front montant d'une impulsion valide n'est publie (mesure, anneau des
+ * captures) qu'a son front descendant, avec un retard egal a sa largeur.
+ * L'impulsion n'entre dans l'anneau des largeurs qu'au front montant
+ * suivant hors trou : sa largeur inclut alors les trous combles.
+ *
+ * La tache attribue chaque impulsion a une pale (rang modulo le nombre de
+ * pales du profil, relatif au demarrage) et lisse sa largeur et son
+ * rapport cyclique. Qualite du signal sur les IRPULSE_WINDOW dernieres
+ * impulsions : part des impulsions de rapport cyclique au moins
+ * IRPULSE_GOOD_PERMILLE (impulsion trop etroite = reflexion faible), les
+ * parasites, trous et fronts manques comptant comme mauvais.
+ */
+
+#define IRPULSE_MIN_WIDTH_TICKS 100     // 10 us : impulsion ou creux plus court = parasite
+#define IRPULSE_RING            16      // Impulsions en attente de la tache
+#define IRPULSE_MAX_BLADES      4       // Pales suivies individuellement (maximum du menu)
+#define IRPULSE_GOOD_PERMILLE   20      // Rapport cyclique minimal d'une bonne reflexion [1/1000]
+#define IRPULSE_WINDOW          64      // Impulsions par evaluation de la qualite
+
+/**
+ * @brief Statistiques des impulsions.
+ */
+typedef struct {
+    uint32_t pulses;        // Impulsions valides depuis le demarrage
+    uint32_t glitches;      // Parasites rejetes
+    uint32_t dropouts;      // Trous de reflexion combles
+    uint32_t resyncs;       // Fronts manques (alternance recalee)
+    uint8_t quality;        // Qualite du signal [%] (0 avant la premiere fenetre)
+    uint8_t blades;         // Pales suivies
+    uint16_t widthUs[IRPULSE_MAX_BLADES];       // Largeur lissee par pale [us]
+    uint16_t dutyPermille[IRPULSE_MAX_BLADES];  // Rapport cyclique lisse par pale [1/1000]
+} IrPulse_Stats;
+
+/**
+ * @brief Remet les statistiques et l'alternance des fronts a zero.
+ */
+void IrPulse_Start(void);
+
+/**
+ * @brief Recale l'alternance apres une reprogrammation d'IC3.
+ *
+ * @details Le prochain front capture est montant ; interruption IC3 masquee.
+ */
+void IrPulse_Resync(void);
+
+/**
+ * @brief Traite un front capture (appelee par l'ISR IC3 en mode deux fronts).
+ *
+ * @param cap Front capture [ticks IC], remplace par le front montant publie
+ * @return true si une impulsion valide se termine : *cap est a publier
+ */
+bool IrPulse_EdgeIsr(uint32_t *cap);
+
+/**
+ * @brief Attribue les impulsions aux pales et evalue la qualite (creneau de la chaine IR).
+ */
+void IrPulse_Task(void);
+
+/**
+ * @brief Copie des statistiques.
+ *
+ * @param out Copie des statistiques
+ */
+void IrPulse_Get(IrPulse_Stats *out);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+--------------------------------------------------------
+ Fichier : IsrPrio.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Application des configurations de priorite des interruptions
+--------------------------------------------------------
+*/
+// Inclusion du header priorites
+#include "IsrPrio.h" // Table des configurations
+// Inclusion des definitions systeme
+#include "system_definitions.h" // PLIB interruptions
+
+// Niveaux par configuration (ordre de ISR_PRIO_CONFIG)
+static const IsrPrio_Config configs[ISR_PRIO_COUNT] = {
+    { 1, 1, 1 }, // ISR_PRIO_BASELINE
+    { 1, 3, 1 }, // ISR_PRIO_IC3_FIRST
+    { 1, 4, 2 }, // ISR_PRIO_IC3_COM_T1
+    { 3, 1, 1 }, // ISR_PRIO_T1_FIRST
+};
+
+static uint8_t current = ISR_PRIO_DEFAULT; // Configuration appliquee
+
+/**
+ * @brief Applique une configuration de priorites.
+ *
+ * @details
+ * Les priorites sont ecrites interruptions masquees : aucune ISR ne demarre
+ * avec une configuration a moitie appliquee.
+ *
+ * @param config Configuration (ISR_PRIO_CONFIG)
+ * @return false si la configuration n'existe pas
+ */
+bool IsrPrio_Apply(uint8_t config)
+{
+    const IsrPrio_Config *c; // Niveaux demandes
+    unsigned int status; // Etat des interruptions
+
+    if (config >= ISR_PRIO_COUNT) {
+        return false; // Configuration inconnue
+    }
+    c = &configs[config];
+
+    status = __builtin_disable_interrupts(); // Bascule atomique
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_T1, (INT_PRIORITY_LEVEL) c->timer1);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_IC3, (INT_PRIORITY_LEVEL) c->ic3);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_IC3_ERROR, (INT_PRIORITY_LEVEL) c->ic3);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_DMA0, (INT_PRIORITY_LEVEL) c->com);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_UART5_TX, (INT_PRIORITY_LEVEL) c->com);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_UART2_RX, (INT_PRIORITY_LEVEL) c->com);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_DMA1, (INT_PRIORITY_LEVEL) c->com);
+    current = config;
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+    return true;
+}
+
+/**
+ * @brief Configuration actuellement appliquee.
+ *
+ * @return Index de configuration (ISR_PRIO_CONFIG)
+ */
+uint8_t IsrPrio_Current(void)
+{
+    return current;
+}
+
+/**
+ * @brief Niveaux d'une configuration.
+ *
+ * @param config Configuration (ISR_PRIO_CONFIG)
+ * @return Pointeur sur les niveaux, 0 si la configuration n'existe pas
+ */
+const IsrPrio_Config* IsrPrio_Get(uint8_t config)
+{
+    if (config >= ISR_PRIO_COUNT) {
+        return 0; // Configuration inconnue
+    }
+    return &configs[config];
+}
@@ -0,0 +1,68 @@
+/*
+--------------------------------------------------------
+ Fichier : IsrPrio.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Table des configurations de priorite des interruptions
+--------------------------------------------------------*/
+
+#ifndef _ISRPRIO_H_
+#define _ISRPRIO_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Les ISR de system_interrupt.c sont declarees ipl1AUTO : le prologue AUTO
+ * recopie le niveau demande (Cause.RIPL) dans Status.IPL, le niveau reel est
+ * donc celui programme dans le controleur d'interruptions. Changer une
+ * priorite ici suffit, sans recompiler les ISR.
+ *
+ * Groupe "com" : DMA0, U5TX, U2RX (RS485) et DMA1 (flux USB).
+ */
+
+// Configurations disponibles
+typedef enum {
+    ISR_PRIO_BASELINE = 0,  // Tout au niveau 1 (configuration d'origine)
+    ISR_PRIO_IC3_FIRST,     // IC3 niveau 3, le reste au niveau 1
+    ISR_PRIO_IC3_COM_T1,    // IC3 niveau 4 > com niveau 2 > Timer1 niveau 1
+    ISR_PRIO_T1_FIRST,      // Timer1 niveau 3 > IC3 et com niveau 1 (pire cas)
+    ISR_PRIO_COUNT
+} ISR_PRIO_CONFIG;
+
+// Configuration appliquee au demarrage
+#define ISR_PRIO_DEFAULT    ISR_PRIO_BASELINE
+
+/**
+ * @brief Niveaux de priorite d'une configuration (1 a 7).
+ */
+typedef struct {
+    uint8_t timer1;     // Base de temps 1 ms
+    uint8_t ic3;        // Capture IR (et son vecteur d'erreur)
+    uint8_t com;        // RS485 et flux USB
+} IsrPrio_Config;
+
+/**
+ * @brief Applique une configuration de priorites.
+ *
+ * @param config Configuration (ISR_PRIO_CONFIG)
+ * @return false si la configuration n'existe pas
+ */
+bool IsrPrio_Apply(uint8_t config);
+
+/**
+ * @brief Configuration actuellement appliquee.
+ *
+ * @return Index de configuration (ISR_PRIO_CONFIG)
+ */
+uint8_t IsrPrio_Current(void);
+
+/**
+ * @brief Niveaux d'une configuration.
+ *
+ * @param config Configuration (ISR_PRIO_CONFIG)
+ * @return Pointeur sur les niveaux, 0 si la configuration n'existe pas
+ */
+const IsrPrio_Config* IsrPrio_Get(uint8_t config);
+
+#endif
@@ -1,6 +1,8 @@
 /* -----------------------------------------------------------------------------
  * LCD.c - Driver for Newhaven NHD-C0220BiZ-FSW-FBW-3V3M
- * Simplified I2C driver using Harmony static functions (DRV_I2C0_*).
+ * Writes go through the interrupt-driven I2C queue (i2c_master): each
+ * (control, data) pair is buffered and sent in the background, several
+ * pairs per transaction using the ST7036i continuation bit (Co).
  *
  * Sequence and timing now match exactly the ST7036i datasheet example
  * (see "Initialization For ST7036i"), and hexadecimal literals are written
@@ -11,64 +13,186 @@
 #include <xc.h> // Inclusion des definitions du compilateur
 #include <stdint.h> // Inclusion des types entiers standard
 #include <stdbool.h> // Inclusion du type booleen standard
-#include <stdio.h> // Inclusion des fonctions d'entree/sortie standard
-#include <stdarg.h> // Inclusion des fonctions pour arguments variables
-#include "Mc32Delays.h" // Inclusion des fonctions de delai
+#include <string.h> // Inclusion de memset
 #include "system_definitions.h" // Inclusion des definitions systeme
+#include "Profiler.h" // Inclusion des sondes de temps d'execution
+#include "Deadline.h" // Inclusion des echeances (attentes bornees)
+#include "i2c_master.h" // Inclusion du maitre I2C sur interruptions
 
 /* -------------------------------------------------------------------------- */
-#define LCD_I2C_ADDR_WRITE  0x78   /* 8-bit write address from datasheet */
+#define LCD_I2C_ADDR        0x3C   /* 7-bit address (0x78 write)  */
 #define LCD_CMD             0x00   /* control byte: command */
 #define LCD_DATA            0x40   /* control byte: data    */
+#define LCD_CONTINUE        0x80   /* control byte: Co = another pair follows */
+
+#define LCD_RING_PAIRS      128    /* paires en attente (2 ecrans complets)   */
+#define LCD_BATCH_PAIRS     16     /* paires par transaction I2C              */
+#define LCD_FULL_TIMEOUT_US 5000   /* attente maximale d'une place libre      */
+#define LCD_XFER_US         100    /* 3 octets a 400 kHz + start / stop       */
+#define LCD_PING_TIMEOUT_US 2000   /* attente maximale de la reponse au ping  */
+#define LCD_POWER_UP_US     50000  /* 40 ms apres VDD = 2.7 V + marge      */
+#define LCD_FRAME_BUDGET_PAIRS 24  /* paires par lcd_frame_flush (48 octets, ~1.2 ms a 400 kHz) */
+#define LCD_SET_CGRAM       0x40   /* commande : adresse CGRAM (IS = 0)       */
+#define LCD_SET_DDRAM       0x80   /* commande : adresse DDRAM                */
+#define LCD_GLYPH_ROWS      8      /* lignes de pixels d'un caractere         */
+#define LCD_UNKNOWN_CELL    0x00   /* case d'ecran inconnue (jamais dans l'image) */
+#define LCD_UNKNOWN_ROW     0xFF   /* ligne CGRAM inconnue (5 bits utiles)    */
 
 static const uint8_t s_lineAddr[2] = {0x00, 0x40}; // Adresses de debut de ligne
 
+/* Sequence d'init ST7036i : commande puis attente avant la suivante */
+typedef struct {
+    uint8_t cmd;        // Commande a envoyer
+    uint16_t waitUs;    // Attente apres la commande [us]
+} LcdInitStep;
+
+static const LcdInitStep s_initSeq[] = {
+    {0x38, 30},     // Function set (IS=0)
+    {0x39, 30},     // Function set (IS=1)
+    {0x14, 30},     // Bias/OSC
+    {0x78, 30},     // Contrast low byte
+    {0x5E, 30},     // Contrast high + booster
+    {0x6D, 200},    // Follower control, stabilisation booster
+    {0x0C, 30},     // Display ON
+    {0x01, 2000},   // Clear display
+    {0x06, 30},     // Entry mode
+    {0x38, 30}      // Function set (IS=0) : 0x40-0x7F redeviennent des adresses CGRAM
+};
+#define LCD_INIT_STEPS  (sizeof (s_initSeq) / sizeof (s_initSeq[0]))
+
+static Deadline_Resume s_init; // Point de reprise de l'init
+static bool s_ready = false; // Init terminee
+static volatile uint32_t s_busErrors = 0; // Transactions en echec ou paires perdues
+
+static uint8_t s_ring[LCD_RING_PAIRS][2]; // Paires (controle, donnee) en attente
+static volatile uint8_t s_ringHead = 0; // Plus ancienne paire
+static volatile uint8_t s_ringCount = 0; // Paires en attente
+static uint8_t s_xfer[2 * LCD_BATCH_PAIRS]; // Octets de la transaction en cours
+static volatile bool s_inFlight = false; // Transaction LCD dans la file I2C
+static volatile uint8_t s_pingResult = 0xFF; // Resultat du ping (0xFF = en cours)
+
+static char s_frame[LCD_ROWS][LCD_COLS]; // Image voulue de l'ecran
+static char s_shown[LCD_ROWS][LCD_COLS]; // Image envoyee a l'ecran (0 = inconnue)
+static uint8_t s_glyph[LCD_GLYPHS * LCD_GLYPH_ROWS]; // CGRAM voulue
+static uint8_t s_glyphShown[LCD_GLYPHS * LCD_GLYPH_ROWS]; // CGRAM envoyee (0xFF = inconnue)
+
+static void _kick(void);
+
 /* -------------------------------------------------------------------------- */
-/* Byte-level helper - 30 us gap kept for compatibility                      */
+/* Background transfer - pairs batched with the continuation bit             */
 /* -------------------------------------------------------------------------- */
 /**
- * @brief Envoie un octet sur le bus I2C vers le LCD.
+ * @brief Fin d'une transaction LCD (contexte d'interruption).
+ *
+ * @param result Resultat de la transaction (I2C_RESULT)
+ * @param ctx Inutilise
+ * @return Aucun retour.
+ */
+static void _xferDone(uint8_t result, void *ctx)
+{
+    (void) ctx;
+    if (result != I2C_RESULT_OK) {
+        s_busErrors++; // Paires de la transaction perdues
+    }
+    s_inFlight = false;
+    _kick(); // Lot suivant
+}
+
+/**
+ * @brief Soumet le prochain lot de paires si aucune transaction LCD n'est en cours.
  *
  * @details
- * Cette fonction ecrit un octet sur le bus I2C et attend la fin de l'ecriture.
+ * Toutes les paires sauf la derniere portent le bit Co : le ST7036i attend
+ * alors un nouvel octet de controle. Une paire = 2 octets a 400 kHz = 45 us,
+ * plus que les 26 us d'execution d'une commande.
  *
- * @param byte Octet a envoyer.
+ * @param Aucun parametre.
  * @return Aucun retour.
+ */
+static void _kick(void)
+{
+    I2C_Transaction t; // Transaction du lot
+    unsigned int status; // Etat des interruptions
+    uint8_t n, i, k; // Paires du lot
+
+    status = __builtin_disable_interrupts(); // Anneau partage avec le callback
+    if (!s_inFlight && (s_ringCount != 0)) {
+        n = (s_ringCount < LCD_BATCH_PAIRS) ? s_ringCount : LCD_BATCH_PAIRS;
+        for (i = 0; i < n; i++) {
+            k = (uint8_t) ((s_ringHead + i) % LCD_RING_PAIRS);
+            s_xfer[2 * i] = (uint8_t) (s_ring[k][0] | ((i < (n - 1)) ? LCD_CONTINUE : 0));
+            s_xfer[2 * i + 1] = s_ring[k][1];
+        }
+        t.addr = LCD_I2C_ADDR;
+        t.wrBuf = s_xfer;
+        t.wrLen = (uint16_t) (2 * n);
+        t.rdBuf = 0;
+        t.rdLen = 0;
+        t.callback = _xferDone;
+        t.ctx = 0;
+        if (i2c_submit(&t)) {
+            s_ringHead = (uint8_t) ((s_ringHead + n) % LCD_RING_PAIRS);
+            s_ringCount -= n;
+            s_inFlight = true;
+        }
+    }
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+}
+
+/**
+ * @brief Indique si des paires restent a envoyer.
  *
- * @pre Le bus I2C doit etre initialise.
- * @post L'octet est envoye au LCD.
+ * @param Aucun parametre.
+ * @return true tant que l'anneau ou une transaction LCD n'est pas vide.
  */
-static void _sendByte(uint8_t byte)
+static bool _pending(void)
 {
-    DRV_I2C0_ByteWrite(byte); // Ecrit l'octet sur le bus I2C
-    while (!DRV_I2C0_WaitForByteWriteToComplete()); // Attend la fin de l'ecriture
-    delay_usCt(30); // Delai de 30 us
+    return (s_inFlight || (s_ringCount != 0));
 }
 
 /**
- * @brief Envoie une paire (controle, donnee) brute au LCD.
+ * @brief Met en file une paire (controle, donnee) pour le LCD.
  *
  * @details
- * Cette fonction envoie un octet de controle puis une donnee brute.
+ * Rend la main des que la paire est en file. Si l'anneau est plein,
+ * attend une place au plus LCD_FULL_TIMEOUT_US puis abandonne la paire.
  *
  * @param control Octet de controle (commande ou donnee)
  * @param data Octet de donnee
  * @return Aucun retour.
  *
- * @pre Le bus I2C doit etre initialise.
- * @post La donnee est envoyee au LCD.
+ * @pre Le bus I2C doit etre initialise (i2c_init).
+ * @post La paire sera envoyee en arriere-plan.
  */
 static void _sendRaw(uint8_t control, uint8_t data)
 {
-    DRV_I2C0_MasterStart(); // Start I2C
-    delay_usCt(30); // Delai
+    Deadline timeout; // Limite de l'attente d'une place
+    unsigned int status; // Etat des interruptions
+    uint8_t k; // Place dans l'anneau
 
-    _sendByte(LCD_I2C_ADDR_WRITE);  // Adresse esclave
-    _sendByte(control);             // 0x00 ou 0x40
-    _sendByte(data);                // Donnee
-
-    DRV_I2C0_MasterStop(); // Stop I2C
-    delay_usCt(30); // Delai
+    PROF_BEGIN(PROF_SITE_I2C_LCD); // Debut de la sonde
+    if (s_ringCount >= LCD_RING_PAIRS) {
+        timeout = Deadline_InUs(LCD_FULL_TIMEOUT_US);
+        while (s_ringCount >= LCD_RING_PAIRS) { // Le callback libere des places
+            i2c_task(); // Recupere le bus s'il est bloque
+            if (Deadline_Expired(timeout)) {
+                s_busErrors++; // Paire perdue
+                return;
+            }
+        }
+    }
+    status = __builtin_disable_interrupts();
+    k = (uint8_t) ((s_ringHead + s_ringCount) % LCD_RING_PAIRS);
+    s_ring[k][0] = control;
+    s_ring[k][1] = data;
+    s_ringCount++;
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+    _kick(); // Demarre si aucune transaction LCD en cours
+    PROF_END(PROF_SITE_I2C_LCD); // Fin de la sonde
 }
 
 static inline void _cmd(uint8_t c)  { _sendRaw(LCD_CMD , c); } // Envoie une commande
@@ -78,59 +202,90 @@ static inline void _data(uint8_t d) { _sendRaw(LCD_DATA, d); } // Envoie une don
 /* Initialisation sequence strict datasheet                                 */
 /* -------------------------------------------------------------------------- */
 /**
- * @brief Initialise l'afficheur LCD.
+ * @brief Demarre l'initialisation non bloquante de l'afficheur.
  *
  * @details
- * Sequence d'initialisation conforme a la datasheet ST7036i.
+ * La premiere commande est programmee LCD_POWER_UP_US apres cet appel.
+ * lcd_init_task() doit ensuite etre appelee jusqu'a ce qu'elle renvoie true.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
- *
- * @pre Aucun prerequis specifique.
- * @post L'afficheur LCD est pret a etre utilise.
  */
-void lcd_init(void)
+void lcd_init_start(void)
 {
-    /* 40 ms after VDD rises to 2.7 V */
-    delay_msCt(50); // Delai d'attente apres alimentation
-
-    //DRV_I2C0_MasterStart(); /* implicite dans _sendRaw mais on garde le timing exact */
-
-    /* Function set (IS=0) */
-    _cmd(0x38); // Commande function set
-    delay_usCt(30);
-
-    /* Function set (IS=1) */
-    _cmd(0x39); // Commande function set avec IS=1
-    delay_usCt(30);
-
-    /* Bias/OSC */
-    _cmd(0x14); // Reglage bias/oscillateur
-    delay_usCt(30);
-
-    /* Contrast low byte */
-    _cmd(0x78); // Reglage contraste bas
-    delay_usCt(30);
-
-    /* Contrast high + booster */
-    _cmd(0x5E); // Reglage contraste haut + booster
-    delay_usCt(30);
+    s_ready = false; // Afficheur pas encore utilisable
+    lcd_frame_invalidate(); // Ecran et CGRAM a renvoyer
+    Deadline_ResumeAfterUs(&s_init, 0, LCD_POWER_UP_US); // Attente de l'alimentation
+}
 
-    /* Follower control */
-    _cmd(0x6D); // Reglage follower
-    delay_usCt(200);          // Stabilisation booster
+/**
+ * @brief Avance l'initialisation d'une etape si son delai est ecoule.
+ *
+ * @details
+ * Sequence d'initialisation conforme a la datasheet ST7036i. Entre deux
+ * commandes la fonction rend la main : le CPU reste disponible.
+ *
+ * @param Aucun parametre.
+ * @return true quand l'afficheur est pret.
+ */
+bool lcd_init_task(void)
+{
+    if (s_ready) {
+        return true; // Deja initialise
+    }
+    if (!Deadline_CanResume(&s_init) || _pending()) {
+        return false; // Delai de l'etape en cours ou commande pas encore partie
+    }
+    if (s_init.step >= LCD_INIT_STEPS) {
+        s_ready = true; // Derniere attente ecoulee
+        return true;
+    }
+    _cmd(s_initSeq[s_init.step].cmd); // Commande de l'etape
+    Deadline_ResumeAfterUs(&s_init, s_init.step + 1, LCD_XFER_US + s_initSeq[s_init.step].waitUs);
+    return false;
+}
 
-    /* Display ON */
-    _cmd(0x0C); // Allume l'affichage
-    delay_usCt(30);
+/**
+ * @brief Indique si l'afficheur est initialise.
+ *
+ * @param Aucun parametre.
+ * @return true si l'afficheur est pret.
+ */
+bool lcd_is_ready(void)
+{
+    return s_ready;
+}
 
-    /* Clear display */
-    _cmd(0x01); // Efface l'affichage
-    delay_msCt(2);
+/**
+ * @brief Nombre de transactions I2C en echec ou de paires perdues.
+ *
+ * @param Aucun parametre.
+ * @return Compteur d'erreurs de bus.
+ */
+uint32_t lcd_get_bus_errors(void)
+{
+    return s_busErrors;
+}
 
-    /* Entry mode */
-    _cmd(0x06); // Mode entree
-    delay_usCt(30);
+/**
+ * @brief Initialise l'afficheur LCD (version bloquante).
+ *
+ * @details
+ * Enchaine lcd_init_start() et lcd_init_task() jusqu'a la fin de la
+ * sequence. Reserve aux cas ou rien d'autre ne peut avancer en parallele.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @pre Aucun prerequis specifique.
+ * @post L'afficheur LCD est pret a etre utilise.
+ */
+void lcd_init(void)
+{
+    lcd_init_start(); // Programme la sequence
+    while (!lcd_init_task()) {
+        // Attente des delais de la sequence
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -138,11 +293,12 @@ void lcd_init(void)
 /* -------------------------------------------------------------------------- */
 void lcd_set_cursor(uint8_t col, uint8_t row)
 {
-    if (col == 0 || col > 20 || row < 1 || row > 2) 
+    if (col == 0 || col > LCD_COLS || row < 1 || row > LCD_ROWS) 
     {
         return;
     }
-    _cmd(0x80 | (s_lineAddr[row - 1] + col - 1));
+    memset(s_shown, LCD_UNKNOWN_CELL, sizeof(s_shown)); /* ecriture directe : image a renvoyer */
+    _cmd(LCD_SET_DDRAM | (s_lineAddr[row - 1] + col - 1));
 }
 
 void lcd_putc(uint8_t c)
@@ -153,6 +309,7 @@ void lcd_putc(uint8_t c)
     }
     else 
     {
+        memset(s_shown, LCD_UNKNOWN_CELL, sizeof(s_shown)); /* ecriture directe : image a renvoyer */
         _data(c);
     }
 }
@@ -165,45 +322,187 @@ void lcd_put_string(const char *s)
     }
 }
 
-void lcd_printf(const char *fmt, ...)
+/* -------------------------------------------------------------------------- */
+/* Frame buffer - only changed cells are sent                                */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Remplit l'image voulue d'espaces.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void lcd_frame_clear(void)
 {
-    char buf[21];
-    va_list ap;
-    va_start(ap, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, ap);
-    va_end(ap);
-    lcd_put_string(buf);
+    memset(s_frame, ' ', sizeof(s_frame));
 }
-bool LCD_Ping(void)
+
+/**
+ * @brief Ecrit une chaine dans l'image voulue, coupee en fin de ligne.
+ *
+ * @param col Colonne (1-20)
+ * @param row Ligne (1-2)
+ * @param s Chaine terminee par '\0'
+ * @return Aucun retour.
+ */
+void lcd_frame_write(uint8_t col, uint8_t row, const char *s)
 {
-    /* 1. S?assurer que le bus est libre */
-    if (!DRV_I2C0_MasterBusIdle())
-    {
-        DRV_I2C0_MasterStop();               // libere si besoin
+    char *dst = lcd_frame_at(col, row); // Premiere case
+    uint8_t left; // Cases restantes sur la ligne
+
+    if (dst == 0) {
+        return; // Position hors ecran
     }
+    left = (uint8_t) (LCD_COLS - (col - 1));
+    while ((*s != '\0') && (left != 0)) {
+        *dst++ = *s++;
+        left--;
+    }
+}
 
-    /* 2. START */
-    if (!DRV_I2C0_MasterStart())             // genere START
-    {
-        return false;
-    /* (on ne teste pas WaitForStartComplete, il revient tres vite) */
+/**
+ * @brief Adresse d'une case de l'image voulue.
+ *
+ * @details
+ * Permet d'ecrire directement dans l'image (LCD_COLS - col + 1 cases
+ * disponibles jusqu'a la fin de la ligne).
+ *
+ * @param col Colonne (1-20)
+ * @param row Ligne (1-2)
+ * @return Pointeur sur la case, 0 si hors ecran
+ */
+char *lcd_frame_at(uint8_t col, uint8_t row)
+{
+    if (col == 0 || col > LCD_COLS || row < 1 || row > LCD_ROWS) {
+        return 0;
+    }
+    return &s_frame[row - 1][col - 1];
+}
+
+/**
+ * @brief Definit le dessin d'un caractere personnalise.
+ *
+ * @details
+ * Seules les lignes qui changent partent au prochain lcd_frame_flush() ;
+ * toutes les cases qui affichent LCD_GLYPH(n) changent avec elles.
+ *
+ * @param n Numero du caractere (0 a LCD_GLYPHS - 1)
+ * @param rows 8 lignes de 5 pixels (bit 4 = colonne de gauche)
+ * @return Aucun retour.
+ */
+void lcd_glyph_define(uint8_t n, const uint8_t rows[8])
+{
+    uint8_t r; // Ligne de pixels
+
+    if (n >= LCD_GLYPHS) {
+        return; // Caractere inexistant
+    }
+    for (r = 0; r < LCD_GLYPH_ROWS; r++) {
+        s_glyph[(n * LCD_GLYPH_ROWS) + r] = (uint8_t) (rows[r] & 0x1F);
+    }
+}
+
+/**
+ * @brief Force le prochain envoi de l'image et de la CGRAM completes.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void lcd_frame_invalidate(void)
+{
+    memset(s_shown, LCD_UNKNOWN_CELL, sizeof(s_shown));
+    memset(s_glyphShown, LCD_UNKNOWN_ROW, sizeof(s_glyphShown));
+}
+
+/**
+ * @brief Envoie les suites d'octets modifies d'une memoire de l'afficheur.
+ *
+ * @details
+ * Chaque suite coute une commande d'adresse puis une paire par octet ;
+ * l'adresse s'incremente seule. S'arrete quand le budget est epuise : le
+ * reste part a l'appel suivant (shown n'est mis a jour qu'a l'envoi).
+ *
+ * @param budget Paires encore autorisees (decremente)
+ * @param setAddr Commande d'adresse du premier octet (CGRAM ou DDRAM)
+ * @param want Contenu voulu
+ * @param shown Contenu envoye
+ * @param len Nombre d'octets
+ * @return Aucun retour.
+ */
+static void _flushRuns(uint8_t *budget, uint8_t setAddr, const uint8_t *want, uint8_t *shown, uint8_t len)
+{
+    uint8_t i = 0; // Octet courant
+
+    while ((i < len) && (*budget >= 2)) { // Adresse + au moins un octet
+        if (want[i] == shown[i]) {
+            i++;
+            continue; // Octet identique
+        }
+        _cmd((uint8_t) (setAddr + i)); // Adresse de la suite
+        (*budget)--;
+        while ((i < len) && (want[i] != shown[i]) && (*budget != 0)) {
+            _data(want[i]);
+            shown[i] = want[i];
+            i++;
+            (*budget)--;
+        }
     }
-    
-    /* 3. Adresse esclave + W = 0 (0x78) */
-    if (!DRV_I2C0_ByteWrite(0x78))
-        goto stop;                           // erreur d?ecriture
+}
+
+/**
+ * @brief Envoie la CGRAM et les cases de l'image qui different de l'ecran.
+ *
+ * @details
+ * Au plus LCD_FRAME_BUDGET_PAIRS paires par appel, CGRAM d'abord. Rien
+ * n'est envoye tant que l'envoi precedent n'est pas parti : l'anneau ne
+ * contient jamais plus d'un budget.
+ *
+ * @param Aucun parametre.
+ * @return Nombre de paires mises en file (0 si rien n'a change).
+ */
+uint8_t lcd_frame_flush(void)
+{
+    uint8_t budget = LCD_FRAME_BUDGET_PAIRS; // Paires restantes
+    uint8_t row; // Ligne de l'ecran
 
-    /* attendre fin de decaleur */
-    if (!DRV_I2C0_WaitForByteWriteToComplete())
-        goto stop;
+    if (!s_ready || _pending()) {
+        return 0; // Afficheur pas pret ou envoi precedent en cours
+    }
+    _flushRuns(&budget, LCD_SET_CGRAM, s_glyph, s_glyphShown, sizeof(s_glyph));
+    for (row = 0; row < LCD_ROWS; row++) {
+        _flushRuns(&budget, (uint8_t) (LCD_SET_DDRAM | s_lineAddr[row]),
+                   (const uint8_t *) s_frame[row], (uint8_t *) s_shown[row], LCD_COLS);
+    }
+    return (uint8_t) (LCD_FRAME_BUDGET_PAIRS - budget);
+}
 
-    /* 4. Lire l?ACK/NACK du LCD */
-    bool ack = DRV_I2C0_WriteByteAcknowledged();
+/**
+ * @brief Callback du ping (contexte d'interruption).
+ *
+ * @param result Resultat de la transaction (I2C_RESULT)
+ * @param ctx Inutilise
+ * @return Aucun retour.
+ */
+static void _pingDone(uint8_t result, void *ctx)
+{
+    (void) ctx;
+    s_pingResult = result;
+}
 
-stop:
-    /* 5. STOP, libere le bus */
-    DRV_I2C0_MasterStop();
-    DRV_I2C0_WaitForStopComplete();
+bool LCD_Ping(void)
+{
+    I2C_Transaction t = { LCD_I2C_ADDR, 0, 0, 0, 0, _pingDone, 0 }; // Adresse seule
+    Deadline timeout; // Limite de l'attente
 
-    return ack;      /* true  = LCD present, false = pas d?ACK */
-}
\ No newline at end of file
+    s_pingResult = 0xFF; // Reponse en attente
+    if (!i2c_submit(&t)) {
+        return false; // File pleine
+    }
+    timeout = Deadline_InUs(LCD_PING_TIMEOUT_US);
+    while (s_pingResult == 0xFF) {
+        i2c_task(); // Recupere le bus s'il est bloque
+        if (Deadline_Expired(timeout)) {
+            return false;
+        }
+    }
+    return (s_pingResult == I2C_RESULT_OK); /* true = LCD present, false = pas d'ACK */
+}
@@ -3,7 +3,16 @@
 #define LCD_H
 
 #include <stdint.h> // Inclusion des types entiers standard
-#include "system_definitions.h"   // Prototypes DRV_I2C0_*
+#include <stdbool.h> // Inclusion du type booleen standard
+#include "system_definitions.h"   // Definitions systeme
+
+#define LCD_COLS    20 // Colonnes de l'afficheur
+#define LCD_ROWS    2  // Lignes de l'afficheur
+#define LCD_GLYPHS  8  // Caracteres personnalises (CGRAM)
+
+// Code d'un caractere personnalise dans l'image (0x08-0x0F : miroir CGRAM
+// du ST7036, jamais '\0')
+#define LCD_GLYPH(n)    ((char) (0x08 + (n)))
 
 
 /* ------------------------------------------------------------------
@@ -23,6 +32,42 @@
  */
 void lcd_init(void);
 
+/**
+ * @brief Demarre l'initialisation non bloquante de l'afficheur.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @post lcd_init_task() doit etre appelee jusqu'a ce qu'elle renvoie true.
+ */
+void lcd_init_start(void);
+
+/**
+ * @brief Avance l'initialisation d'une etape si son delai est ecoule.
+ *
+ * @param Aucun parametre.
+ * @return true quand l'afficheur est pret.
+ *
+ * @pre lcd_init_start() doit avoir ete appelee.
+ */
+bool lcd_init_task(void);
+
+/**
+ * @brief Indique si l'afficheur est initialise.
+ *
+ * @param Aucun parametre.
+ * @return true si l'afficheur est pret.
+ */
+bool lcd_is_ready(void);
+
+/**
+ * @brief Nombre de transactions I2C en echec ou de paires perdues.
+ *
+ * @param Aucun parametre.
+ * @return Compteur d'erreurs de bus.
+ */
+uint32_t lcd_get_bus_errors(void);
+
 /* ------------------------------------------------------------------
    Positionne le curseur : colonne 1-20, ligne 1-2.
 ------------------------------------------------------------------ */
@@ -76,22 +121,65 @@ void lcd_putc(uint8_t c);
 void lcd_put_string(const char *str);
 
 /* ------------------------------------------------------------------
-   Affiche une chaine formatee (max 20 caracteres visibles).
+   Image de l'ecran : l'appelant compose l'image voulue et les caracteres
+   personnalises, lcd_frame_flush() n'envoie que les cases et les lignes
+   CGRAM modifiees, dans un budget fixe d'octets I2C par appel. Une
+   ecriture directe (lcd_putc, lcd_set_cursor) force le renvoi complet de
+   l'image suivante.
 ------------------------------------------------------------------ */
 /**
- * @brief Affiche une chaine formatee sur l'ecran LCD.
+ * @brief Remplit l'image voulue d'espaces.
  *
- * @details
- * Affiche une chaine formatee, limitee a 20 caracteres visibles.
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void lcd_frame_clear(void);
+
+/**
+ * @brief Ecrit une chaine dans l'image voulue, coupee en fin de ligne.
  *
- * @param format Format de la chaine.
- * @param ... Arguments variables.
+ * @param col Colonne (1-20)
+ * @param row Ligne (1-2)
+ * @param s Chaine terminee par '\0'
  * @return Aucun retour.
+ */
+void lcd_frame_write(uint8_t col, uint8_t row, const char *s);
+
+/**
+ * @brief Adresse d'une case de l'image voulue.
+ *
+ * @param col Colonne (1-20)
+ * @param row Ligne (1-2)
+ * @return Pointeur sur la case, 0 si hors ecran
+ */
+char *lcd_frame_at(uint8_t col, uint8_t row);
+
+/**
+ * @brief Definit le dessin d'un caractere personnalise.
+ *
+ * @param n Numero du caractere (0 a LCD_GLYPHS - 1), affiche par LCD_GLYPH(n)
+ * @param rows 8 lignes de 5 pixels (bit 4 = colonne de gauche)
+ * @return Aucun retour.
+ */
+void lcd_glyph_define(uint8_t n, const uint8_t rows[8]);
+
+/**
+ * @brief Force le prochain envoi de l'image et de la CGRAM completes.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void lcd_frame_invalidate(void);
+
+/**
+ * @brief Envoie la CGRAM et les cases de l'image qui different de l'ecran.
+ *
+ * @param Aucun parametre.
+ * @return Nombre de paires mises en file (0 si rien n'a change).
  *
  * @pre L'afficheur doit etre initialise.
- * @post La chaine formatee est affichee.
  */
-void lcd_printf(const char *format, ...);
+uint8_t lcd_frame_flush(void);
 
 /**
  * @brief Teste la presence de l'afficheur LCD sur le bus I2C.
@@ -14,6 +14,7 @@
 #include "Mc32Spi.h" // Inclusion du module SPI
 #include "Mc32Delays.h" // Inclusion des fonctions de delai
 #include "peripheral/spi/plib_spi.h" // Inclusion de la bibliotheque SPI
+#include "Profiler.h" // Inclusion des sondes de temps d'execution
 
 /**
  * @brief Configure le SPI pour l'accelerometre LIS2HH12.
@@ -54,8 +55,8 @@ void SPI_ConfigureAcc(void)
  */
 void LIS2HH12_Init(void)
 {
-    // CTRL1 : ODR = 100 Hz, mode normal, tous les axes actives
-    // 0x57 = 0101 0111 => ODR = 100Hz, X/Y/Z actives
+    // CTRL1 : ODR = 400 Hz, mode normal, tous les axes actives
+    // 0x57 = 0101 0111 => ODR[6:4] = 101 (400 Hz, LIS2HH12_ODR_HZ), X/Y/Z actives
     LIS2HH12_WriteReg(0x20, 0x57);
 
     // CTRL2 : filtre haute frequence desactive (par defaut), on ne change rien ici
@@ -63,8 +64,8 @@ void LIS2HH12_Init(void)
     // CTRL3 : toutes les interruptions desactivees, DRDY desactive
     LIS2HH12_WriteReg(0x22, 0x00);
 
-    // CTRL4 : echelle +-2g, high resolution desactive (par defaut)
-    LIS2HH12_WriteReg(0x23, 0x00);
+    // CTRL4 : echelle +-2g, IF_ADD_INC actif pour les lectures en rafale
+    LIS2HH12_WriteReg(0x23, 0x04);
 
     // CTRL5 : filtre FIFO, pas necessaire pour lecture simple
     LIS2HH12_WriteReg(0x24, 0x00);
@@ -140,7 +141,7 @@ void LIS2HH12_ReadXYZ(int16_t *x, int16_t *y, int16_t *z)
     uint8_t i;
 
     CS_ACC_Off(); // Active le chip select
-    spi_write1(0xC0 | LIS2HH12_OUT_X_L); // 0xC0 = read + auto-increment
+    spi_write1(0x80 | LIS2HH12_OUT_X_L); // Lecture, l'increment vient de IF_ADD_INC
     for (i = 0; i < 6; i = i + 1) {
         buf[i] = spi_read1(0xFF); // Lit chaque octet
     }
@@ -150,3 +151,85 @@ void LIS2HH12_ReadXYZ(int16_t *x, int16_t *y, int16_t *z)
     *y = (int16_t)((buf[3] << 8) | buf[2]); // Assemble Y
     *z = (int16_t)((buf[5] << 8) | buf[4]); // Assemble Z
 }
+
+/**
+ * @brief Met le LIS2HH12 en mode power-down.
+ *
+ * @details
+ * CTRL1.ODR = 000 : plus aucune conversion, consommation de quelques uA.
+ * LIS2HH12_Init remet le capteur en mesure.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void LIS2HH12_PowerDown(void)
+{
+    LIS2HH12_WriteReg(0x20, 0x07); // CTRL1 : ODR = power-down, axes conserves
+}
+
+/**
+ * @brief Active la FIFO du LIS2HH12 en mode stream.
+ *
+ * @details
+ * CTRL3.FIFO_EN = 1 puis FIFO_CTRL.FMODE = 010 (stream : les plus anciens
+ * echantillons sont ecrases si la FIFO deborde).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void LIS2HH12_EnableFifo(void)
+{
+    LIS2HH12_WriteReg(0x22, 0x80); // CTRL3 : FIFO_EN
+    LIS2HH12_WriteReg(LIS2HH12_FIFO_CTRL, 0x40); // FMODE = stream
+}
+
+/**
+ * @brief Nombre d'echantillons presents dans la FIFO (lecture de FIFO_SRC).
+ *
+ * @details
+ * FIFO_SRC donne le nombre d'echantillons non lus (FSS) et le debordement
+ * (OVR, FIFO pleine = 32).
+ *
+ * @param Aucun parametre.
+ * @return Echantillons non lus, LIS2HH12_FIFO_SIZE si la FIFO a deborde.
+ */
+uint8_t LIS2HH12_FifoLevel(void)
+{
+    uint8_t src = LIS2HH12_ReadReg(LIS2HH12_FIFO_SRC); // Etat de la FIFO
+
+    if (src & 0x40) {
+        return LIS2HH12_FIFO_SIZE; // Debordement : FIFO pleine
+    }
+    return src & 0x1F; // Echantillons non lus
+}
+
+/**
+ * @brief Lit des echantillons de la FIFO en une seule rafale SPI.
+ *
+ * @details
+ * Une seule transaction lit tous les octets. Les echantillons arrives
+ * depuis LIS2HH12_FifoLevel restent dans la FIFO pour la lecture suivante.
+ *
+ * @param xyz Buffer de sortie (3 valeurs par echantillon).
+ * @param count Echantillons a lire, au plus LIS2HH12_FifoLevel().
+ * @return Aucun retour.
+ */
+void LIS2HH12_ReadFifoBurst(int16_t *xyz, uint8_t count)
+{
+    uint8_t i;
+    uint8_t lo; // Octet de poids faible
+
+    if (count == 0) {
+        return; // Rien a lire
+    }
+
+    PROF_BEGIN(PROF_SITE_SPI_ACC); // Debut de la sonde
+    CS_ACC_Off(); // Active le chip select
+    spi_write1(0x80 | LIS2HH12_OUT_X_L); // Lecture en rafale depuis OUT_X_L
+    for (i = 0; i < (uint8_t) (count * 3); i++) {
+        lo = spi_read1(0xFF); // Poids faible
+        xyz[i] = (int16_t) ((spi_read1(0xFF) << 8) | lo); // Poids fort
+    }
+    CS_ACC_On(); // Desactive le chip select
+    PROF_END(PROF_SITE_SPI_ACC); // Fin de la sonde
+}
@@ -25,6 +25,13 @@
 #define LIS2HH12_OUT_Z_L 0x2C // Registre Z bas
 #define LIS2HH12_OUT_Z_H 0x2D // Registre Z haut
 
+// Registres FIFO
+#define LIS2HH12_FIFO_CTRL 0x2E // Mode et seuil de la FIFO
+#define LIS2HH12_FIFO_SRC 0x2F // Etat et remplissage de la FIFO
+#define LIS2HH12_FIFO_SIZE 32 // Profondeur de la FIFO (echantillons XYZ)
+#define LIS2HH12_ODR_HZ 400 // Frequence d'echantillonnage programmee par LIS2HH12_Init
+#define LIS2HH12_MG_PER_LSB 0.061f // Sensibilite a +-2g (CTRL4.FS = 00) [mg/LSB]
+
 /**
  * @brief Configure le SPI pour l'accelerometre LIS2HH12.
  *
@@ -112,4 +119,56 @@ void LIS2HH12_ReadXYZ(int16_t *x, int16_t *y, int16_t *z);
  */
 void LIS2HH12_Init(void);
 
+/**
+ * @brief Met le LIS2HH12 en mode power-down.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @pre Le SPI doit etre configure pour l'accelerometre.
+ * @post Le capteur ne mesure plus jusqu'au prochain LIS2HH12_Init.
+ */
+void LIS2HH12_PowerDown(void);
+
+/**
+ * @brief Active la FIFO du LIS2HH12 en mode stream.
+ *
+ * @details
+ * Les echantillons s'accumulent dans la FIFO interne (32 niveaux) au rythme
+ * de l'ODR, ce qui permet de lire tous les echantillons par paquets.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @pre LIS2HH12_Init doit avoir ete appelee.
+ * @post La FIFO accumule les echantillons.
+ */
+void LIS2HH12_EnableFifo(void);
+
+/**
+ * @brief Nombre d'echantillons presents dans la FIFO (lecture de FIFO_SRC).
+ *
+ * @details
+ * Les echantillons comptes sont tous anterieurs a la lecture : l'appelant
+ * peut dater le bloc juste apres, avant LIS2HH12_ReadFifoBurst.
+ *
+ * @return Echantillons non lus, LIS2HH12_FIFO_SIZE si la FIFO a deborde.
+ *
+ * @pre LIS2HH12_EnableFifo doit avoir ete appelee.
+ */
+uint8_t LIS2HH12_FifoLevel(void);
+
+/**
+ * @brief Lit des echantillons de la FIFO en une seule rafale SPI.
+ *
+ * @details
+ * X, Y, Z entrelaces. L'adresse revient sur OUT_X_L apres OUT_Z_H.
+ *
+ * @param xyz Buffer de sortie (3 valeurs par echantillon).
+ * @param count Echantillons a lire, au plus LIS2HH12_FifoLevel().
+ *
+ * @post Les echantillons lus sont retires de la FIFO.
+ */
+void LIS2HH12_ReadFifoBurst(int16_t *xyz, uint8_t count);
+
 #endif
@@ -0,0 +1,358 @@
+/*
+--------------------------------------------------------
+ Fichier : LatBench.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Banc de mesure de latence et de gigue de la chaine de capture IR
+--------------------------------------------------------
+*/
+// Inclusion du header banc de latence
+#include "LatBench.h" // Prototypes du banc
+// Inclusion du header application
+#include "app.h" // Buffer de capture et base de temps
+// Inclusion du header base de temps
+#include "Timebase.h" // Frequence du Core Timer
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Calcul de la mesure visuelle
+// Inclusion de la configuration systeme
+#include "system_config.h" // Configuration systeme
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Drivers IC / TMR et SFR
+#include <string.h> // Pour memset
+
+#define LATBENCH_TICKS_PER_US (RPMCALC_TIMER_FREQ / 1000000UL) // Ticks IC par us
+
+static LatBench_Result results[ISR_PRIO_COUNT]; // Resultats par configuration
+static volatile bool running = false; // Capture et OC4 utilises par le banc
+static volatile bool measuring = false; // Fenetre de mesure ouverte
+static uint8_t state = LATBENCH_IDLE; // Etat du banc
+static uint8_t config = 0; // Configuration mesuree
+static uint16_t freq = 0; // Frequence demandee [Hz]
+static uint32_t halfPeriod = 0; // Demi-periode du signal [ticks IC]
+static uint32_t period = 0; // Periode du signal [ticks IC]
+static uint32_t nominalCore = 0; // Periode du signal [ticks Core Timer]
+static uint32_t windowStartMs = 0; // Debut de la fenetre courante
+
+// Etat de l'ISR IC3 (derniere capture mesuree)
+static bool havePrev = false; // Capture precedente valide
+static uint32_t prevCap = 0; // Capture precedente [ticks IC]
+static uint32_t prevCore = 0; // Entree ISR precedente [ticks Core Timer]
+
+/**
+ * @brief Classe log2 d'une latence.
+ *
+ * @param ticks Latence en ticks IC
+ * @return Index de classe (0 pour 0 et 1)
+ */
+static uint8_t LatBench_Bucket(uint32_t ticks)
+{
+    uint8_t b = 0; // Classe
+
+    while ((ticks > 1) && (b < (LATBENCH_HIST_BUCKETS - 1))) {
+        ticks >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/**
+ * @brief Ouvre la fenetre de la configuration courante.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void LatBench_BeginWindow(void)
+{
+    measuring = false; // L'ISR ignore les captures pendant la stabilisation
+    IsrPrio_Apply(config); // Priorites a mesurer
+    windowStartMs = appData.tickMs;
+}
+
+/**
+ * @brief Arrete le signal de test et rend la capture.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void LatBench_Stop(void)
+{
+    measuring = false;
+    OC4CONbits.ON = 0; // Arrete le signal
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_OUTPUT_COMPARE_4);
+    PLIB_PORTS_PinDirectionInputSet(PORTS_ID_0, PORT_CHANNEL_F, PORTS_BIT_POS_5); // RF5 en haute impedance
+    DRV_IC0_Stop(); // Arrete la capture
+    DRV_TMR1_Stop(); // Arrete le timer
+    appData.rpmCaptureActive = false;
+    IsrPrio_Apply(ISR_PRIO_DEFAULT); // Priorites de production
+    running = false;
+}
+
+/**
+ * @brief Verifie le RPM calcule a partir du buffer de capture.
+ *
+ * @details
+ * Meme calcul que la mesure visuelle (1 front par tour). L'erreur est
+ * rapportee a la periode reellement generee, pas a la frequence demandee
+ * (arrondi de la demi-periode). La latence bout en bout est l'age de la
+ * derniere capture au moment du calcul.
+ *
+ * @param r Resultats de la configuration courante
+ * @return Aucun retour.
+ */
+static void LatBench_CheckRpm(LatBench_Result *r)
+{
+    uint8_t i = appData.captureIndex; // Index courant
+    uint8_t j = (i + RPM_CAPTURE_BUFFER_SIZE - 1) % RPM_CAPTURE_BUFFER_SIZE; // Derniere capture
+    uint8_t k = (j + RPM_CAPTURE_BUFFER_SIZE - 1) % RPM_CAPTURE_BUFFER_SIZE; // Capture precedente
+    uint32_t newest = appData.captureBuffer[j]; // Derniere capture
+    uint32_t delta = newest - appData.captureBuffer[k]; // Periode mesuree
+    uint32_t now = DRV_TMR1_CounterValueGet(); // Instant du calcul [ticks IC]
+    uint64_t exact = 60ULL * RPMCALC_TIMER_FREQ; // RPM x periode attendus
+    uint64_t got; // RPM calcule x periode generee
+    uint32_t rpm; // RPM calcule
+    uint32_t errPpm; // Erreur relative
+    uint32_t e2eUs; // Age de la capture
+
+    if ((r->edges < 3) || (delta == 0)) {
+        return; // Buffer pas encore rempli par la fenetre
+    }
+
+    rpm = RpmCalc_FromPeriod(delta, 1); // Calcul de la mesure visuelle
+    got = (uint64_t) rpm * period;
+    errPpm = (uint32_t) ((((got > exact) ? (got - exact) : (exact - got)) * 1000000ULL) / exact);
+    e2eUs = (now - newest) / LATBENCH_TICKS_PER_US;
+
+    r->rpmSamples++;
+    if (errPpm > r->rpmErrMaxPpm) {
+        r->rpmErrMaxPpm = errPpm;
+    }
+    if (e2eUs > r->e2eMaxUs) {
+        r->e2eMaxUs = e2eUs;
+    }
+    r->e2eSumUs += e2eUs;
+}
+
+/**
+ * @brief Lance le balayage de toutes les configurations.
+ *
+ * @details
+ * Refuse si la mesure visuelle utilise deja la capture. Le signal est
+ * genere en mode toggle : OC4R avance d'une demi-periode a chaque front.
+ *
+ * @param freqHz Frequence du signal de test
+ * @return false si hors limites ou capture deja utilisee
+ */
+bool LatBench_Start(uint16_t freqHz)
+{
+    uint8_t c; // Index de configuration
+
+    if (running || appData.rpmCaptureActive) {
+        return false; // Capture deja utilisee
+    }
+    if ((freqHz < LATBENCH_FREQ_MIN) || (freqHz > LATBENCH_FREQ_MAX)) {
+        return false; // Frequence hors limites
+    }
+
+    freq = freqHz;
+    halfPeriod = RPMCALC_TIMER_FREQ / (2UL * freqHz);
+    period = 2 * halfPeriod;
+    nominalCore = (period * Timebase_TicksPerUs()) / LATBENCH_TICKS_PER_US;
+
+    memset(results, 0, sizeof(results)); // Nouveau balayage
+    for (c = 0; c < ISR_PRIO_COUNT; c++) {
+        results[c].latMin = 0xFFFF;
+    }
+
+    // Capture : meme configuration que la mesure visuelle
+    appData.captureIndex = 0;
+    appData.rpmCaptureActive = true;
+    CFGCONbits.ICACLK = 0; // IC sur T2/T3
+    DRV_TMR1_Start(); // Demarre le timer
+    DRV_IC0_Start(); // Demarre la capture
+
+    // OC4 : toggle 32 bits sur T2/T3
+    OC4CON = 0;
+    OC4CONbits.OC32 = 1; // Comparaison 32 bits
+    OC4CONbits.OCTSEL = 0; // Base de temps T2/T3
+    OC4CONbits.OCM = 3; // Bascule a chaque egalite
+    OC4R = DRV_TMR1_CounterValueGet() + halfPeriod; // Premier front
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_OC4, INT_PRIORITY_LEVEL1); // Jamais au-dessus de IC3 : ne fausse pas la latence mesuree
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_OC4, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_OUTPUT_COMPARE_4);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_OUTPUT_COMPARE_4);
+    PLIB_PORTS_PinDirectionOutputSet(PORTS_ID_0, PORT_CHANNEL_F, PORTS_BIT_POS_5); // RF5 pilote par OC4
+    OC4CONbits.ON = 1;
+
+    config = 0;
+    state = LATBENCH_RUNNING;
+    running = true;
+    LatBench_BeginWindow();
+    return true;
+}
+
+/**
+ * @brief Tache lente (creneau SERVICE_TASKS) : fenetres et calcul RPM.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void LatBench_Task(void)
+{
+    uint32_t elapsed; // Temps depuis le debut de la fenetre
+
+    if (!running) {
+        return;
+    }
+
+    elapsed = appData.tickMs - windowStartMs;
+    if (!measuring) {
+        if (elapsed >= LATBENCH_SETTLE_MS) {
+            measuring = true; // Priorites stables, ouvre la fenetre
+        }
+        return;
+    }
+
+    LatBench_CheckRpm(&results[config]); // Chemin capture -> RPM
+
+    if (elapsed >= (LATBENCH_SETTLE_MS + LATBENCH_WINDOW_MS)) {
+        measuring = false; // Fige les resultats de la configuration
+        if (results[config].edges == 0) {
+            LatBench_Stop();
+            state = LATBENCH_NO_SIGNAL; // Cavalier RF5 -> RF4 absent
+            return;
+        }
+        config++;
+        if (config >= ISR_PRIO_COUNT) {
+            LatBench_Stop();
+            state = LATBENCH_DONE; // Balayage termine
+        } else {
+            LatBench_BeginWindow(); // Configuration suivante
+        }
+    }
+}
+
+/**
+ * @brief Indique si le banc utilise la capture.
+ *
+ * @return true pendant le balayage
+ */
+bool LatBench_IsRunning(void)
+{
+    return running;
+}
+
+/**
+ * @brief Etat du banc et frequence du dernier balayage.
+ *
+ * @param freqHz Frequence du signal de test (peut etre 0)
+ * @return Etat (LATBENCH_STATE)
+ */
+uint8_t LatBench_GetState(uint16_t *freqHz)
+{
+    if (freqHz != 0) {
+        *freqHz = freq;
+    }
+    return state;
+}
+
+/**
+ * @brief Copie des resultats d'une configuration.
+ *
+ * @details
+ * La copie est faite interruptions masquees pour ne pas melanger deux
+ * captures pendant une fenetre ouverte.
+ *
+ * @param cfg Configuration (ISR_PRIO_CONFIG)
+ * @param out Copie des resultats
+ * @return false si la configuration n'existe pas
+ */
+bool LatBench_GetResult(uint8_t cfg, LatBench_Result *out)
+{
+    unsigned int status; // Etat des interruptions
+
+    if (cfg >= ISR_PRIO_COUNT) {
+        return false;
+    }
+    status = __builtin_disable_interrupts(); // Copie coherente
+    *out = results[cfg];
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+    return true;
+}
+
+/**
+ * @brief Mesure d'une capture (appelee par l'ISR IC3).
+ *
+ * @details
+ * La latence est la difference entre TMR2 lu en entree d'ISR et la valeur
+ * capturee au front. La gigue compare l'intervalle entre deux entrees
+ * d'ISR (Core Timer, 20 ns) a la periode nominale. Un ecart de plus de
+ * 1,5 periode entre deux captures compte des fronts perdus.
+ *
+ * @param cap Valeur capturee (ticks IC)
+ * @param entryTmr TMR2 lu en entree d'ISR
+ * @param entryCore Core Timer lu en entree d'ISR
+ * @return Aucun retour.
+ */
+void LatBench_CaptureIsr(uint32_t cap, uint32_t entryTmr, uint32_t entryCore)
+{
+    LatBench_Result *r; // Resultats de la configuration courante
+    uint32_t lat; // Latence front -> entree ISR
+    uint32_t gap; // Ecart entre deux captures
+    uint32_t interval; // Ecart entre deux entrees d'ISR
+    uint32_t jitter; // Ecart au nominal
+    uint8_t b; // Classe de l'histogramme
+
+    if (!measuring) {
+        havePrev = false; // Repart d'une capture propre a l'ouverture
+        return;
+    }
+    r = &results[config];
+
+    lat = entryTmr - cap; // Latence en ticks IC
+    if (lat > 0xFFFF) {
+        lat = 0xFFFF; // Sature
+    }
+    r->edges++;
+    if (lat < r->latMin) {
+        r->latMin = (uint16_t) lat;
+    }
+    if (lat > r->latMax) {
+        r->latMax = (uint16_t) lat;
+    }
+    r->latSum += lat;
+    b = LatBench_Bucket(lat);
+    if (r->latHist[b] < 0xFFFF) {
+        r->latHist[b]++; // Sature a 65535
+    }
+
+    if (havePrev) {
+        gap = cap - prevCap;
+        if (gap > (period + (period / 2))) {
+            r->missed += ((gap + (period / 2)) / period) - 1; // Fronts sautes
+        } else {
+            interval = entryCore - prevCore;
+            jitter = (interval > nominalCore) ? (interval - nominalCore) : (nominalCore - interval);
+            if (jitter > r->jitterMax) {
+                r->jitterMax = jitter;
+            }
+            r->jitterSum += jitter;
+            r->jitterSamples++;
+        }
+    }
+    prevCap = cap;
+    prevCore = entryCore;
+    havePrev = true;
+}
+
+/**
+ * @brief Callback de l'ISR OC4 : programme le prochain front.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void LatBench_Oc4Callback(void)
+{
+    OC4R += halfPeriod; // Prochaine bascule, datee par le materiel
+}
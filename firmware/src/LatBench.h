@@ -0,0 +1,122 @@
+/*
+--------------------------------------------------------
+ Fichier : LatBench.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Banc de mesure de latence et de gigue de la chaine de capture IR
+--------------------------------------------------------*/
+
+#ifndef _LATBENCH_H_
+#define _LATBENCH_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "IsrPrio.h" // Configurations de priorite
+
+/*
+ * Cablage : un cavalier relie RF5 (OC4, broche 42) a RF4 (IC3, broche 41).
+ * Le capteur IR est coupe (IR_EN) pendant le banc.
+ *
+ * OC4 bascule en mode toggle sur le timer 32 bits T2/T3 de la capture :
+ * chaque front est date par le materiel, la periode est exacte. L'ISR OC4
+ * (niveau 1, jamais au-dessus de IC3 quelle que soit la configuration) ne
+ * fait que reprogrammer la comparaison : elle a une demi-periode pour le
+ * faire et ne preempte pas l'ISR mesuree.
+ *
+ * Le banc balaie toutes les configurations de IsrPrio, LATBENCH_WINDOW_MS
+ * chacune, et mesure pour chacune :
+ *   - latence front -> entree ISR IC3 (TMR2 lu en entree - valeur capturee)
+ *   - gigue d'entree ISR (ecart au nominal entre deux entrees, Core Timer)
+ *   - fronts perdus (ecart entre captures > 1,5 periode)
+ *   - erreur du RPM calcule et latence bout en bout capture -> RPM
+ */
+
+// Duree de mesure par configuration [ms]
+#define LATBENCH_WINDOW_MS      2000
+// Duree ignoree apres un changement de configuration [ms]
+#define LATBENCH_SETTLE_MS      50
+// Frequence du signal de test [Hz]
+#define LATBENCH_FREQ_MIN       10
+#define LATBENCH_FREQ_MAX       5000
+// Classes de l'histogramme de latence : classe n = [2^n, 2^(n+1)[ ticks IC
+#define LATBENCH_HIST_BUCKETS   8
+
+// Etat du banc
+typedef enum {
+    LATBENCH_IDLE = 0,      // Jamais lance
+    LATBENCH_RUNNING,       // Balayage en cours
+    LATBENCH_DONE,          // Resultats disponibles
+    LATBENCH_NO_SIGNAL      // Aucune capture : cavalier absent
+} LATBENCH_STATE;
+
+/**
+ * @brief Resultats d'une configuration de priorites.
+ */
+typedef struct {
+    uint32_t edges;             // Captures traitees
+    uint32_t missed;            // Fronts perdus
+    uint16_t latMin;            // Latence minimale [ticks IC, 100 ns]
+    uint16_t latMax;            // Latence maximale [ticks IC]
+    uint32_t latSum;            // Somme des latences (moyenne)
+    uint32_t jitterSamples;     // Intervalles mesures (sans front perdu)
+    uint32_t jitterMax;         // Gigue d'entree maximale [ticks Core Timer]
+    uint32_t jitterSum;         // Somme des gigues (moyenne)
+    uint32_t rpmSamples;        // Calculs de RPM verifies
+    uint32_t rpmErrMaxPpm;      // Erreur RPM maximale [ppm]
+    uint32_t e2eMaxUs;          // Latence capture -> RPM maximale [us]
+    uint32_t e2eSumUs;          // Somme des latences capture -> RPM
+    uint16_t latHist[LATBENCH_HIST_BUCKETS]; // Histogramme log2 des latences
+} LatBench_Result;
+
+/**
+ * @brief Lance le balayage de toutes les configurations.
+ *
+ * @param freqHz Frequence du signal de test
+ * @return false si hors limites ou capture deja utilisee
+ */
+bool LatBench_Start(uint16_t freqHz);
+
+/**
+ * @brief Tache lente (creneau SERVICE_TASKS) : fenetres et calcul RPM.
+ */
+void LatBench_Task(void);
+
+/**
+ * @brief Indique si le banc utilise la capture.
+ *
+ * @return true pendant le balayage
+ */
+bool LatBench_IsRunning(void);
+
+/**
+ * @brief Etat du banc et frequence du dernier balayage.
+ *
+ * @param freqHz Frequence du signal de test (peut etre 0)
+ * @return Etat (LATBENCH_STATE)
+ */
+uint8_t LatBench_GetState(uint16_t *freqHz);
+
+/**
+ * @brief Copie des resultats d'une configuration.
+ *
+ * @param cfg Configuration (ISR_PRIO_CONFIG)
+ * @param out Copie des resultats
+ * @return false si la configuration n'existe pas
+ */
+bool LatBench_GetResult(uint8_t cfg, LatBench_Result *out);
+
+/**
+ * @brief Mesure d'une capture (appelee par l'ISR IC3).
+ *
+ * @param cap Valeur capturee (ticks IC)
+ * @param entryTmr TMR2 lu en entree d'ISR
+ * @param entryCore Core Timer lu en entree d'ISR
+ */
+void LatBench_CaptureIsr(uint32_t cap, uint32_t entryTmr, uint32_t entryCore);
+
+/**
+ * @brief Callback de l'ISR OC4 : programme le prochain front.
+ */
+void LatBench_Oc4Callback(void);
+
+#endif
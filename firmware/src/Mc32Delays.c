@@ -13,6 +13,7 @@
 // Revu / modifie:
 // CHR 17.12.2015    besoin du fichier maison Mc32CoreTimer.h
 // SCA 11.10.2016   ajoute fonction delais core timer
+// LMS 2024         Core Timer libre (plus de _CP0_SET_COUNT)
 /*--------------------------------------------------------*/
 
 
@@ -21,6 +22,7 @@
 //#include "Mc32CoreTimer.h"
 #include <xc.h> //pour les fonctions d'accs au Core Timer
 #include <stdint.h>
+#include "system_config.h" // SYS_CLK_FREQ
 
 /*--------------------------------------------------------*/
 // Fonction delay500ns
@@ -93,6 +95,9 @@ void delay_ms(unsigned int ms)
 // 2. Force l'optimisation 0 des fonctions delay_msCt() et delay_usCt()
 // ci-dessous
 // Tout ceci pour eviter toute optimisation et obtenir un comportement reproductible
+// LMS 2024 : le Core Timer n'est plus remis a 0, on attend sur la difference
+// (arithmetique non signee, correcte au debordement). Il sert de base de
+// temps libre pour Timebase / Profiler.
 //
 // Fonctions testees avec MPLABX 3.40, xc32 1.42 et Harmony 1.08.01 sur Starter-kit ES
 // PIC32MXF795L @ 80 MHz. Mesures :
@@ -106,12 +111,13 @@ void delay_ms(unsigned int ms)
 // (appels aux fonctions ? / toggle des IO ?)
 
 #ifndef SYS_FREQ
-#define SYS_FREQ 200000000L   // 200 MHz
+#define SYS_FREQ SYS_CLK_FREQ   // Profil de performance courant (system_config.h)
 #endif
 
 //le core timer est incremente tous les 2 SYSCLK
 #define TICK_CT_MS (SYS_FREQ / 2000L)
 #define TICK_CT_US (SYS_FREQ / 2000000L)
+#define TICK_CT_500NS (SYS_FREQ / 4000000L)
 #define TICK_OVERHEAD 7    //pour ajustement. mesure 15 cycles Core Timer de surplus
 //valeur quasi-fixe (pu observer 3 cycles CPU en plus en optimisation 0
 //par rapport a 1.
@@ -124,10 +130,10 @@ void delay_ms(unsigned int ms)
 void __attribute__((optimize("-O0"))) delay_msCt(uint32_t NbMs)
 {
     uint32_t time_to_wait;
+    uint32_t start = _CP0_GET_COUNT();
 
-    _CP0_SET_COUNT(0);
     time_to_wait = (TICK_CT_MS * NbMs) - TICK_OVERHEAD;
-    while(_CP0_GET_COUNT()  < time_to_wait) {
+    while((_CP0_GET_COUNT() - start) < time_to_wait) {
         // Waiting
     }
 }
@@ -140,10 +146,10 @@ void __attribute__((optimize("-O0"))) delay_msCt(uint32_t NbMs)
 void __attribute__((optimize("-O0"))) delay_usCt(uint32_t NbUs)
 {
     uint32_t time_to_wait;
+    uint32_t start = _CP0_GET_COUNT();
 
-    _CP0_SET_COUNT(0);
     time_to_wait = (TICK_CT_US * NbUs) - TICK_OVERHEAD;
-    while(_CP0_GET_COUNT()  < time_to_wait) {
+    while((_CP0_GET_COUNT() - start) < time_to_wait) {
         // Waiting
     }
 }
@@ -155,8 +161,9 @@ void __attribute__((optimize("-O0"))) delay_usCt(uint32_t NbUs)
 //utilise le Core Timer
 void __attribute__((optimize("-O0"))) delay500nsCt(void)
 {
-    _CP0_SET_COUNT(0);
-    while (_CP0_GET_COUNT() < 50L) {
-        // 50 ticks  10 ns = 500 ns
+    uint32_t start = _CP0_GET_COUNT();
+
+    while ((_CP0_GET_COUNT() - start) < TICK_CT_500NS) {
+        // 50 ticks a 200 MHz, 25 ticks a 100 MHz (profil ECO)
     }
 }
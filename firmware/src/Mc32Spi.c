@@ -12,6 +12,21 @@
 #include "Mc32Spi.h" // Prototypes des fonctions SPI utilitaires
 // Inclusion de la librairie SPI
 #include "peripheral/SPI/plib_spi.h" // Fonctions de la librairie SPI Harmony
+// Inclusion du header echeances
+#include "Deadline.h" // Attentes bornees
+
+// Attente maximale d'un octet SPI [us] (1 octet a 2 MHz = 4 us)
+#define SPI_TIMEOUT_US 100
+
+static uint32_t spiTimeouts = 0; // Attentes abandonnees
+
+// Attend une condition au plus SPI_TIMEOUT_US (module coupe ou bloque)
+#define SPI_WAIT_UNTIL(cond) do { \
+        Deadline spiDl = Deadline_InUs(SPI_TIMEOUT_US); \
+        while (!(cond)) { \
+            if (Deadline_Expired(spiDl)) { spiTimeouts++; break; } \
+        } \
+    } while (0)
 
 /**
  * @brief Ecrit une donnee sur le bus SPI1 et vide le buffer de reception.
@@ -26,8 +41,8 @@
 void spi_write1(uint8_t val)
 {
     PLIB_SPI_BufferWrite(SPI_ID_1, val); // Ecrit la donnee sur SPI1
-    while (PLIB_SPI_IsBusy(SPI_ID_1)); // Attend la fin de la transmission
-    while (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_1)); // Attend la reception
+    SPI_WAIT_UNTIL(!PLIB_SPI_IsBusy(SPI_ID_1)); // Attend la fin de la transmission
+    SPI_WAIT_UNTIL(!PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_1)); // Attend la reception
     (void)PLIB_SPI_BufferRead(SPI_ID_1); // Vide le buffer de reception
 }
 
@@ -41,11 +56,8 @@ void spi_write1(uint8_t val)
  * @return Aucun retour.
  */
 void spi_write2(uint8_t Val){
-   int SpiBusy; // Variable pour surveiller l'etat du SPI
    PLIB_SPI_BufferWrite(SPI_ID_2, Val); // Ecrit la donnee sur SPI2
-   do {
-     SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_2) ; // Attend la fin de la transmission
-   } while (SpiBusy == 1);
+   SPI_WAIT_UNTIL(!PLIB_SPI_IsBusy(SPI_ID_2)); // Attend la fin de la transmission
 }
 
 /**
@@ -59,13 +71,10 @@ void spi_write2(uint8_t Val){
  * @return Valeur recue sur le bus SPI1.
  */
 uint8_t spi_read1(uint8_t Val){
-   int SpiBusy; // Variable pour surveiller l'etat du SPI
    uint32_t lu; // Variable pour stocker la valeur lue
    PLIB_SPI_BufferWrite(SPI_ID_1, Val); // Ecrit la donnee sur SPI1
-   do {
-        SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_1) ; // Attend la fin de la transmission
-   } while (SpiBusy == 1);
-   while (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_1)); // Attend la reception
+   SPI_WAIT_UNTIL(!PLIB_SPI_IsBusy(SPI_ID_1)); // Attend la fin de la transmission
+   SPI_WAIT_UNTIL(!PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_1)); // Attend la reception
    lu = PLIB_SPI_BufferRead(SPI_ID_1); // Lit la valeur recue
    return lu; // Retourne la valeur recue
 }
@@ -81,16 +90,20 @@ uint8_t spi_read1(uint8_t Val){
  * @return Valeur recue sur le bus SPI2.
  */
 uint8_t spi_read2(uint8_t Val){
-   int SpiBusy; // Variable pour surveiller l'etat du SPI
    uint8_t lu; // Variable pour stocker la valeur lue
    PLIB_SPI_BufferWrite(SPI_ID_2, Val); // Ecrit la donnee sur SPI2
-   do {
-      SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_2) ; // Attend la fin de la transmission
-   } while (SpiBusy == 1);
-   while (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_2)); // Attend la reception
+   SPI_WAIT_UNTIL(!PLIB_SPI_IsBusy(SPI_ID_2)); // Attend la fin de la transmission
+   SPI_WAIT_UNTIL(!PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_2)); // Attend la reception
    lu = PLIB_SPI_BufferRead(SPI_ID_2); // Lit la valeur recue
    return lu; // Retourne la valeur recue
 }
 
-
-
+/**
+ * @brief Nombre d'attentes SPI abandonnees sur timeout.
+ *
+ * @return Compteur de timeouts.
+ */
+uint32_t spi_get_timeouts(void)
+{
+    return spiTimeouts; // Compteur interne
+}
@@ -21,5 +21,6 @@ void spi_write1( uint8_t Val);
 void spi_write2( uint8_t Val);
 uint8_t spi_read1( uint8_t Val);
 uint8_t spi_read2( uint8_t Val);
+uint32_t spi_get_timeouts(void);
 
 #endif
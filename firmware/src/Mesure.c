@@ -0,0 +1,194 @@
+/*
+--------------------------------------------------------
+ Fichier : Mesure.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Chaine de mesure RPM et instantane coherent pour l'affichage
+--------------------------------------------------------
+*/
+// Inclusion du header mesure
+#include "Mesure.h" // Prototypes de la chaine de mesure
+// Inclusion du header verrou de sequence
+#include "SeqLock.h" // Publication sans masquer les interruptions
+// Inclusion du header application
+#include "app.h" // Mode, profil et base de temps
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // RPM et confiance a partir des periodes
+// Inclusion du header fusion
+#include "RpmFusion.h" // Filtre RPM multi-capteurs
+#include <string.h> // Pour memset
+
+/**
+ * @brief Dernieres captures IR (ecrites par l'ISR IC3).
+ */
+typedef struct {
+    uint32_t count;         // Captures depuis Mesure_IrStart
+    uint32_t gates;         // Portes mesurees depuis Mesure_IrStart
+    uint32_t lastCap;       // Derniere capture [ticks IC]
+    uint32_t delta;         // Derniere porte [ticks IC]
+    uint32_t prevDelta;     // Porte precedente [ticks IC]
+    uint16_t edges;         // Fronts de la derniere porte
+    uint16_t prevEdges;     // Fronts de la porte precedente
+    uint32_t timeMs;        // Instant de la derniere capture [ms]
+} Mesure_IrRaw;
+
+static volatile bool irActive = false; // ISR autorisee a publier
+static SeqLock irLock; // Verrou des captures (ecrivain : ISR IC3)
+static Mesure_IrRaw irRaw; // Captures publiees par l'ISR
+static SeqLock snapLock; // Verrou de l'instantane (ecrivain : Mesure_Task)
+static Mesure_Snapshot snap; // Instantane publie
+static uint32_t fusedCount = 0; // Derniere porte transmise au filtre
+
+/**
+ * @brief Remet la chaine et l'instantane a zero.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Mesure_Init(void)
+{
+    irActive = false;
+    memset(&irRaw, 0, sizeof(irRaw));
+    memset(&snap, 0, sizeof(snap));
+    irLock.seq = 0;
+    snapLock.seq = 0;
+    fusedCount = 0;
+    RpmFusion_Reset();
+}
+
+/**
+ * @brief Active l'alimentation de la chaine IR par l'ISR IC3.
+ *
+ * @details
+ * L'ISR est encore coupee pendant la remise a zero : pas d'ecrivain
+ * concurrent.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Mesure_IrStart(void)
+{
+    irActive = false;
+    SeqLock_WriteBegin(&irLock);
+    memset(&irRaw, 0, sizeof(irRaw)); // Oublie les captures precedentes
+    SeqLock_WriteEnd(&irLock);
+    fusedCount = 0;
+    irActive = true;
+}
+
+/**
+ * @brief Coupe l'alimentation de la chaine IR.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Mesure_IrStop(void)
+{
+    irActive = false;
+}
+
+/**
+ * @brief Enregistre une capture (appelee par l'ISR IC3).
+ *
+ * @details
+ * Quelques soustractions : le calcul du RPM reste dans Mesure_Task.
+ * Une capture sans porte (changement de mode du compteur) ne sert que de
+ * debut a la porte suivante.
+ *
+ * @param cap Valeur capturee (ticks IC)
+ * @param edges Fronts depuis la capture precedente (0 = pas de porte)
+ * @param nowMs Base de temps en ms
+ * @return Aucun retour.
+ */
+void Mesure_CaptureIsr(uint32_t cap, uint16_t edges, uint32_t nowMs)
+{
+    if (!irActive) {
+        return; // Chaine IR arretee
+    }
+    SeqLock_WriteBegin(&irLock);
+    if ((irRaw.count != 0) && (edges != 0)) {
+        irRaw.prevDelta = irRaw.delta;
+        irRaw.prevEdges = irRaw.edges;
+        irRaw.delta = cap - irRaw.lastCap; // Porte, correcte au debordement
+        irRaw.edges = edges;
+        irRaw.gates++;
+    }
+    irRaw.lastCap = cap;
+    irRaw.timeMs = nowMs;
+    irRaw.count++;
+    SeqLock_WriteEnd(&irLock);
+}
+
+/**
+ * @brief Calcule et publie l'instantane.
+ *
+ * @details
+ * Le RPM est calcule avec le nombre de pales et le profil lus dans le meme
+ * passage, puis publie avec eux : l'affichage ne peut pas associer un RPM
+ * a un autre profil. Le RPM IR est calcule tant que la chaine IR du
+ * moteur de mesure tourne, quel que soit l'ecran affiche. Sans front
+ * depuis MESURE_IR_LOST_MS, RPM et confiance retombent a zero.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Mesure_Task(void)
+{
+    Mesure_IrRaw raw; // Copie coherente des captures
+    Mesure_Snapshot s; // Nouvel instantane
+    RpmFusion_Output f; // Sortie du filtre
+    float sigma; // Ecart type de la mesure IR [RPM]
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+    uint32_t seq; // Version lue
+
+    do {
+        seq = SeqLock_ReadBegin(&irLock);
+        raw = irRaw;
+    } while (SeqLock_ReadRetry(&irLock, seq));
+
+    s.mode = appData.measureMode;
+    s.profil = appData.selectedProfil;
+    s.nbBlades = appData.nbBlades;
+    s.rpm = 0;
+    s.confidence = 0;
+    s.timestampMs = now;
+
+    if (irActive && (raw.gates >= 1)
+        && ((uint32_t) (now - raw.timeMs) < MESURE_IR_LOST_MS)) {
+        s.rpm = RpmCalc_FromGate(raw.delta, raw.edges, s.nbBlades);
+        if (raw.gates >= 2) {
+            // Stabilite des periodes par front (portes de longueurs differentes ramenees au front)
+            s.confidence = RpmCalc_Confidence(raw.delta * raw.prevEdges, raw.prevDelta * raw.edges);
+        }
+        s.timestampMs = raw.timeMs;
+        if ((raw.gates != fusedCount) && (s.rpm != 0)) {
+            fusedCount = raw.gates; // Une seule fois par porte
+            sigma = (float) s.rpm * (MESURE_IR_SIGMA_MIN + MESURE_IR_SIGMA_PER_PCT * (float) (100 - s.confidence));
+            (void) RpmFusion_Update(RPMFUSION_SRC_IR, (float) s.rpm, sigma * sigma, raw.timeMs);
+        }
+    }
+
+    RpmFusion_Get(&f, now); // Extrapole a l'instant de publication
+    s.rpmFiltered = (uint32_t) (f.rpm + 0.5f);
+    s.rpmRate = (int32_t) f.rate;
+
+    SeqLock_WriteBegin(&snapLock);
+    snap = s;
+    SeqLock_WriteEnd(&snapLock);
+}
+
+/**
+ * @brief Copie coherente de l'instantane courant.
+ *
+ * @param out Copie de l'instantane
+ * @return Aucun retour.
+ */
+void Mesure_Get(Mesure_Snapshot *out)
+{
+    uint32_t seq; // Version lue
+
+    do {
+        seq = SeqLock_ReadBegin(&snapLock);
+        *out = snap;
+    } while (SeqLock_ReadRetry(&snapLock, seq));
+}
@@ -0,0 +1,87 @@
+/*
+--------------------------------------------------------
+ Fichier : Mesure.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Chaine de mesure RPM et instantane coherent pour l'affichage
+--------------------------------------------------------*/
+
+#ifndef _MESURE_H_
+#define _MESURE_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Deux etages, chacun avec un seul ecrivain et un verrou de sequence :
+ *   - l'ISR IC3 publie la derniere capture et les deux dernieres portes
+ *     (duree et nombre de fronts, un seul en mode front a front) ;
+ *   - Mesure_Task (creneau lent) en deduit RPM et confiance et publie
+ *     l'instantane {RPM, confiance, mode, profil, horodatage}.
+ * Chaque nouvelle periode IR alimente aussi le filtre RpmFusion (variance
+ * deduite de la confiance) ; l'instantane porte le RPM filtre et sa
+ * derivee a cote du RPM brut.
+ * L'affichage, la telemetrie et les commandes lisent l'instantane par
+ * Mesure_Get : les champs sont toujours coherents entre eux, sans masquer
+ * les interruptions.
+ */
+
+// Duree sans front avant de declarer le signal IR perdu [ms]
+#define MESURE_IR_LOST_MS   1100
+// Ecart type relatif d'une periode IR : plancher et part par point de confiance manquant
+#define MESURE_IR_SIGMA_MIN     0.005f
+#define MESURE_IR_SIGMA_PER_PCT 0.0005f
+
+/**
+ * @brief Instantane de la mesure courante.
+ */
+typedef struct {
+    uint32_t timestampMs;   // Instant de la derniere capture utilisee [ms]
+    uint32_t rpm;           // RPM calcule (0 si pas de signal)
+    uint32_t rpmFiltered;   // RPM du filtre de fusion (0 si perime)
+    int32_t rpmRate;        // Derivee du RPM filtre [RPM/s]
+    uint8_t confidence;     // Confiance de la mesure [%]
+    uint8_t mode;           // Mode de mesure (MESURE_MODE)
+    uint8_t profil;         // Profil actif lors du calcul (0-3)
+    uint8_t nbBlades;       // Nombre de pales utilise pour le calcul
+} Mesure_Snapshot;
+
+/**
+ * @brief Remet la chaine et l'instantane a zero.
+ */
+void Mesure_Init(void);
+
+/**
+ * @brief Active l'alimentation de la chaine IR par l'ISR IC3.
+ *
+ * @details Les captures precedentes sont oubliees.
+ */
+void Mesure_IrStart(void);
+
+/**
+ * @brief Coupe l'alimentation de la chaine IR.
+ */
+void Mesure_IrStop(void);
+
+/**
+ * @brief Enregistre une capture (appelee par l'ISR IC3).
+ *
+ * @param cap Valeur capturee (ticks IC)
+ * @param edges Fronts depuis la capture precedente (0 = pas de porte)
+ * @param nowMs Base de temps en ms
+ */
+void Mesure_CaptureIsr(uint32_t cap, uint16_t edges, uint32_t nowMs);
+
+/**
+ * @brief Calcule et publie l'instantane (creneau SERVICE_TASKS).
+ */
+void Mesure_Task(void);
+
+/**
+ * @brief Copie coherente de l'instantane courant.
+ *
+ * @param out Copie de l'instantane
+ */
+void Mesure_Get(Mesure_Snapshot *out);
+
+#endif
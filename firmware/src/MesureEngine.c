@@ -0,0 +1,483 @@
+/*
+--------------------------------------------------------
+ Fichier : MesureEngine.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Moteur de mesure : chaines IR, audio et vibration en parallele
+--------------------------------------------------------
+*/
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Prototypes du moteur
+// Inclusion du header application
+#include "app.h" // Capture, profil et base de temps
+// Inclusion du header mesure
+#include "Mesure.h" // Chaine IR
+// Inclusion du header compteur IR
+#include "IrCounter.h" // Front a front ou porte reciproque
+// Inclusion du header impulsions IR
+#include "IrPulse.h" // Largeur des impulsions par pale
+// Inclusion du header calibration IR
+#include "IrCalib.h" // Balayage du seuil
+// Inclusion du header estimateur vibration
+#include "VibEstim.h" // Raie d'allumage sur l'accelerometre
+// Inclusion du header fusion
+#include "RpmFusion.h" // Filtre RPM multi-capteurs
+// Inclusion du header horloge accelerometre
+#include "AccClock.h" // Datation des echantillons sur la base de temps IC
+// Inclusion du header equilibrage
+#include "Balance.h" // Vibration synchrone du tour
+// Inclusion du header moyenne synchrone
+#include "Tsa.h" // Revolution moyenne et spectre d'ordres
+// Inclusion du header suivi d'ordres
+#include "OrderTrack.h" // Reechantillonnage angulaire
+// Inclusion du header zoom FFT
+#include "Zoom.h" // Bande fine autour de la raie attendue
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // FIFO de l'accelerometre
+// Inclusion du header flux USB
+#include "UsbStream.h" // Export des echantillons bruts
+// Inclusion du header banc de latence
+#include "LatBench.h" // Capture partagee avec le banc
+// Inclusion du header base de temps
+#include "Timebase.h" // Chronometrage des pas
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Drivers IC / timer et broches
+#include <math.h> // Pour sqrtf
+#include <string.h> // Pour memset
+
+// Duree de validite d'un RPM vibration sans nouvelle raie [ms]
+#define MESURE_VIB_LOST_MS  1000
+
+/**
+ * @brief Description constante d'une chaine.
+ */
+typedef struct {
+    bool (*start)(void); // Demarrage (false = impossible pour l'instant)
+    void (*stop)(void); // Arret et coupure du capteur
+    void (*step)(uint32_t nowMs); // Pas de calcul
+    uint16_t periodMs; // Periode nominale des pas [ms]
+    uint16_t budgetUs; // Duree maximale d'un pas [us]
+    uint8_t maxBackoff; // Doublements de periode permis en depassement
+    uint16_t lostMs; // Validite d'un RPM sans mise a jour [ms]
+} MesurePipe;
+
+/**
+ * @brief Etat d'execution d'une chaine.
+ */
+typedef struct {
+    bool running; // Chaine demarree
+    uint8_t backoff; // Periode = nominale << backoff
+    uint8_t goodSteps; // Pas consecutifs dans le budget
+    uint32_t nextMs; // Prochain pas ou prochain essai de demarrage [ms]
+    uint32_t rpm; // Dernier RPM publie
+    uint32_t rpmMs; // Instant du dernier RPM [ms]
+    uint32_t steps; // Pas executes
+    uint32_t overruns; // Pas hors budget
+    uint16_t lastUs; // Duree du dernier pas [us]
+    uint16_t maxUs; // Duree maximale d'un pas [us]
+} MesurePipeState;
+
+static MesurePipeState pipes[MESURE_PIPE_COUNT]; // Etat des chaines
+static bool stopped = false; // Extinction : plus de demarrage
+static int16_t accFifo[3 * LIS2HH12_FIFO_SIZE]; // Echantillons lus dans la FIFO
+
+/**
+ * @brief Publie le RPM d'une chaine.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @param rpm RPM mesure
+ * @param timeMs Instant de la mesure [ms]
+ * @return Aucun retour.
+ */
+static void MesureEngine_Publish(uint8_t pipe, uint32_t rpm, uint32_t timeMs)
+{
+    pipes[pipe].rpm = rpm;
+    pipes[pipe].rpmMs = timeMs;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Chaine IR                                                                  */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Alimente l'IR et demarre la capture IC3.
+ *
+ * @details
+ * Le banc de latence utilise la meme capture : il faut attendre sa fin.
+ *
+ * @param Aucun parametre.
+ * @return false si la capture est occupee
+ */
+static bool MesureEngine_IrStart(void)
+{
+    if (LatBench_IsRunning() || appData.rpmCaptureActive) {
+        return false; // Capture occupee par le banc
+    }
+    appData.captureIndex = 0; // Reset l'index de capture
+    appData.rpmCaptureActive = true; // Active la capture
+    Mesure_IrStart(); // Oublie les periodes precedentes
+    CFGCONbits.ICACLK = 0; // Configure le timer
+    DRV_TMR1_Start(); // Demarre le timer
+    IrCounter_Start(); // Compteur de fronts T6, capture front a front
+    DRV_IC0_Start(); // Demarre la capture
+    IR_EN_On(); // Alimente l'IR
+    return true;
+}
+
+/**
+ * @brief Arrete la capture IC3 et coupe l'IR.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void MesureEngine_IrStop(void)
+{
+    appData.rpmCaptureActive = false; // Desactive la capture
+    Mesure_IrStop(); // Plus de mesure en cours
+    IrCalib_Cancel(); // Plus de captures : seuil d'avant la calibration
+    DRV_IC0_Stop(); // Arrete la capture
+    IrCounter_Stop(); // Capture front a front pour le banc de latence
+    DRV_TMR1_Stop(); // Arrete le timer
+    IR_EN_Off(); // Coupe l'IR
+}
+
+/**
+ * @brief Publie le RPM du dernier instantane IR.
+ *
+ * @details
+ * Le calcul reste dans Mesure_Task (une porte par capture) ; le pas
+ * releve son resultat, adapte le mode du compteur IR au debit de fronts
+ * et attribue les impulsions aux pales.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void MesureEngine_IrStep(uint32_t nowMs)
+{
+    Mesure_Snapshot m; // Dernier instantane
+
+    (void) nowMs;
+    IrCounter_Task(); // Front a front ou porte selon le debit
+    IrPulse_Task(); // Largeur et qualite par pale
+    Mesure_Get(&m);
+    if (m.rpm != 0) {
+        MesureEngine_Publish(MESURE_PIPE_IR, m.rpm, m.timestampMs);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Chaine audio                                                               */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Pas de microphone cable sur cette carte.
+ *
+ * @param Aucun parametre.
+ * @return false (toujours indisponible)
+ */
+static bool MesureEngine_AudioStart(void)
+{
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Chaine vibration                                                           */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Initialise l'accelerometre et sa FIFO.
+ *
+ * @param Aucun parametre.
+ * @return false si le LIS2HH12 ne repond pas
+ */
+static bool MesureEngine_VibStart(void)
+{
+    SPI_ConfigureAcc(); // Le SPI1 est partage avec les potentiometres
+    LIS2HH12_Init(); // Initialise le capteur
+    if (LIS2HH12_ReadID() != LIS2HH12_WHO_AM_I_RESP) {
+        return false; // Capteur absent
+    }
+    LIS2HH12_EnableFifo(); // FIFO en mode flux : aucun echantillon perdu
+    VibEstim_Init((float) LIS2HH12_ODR_HZ); // Fenetre vide
+    AccClock_Reset((float) LIS2HH12_ODR_HZ); // Nouvelle numerotation
+    return true;
+}
+
+/**
+ * @brief Met l'accelerometre en power-down.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void MesureEngine_VibStop(void)
+{
+    SPI_ConfigureAcc(); // Le SPI1 est partage avec les potentiometres
+    LIS2HH12_PowerDown(); // Accelerometre en power-down
+}
+
+/**
+ * @brief Decoupe le bloc lu en tours pour les mesures synchrones.
+ *
+ * @details
+ * Le decoupage ne tourne que si l'equilibrage, la moyenne synchrone ou
+ * le suivi d'ordres attend des echantillons.
+ *
+ * @param nb Echantillons lus
+ * @param first Numero AccClock du premier echantillon
+ * @return Aucun retour.
+ */
+static void MesureEngine_RevSync(uint8_t nb, uint32_t first)
+{
+    RevSync_Sample smp; // Echantillon date dans son tour
+
+    if (!Balance_IsRunning() && !Tsa_IsRunning() && !OrderTrack_IsRunning()) {
+        RevSync_Stop();
+        return;
+    }
+    RevSync_Push(accFifo, nb, first);
+    while (RevSync_Next(&smp)) {
+        Balance_Add(&smp);
+        Tsa_Add(&smp);
+        OrderTrack_Add(&smp);
+    }
+}
+
+/**
+ * @brief Vide la FIFO, alimente le flux USB, les mesures synchrones du tour, le zoom et l'estimateur spectral.
+ *
+ * @details
+ * Le timer de la capture IR est lu juste apres FIFO_SRC, avant la rafale,
+ * pour dater les echantillons (AccClock) ; sans chaine IR il est arrete et la datation
+ * repart. Une FIFO pleine a pu deborder : la numerotation repart aussi.
+ * La raie d'allumage donne le RPM : f x 60 x tours par cycle / cylindres.
+ * L'ecart type transmis au filtre est d'une demi-raie, reduit quand la
+ * raie domine nettement la bande.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void MesureEngine_VibStep(uint32_t nowMs)
+{
+    VibEstim_Result r; // Derniere estimation
+    uint8_t nb; // Echantillons lus
+    uint32_t stamp; // Instant de la lecture [ticks IC]
+    uint32_t first; // Numero AccClock du premier echantillon lu
+    uint8_t nbCyl = appData.nbCylindres; // Cylindres du profil
+    float perHz; // RPM par Hz de raie
+    float rpm; // RPM estime
+    float sigma; // Ecart type [RPM]
+
+    SPI_ConfigureAcc(); // Le SPI1 est partage avec les potentiometres
+    nb = LIS2HH12_FifoLevel(); // FIFO_SRC : echantillons deja produits
+    stamp = DRV_TMR1_CounterValueGet(); // Apres FIFO_SRC : les nb echantillons comptes sont anterieurs
+    if (nb == 0) {
+        return;
+    }
+    LIS2HH12_ReadFifoBurst(accFifo, nb); // Lecture en rafale
+    first = AccClock_Observe(stamp, nb, (nb == LIS2HH12_FIFO_SIZE) || !pipes[MESURE_PIPE_IR].running);
+    UsbStream_PushAcc(accFifo, nb); // Bloc brut vers le PC (si flux actif)
+    MesureEngine_RevSync(nb, first); // Equilibrage et moyenne synchrone
+    Zoom_Push(accFifo, nb, nowMs); // Zoom FFT (si demarre)
+    if (!VibEstim_Push(accFifo, nb, nowMs)) {
+        return; // Fenetre pas encore avancee
+    }
+
+    VibEstim_Get(&r);
+    if (!r.valid || (nbCyl == 0)) {
+        MesureEngine_Publish(MESURE_PIPE_VIB, 0, r.timeMs); // Sous le seuil de bruit : affiche "--"
+        return;
+    }
+    perHz = (60.0f * (float) MESURE_ENGINE_REVS_PER_CYCLE) / (float) nbCyl;
+    rpm = r.freqHz * perHz;
+    sigma = 0.5f * r.binHz * perHz * sqrtf(r.threshold / r.snr);
+    (void) RpmFusion_Update(RPMFUSION_SRC_VIB, rpm, sigma * sigma, r.timeMs);
+    MesureEngine_Publish(MESURE_PIPE_VIB, (uint32_t) (rpm + 0.5f), r.timeMs);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Table des chaines                                                          */
+/* -------------------------------------------------------------------------- */
+static const MesurePipe pipeTable[MESURE_PIPE_COUNT] = {
+    [MESURE_PIPE_IR] = {
+        .start = MesureEngine_IrStart, .stop = MesureEngine_IrStop, .step = MesureEngine_IrStep,
+        .periodMs = 11, .budgetUs = 100, .maxBackoff = MESURE_ENGINE_MAX_BACKOFF,
+        .lostMs = MESURE_IR_LOST_MS
+    },
+    [MESURE_PIPE_AUDIO] = {
+        .start = MesureEngine_AudioStart, .stop = 0, .step = 0,
+        .periodMs = 11, .budgetUs = 0, .maxBackoff = 0, .lostMs = 0
+    },
+    [MESURE_PIPE_VIB] = {
+        // 44 ms = 17 echantillons a 400 Hz. La FIFO de 32 (80 ms) absorbe la gigue
+        // du creneau de 11 ms mais pas un pas double : pas de recul, depassements comptes
+        .start = MesureEngine_VibStart, .stop = MesureEngine_VibStop, .step = MesureEngine_VibStep,
+        .periodMs = 44, .budgetUs = 2500, .maxBackoff = 0, .lostMs = MESURE_VIB_LOST_MS
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/* Ordonnancement                                                             */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Remet toutes les chaines a l'arret (demarrage au prochain pas).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void MesureEngine_Init(void)
+{
+    uint8_t p; // Index de chaine
+
+    memset(pipes, 0, sizeof(pipes));
+    for (p = 0; p < MESURE_PIPE_COUNT; p++) {
+        pipes[p].nextMs = appData.tickMs; // Demarrage au prochain pas
+    }
+    stopped = false;
+}
+
+/**
+ * @brief Execute un pas chronometre et ajuste la periode de la chaine.
+ *
+ * @param p Chaine (MESURE_PIPE)
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void MesureEngine_Step(uint8_t p, uint32_t nowMs)
+{
+    const MesurePipe *d = &pipeTable[p]; // Description
+    MesurePipeState *s = &pipes[p]; // Etat
+    uint32_t start = Timebase_Now(); // Debut du pas
+    uint32_t us; // Duree du pas
+
+    d->step(nowMs);
+    us = Timebase_TicksToUs(Timebase_Now() - start);
+    if (us > 0xFFFF) {
+        us = 0xFFFF; // Sature sur 16 bits
+    }
+    s->lastUs = (uint16_t) us;
+    if (s->lastUs > s->maxUs) {
+        s->maxUs = s->lastUs;
+    }
+    s->steps++;
+
+    if (us > d->budgetUs) {
+        s->overruns++;
+        s->goodSteps = 0;
+        if (s->backoff < d->maxBackoff) {
+            s->backoff++; // Periode doublee
+        }
+    } else if (s->backoff > 0) {
+        s->goodSteps++;
+        if (s->goodSteps >= MESURE_ENGINE_RECOVER_STEPS) {
+            s->goodSteps = 0;
+            s->backoff--; // Periode divisee par deux
+        }
+    }
+    s->nextMs = nowMs + ((uint32_t) d->periodMs << s->backoff);
+}
+
+/**
+ * @brief Demarre et execute les chaines dues (creneau SERVICE_TASKS).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void MesureEngine_Task(void)
+{
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+    uint8_t p; // Index de chaine
+
+    if (stopped) {
+        return; // Extinction en cours
+    }
+
+    for (p = 0; p < MESURE_PIPE_COUNT; p++) {
+        MesurePipeState *s = &pipes[p];
+
+        if ((int32_t) (now - s->nextMs) < 0) {
+            continue; // Pas encore due
+        }
+        if (!s->running) {
+            if (pipeTable[p].start()) {
+                s->running = true;
+                s->rpm = 0; // Pas de resultat d'un demarrage precedent
+                s->backoff = 0;
+                s->goodSteps = 0;
+                s->nextMs = now + pipeTable[p].periodMs; // Premier pas a la periode suivante
+            } else {
+                s->nextMs = now + MESURE_ENGINE_RETRY_MS; // Nouvel essai plus tard
+            }
+            continue;
+        }
+        MesureEngine_Step(p, now);
+    }
+}
+
+/**
+ * @brief Arrete une chaine et libere ses ressources tout de suite.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @return Aucun retour.
+ */
+void MesureEngine_Release(uint8_t pipe)
+{
+    if ((pipe >= MESURE_PIPE_COUNT) || !pipes[pipe].running) {
+        return;
+    }
+    pipeTable[pipe].stop();
+    pipes[pipe].running = false;
+    pipes[pipe].nextMs = appData.tickMs + MESURE_ENGINE_RETRY_MS; // Redemarrage plus tard
+}
+
+/**
+ * @brief Arrete toutes les chaines sans redemarrage (extinction).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void MesureEngine_StopAll(void)
+{
+    uint8_t p; // Index de chaine
+
+    for (p = 0; p < MESURE_PIPE_COUNT; p++) {
+        MesureEngine_Release(p);
+    }
+    stopped = true;
+}
+
+/**
+ * @brief Indique si une chaine est demarree.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @return true si la chaine tourne
+ */
+bool MesureEngine_IsRunning(uint8_t pipe)
+{
+    return (pipe < MESURE_PIPE_COUNT) && pipes[pipe].running;
+}
+
+/**
+ * @brief Resultat et charge d'une chaine.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @param out Copie de l'etat
+ * @return false si la chaine n'existe pas
+ */
+bool MesureEngine_GetStatus(uint8_t pipe, MesureEngine_Status *out)
+{
+    const MesurePipeState *s; // Etat de la chaine
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+
+    if (pipe >= MESURE_PIPE_COUNT) {
+        return false;
+    }
+    s = &pipes[pipe];
+    out->running = s->running;
+    out->rpm = s->rpm;
+    out->timeMs = s->rpmMs;
+    out->locked = s->running && (s->rpm != 0)
+        && ((uint32_t) (now - s->rpmMs) < pipeTable[pipe].lostMs);
+    out->steps = s->steps;
+    out->overruns = s->overruns;
+    out->periodMs = (uint16_t) (pipeTable[pipe].periodMs << s->backoff);
+    out->lastUs = s->lastUs;
+    out->maxUs = s->maxUs;
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+--------------------------------------------------------
+ Fichier : MesureEngine.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Moteur de mesure : chaines IR, audio et vibration en parallele
+--------------------------------------------------------*/
+
+#ifndef _MESUREENGINE_H_
+#define _MESUREENGINE_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Les trois chaines de mesure tournent en fond, quel que soit l'ecran
+ * affiche : le menu ne fait que choisir le resultat montre. Chaque chaine
+ * est decrite par une entree constante (demarrage, arret, pas de calcul,
+ * periode et budget) et executee par MesureEngine_Task dans le creneau lent.
+ *
+ * Budget : chaque pas est chronometre au Core Timer. Un pas plus long que
+ * le budget de sa chaine double la periode de cette chaine (au plus
+ * 2^MESURE_ENGINE_MAX_BACKOFF fois) : une chaine trop lente se degrade
+ * seule sans affamer les autres. Apres MESURE_ENGINE_RECOVER_STEPS pas
+ * dans le budget, la periode redescend d'un cran. La chaine vibration ne
+ * recule pas : un pas sur deux ferait deborder la FIFO de l'accelerometre
+ * (80 ms a 400 Hz) ; ses depassements sont seulement comptes.
+ *
+ * Une chaine qui ne peut pas demarrer (capteur absent, capture occupee par
+ * le banc de latence) est retentee toutes les MESURE_ENGINE_RETRY_MS.
+ * La chaine audio n'a pas de chemin materiel sur cette carte : elle reste
+ * arretee et son resultat n'est jamais verrouille.
+ */
+
+#define MESURE_ENGINE_MAX_BACKOFF       2       // Periode multipliee par 4 au plus
+#define MESURE_ENGINE_RECOVER_STEPS     16      // Pas dans le budget avant de raccourcir la periode
+#define MESURE_ENGINE_RETRY_MS          1000    // Delai avant un nouveau demarrage [ms]
+#define MESURE_ENGINE_REVS_PER_CYCLE    2       // Tours par cycle moteur (4 temps)
+
+// Chaines de mesure
+typedef enum {
+    MESURE_PIPE_IR = 0,     // Capture IR (mesure visuelle)
+    MESURE_PIPE_AUDIO,      // Microphone
+    MESURE_PIPE_VIB,        // Accelerometre
+    MESURE_PIPE_COUNT
+} MESURE_PIPE;
+
+/**
+ * @brief Resultat et charge d'une chaine.
+ */
+typedef struct {
+    bool running;           // Chaine demarree
+    bool locked;            // RPM recent disponible
+    uint32_t rpm;           // Dernier RPM publie (0 si aucun)
+    uint32_t timeMs;        // Instant du dernier RPM [ms]
+    uint32_t steps;         // Pas executes
+    uint32_t overruns;      // Pas hors budget
+    uint16_t periodMs;      // Periode courante [ms]
+    uint16_t lastUs;        // Duree du dernier pas [us]
+    uint16_t maxUs;         // Duree maximale d'un pas [us]
+} MesureEngine_Status;
+
+/**
+ * @brief Remet toutes les chaines a l'arret (demarrage au prochain pas).
+ */
+void MesureEngine_Init(void);
+
+/**
+ * @brief Demarre et execute les chaines dues (creneau SERVICE_TASKS).
+ */
+void MesureEngine_Task(void);
+
+/**
+ * @brief Arrete une chaine et libere ses ressources tout de suite.
+ *
+ * @details Elle redemarre seule des que son demarrage est de nouveau
+ * possible (ex. capture IR rendue par le banc de latence).
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ */
+void MesureEngine_Release(uint8_t pipe);
+
+/**
+ * @brief Arrete toutes les chaines sans redemarrage (extinction).
+ */
+void MesureEngine_StopAll(void);
+
+/**
+ * @brief Indique si une chaine est demarree.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @return true si la chaine tourne
+ */
+bool MesureEngine_IsRunning(uint8_t pipe);
+
+/**
+ * @brief Resultat et charge d'une chaine.
+ *
+ * @param pipe Chaine (MESURE_PIPE)
+ * @param out Copie de l'etat
+ * @return false si la chaine n'existe pas
+ */
+bool MesureEngine_GetStatus(uint8_t pipe, MesureEngine_Status *out);
+
+#endif
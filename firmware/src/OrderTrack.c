@@ -0,0 +1,351 @@
+/*
+--------------------------------------------------------
+ Fichier : OrderTrack.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Suivi d'ordres : reechantillonnage angulaire de l'accelerometre
+--------------------------------------------------------
+*/
+// Inclusion du header suivi d'ordres
+#include "OrderTrack.h" // Prototypes du suivi d'ordres
+// Inclusion du header FFT
+#include "Fft.h" // FFT complexe
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaines IR et vibration
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Sensibilite de l'accelerometre
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+#include <math.h> // Pour cosf, sqrtf, ceil
+#include <string.h> // Pour memset
+
+#define ORDERTRACK_PI 3.14159265358979f // Pi en simple precision
+
+static bool running = false; // Suivi en cours
+static uint32_t revMin = 0; // Premier tour du suivi (numero de capture IC3)
+static uint32_t revBase = 0; // Tour d'origine des angles
+static bool haveIndex = false; // Numero AccClock precedent disponible
+static uint32_t lastIndex = 0; // Numero AccClock precedent
+
+static float histX[4][3]; // Quatre derniers echantillons (0 = plus ancien)
+static double histT[4]; // Angle des quatre derniers echantillons [tours]
+static uint8_t histCount = 0; // Echantillons dans l'historique
+static bool aligned = false; // Prochain angle cible calcule
+static uint32_t nextK = 0; // Prochain angle cible [1 / ORDERTRACK_PER_REV tour]
+
+static float ring[3][ORDERTRACK_N]; // Fenetre glissante angulaire par axe
+static float rpmRing[ORDERTRACK_N]; // Regime de chaque point
+static uint16_t writeIdx = 0; // Prochaine case ecrite (= plus ancien point)
+static uint16_t filled = 0; // Points valides dans la fenetre
+static uint16_t fresh = 0; // Points recus depuis le dernier spectre
+static float hann[ORDERTRACK_N]; // Fenetre de Hann
+static bool hannReady = false; // Fenetre calculee
+static Fft_Cplx buf[ORDERTRACK_N]; // Points puis spectre
+static float power[ORDERTRACK_N / 2]; // Puissance des trois axes par raie
+static OrderTrack_Result result; // Dernier spectre
+
+/**
+ * @brief Vide la fenetre, l'historique et le resultat.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void OrderTrack_Reset(void)
+{
+    uint16_t k; // Index de la fenetre
+
+    if (!hannReady) {
+        for (k = 0; k < ORDERTRACK_N; k++) {
+            hann[k] = 0.5f - 0.5f * cosf((2.0f * ORDERTRACK_PI * (float) k) / (float) ORDERTRACK_N);
+        }
+        hannReady = true;
+    }
+    histCount = 0;
+    aligned = false;
+    writeIdx = 0;
+    filled = 0;
+    fresh = 0;
+    haveIndex = false;
+    memset(&result, 0, sizeof(result));
+}
+
+/**
+ * @brief Demarre le suivi (fenetre vide, tours a partir de maintenant).
+ *
+ * @param Aucun parametre.
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool OrderTrack_Start(void)
+{
+    if (!MesureEngine_IsRunning(MESURE_PIPE_IR) || !MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        return false;
+    }
+    OrderTrack_Reset();
+    revMin = RevSync_MarkerNow(); // Tours ouverts a partir de maintenant
+    revBase = revMin;
+    running = true;
+    return true;
+}
+
+/**
+ * @brief Arrete le suivi (le dernier spectre reste lisible).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void OrderTrack_Stop(void)
+{
+    running = false;
+}
+
+/**
+ * @brief Indique si le suivi recoit des echantillons.
+ *
+ * @param Aucun parametre.
+ * @return true entre OrderTrack_Start et OrderTrack_Stop
+ */
+bool OrderTrack_IsRunning(void)
+{
+    return running;
+}
+
+/**
+ * @brief Charge deux axes centres et fenetres dans le buffer de la FFT.
+ *
+ * @param re Axe place en partie reelle
+ * @param im Axe place en partie imaginaire (0 = aucun)
+ * @return Aucun retour.
+ */
+static void OrderTrack_Load(const float *re, const float *im)
+{
+    float meanRe = 0.0f; // Composante continue (gravite) de l'axe reel
+    float meanIm = 0.0f; // Composante continue de l'axe imaginaire
+    uint16_t i; // Index dans la fenetre glissante
+    uint16_t k; // Index dans le buffer (du plus ancien au plus recent)
+
+    for (k = 0; k < ORDERTRACK_N; k++) {
+        meanRe += re[k];
+        if (im != 0) {
+            meanIm += im[k];
+        }
+    }
+    meanRe /= (float) ORDERTRACK_N;
+    meanIm /= (float) ORDERTRACK_N;
+
+    i = writeIdx;
+    for (k = 0; k < ORDERTRACK_N; k++) {
+        buf[k].re = (re[i] - meanRe) * hann[k];
+        buf[k].im = (im != 0) ? ((im[i] - meanIm) * hann[k]) : 0.0f;
+        i = (i + 1) % ORDERTRACK_N;
+    }
+}
+
+/**
+ * @brief Spectre d'ordres de la fenetre angulaire.
+ *
+ * @details
+ * Meme somme des trois axes que VibEstim. Amplitude d'un ordre entier :
+ * 4 sqrt(P) / N (gain coherent de la fenetre de Hann : 1/2). La raie
+ * dominante est recherchee au-dessus d'un demi-ordre et affinee par
+ * interpolation parabolique.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void OrderTrack_Estimate(void)
+{
+    const uint16_t perOrder = ORDERTRACK_N / ORDERTRACK_PER_REV; // Raies par ordre
+    uint16_t kMin = perOrder / 2; // Premiere raie recherchee (demi-ordre)
+    uint16_t kPeak; // Raie la plus forte
+    uint16_t k; // Index de raie
+    float sum = 0.0f; // Puissance totale de la bande
+    float a, b, c; // Raie et ses voisines
+    float den; // Courbure de la parabole
+    float delta = 0.0f; // Decalage de l'extremum [raies]
+
+    if (kMin < 2) {
+        kMin = 2; // Jamais la raie continue ni sa voisine
+    }
+
+    OrderTrack_Load(ring[0], ring[1]); // X + j Y
+    (void) Fft_Forward(buf, ORDERTRACK_N);
+    for (k = 1; k < (ORDERTRACK_N / 2); k++) {
+        const Fft_Cplx *p = &buf[k];
+        const Fft_Cplx *q = &buf[ORDERTRACK_N - k];
+        power[k] = 0.5f * ((p->re * p->re) + (p->im * p->im) + (q->re * q->re) + (q->im * q->im));
+    }
+
+    OrderTrack_Load(ring[2], 0); // Z seul
+    (void) Fft_Forward(buf, ORDERTRACK_N);
+    for (k = 1; k < (ORDERTRACK_N / 2); k++) {
+        power[k] += (buf[k].re * buf[k].re) + (buf[k].im * buf[k].im);
+    }
+
+    kPeak = kMin;
+    for (k = kMin; k < (ORDERTRACK_N / 2); k++) {
+        sum += power[k];
+        if ((k < ((ORDERTRACK_N / 2) - 1)) && (power[k] > power[kPeak])) {
+            kPeak = k; // La derniere raie n'a pas de voisine haute
+        }
+    }
+
+    a = power[kPeak - 1];
+    b = power[kPeak];
+    c = power[kPeak + 1];
+    den = a - 2.0f * b + c;
+    if (den < 0.0f) {
+        delta = 0.5f * (a - c) / den; // Dans [-0.5, 0.5] pour un maximum local
+    }
+
+    result.peakOrder = ((float) kPeak + delta) / (float) perOrder;
+    result.ratio = (sum > 0.0f) ? (b * (float) ((ORDERTRACK_N / 2) - kMin) / sum) : 0.0f;
+    result.peakPct = (sum > 0.0f) ? (uint8_t) ((100.0f * (a + b + c)) / sum) : 0;
+    result.valid = (result.ratio >= ORDERTRACK_MIN_RATIO);
+    for (k = 0; k < ORDERTRACK_ORDERS; k++) {
+        uint16_t bin = (uint16_t) ((k + 1) * perOrder); // Raie de l'ordre k + 1
+
+        result.ampMg[k] = (bin < (ORDERTRACK_N / 2))
+            ? ((4.0f / (float) ORDERTRACK_N) * sqrtf(power[bin]) * LIS2HH12_MG_PER_LSB) : 0.0f;
+    }
+    result.rpmMin = rpmRing[0];
+    result.rpmMax = rpmRing[0];
+    for (k = 1; k < ORDERTRACK_N; k++) {
+        if (rpmRing[k] < result.rpmMin) {
+            result.rpmMin = rpmRing[k];
+        }
+        if (rpmRing[k] > result.rpmMax) {
+            result.rpmMax = rpmRing[k];
+        }
+    }
+    result.frames++;
+}
+
+/**
+ * @brief Interpolation cubique de Catmull-Rom entre x1 et x2.
+ *
+ * @param x0 Echantillon avant x1
+ * @param x1 Echantillon qui precede le point
+ * @param x2 Echantillon qui suit le point
+ * @param x3 Echantillon apres x2
+ * @param mu Position entre x1 et x2 (0-1)
+ * @return Valeur interpolee
+ */
+static float OrderTrack_Cubic(float x0, float x1, float x2, float x3, float mu)
+{
+    float c1 = 0.5f * (x2 - x0); // Pente en x1
+    float c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3; // Terme quadratique
+    float c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2); // Terme cubique
+
+    return ((c3 * mu + c2) * mu + c1) * mu + x1;
+}
+
+/**
+ * @brief Reechantillonne un echantillon d'angle connu (banc ou OrderTrack_Add).
+ *
+ * @details
+ * Les angles cibles entre les deux echantillons du milieu de l'historique
+ * sont produits : le point est en retard de deux echantillons sur la FIFO.
+ * Une rupture (echantillon manquant, angle non croissant) vide
+ * l'historique et la fenetre : un spectre ne couvre jamais un trou.
+ *
+ * @param xyz Axes [LSB]
+ * @param turns Angle de l'echantillon [tours], croissant
+ * @param rpm Regime instantane
+ * @param contiguous false si des echantillons manquent depuis le precedent
+ * @return true si un nouveau spectre est disponible
+ */
+bool OrderTrack_Feed(const float *xyz, double turns, float rpm, bool contiguous)
+{
+    const double step = 1.0 / (double) ORDERTRACK_PER_REV; // Pas d'angle [tours]
+    bool ready = false; // Spectre calcule
+    double t1, t2; // Angles encadrant les points produits [tours]
+    uint8_t i; // Index d'historique
+    uint8_t k; // Axe
+
+    if (!contiguous || ((histCount > 0) && (turns <= histT[3]))) {
+        histCount = 0; // Rupture : repart de cet echantillon
+        aligned = false;
+        filled = 0;
+        fresh = 0;
+    }
+    for (i = 0; i < 3; i++) {
+        histT[i] = histT[i + 1];
+        for (k = 0; k < 3; k++) {
+            histX[i][k] = histX[i + 1][k];
+        }
+    }
+    histT[3] = turns;
+    for (k = 0; k < 3; k++) {
+        histX[3][k] = xyz[k];
+    }
+    if (histCount < 4) {
+        histCount++;
+    }
+    if (histCount < 4) {
+        return false;
+    }
+
+    t1 = histT[1];
+    t2 = histT[2];
+    if (!aligned) {
+        nextK = (uint32_t) ceil(t1 * (double) ORDERTRACK_PER_REV); // Premier angle cible
+        aligned = true;
+    }
+    while (((double) nextK * step) < t2) {
+        float mu = (float) ((((double) nextK * step) - t1) / (t2 - t1)); // Position entre x1 et x2
+
+        for (k = 0; k < 3; k++) {
+            ring[k][writeIdx] = OrderTrack_Cubic(histX[0][k], histX[1][k], histX[2][k], histX[3][k], mu);
+        }
+        rpmRing[writeIdx] = rpm;
+        writeIdx = (writeIdx + 1) % ORDERTRACK_N;
+        if (filled < ORDERTRACK_N) {
+            filled++;
+        }
+        fresh++;
+        nextK++;
+
+        if ((filled == ORDERTRACK_N) && (fresh >= ORDERTRACK_HOP)) {
+            fresh = 0;
+            OrderTrack_Estimate();
+            ready = true;
+        }
+    }
+    return ready;
+}
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @param smp Echantillon date
+ * @return Aucun retour.
+ */
+void OrderTrack_Add(const RevSync_Sample *smp)
+{
+    float xyz[3]; // Axes [LSB]
+    bool contiguous; // Aucun echantillon manquant
+    uint8_t k; // Axe
+
+    if (!running || ((int32_t) (smp->rev - revMin) < 0)) {
+        return;
+    }
+    contiguous = haveIndex && (smp->index == (lastIndex + 1));
+    lastIndex = smp->index;
+    haveIndex = true;
+    for (k = 0; k < 3; k++) {
+        xyz[k] = (float) smp->xyz[k];
+    }
+    (void) OrderTrack_Feed(xyz, (double) (smp->rev - revBase) + (double) smp->turn,
+                           (60.0f * (float) RPMCALC_TIMER_FREQ) / (float) smp->period, contiguous);
+}
+
+/**
+ * @brief Copie du dernier spectre.
+ *
+ * @param out Copie du spectre
+ * @return Aucun retour.
+ */
+void OrderTrack_Get(OrderTrack_Result *out)
+{
+    *out = result;
+}
@@ -0,0 +1,107 @@
+/*
+--------------------------------------------------------
+ Fichier : OrderTrack.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Suivi d'ordres : reechantillonnage angulaire de l'accelerometre
+--------------------------------------------------------*/
+
+#ifndef _ORDERTRACK_H_
+#define _ORDERTRACK_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "RevSync.h" // Echantillons dates dans leur tour
+
+/*
+ * Suivi d'ordres calcule : en montee ou descente de regime, une raie a
+ * frequence fixe en ordres glisse dans un spectre en temps et s'etale sur
+ * plusieurs raies. Les echantillons sont donc reechantillonnes a pas
+ * d'angle constant (ORDERTRACK_PER_REV points par tour) avant la FFT.
+ *
+ * L'angle de chaque echantillon vient des reperes IR (RevSync : vitesse
+ * constante entre deux reperes, donc regime instantane tour par tour).
+ * Pour chaque angle cible entre deux echantillons consecutifs, l'index
+ * fractionnaire est interpole lineairement en angle, puis le signal est
+ * interpole en temps par une cubique de Catmull-Rom sur quatre
+ * echantillons (forme de Horner : 3 multiplications par axe et par point).
+ *
+ * Les points angulaires remplissent une fenetre glissante de ORDERTRACK_N
+ * points ; tous les ORDERTRACK_HOP points, les trois axes sont centres,
+ * ponderes par une fenetre de Hann et leurs spectres sommes (deux FFT,
+ * comme VibEstim). Une raie vaut 1 / (ORDERTRACK_N / ORDERTRACK_PER_REV)
+ * ordre. Sous 60 x ODR / ORDERTRACK_PER_REV RPM, le pas d'angle est plus
+ * grossier que l'echantillonnage et le contenu au-dela de PER_REV / 2
+ * ordres se replie.
+ */
+
+#define ORDERTRACK_PER_REV      32      // Points par tour
+#define ORDERTRACK_N            256     // Points par fenetre (puissance de 2)
+#define ORDERTRACK_HOP          128     // Nouveaux points entre deux spectres
+#define ORDERTRACK_ORDERS       8       // Ordres entiers rapportes (1 a ORDERTRACK_ORDERS)
+#define ORDERTRACK_MIN_RATIO    8.0f    // Raie / puissance moyenne minimale
+
+/**
+ * @brief Dernier spectre d'ordres.
+ */
+typedef struct {
+    bool valid;                         // Raie dominante retenue
+    float peakOrder;                    // Ordre de la raie dominante
+    float ratio;                        // Raie / puissance moyenne
+    uint8_t peakPct;                    // Part de la puissance dans la raie et ses voisines [%]
+    float rpmMin;                       // Regime minimal sur la fenetre
+    float rpmMax;                       // Regime maximal sur la fenetre
+    float ampMg[ORDERTRACK_ORDERS];     // Amplitude des ordres entiers, trois axes [mg]
+    uint32_t frames;                    // Spectres calcules depuis le demarrage
+} OrderTrack_Result;
+
+/**
+ * @brief Demarre le suivi (fenetre vide, tours a partir de maintenant).
+ *
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool OrderTrack_Start(void);
+
+/**
+ * @brief Arrete le suivi (le dernier spectre reste lisible).
+ */
+void OrderTrack_Stop(void);
+
+/**
+ * @brief Indique si le suivi recoit des echantillons.
+ *
+ * @return true entre OrderTrack_Start et OrderTrack_Stop
+ */
+bool OrderTrack_IsRunning(void);
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @param smp Echantillon date
+ */
+void OrderTrack_Add(const RevSync_Sample *smp);
+
+/**
+ * @brief Vide la fenetre, l'historique et le resultat.
+ */
+void OrderTrack_Reset(void);
+
+/**
+ * @brief Reechantillonne un echantillon d'angle connu (banc ou OrderTrack_Add).
+ *
+ * @param xyz Axes [LSB]
+ * @param turns Angle de l'echantillon [tours], croissant
+ * @param rpm Regime instantane
+ * @param contiguous false si des echantillons manquent depuis le precedent
+ * @return true si un nouveau spectre est disponible
+ */
+bool OrderTrack_Feed(const float *xyz, double turns, float rpm, bool contiguous);
+
+/**
+ * @brief Copie du dernier spectre.
+ *
+ * @param out Copie du spectre
+ */
+void OrderTrack_Get(OrderTrack_Result *out);
+
+#endif
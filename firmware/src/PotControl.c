@@ -14,6 +14,8 @@
 #include "system_config.h" // Configuration systeme
 // Inclusion des definitions systeme
 #include "system_definitions.h" // Definitions systeme
+// Inclusion des sondes de temps d'execution
+#include "Profiler.h" // Sonde sur les ecritures SPI
 #include <stddef.h> // Pour NULL
 // Inclusion de la librairie SPI
 #include "peripheral/spi/plib_spi.h" // Fonctions SPI Harmony
@@ -64,6 +66,7 @@ void Pot_Write(uint8_t index, uint8_t value)
     if (index >= POT_TOTAL) {
         return; // Index hors limite, ne fait rien
     }
+    PROF_BEGIN(PROF_SITE_SPI_POT); // Debut de la sonde
     if (index == POT_INDEX_U3_WIPER0) {
         CS_POT_1_Off(); // Active le chip select 1
         spi_write1(0x00); // Commande pour wiper 0
@@ -82,6 +85,7 @@ void Pot_Write(uint8_t index, uint8_t value)
         spi_write1(value); // Envoie la valeur
         CS_POT_2_On(); // Desactive le chip select 2
     }
+    PROF_END(PROF_SITE_SPI_POT); // Fin de la sonde
 }
 
 /**
@@ -107,9 +111,9 @@ bool Pot_Read(uint8_t index, uint8_t* value)
     // CS_POT_1_Off active le chip select 1
     CS_POT_1_Off();
     (void)spi_read1(cmd); // Envoie la commande de lecture
-    delay_us(5); // Petit delai pour stabilite
+    delay_usCt(5); // Petit delai pour stabilite (Core Timer, independant de SYSCLK)
     *value = spi_read1(0xFF); // Lit la valeur recue
-    delay_us(10); // Delai apres lecture
+    delay_usCt(10); // Delai apres lecture
     CS_POT_1_On(); // Desactive le chip select 1
     return true; // Lecture reussie
 }
\ No newline at end of file
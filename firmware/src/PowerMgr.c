@@ -0,0 +1,295 @@
+/*
+--------------------------------------------------------
+ Fichier : PowerMgr.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Gestion d'energie : IDLE entre les ticks, PMD, capteurs et retroeclairage
+--------------------------------------------------------
+*/
+// Inclusion du header gestion d'energie
+#include "PowerMgr.h" // Prototypes du gestionnaire d'energie
+// Inclusion du header application
+#include "app.h" // Etat de l'application et base de temps
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Capteurs alimentes par les chaines de mesure
+// Inclusion du header base de temps
+#include "Timebase.h" // Mesure du temps passe en IDLE
+// Inclusion de la configuration systeme
+#include "system_config.h" // Configuration systeme (broches)
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Definitions systeme (SFR)
+
+/*
+ * Modules coupes par PMD (jamais utilises par le firmware) :
+ *   PMD1 : CVR                      PMD2 : CMP1, CMP2
+ *   PMD3 : IC1, IC2, IC4..IC9, OC1..OC3, OC5..OC9
+ *   PMD4 : T4, T5, T7..T9
+ *   PMD5 : U1, U3, U6, SPI2..SPI6, I2C2..I2C5, USB, CAN1, CAN2
+ *   PMD6 : RTCC, REFO1..REFO4, PMP, EBI, SQI1, ETH
+ *   PMD7 : RNG, CRYPTO
+ * Restent actifs : ADC, IC3, OC4 (banc de latence), T1..T3, T6 (compteur
+ * de fronts IR), U2, U4, U5, SPI1, I2C1, DMA.
+ * Un module ajoute plus tard doit etre retire de ces masques.
+ */
+#define POWER_PMD1_UNUSED   0x00001000
+#define POWER_PMD2_UNUSED   0x00000003
+#define POWER_PMD3_UNUSED   0x01F701FB
+#define POWER_PMD4_UNUSED   0x000001D8
+#define POWER_PMD5_UNUSED   0x311E3E25
+#define POWER_PMD6_UNUSED   0x10830F01
+#define POWER_PMD7_UNUSED   0x00500000
+
+// Periode du PWM logiciel du retroeclairage [ms]
+#define POWER_BL_PWM_PERIOD 4
+
+static PowerMgr_Stats stats; // Compteurs d'energie
+static bool initDone = false; // PowerMgr_Init executee
+static bool shutdown = false; // Extinction demandee
+static volatile uint8_t backlight = POWER_BL_FULL; // Niveau demande
+static uint8_t measureMode = MESURE_MODE_AUCUNE; // Mode de mesure alimente
+static uint32_t lastActivityMs = 0; // Derniere action utilisateur
+static uint32_t lastTaskMs = 0; // Derniere integration d'energie
+static uint32_t idleTicks = 0; // Ticks du core timer passes en IDLE
+static uint32_t coreTicksPerMs = 0; // Frequence du core timer [ticks/ms]
+static uint64_t chargeUaMs = 0; // Charge consommee [uA.ms]
+
+/**
+ * @brief Ecrit les registres PMD (sequence de deverrouillage).
+ *
+ * @details
+ * PMDLOCK n'est modifiable qu'apres la sequence SYSKEY, interruptions
+ * masquees. PMDL1WAY = OFF autorise un reverrouillage ulterieur.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void PowerMgr_GatePeripherals(void)
+{
+    unsigned int status = __builtin_disable_interrupts(); // Sequence non interruptible
+
+    SYSKEY = 0x00000000; // Verrouille
+    SYSKEY = 0xAA996655; // Cle 1
+    SYSKEY = 0x556699AA; // Cle 2
+    CFGCONbits.PMDLOCK = 0; // Registres PMD modifiables
+
+    PMD1SET = POWER_PMD1_UNUSED; // Coupe les modules inutilises
+    PMD2SET = POWER_PMD2_UNUSED;
+    PMD3SET = POWER_PMD3_UNUSED;
+    PMD4SET = POWER_PMD4_UNUSED;
+    PMD5SET = POWER_PMD5_UNUSED;
+    PMD6SET = POWER_PMD6_UNUSED;
+    PMD7SET = POWER_PMD7_UNUSED;
+
+    CFGCONbits.PMDLOCK = 1; // Reverrouille les PMD
+    SYSKEY = 0x00000000; // Reverrouille le systeme
+
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+}
+
+/**
+ * @brief Coupe les peripheriques inutilises et prepare le mode IDLE.
+ *
+ * @details
+ * OSCCON.SLPEN = 0 : l'instruction wait met le CPU en IDLE (et non en
+ * SLEEP), les timers, l'UART et le DMA continuent de tourner.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @pre Appelee apres l'init des peripheriques utilises.
+ */
+void PowerMgr_Init(void)
+{
+    unsigned int status; // Etat des interruptions
+
+    PowerMgr_GatePeripherals(); // Coupe les modules jamais utilises
+
+    status = __builtin_disable_interrupts(); // Sequence non interruptible
+    SYSKEY = 0x00000000;
+    SYSKEY = 0xAA996655; // Cle 1
+    SYSKEY = 0x556699AA; // Cle 2
+    OSCCONCLR = _OSCCON_SLPEN_MASK; // wait = IDLE
+    SYSKEY = 0x00000000; // Reverrouille
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+
+    coreTicksPerMs = Timebase_TicksPerUs() * 1000; // Core timer = SYSCLK / 2
+    IR_EN_Off(); // Alimente par la chaine IR du moteur de mesure
+    measureMode = MESURE_MODE_AUCUNE;
+    backlight = POWER_BL_FULL; // Retroeclairage plein
+    shutdown = false;
+    lastActivityMs = appData.tickMs;
+    lastTaskMs = appData.tickMs;
+    idleTicks = 0;
+    initDone = true;
+}
+
+/**
+ * @brief Met le CPU en IDLE jusqu'a la prochaine interruption.
+ *
+ * @details
+ * Les interruptions sont masquees pendant le test de l'etat : une IRQ qui
+ * arrive entre le test et le wait reveille quand meme le CPU (le wait se
+ * termine sur une IRQ en attente), elle est servie au demasquage.
+ * Le temps passe en IDLE est mesure avec le core timer.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void PowerMgr_Idle(void)
+{
+    uint32_t start; // Core timer avant le wait
+
+    if (!initDone) {
+        return; // Application pas encore initialisee
+    }
+
+    __builtin_disable_interrupts(); // Ferme la fenetre test / wait
+    if ((appData.state == APP_STATE_WAIT) || (appData.state == APP_STATE_INIT_WAIT)) {
+        start = Timebase_Now(); // Debut de la veille
+        _wait(); // CPU en IDLE jusqu'a une interruption
+        idleTicks += Timebase_Now() - start; // Temps passe en IDLE
+    }
+    __builtin_enable_interrupts(); // L'ISR en attente est servie ici
+}
+
+/**
+ * @brief Tick 1 ms (appele depuis le callback Timer1) : PWM du retroeclairage.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void PowerMgr_TickIsr(void)
+{
+    static uint8_t phase = 0; // Position dans la periode PWM
+    bool on; // Etat voulu du retroeclairage
+
+    if (!initDone || shutdown) {
+        return; // Retroeclairage gere ailleurs
+    }
+
+    phase = (phase + 1) % POWER_BL_PWM_PERIOD;
+    if (backlight == POWER_BL_FULL) {
+        on = true;
+    } else if (backlight == POWER_BL_DIM) {
+        on = (phase < POWER_DIM_DUTY); // Rapport cyclique reduit
+    } else {
+        on = false;
+    }
+
+    if (on != (BL_CONTROL_StateGet() != 0)) {
+        BL_CONTROL_StateSet(on); // Ecrit seulement les changements
+    }
+}
+
+/**
+ * @brief Signale une action utilisateur (retroeclairage plein).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void PowerMgr_NotifyActivity(void)
+{
+    lastActivityMs = appData.tickMs; // Redemarre le delai d'inactivite
+    backlight = POWER_BL_FULL; // Retroeclairage plein
+}
+
+/**
+ * @brief Memorise le mode de mesure affiche.
+ *
+ * @details
+ * Les capteurs sont alimentes par le moteur de mesure, quel que soit
+ * l'ecran : le mode ne decide plus que du retroeclairage hors activite.
+ *
+ * @param mode Nouveau mode (MESURE_MODE)
+ * @return Aucun retour.
+ */
+void PowerMgr_SetMeasureMode(uint8_t mode)
+{
+    measureMode = mode; // Mode affiche
+}
+
+/**
+ * @brief Tache periodique : inactivite et integration de l'energie.
+ *
+ * @details
+ * Le courant moyen de la periode est la somme des charges actives et du
+ * courant CPU pondere par le temps passe en IDLE.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void PowerMgr_Task(void)
+{
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+    uint32_t elapsedMs = now - lastTaskMs; // Duree de la periode
+    uint32_t idleMs; // Temps passe en IDLE
+    uint32_t currentUa; // Courant moyen de la periode
+
+    if (!initDone || (elapsedMs == 0)) {
+        return;
+    }
+
+    // Retroeclairage selon l'inactivite
+    if ((uint32_t) (now - lastActivityMs) >= POWER_OFF_DELAY_MS) {
+        backlight = (measureMode == MESURE_MODE_AUCUNE) ? POWER_BL_OFF : POWER_BL_DIM; // Reste lisible en mesure
+    } else if ((uint32_t) (now - lastActivityMs) >= POWER_DIM_DELAY_MS) {
+        backlight = POWER_BL_DIM;
+    }
+
+    // Part du temps passee en IDLE
+    idleMs = idleTicks / coreTicksPerMs;
+    idleTicks = 0;
+    if (idleMs > elapsedMs) {
+        idleMs = elapsedMs; // Arrondis du core timer
+    }
+    stats.idlePercent = (uint8_t) ((idleMs * 100) / elapsedMs);
+
+    // Courant moyen estime
+    currentUa = ((POWER_CPU_IDLE_UA * idleMs) + (POWER_CPU_RUN_UA * (elapsedMs - idleMs))) / elapsedMs;
+    currentUa += POWER_BASE_UA;
+    if (backlight == POWER_BL_FULL) {
+        currentUa += POWER_BACKLIGHT_UA;
+    } else if (backlight == POWER_BL_DIM) {
+        currentUa += (POWER_BACKLIGHT_UA * POWER_DIM_DUTY) / POWER_BL_PWM_PERIOD;
+    }
+    if (MesureEngine_IsRunning(MESURE_PIPE_IR)) {
+        currentUa += POWER_IR_UA;
+    }
+    if (MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        currentUa += POWER_ACC_UA;
+    }
+
+    chargeUaMs += (uint64_t) currentUa * elapsedMs; // Integration
+    stats.averageUa = currentUa;
+    stats.chargeUah = (uint32_t) (chargeUaMs / 3600000ULL); // uA.ms -> uAh
+    stats.backlight = backlight;
+    lastTaskMs = now;
+}
+
+/**
+ * @brief Coupe toutes les charges puis le regulateur (option "Eteindre").
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void PowerMgr_Shutdown(void)
+{
+    shutdown = true; // Plus de PWM du retroeclairage
+    MesureEngine_StopAll(); // Coupe les capteurs
+    BL_CONTROL_Off(); // Eteint le retroeclairage
+    EN_LDO_Off(); // Eteint le regulateur
+}
+
+/**
+ * @brief Retourne les compteurs d'energie.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const PowerMgr_Stats* PowerMgr_GetStats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,112 @@
+/*
+--------------------------------------------------------
+ Fichier : PowerMgr.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations du gestionnaire d'energie (veille CPU, peripheriques, retroeclairage)
+--------------------------------------------------------*/
+
+#ifndef _POWERMGR_H_
+#define _POWERMGR_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "system_config.h" // Profil de performance
+
+/*
+ * Entre deux ticks le CPU passe en mode IDLE (instruction wait) : les
+ * peripheriques et les interruptions continuent, seul le coeur s'arrete.
+ * Les modules internes jamais utilises sont coupes par PMD au demarrage.
+ * Les capteurs externes sont alimentes tant que leur chaine du moteur de
+ * mesure tourne (MesureEngine).
+ *
+ * La consommation est estimee a partir du temps passe en IDLE et de l'etat
+ * des charges (valeurs typiques ci-dessous, a recaler par une mesure).
+ */
+
+// Inactivite avant reduction du retroeclairage [ms]
+#define POWER_DIM_DELAY_MS      30000
+// Inactivite avant extinction du retroeclairage, hors mesure [ms]
+#define POWER_OFF_DELAY_MS      120000
+// Rapport cyclique du retroeclairage reduit (sur 4 ms)
+#define POWER_DIM_DUTY          1
+
+// Courants typiques pour l'estimation d'energie [uA]
+#if (PERF_PROFILE == PERF_PROFILE_FULL)
+#define POWER_CPU_RUN_UA        95000 // Coeur actif a 200 MHz
+#define POWER_CPU_IDLE_UA       30000 // Coeur en IDLE, peripheriques actifs
+#else
+#define POWER_CPU_RUN_UA        55000 // Coeur actif a 100 MHz
+#define POWER_CPU_IDLE_UA       20000 // Coeur en IDLE, peripheriques actifs
+#endif
+#define POWER_BASE_UA           3000  // LCD, LDO, transceivers
+#define POWER_BACKLIGHT_UA      20000 // Retroeclairage plein
+#define POWER_IR_UA             15000 // Emetteur / recepteur IR
+#define POWER_ACC_UA            200   // LIS2HH12 en mesure
+
+// Niveaux de retroeclairage
+typedef enum {
+    POWER_BL_OFF = 0, // Eteint
+    POWER_BL_DIM,     // Reduit
+    POWER_BL_FULL     // Plein
+} POWER_BACKLIGHT;
+
+/**
+ * @brief Compteurs du gestionnaire d'energie.
+ */
+typedef struct {
+    uint32_t averageUa;     // Courant moyen estime sur la derniere periode [uA]
+    uint32_t chargeUah;     // Charge consommee depuis le demarrage [uAh]
+    uint8_t idlePercent;    // Part du temps passee en IDLE [%]
+    uint8_t backlight;      // Niveau du retroeclairage (POWER_BACKLIGHT)
+} PowerMgr_Stats;
+
+/**
+ * @brief Coupe les peripheriques inutilises et prepare le mode IDLE.
+ */
+void PowerMgr_Init(void);
+
+/**
+ * @brief Met le CPU en IDLE jusqu'a la prochaine interruption.
+ *
+ * @details
+ * Appelee a chaque tour de la boucle principale. Ne dort pas si une tache
+ * de service est en attente.
+ */
+void PowerMgr_Idle(void);
+
+/**
+ * @brief Tick 1 ms (appele depuis le callback Timer1) : PWM du retroeclairage.
+ */
+void PowerMgr_TickIsr(void);
+
+/**
+ * @brief Signale une action utilisateur (retroeclairage plein).
+ */
+void PowerMgr_NotifyActivity(void);
+
+/**
+ * @brief Memorise le mode de mesure affiche (retroeclairage hors activite).
+ *
+ * @param mode Nouveau mode (MESURE_MODE)
+ */
+void PowerMgr_SetMeasureMode(uint8_t mode);
+
+/**
+ * @brief Tache periodique : inactivite et integration de l'energie.
+ */
+void PowerMgr_Task(void);
+
+/**
+ * @brief Coupe toutes les charges puis le regulateur (option "Eteindre").
+ */
+void PowerMgr_Shutdown(void);
+
+/**
+ * @brief Retourne les compteurs d'energie.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const PowerMgr_Stats* PowerMgr_GetStats(void);
+
+#endif
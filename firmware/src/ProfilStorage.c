@@ -51,6 +51,7 @@ void Profils_LoadFromNVM(void)
  * @details
  * Recharge la NVM en RAM avant modification pour ne pas perdre les autres profils.
  * Modifie le profil voulu, efface la page puis ecrit tout le tableau profils.
+ * Le seuil IR calibre du profil est conserve.
  *
  * @param idx Index du profil a sauvegarder
  * @param blades Nombre de pales
@@ -65,7 +66,28 @@ void Profils_SaveToNVM(uint8_t idx, uint8_t blades, uint8_t cyl)
     profils[idx].nbBlades = blades; // Met a jour le nombre de pales
     profils[idx].nbCylindres = cyl; // Met a jour le nombre de cylindres
     profils[idx].validFlag = PROFIL_VALID_FLAG; // Marque comme valide
-    profils[idx].reserved = 0; // Alignement
+    NVM_Open(); // Ouvre le driver NVM
+    DRV_NVM_Erase(nvmHandle, NULL, NVM_ADDR_PROFILS, PAGE_SIZE / ROW_SIZE); // Efface la page
+    DRV_NVM_Write(nvmHandle, NULL, (uint8_t *)profils, NVM_ADDR_PROFILS, sizeof(profils)); // Ecrit la page
+}
+
+/**
+ * @brief Sauvegarde le seuil IR calibre d'un profil dans la memoire NVM.
+ *
+ * @details
+ * Meme sequence que Profils_SaveToNVM : les autres champs et les autres
+ * profils sont relus puis reecrits tels quels.
+ *
+ * @param idx Index du profil
+ * @param seuil Wiper du seuil IR
+ */
+void Profils_SaveIrSeuil(uint8_t idx, uint8_t seuil)
+{
+    if (idx >= NB_PROFILS) {
+        return; // Index hors limite
+    }
+    Profils_LoadFromNVM(); // Recharge la NVM en RAM avant modification
+    profils[idx].irSeuil = seuil; // Met a jour le seuil IR
     NVM_Open(); // Ouvre le driver NVM
     DRV_NVM_Erase(nvmHandle, NULL, NVM_ADDR_PROFILS, PAGE_SIZE / ROW_SIZE); // Efface la page
     DRV_NVM_Write(nvmHandle, NULL, (uint8_t *)profils, NVM_ADDR_PROFILS, sizeof(profils)); // Ecrit la page
@@ -93,7 +115,8 @@ Profil* Profils_Get(uint8_t idx)
  * @brief Reinitialise tous les profils aux valeurs d'usine et sauvegarde en NVM.
  *
  * @details
- * Remet tous les profils a 2 pales, 4 cylindres, non valides, puis ecrit en NVM.
+ * Remet tous les profils a 2 pales, 4 cylindres, non valides et non
+ * calibres, puis ecrit en NVM.
  */
 void Profils_ResetAll(void)
 {
@@ -102,7 +125,7 @@ void Profils_ResetAll(void)
         profils[i].nbBlades = 2; // Valeur par defaut
         profils[i].nbCylindres = 4; // Valeur par defaut
         profils[i].validFlag = 0; // Non valide
-        profils[i].reserved = 0; // Alignement
+        profils[i].irSeuil = 0xFF; // Seuil IR non calibre
     }
     NVM_Open(); // Ouvre le driver NVM
     DRV_NVM_Erase(nvmHandle, NULL, NVM_ADDR_PROFILS, PAGE_SIZE / ROW_SIZE); // Efface la page
@@ -128,19 +151,19 @@ int Profils_TestSaveLoad(void)
     if (tmpAvant[idx].nbBlades != 0xFF ||
         tmpAvant[idx].nbCylindres != 0xFF ||
         tmpAvant[idx].validFlag != 0xFF ||
-        tmpAvant[idx].reserved != 0xFF) {
+        tmpAvant[idx].irSeuil != 0xFF) {
         return -1; // Effacement KO
     }
     profils[idx].nbBlades = 3; // Nouvelle valeur
     profils[idx].nbCylindres = 6; // Nouvelle valeur
     profils[idx].validFlag = PROFIL_VALID_FLAG; // Marque comme valide
-    profils[idx].reserved = 0; // Alignement
+    profils[idx].irSeuil = 64; // Nouvelle valeur
     DRV_NVM_Write(nvmHandle, NULL, (uint8_t *)profils, NVM_ADDR_PROFILS, sizeof(profils)); // Ecrit la page
     DRV_NVM_Read(nvmHandle, NULL, (uint8_t *)tmpApres, NVM_ADDR_PROFILS, sizeof(tmpApres)); // Lit apres ecriture
     if (tmpApres[idx].nbBlades == 3 &&
         tmpApres[idx].nbCylindres == 6 &&
         tmpApres[idx].validFlag == PROFIL_VALID_FLAG &&
-        tmpApres[idx].reserved == 0) {
+        tmpApres[idx].irSeuil == 64) {
         return 1; // OK ecriture + effacement valides
     }
     return 0; // Ecriture KO
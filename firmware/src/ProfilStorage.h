@@ -25,13 +25,13 @@
  * - nbBlades : nombre de pales
  * - nbCylindres : nombre de cylindres
  * - validFlag : drapeau de validite
- * - reserved : pour alignement
+ * - irSeuil : wiper du seuil IR calibre (hors plage = non calibre, voir IrCalib)
  */
 typedef struct {
     uint8_t nbBlades;      // Nombre de pales
     uint8_t nbCylindres;   // Nombre de cylindres
     uint8_t validFlag;     // Drapeau de validite
-    uint8_t reserved;      // Pour alignement memoire
+    uint8_t irSeuil;       // Wiper du seuil IR calibre (0xFF apres effacement)
 } Profil;
 
 /**
@@ -52,6 +52,13 @@ void Profils_LoadFromNVM(void);
  */
 void Profils_SaveToNVM(uint8_t index, uint8_t blades, uint8_t cyl);
 
+/**
+ * @brief Sauvegarde le seuil IR calibre d'un profil dans la memoire NVM.
+ * @param index Indice du profil (0 a NB_PROFILS-1)
+ * @param seuil Wiper du seuil IR
+ */
+void Profils_SaveIrSeuil(uint8_t index, uint8_t seuil);
+
 /**
  * @brief Retourne un pointeur vers le profil specifie.
  * @param index Indice du profil
@@ -0,0 +1,118 @@
+/*
+--------------------------------------------------------
+ Fichier : Profiler.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Statistiques des sondes de temps d'execution
+--------------------------------------------------------
+*/
+// Inclusion du header profiler
+#include "Profiler.h" // Prototypes du profiler
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Masquage des interruptions
+#include <string.h> // Pour memset
+
+static Profiler_Site sites[PROF_SITE_COUNT]; // Statistiques par point
+
+/**
+ * @brief Remet toutes les statistiques a zero.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Profiler_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PROF_SITE_COUNT; i++) {
+        Profiler_Clear(i); // Point a zero
+    }
+}
+
+/**
+ * @brief Enregistre une duree (utilisable en ISR).
+ *
+ * @details
+ * Chaque point n'est alimente que par un seul contexte (ISR ou boucle
+ * principale), l'ecriture n'a donc pas besoin d'etre protegee.
+ *
+ * @param site Point de mesure (PROF_SITE)
+ * @param ticks Duree en ticks du Core Timer
+ * @return Aucun retour.
+ */
+void Profiler_Record(uint8_t site, uint32_t ticks)
+{
+    Profiler_Site *s; // Point concerne
+    uint8_t bucket = 0; // Classe de l'histogramme
+
+    if (site >= PROF_SITE_COUNT) {
+        return; // Point inconnu
+    }
+    s = &sites[site];
+
+    s->count++;
+    s->sum += ticks;
+    if (ticks < s->min) {
+        s->min = ticks; // Nouveau minimum
+    }
+    if (ticks > s->max) {
+        s->max = ticks; // Nouveau maximum
+    }
+
+    if (ticks != 0) {
+        bucket = (uint8_t) (31 - __builtin_clz(ticks)); // floor(log2(ticks))
+    }
+    if (bucket >= PROF_HIST_BUCKETS) {
+        bucket = PROF_HIST_BUCKETS - 1; // Derniere classe ouverte
+    }
+    if (s->hist[bucket] != 0xFFFF) {
+        s->hist[bucket]++; // Sature au lieu de reboucler
+    }
+}
+
+/**
+ * @brief Copie coherente des statistiques d'un point.
+ *
+ * @details
+ * Les interruptions sont masquees pendant la copie pour ne pas lire un
+ * point a moitie mis a jour par une ISR.
+ *
+ * @param site Point de mesure (PROF_SITE)
+ * @param out Copie des statistiques
+ * @return false si le point n'existe pas
+ */
+bool Profiler_Snapshot(uint8_t site, Profiler_Site *out)
+{
+    unsigned int status; // Etat des interruptions
+
+    if (site >= PROF_SITE_COUNT) {
+        return false; // Point inconnu
+    }
+    status = __builtin_disable_interrupts(); // Copie atomique
+    *out = sites[site];
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+    return true;
+}
+
+/**
+ * @brief Remet les statistiques d'un point a zero.
+ *
+ * @param site Point de mesure (PROF_SITE)
+ * @return Aucun retour.
+ */
+void Profiler_Clear(uint8_t site)
+{
+    unsigned int status; // Etat des interruptions
+
+    if (site >= PROF_SITE_COUNT) {
+        return; // Point inconnu
+    }
+    status = __builtin_disable_interrupts(); // Remise a zero atomique
+    memset(&sites[site], 0, sizeof (Profiler_Site));
+    sites[site].min = 0xFFFFFFFF; // Aucun minimum encore
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+}
@@ -0,0 +1,84 @@
+/*
+--------------------------------------------------------
+ Fichier : Profiler.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Sondes de temps d'execution (min / max / moyenne / histogramme)
+--------------------------------------------------------*/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "Timebase.h" // Horodatage Core Timer
+
+// Commenter pour retirer toutes les sondes du code
+#define PROFILER_ENABLE
+
+// Nombre de classes de l'histogramme : classe n = [2^n, 2^(n+1)[ ticks
+#define PROF_HIST_BUCKETS   22
+
+// Points de mesure
+typedef enum {
+    PROF_SITE_IC3_ISR = 0,  // DRV_IC3_Callback
+    PROF_SITE_TIMER1_ISR,   // App_Timer1Callback
+    PROF_SITE_MENU_TASK,    // Menu_Task (affichage compris)
+    PROF_SITE_MENU_DISPLAY, // Menu_Display
+    PROF_SITE_SPI_ACC,      // Lecture en rafale de l'accelerometre
+    PROF_SITE_SPI_POT,      // Ecriture d'un potentiometre
+    PROF_SITE_I2C_LCD,      // Mise en file d'une paire I2C vers le LCD
+    PROF_SITE_COUNT
+} PROF_SITE;
+
+/**
+ * @brief Statistiques d'un point de mesure (durees en ticks Core Timer).
+ */
+typedef struct {
+    uint32_t count;                     // Nombre de mesures
+    uint32_t min;                       // Duree minimale
+    uint32_t max;                       // Duree maximale
+    uint64_t sum;                       // Somme des durees (moyenne)
+    uint16_t hist[PROF_HIST_BUCKETS];   // Histogramme log2 (sature a 65535)
+} Profiler_Site;
+
+#ifdef PROFILER_ENABLE
+// Debut de mesure : declare l'horodatage local du point
+#define PROF_BEGIN(site)    uint32_t profStart_##site = Timebase_Now()
+// Fin de mesure : enregistre la duree depuis PROF_BEGIN
+#define PROF_END(site)      Profiler_Record((site), Timebase_Now() - profStart_##site)
+#else
+#define PROF_BEGIN(site)
+#define PROF_END(site)
+#endif
+
+/**
+ * @brief Remet toutes les statistiques a zero.
+ */
+void Profiler_Init(void);
+
+/**
+ * @brief Enregistre une duree (utilisable en ISR).
+ *
+ * @param site Point de mesure (PROF_SITE)
+ * @param ticks Duree en ticks du Core Timer
+ */
+void Profiler_Record(uint8_t site, uint32_t ticks);
+
+/**
+ * @brief Copie coherente des statistiques d'un point.
+ *
+ * @param site Point de mesure (PROF_SITE)
+ * @param out Copie des statistiques
+ * @return false si le point n'existe pas
+ */
+bool Profiler_Snapshot(uint8_t site, Profiler_Site *out);
+
+/**
+ * @brief Remet les statistiques d'un point a zero.
+ *
+ * @param site Point de mesure (PROF_SITE)
+ */
+void Profiler_Clear(uint8_t site);
+
+#endif
@@ -0,0 +1,250 @@
+/*
+--------------------------------------------------------
+ Fichier : RevSync.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Decoupage du flux de l'accelerometre en tours sur les reperes IR
+--------------------------------------------------------
+*/
+// Inclusion du header decoupage en tours
+#include "RevSync.h" // Prototypes du decoupage
+// Inclusion du header horloge accelerometre
+#include "AccClock.h" // Instant des echantillons
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+// Inclusion du header application
+#include "app.h" // Anneau des captures IR
+
+#define REVSYNC_MIN_TICKS (60UL * RPMCALC_TIMER_FREQ / REVSYNC_MAX_RPM) // Tour le plus court
+#define REVSYNC_MAX_TICKS (60UL * RPMCALC_TIMER_FREQ / REVSYNC_MIN_RPM) // Tour le plus long
+
+/**
+ * @brief Echantillon en attente du repere qui ferme son tour.
+ */
+typedef struct {
+    uint32_t index; // Numero AccClock
+    int16_t xyz[3]; // Axes bruts
+} RevSync_Pending;
+
+static bool active = false; // Un consommateur lit les echantillons
+static RevSync_Pending pending[REVSYNC_PENDING]; // Echantillons en attente
+static uint8_t pendHead = 0; // Plus ancien echantillon en attente
+static uint8_t pendCount = 0; // Echantillons en attente
+static uint32_t markers[REVSYNC_MARKERS]; // Reperes IR [ticks IC], du plus ancien au plus recent
+static uint8_t markHead = 0; // Repere ouvrant le tour courant
+static uint8_t markCount = 0; // Reperes retenus
+static uint32_t markSeq = 0; // Numero de capture du repere markHead
+static uint32_t capSeen = 0; // Captures IC3 deja recopiees
+static uint32_t prevPeriod = 0; // Periode du tour precedent [ticks IC]
+static uint32_t lost = 0; // Pertes depuis le demarrage
+
+/**
+ * @brief Repere IR d'indice i (0 = ouverture du tour courant).
+ *
+ * @param i Indice relatif au tour courant
+ * @return Instant du repere [ticks IC]
+ */
+static uint32_t RevSync_Marker(uint8_t i)
+{
+    return markers[(markHead + i) % REVSYNC_MARKERS];
+}
+
+/**
+ * @brief Passe au tour suivant.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void RevSync_DropMarker(void)
+{
+    markHead = (markHead + 1) % REVSYNC_MARKERS;
+    markSeq++;
+    markCount--;
+}
+
+/**
+ * @brief Recopie les nouvelles captures IC3 dans l'anneau des reperes.
+ *
+ * @details
+ * L'anneau IC3 ne garde que RPM_CAPTURE_BUFFER_SIZE captures : au-dela,
+ * des reperes sont perdus et le decoupage en tours repart a zero.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void RevSync_PullMarkers(void)
+{
+    uint8_t index; // Prochain emplacement ecrit par l'ISR
+    uint32_t count = APP_CaptureCount(&index); // Captures depuis le demarrage
+    uint32_t fresh = count - capSeen; // Nouvelles captures
+    uint32_t c; // Capture recopiee
+
+    if (fresh >= RPM_CAPTURE_BUFFER_SIZE) {
+        lost++; // L'anneau a tourne entre deux lectures
+        markCount = 0;
+        prevPeriod = 0;
+        fresh = RPM_CAPTURE_BUFFER_SIZE - 1;
+    }
+    for (c = fresh; c > 0; c--) {
+        if (markCount == REVSYNC_MARKERS) {
+            RevSync_DropMarker(); // Oublie le plus ancien
+        }
+        if (markCount == 0) {
+            markSeq = count - c;
+        }
+        markers[(markHead + markCount) % REVSYNC_MARKERS] =
+            appData.captureBuffer[(index + RPM_CAPTURE_BUFFER_SIZE - c) % RPM_CAPTURE_BUFFER_SIZE];
+        markCount++;
+    }
+    capSeen = count;
+}
+
+/**
+ * @brief Indique si le tour courant est exploitable.
+ *
+ * @param period Duree du tour [ticks IC]
+ * @return true si le tour est dans les limites et proche du precedent
+ */
+static bool RevSync_RevOk(uint32_t period)
+{
+    uint32_t diff; // Ecart au tour precedent
+
+    if ((period < REVSYNC_MIN_TICKS) || (period > REVSYNC_MAX_TICKS)) {
+        return false;
+    }
+    if (prevPeriod == 0) {
+        return false; // Premier tour : pas de reference
+    }
+    diff = (period > prevPeriod) ? (period - prevPeriod) : (prevPeriod - period);
+    return (diff < (prevPeriod / 4));
+}
+
+/**
+ * @brief Ajoute des echantillons de l'accelerometre.
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param firstIndex Numero AccClock du premier echantillon
+ * @return Aucun retour.
+ */
+void RevSync_Push(const int16_t *xyz, uint8_t nb, uint32_t firstIndex)
+{
+    uint8_t i; // Echantillon
+    uint8_t k; // Axe
+
+    if (!active) {
+        uint8_t index; // Inutilise
+
+        pendHead = 0;
+        pendCount = 0;
+        markHead = 0;
+        markCount = 0;
+        prevPeriod = 0;
+        capSeen = APP_CaptureCount(&index); // Reperes a partir de maintenant
+        active = true;
+    }
+
+    RevSync_PullMarkers();
+    for (i = 0; i < nb; i++) {
+        RevSync_Pending *p; // Case ecrite
+
+        if (pendCount == REVSYNC_PENDING) {
+            pendHead = (pendHead + 1) % REVSYNC_PENDING; // Plus de place : oublie le plus ancien
+            pendCount--;
+            lost++;
+        }
+        p = &pending[(pendHead + pendCount) % REVSYNC_PENDING];
+        p->index = firstIndex + i;
+        for (k = 0; k < 3; k++) {
+            p->xyz[k] = xyz[3 * i + k];
+        }
+        pendCount++;
+    }
+}
+
+/**
+ * @brief Echantillon suivant dont le tour est ferme.
+ *
+ * @param out Echantillon date
+ * @return false s'il faut attendre le repere suivant
+ */
+bool RevSync_Next(RevSync_Sample *out)
+{
+    while (pendCount > 0) {
+        const RevSync_Pending *p = &pending[pendHead];
+        uint32_t t; // Instant de l'echantillon [ticks IC]
+        uint32_t period; // Duree du tour [ticks IC]
+        bool ready = false; // Echantillon rendu
+        uint8_t k; // Axe
+
+        if (AccClock_SampleTime(p->index, &t)) {
+            while ((markCount >= 2) && ((int32_t) (t - RevSync_Marker(1)) >= 0)) {
+                prevPeriod = RevSync_Marker(1) - RevSync_Marker(0);
+                RevSync_DropMarker(); // L'echantillon appartient a un tour suivant
+            }
+            if ((markCount >= 1) && ((int32_t) (t - RevSync_Marker(0)) >= 0)) {
+                if (markCount < 2) {
+                    return false; // Tour pas encore ferme : attend le repere suivant
+                }
+                period = RevSync_Marker(1) - RevSync_Marker(0);
+                if (RevSync_RevOk(period)) {
+                    for (k = 0; k < 3; k++) {
+                        out->xyz[k] = p->xyz[k];
+                    }
+                    out->index = p->index;
+                    out->turn = (float) (t - RevSync_Marker(0)) / (float) period;
+                    out->rev = markSeq;
+                    out->period = period;
+                    ready = true;
+                }
+            }
+        }
+        pendHead = (pendHead + 1) % REVSYNC_PENDING; // Rendu, ou non datable
+        pendCount--;
+        if (ready) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Oublie les echantillons et les reperes (plus de consommateur).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void RevSync_Stop(void)
+{
+    active = false;
+}
+
+/**
+ * @brief Indique si un consommateur lit les echantillons.
+ *
+ * @return true entre le premier RevSync_Push et RevSync_Stop
+ */
+bool RevSync_IsActive(void)
+{
+    return active;
+}
+
+/**
+ * @brief Numero de la prochaine capture IC3.
+ *
+ * @return Premier numero de tour ouvert apres l'appel
+ */
+uint32_t RevSync_MarkerNow(void)
+{
+    return appData.captureCount;
+}
+
+/**
+ * @brief Compteur de pertes (anneau IC3 deborde, attente saturee).
+ *
+ * @return Nombre de pertes depuis le demarrage
+ */
+uint32_t RevSync_LostCount(void)
+{
+    return lost;
+}
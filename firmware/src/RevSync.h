@@ -0,0 +1,98 @@
+/*
+--------------------------------------------------------
+ Fichier : RevSync.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Decoupage du flux de l'accelerometre en tours sur les reperes IR
+--------------------------------------------------------*/
+
+#ifndef _REVSYNC_H_
+#define _REVSYNC_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Reference tachymetrique : un seul repere reflechissant sur l'helice
+ * (une capture IC3 par tour). Les echantillons de l'accelerometre sont
+ * dates sur la meme base de temps que les captures (AccClock).
+ *
+ * Chaque echantillon attend que le repere suivant soit capture : sa
+ * position dans le tour est alors exacte, turn = (t - m_k) / (m_k+1 - m_k),
+ * meme si la vitesse varie d'un tour a l'autre. Les tours hors
+ * [REVSYNC_MIN_RPM, REVSYNC_MAX_RPM] ou qui s'ecartent de plus d'un quart
+ * du precedent (repere manque ou parasite) sont ignores.
+ *
+ * Les consommateurs (equilibrage, moyenne synchrone) lisent les
+ * echantillons dates avec RevSync_Next. Le numero de tour est le numero
+ * de la capture IC3 qui l'ouvre (appData.captureCount) : il sert a
+ * ignorer les tours ouverts avant le debut d'une mesure.
+ */
+
+#define REVSYNC_PENDING         128     // Echantillons en attente du repere suivant
+#define REVSYNC_MARKERS         16      // Reperes IR retenus
+#define REVSYNC_MIN_RPM         600     // Tours plus lents ignores (repere manque)
+#define REVSYNC_MAX_RPM         12000   // Tours plus rapides ignores (parasite)
+
+/**
+ * @brief Echantillon date dans son tour.
+ */
+typedef struct {
+    int16_t xyz[3];         // Axes bruts
+    uint32_t index;         // Numero AccClock (continuite du flux)
+    float turn;             // Position dans le tour, 0-1
+    uint32_t rev;           // Numero du tour (capture IC3 qui l'ouvre)
+    uint32_t period;        // Duree du tour [ticks IC]
+} RevSync_Sample;
+
+/**
+ * @brief Ajoute des echantillons de l'accelerometre.
+ *
+ * @details
+ * Le premier appel apres RevSync_Stop repart des captures arrivees
+ * depuis : les tours anterieurs ne sont pas decoupes.
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param firstIndex Numero AccClock du premier echantillon
+ */
+void RevSync_Push(const int16_t *xyz, uint8_t nb, uint32_t firstIndex);
+
+/**
+ * @brief Echantillon suivant dont le tour est ferme.
+ *
+ * @details
+ * Les echantillons non datables ou d'un tour rejete sont sautes.
+ *
+ * @param out Echantillon date
+ * @return false s'il faut attendre le repere suivant
+ */
+bool RevSync_Next(RevSync_Sample *out);
+
+/**
+ * @brief Oublie les echantillons et les reperes (plus de consommateur).
+ */
+void RevSync_Stop(void);
+
+/**
+ * @brief Indique si un consommateur lit les echantillons.
+ *
+ * @return true entre le premier RevSync_Push et RevSync_Stop
+ */
+bool RevSync_IsActive(void);
+
+/**
+ * @brief Numero de la prochaine capture IC3.
+ *
+ * @return Premier numero de tour ouvert apres l'appel
+ */
+uint32_t RevSync_MarkerNow(void);
+
+/**
+ * @brief Compteur de pertes (anneau IC3 deborde, attente saturee).
+ *
+ * @return Nombre de pertes depuis le demarrage
+ */
+uint32_t RevSync_LostCount(void);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmCalc.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Calcul du RPM a partir des periodes capturees
+--------------------------------------------------------
+*/
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Prototypes du calcul
+
+/**
+ * @brief RPM correspondant a une periode entre deux fronts.
+ *
+ * @param delta Periode mesuree (ticks de capture)
+ * @param pulsesPerRev Nombre de fronts par tour (pales)
+ * @return RPM, 0 si la periode ou le nombre de fronts est nul
+ */
+uint32_t RpmCalc_FromPeriod(uint32_t delta, uint8_t pulsesPerRev)
+{
+    if ((delta == 0) || (pulsesPerRev == 0)) {
+        return 0; // Pas de mesure
+    }
+    return (60UL * RPMCALC_TIMER_FREQ) / (delta * pulsesPerRev);
+}
+
+/**
+ * @brief RPM correspondant a une porte de plusieurs fronts (compteur reciproque).
+ *
+ * @param delta Duree de la porte (ticks de capture)
+ * @param edges Nombre de fronts de la porte
+ * @param pulsesPerRev Nombre de fronts par tour (pales)
+ * @return RPM, 0 si la duree, les fronts ou le nombre de fronts par tour sont nuls
+ */
+uint32_t RpmCalc_FromGate(uint32_t delta, uint16_t edges, uint8_t pulsesPerRev)
+{
+    if ((delta == 0) || (edges == 0) || (pulsesPerRev == 0)) {
+        return 0; // Pas de mesure
+    }
+    return (uint32_t) (((uint64_t) (60UL * RPMCALC_TIMER_FREQ) * edges) / ((uint64_t) delta * pulsesPerRev));
+}
+
+/**
+ * @brief Estime la confiance d'une mesure a partir de deux periodes successives.
+ *
+ * @details
+ * 100 % quand les deux periodes sont identiques, decroit lineairement avec
+ * l'ecart relatif et vaut 0 au-dela de 100 % d'ecart.
+ *
+ * @param delta Derniere periode mesuree (ticks)
+ * @param prevDelta Periode precedente (ticks)
+ * @return Confiance en pourcent
+ */
+uint8_t RpmCalc_Confidence(uint32_t delta, uint32_t prevDelta)
+{
+    uint32_t diff; // Ecart absolu entre les periodes
+    uint32_t pct; // Ecart relatif en pourcent
+
+    if (delta == 0) {
+        return 0; // Pas de periode
+    }
+    diff = (delta > prevDelta) ? (delta - prevDelta) : (prevDelta - delta); // Valeur absolue
+    pct = (uint32_t) (((uint64_t) diff * 100) / delta); // Ecart relatif
+    if (pct >= 100) {
+        return 0; // Periodes incoherentes
+    }
+    return (uint8_t) (100 - pct); // Confiance
+}
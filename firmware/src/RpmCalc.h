@@ -0,0 +1,45 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmCalc.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Calcul du RPM a partir des periodes capturees
+--------------------------------------------------------*/
+
+#ifndef _RPMCALC_H_
+#define _RPMCALC_H_
+
+#include <stdint.h> // Types entiers standard
+
+// Base de temps de la capture : T2/T3 sur PBCLK3 (10 MHz dans tous les profils)
+#define RPMCALC_TIMER_FREQ  10000000UL
+
+/**
+ * @brief RPM correspondant a une periode entre deux fronts.
+ *
+ * @param delta Periode mesuree (ticks de capture)
+ * @param pulsesPerRev Nombre de fronts par tour (pales)
+ * @return RPM, 0 si la periode ou le nombre de fronts est nul
+ */
+uint32_t RpmCalc_FromPeriod(uint32_t delta, uint8_t pulsesPerRev);
+
+/**
+ * @brief RPM correspondant a une porte de plusieurs fronts (compteur reciproque).
+ *
+ * @param delta Duree de la porte (ticks de capture)
+ * @param edges Nombre de fronts de la porte
+ * @param pulsesPerRev Nombre de fronts par tour (pales)
+ * @return RPM, 0 si la duree, les fronts ou le nombre de fronts par tour sont nuls
+ */
+uint32_t RpmCalc_FromGate(uint32_t delta, uint16_t edges, uint8_t pulsesPerRev);
+
+/**
+ * @brief Estime la confiance d'une mesure a partir de deux periodes successives.
+ *
+ * @param delta Derniere periode mesuree (ticks)
+ * @param prevDelta Periode precedente (ticks)
+ * @return Confiance en pourcent
+ */
+uint8_t RpmCalc_Confidence(uint32_t delta, uint32_t prevDelta);
+
+#endif
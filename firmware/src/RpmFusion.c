@@ -0,0 +1,186 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmFusion.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Filtre de Kalman RPM / derivee fusionnant IR, audio et vibration
+--------------------------------------------------------
+*/
+// Inclusion du header fusion
+#include "RpmFusion.h" // Prototypes du filtre
+#include <math.h> // Pour sqrtf
+#include <string.h> // Pour memset
+
+/**
+ * @brief Etat du filtre et covariance (symetrique : 3 termes).
+ */
+typedef struct {
+    bool init;          // Etat initialise
+    float rpm;          // RPM estime
+    float rate;         // Derivee estimee [RPM/s]
+    float p00;          // Variance du RPM
+    float p01;          // Covariance RPM / derivee
+    float p11;          // Variance de la derivee
+    uint32_t timeMs;    // Instant de l'etat [ms]
+    uint8_t sources;    // Sources acceptees depuis l'initialisation
+} RpmFusion_State;
+
+static RpmFusion_State st; // Etat du filtre
+static uint8_t rejectRun = 0; // Rejets consecutifs
+static uint32_t acceptedCount[RPMFUSION_SRC_COUNT]; // Mesures acceptees par source
+static uint32_t rejectedCount[RPMFUSION_SRC_COUNT]; // Mesures rejetees par source
+
+/**
+ * @brief Oublie l'etat (prochaine mesure = etat initial).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void RpmFusion_Reset(void)
+{
+    memset(&st, 0, sizeof(st));
+    rejectRun = 0;
+}
+
+/**
+ * @brief Repart d'une mesure : derivee nulle et incertaine.
+ *
+ * @param source Source de la mesure
+ * @param rpm RPM mesure
+ * @param variance Variance de la mesure
+ * @param timeMs Instant de la mesure
+ * @return Aucun retour.
+ */
+static void RpmFusion_Start(uint8_t source, float rpm, float variance, uint32_t timeMs)
+{
+    st.init = true;
+    st.rpm = rpm;
+    st.rate = 0.0f;
+    st.p00 = variance;
+    st.p01 = 0.0f;
+    st.p11 = RPMFUSION_RATE_VAR0;
+    st.timeMs = timeMs;
+    st.sources = (uint8_t) (1u << source);
+    rejectRun = 0;
+}
+
+/**
+ * @brief Integre une mesure.
+ *
+ * @details
+ * Une mesure un peu plus ancienne que l'etat (sources asynchrones) est
+ * appliquee a l'instant de l'etat, sans retour en arriere.
+ *
+ * @param source Source (RPMFUSION_SOURCE)
+ * @param rpm RPM mesure
+ * @param variance Variance de la mesure [RPM^2], > 0
+ * @param timeMs Instant de la mesure [ms]
+ * @return false si la mesure est rejetee
+ */
+bool RpmFusion_Update(uint8_t source, float rpm, float variance, uint32_t timeMs)
+{
+    int32_t dtMs; // Ecart mesure / etat [ms]
+    float dt, q, y, s, k0, k1; // Prediction et correction
+
+    if ((source >= RPMFUSION_SRC_COUNT) || !(variance > 0.0f)) {
+        return false; // Source inconnue ou variance invalide
+    }
+    dtMs = (int32_t) (timeMs - st.timeMs);
+    if (!st.init || (dtMs > RPMFUSION_STALE_MS)) {
+        RpmFusion_Start(source, rpm, variance, timeMs);
+        acceptedCount[source]++;
+        return true;
+    }
+
+    // Prediction (vitesse constante) jusqu'a l'instant de la mesure
+    if (dtMs > 0) {
+        dt = (float) dtMs * 0.001f;
+        q = RPMFUSION_ACCEL_PSD * dt;
+        st.rpm += st.rate * dt;
+        st.p00 += dt * (2.0f * st.p01 + dt * st.p11) + q * dt * dt * (1.0f / 3.0f);
+        st.p01 += dt * st.p11 + q * dt * 0.5f;
+        st.p11 += q;
+        st.timeMs = timeMs;
+    }
+
+    // Porte sur l'innovation
+    y = rpm - st.rpm;
+    s = st.p00 + variance;
+    if ((y * y) > (RPMFUSION_GATE_SIGMA * RPMFUSION_GATE_SIGMA * s)) {
+        rejectedCount[source]++;
+        if (++rejectRun >= RPMFUSION_RELOCK_REJECTS) {
+            RpmFusion_Start(source, rpm, variance, timeMs); // Le regime a vraiment change
+            acceptedCount[source]++;
+            return true;
+        }
+        return false;
+    }
+
+    // Correction (H = [1 0])
+    k0 = st.p00 / s;
+    k1 = st.p01 / s;
+    st.rpm += k0 * y;
+    st.rate += k1 * y;
+    st.p11 -= k1 * st.p01; // Avant la mise a jour de p01
+    st.p01 -= k0 * st.p01;
+    st.p00 -= k0 * st.p00;
+    st.sources |= (uint8_t) (1u << source);
+    rejectRun = 0;
+    acceptedCount[source]++;
+    return true;
+}
+
+/**
+ * @brief Etat filtre extrapole a un instant.
+ *
+ * @details
+ * L'extrapolation suit la derivee (faible retard pendant une
+ * acceleration), bornee a RPMFUSION_MAX_EXTRAP_MS.
+ *
+ * @param out Sortie
+ * @param nowMs Instant de lecture [ms]
+ * @return Aucun retour.
+ */
+void RpmFusion_Get(RpmFusion_Output *out, uint32_t nowMs)
+{
+    int32_t dtMs = (int32_t) (nowMs - st.timeMs); // Age de l'etat [ms]
+
+    out->valid = st.init && (dtMs <= RPMFUSION_STALE_MS);
+    out->rate = st.rate;
+    out->sigma = sqrtf(st.p00);
+    out->updateMs = st.timeMs;
+    out->sources = st.sources;
+    if (dtMs < 0) {
+        dtMs = 0;
+    } else if (dtMs > RPMFUSION_MAX_EXTRAP_MS) {
+        dtMs = RPMFUSION_MAX_EXTRAP_MS;
+    }
+    out->rpm = st.rpm + st.rate * ((float) dtMs * 0.001f);
+    if (!out->valid) {
+        out->rpm = 0.0f; // Etat perime
+        out->rate = 0.0f;
+    } else if (out->rpm < 0.0f) {
+        out->rpm = 0.0f; // Extrapolation d'une deceleration
+    }
+}
+
+/**
+ * @brief Compteurs de mesures par source.
+ *
+ * @param source Source (RPMFUSION_SOURCE)
+ * @param accepted Mesures acceptees (peut etre 0)
+ * @param rejected Mesures rejetees (peut etre 0)
+ * @return Aucun retour.
+ */
+void RpmFusion_GetCounts(uint8_t source, uint32_t *accepted, uint32_t *rejected)
+{
+    if (source >= RPMFUSION_SRC_COUNT) {
+        return;
+    }
+    if (accepted != 0) {
+        *accepted = acceptedCount[source];
+    }
+    if (rejected != 0) {
+        *rejected = rejectedCount[source];
+    }
+}
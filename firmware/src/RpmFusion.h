@@ -0,0 +1,91 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmFusion.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Filtre de Kalman RPM / derivee fusionnant IR, audio et vibration
+--------------------------------------------------------*/
+
+#ifndef _RPMFUSION_H_
+#define _RPMFUSION_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Etat [RPM, dRPM/dt] a vitesse constante, bruit d'acceleration blanc de
+ * densite RPMFUSION_ACCEL_PSD. Chaque estimateur (IR, audio, vibration)
+ * pousse ses mesures quand il en a, avec leur horodatage et leur variance :
+ * prediction jusqu'a l'instant de la mesure puis correction, en temps
+ * constant (quelques dizaines d'operations flottantes sur la FPU).
+ *
+ * Une mesure dont l'innovation depasse RPMFUSION_GATE_SIGMA ecarts types
+ * est rejetee (harmonique, raie parasite) ; apres RPMFUSION_RELOCK_REJECTS
+ * rejets consecutifs toutes sources confondues, le filtre repart de la
+ * mesure (changement de regime brutal). Sans mesure acceptee depuis
+ * RPMFUSION_STALE_MS, la prochaine mesure reinitialise aussi le filtre.
+ *
+ * Appels depuis la boucle principale uniquement (pas de verrou).
+ */
+
+#define RPMFUSION_ACCEL_PSD         1.0e6f  // Densite du bruit d'acceleration [(RPM/s)^2 / s]
+#define RPMFUSION_RATE_VAR0         1.0e6f  // Variance initiale de la derivee [(RPM/s)^2]
+#define RPMFUSION_GATE_SIGMA        4.0f    // Seuil de rejet [ecarts types]
+#define RPMFUSION_RELOCK_REJECTS    5       // Rejets consecutifs avant reinitialisation
+#define RPMFUSION_STALE_MS          2000    // Etat perime sans mesure acceptee [ms]
+#define RPMFUSION_MAX_EXTRAP_MS     500     // Extrapolation maximale a la lecture [ms]
+
+// Sources de mesure
+typedef enum {
+    RPMFUSION_SRC_IR = 0,   // Capture IR (periode entre fronts)
+    RPMFUSION_SRC_AUDIO,    // Estimateur spectral du microphone
+    RPMFUSION_SRC_VIB,      // Estimateur de l'accelerometre
+    RPMFUSION_SRC_COUNT
+} RPMFUSION_SOURCE;
+
+/**
+ * @brief Sortie du filtre.
+ */
+typedef struct {
+    bool valid;             // Mesure acceptee depuis moins de RPMFUSION_STALE_MS
+    float rpm;              // RPM filtre, extrapole a l'instant demande
+    float rate;             // Derivee [RPM/s]
+    float sigma;            // Ecart type du RPM [RPM]
+    uint32_t updateMs;      // Derniere mesure acceptee [ms]
+    uint8_t sources;        // Sources acceptees depuis la reinitialisation (bit = source)
+} RpmFusion_Output;
+
+/**
+ * @brief Oublie l'etat (prochaine mesure = etat initial).
+ */
+void RpmFusion_Reset(void);
+
+/**
+ * @brief Integre une mesure.
+ *
+ * @param source Source (RPMFUSION_SOURCE)
+ * @param rpm RPM mesure
+ * @param variance Variance de la mesure [RPM^2], > 0
+ * @param timeMs Instant de la mesure [ms]
+ * @return false si la mesure est rejetee
+ */
+bool RpmFusion_Update(uint8_t source, float rpm, float variance, uint32_t timeMs);
+
+/**
+ * @brief Etat filtre extrapole a un instant.
+ *
+ * @param out Sortie
+ * @param nowMs Instant de lecture [ms]
+ */
+void RpmFusion_Get(RpmFusion_Output *out, uint32_t nowMs);
+
+/**
+ * @brief Compteurs de mesures par source.
+ *
+ * @param source Source (RPMFUSION_SOURCE)
+ * @param accepted Mesures acceptees (peut etre 0)
+ * @param rejected Mesures rejetees (peut etre 0)
+ */
+void RpmFusion_GetCounts(uint8_t source, uint32_t *accepted, uint32_t *rejected);
+
+#endif
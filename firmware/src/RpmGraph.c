@@ -0,0 +1,165 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmGraph.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Barre graphe et tendance du RPM en caracteres personnalises
+--------------------------------------------------------
+*/
+// Inclusion du header graphe RPM
+#include "RpmGraph.h" // Prototypes du graphe
+// Inclusion du header LCD
+#include "LCD.h" // Image de l'ecran et CGRAM
+// Inclusion du header formatage
+#include "Fmt.h" // Champs numeriques
+#include <string.h> // Pour memset
+
+#define RPMGRAPH_BAR_GLYPH      0 // Barre de 1 colonne (a 4 : 5 colonnes)
+#define RPMGRAPH_TREND_GLYPH    5 // Premier caractere de la tendance
+#define RPMGRAPH_TREND_CHARS    3 // Caracteres de la tendance
+#define RPMGRAPH_PX_PER_CHAR    5 // Colonnes de pixels par caractere
+#define RPMGRAPH_PX_ROWS        8 // Lignes de pixels par caractere
+
+// Pleines echelles proposees [RPM]
+static const uint32_t scales[] = { 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+#define RPMGRAPH_NB_SCALES  (sizeof(scales) / sizeof(scales[0]))
+
+static uint32_t samples[RPMGRAPH_SAMPLES]; // Anneau des echantillons
+static uint8_t head = 0; // Prochaine place
+static uint8_t count = 0; // Echantillons valides
+static uint32_t lastSampleMs = 0; // Dernier echantillon [ms]
+
+/**
+ * @brief Vide la tendance.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void RpmGraph_Reset(void)
+{
+    head = 0;
+    count = 0;
+}
+
+/**
+ * @brief Ajoute un echantillon a la tendance toutes les RPMGRAPH_SAMPLE_MS.
+ *
+ * @param rpm RPM courant
+ * @param nowMs Base de temps [ms]
+ * @return Aucun retour.
+ */
+void RpmGraph_Sample(uint32_t rpm, uint32_t nowMs)
+{
+    if ((count != 0) && ((nowMs - lastSampleMs) < RPMGRAPH_SAMPLE_MS)) {
+        return; // Pas encore l'heure
+    }
+    lastSampleMs = nowMs;
+    samples[head] = rpm;
+    head = (uint8_t) ((head + 1) % RPMGRAPH_SAMPLES);
+    if (count < RPMGRAPH_SAMPLES) {
+        count++;
+    }
+}
+
+/**
+ * @brief Dessine les caracteres de la barre (1 a 5 colonnes pleines).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void RpmGraph_DefineBar(void)
+{
+    uint8_t rows[RPMGRAPH_PX_ROWS]; // Dessin du caractere
+    uint8_t n; // Colonnes pleines - 1
+
+    for (n = 0; n < RPMGRAPH_PX_PER_CHAR; n++) {
+        memset(rows, (uint8_t) (0x1F << (RPMGRAPH_PX_PER_CHAR - 1 - n)) & 0x1F, sizeof(rows));
+        rows[0] = 0; // Ligne vide en haut
+        rows[RPMGRAPH_PX_ROWS - 1] = 0; // et en bas : la barre ne touche pas la ligne 1
+        lcd_glyph_define((uint8_t) (RPMGRAPH_BAR_GLYPH + n), rows);
+    }
+}
+
+/**
+ * @brief Dessine la tendance dans ses caracteres et fixe la pleine echelle.
+ *
+ * @param rpm RPM courant
+ * @return Pleine echelle retenue [RPM]
+ */
+static uint32_t RpmGraph_DefineTrend(uint32_t rpm)
+{
+    uint8_t rows[RPMGRAPH_TREND_CHARS][RPMGRAPH_PX_ROWS]; // Dessin des caracteres
+    uint32_t lo = rpm, hi = rpm; // Etendue de la fenetre
+    uint32_t span, fullScale, v; // Echelles
+    uint8_t i, k, h, c, r; // Parcours
+
+    for (i = 0; i < count; i++) {
+        v = samples[i];
+        lo = (v < lo) ? v : lo;
+        hi = (v > hi) ? v : hi;
+    }
+    fullScale = scales[RPMGRAPH_NB_SCALES - 1];
+    for (i = 0; i < RPMGRAPH_NB_SCALES; i++) {
+        if (hi <= scales[i]) {
+            fullScale = scales[i]; // Plus petite echelle qui contient tout
+            break;
+        }
+    }
+    span = fullScale / RPMGRAPH_MIN_SPAN_DIV;
+    if ((hi - lo) < span) {
+        v = lo + ((hi - lo) / 2); // Milieu de la fenetre
+        lo = (v > (span / 2)) ? (v - (span / 2)) : 0; // Fenetre minimale centree
+    } else {
+        span = hi - lo;
+    }
+
+    memset(rows, 0, sizeof(rows));
+    for (i = 0; i < count; i++) {
+        k = (uint8_t) ((head + RPMGRAPH_SAMPLES - count + i) % RPMGRAPH_SAMPLES); // Du plus ancien au plus recent
+        v = (samples[k] > lo) ? (samples[k] - lo) : 0;
+        h = (uint8_t) (1 + (((v > span) ? span : v) * (RPMGRAPH_PX_ROWS - 1)) / span); // Hauteur 1 a 8
+        c = (uint8_t) (RPMGRAPH_SAMPLES - count + i); // Colonne : le plus recent a droite
+        for (r = (uint8_t) (RPMGRAPH_PX_ROWS - h); r < RPMGRAPH_PX_ROWS; r++) {
+            rows[c / RPMGRAPH_PX_PER_CHAR][r] |= (uint8_t) (0x10 >> (c % RPMGRAPH_PX_PER_CHAR));
+        }
+    }
+    for (i = 0; i < RPMGRAPH_TREND_CHARS; i++) {
+        lcd_glyph_define((uint8_t) (RPMGRAPH_TREND_GLYPH + i), rows[i]);
+    }
+    return fullScale;
+}
+
+/**
+ * @brief Compose la vue graphique dans l'image de l'ecran et la CGRAM.
+ *
+ * @param rpm RPM courant
+ * @return Aucun retour.
+ */
+void RpmGraph_Render(uint32_t rpm)
+{
+    uint32_t fullScale = RpmGraph_DefineTrend(rpm); // Pleine echelle
+    uint32_t px; // Colonnes de pixels de la barre
+    char *d; // Position d'ecriture
+    uint8_t i;
+
+    RpmGraph_DefineBar();
+
+    d = Fmt_Uint(lcd_frame_at(1, 1), rpm, 5); // "12345 RPM /20k"
+    d = Fmt_Str(d, " RPM /", 0);
+    d = Fmt_Uint(d, fullScale / 1000, 0);
+    (void) Fmt_Str(d, "k", 0);
+    d = lcd_frame_at(RPMGRAPH_TREND_COL, 1);
+    for (i = 0; i < RPMGRAPH_TREND_CHARS; i++) {
+        *d++ = LCD_GLYPH(RPMGRAPH_TREND_GLYPH + i); // Caracteres de la tendance
+    }
+
+    px = (rpm >= fullScale) ? (LCD_COLS * RPMGRAPH_PX_PER_CHAR)
+                            : ((rpm * (LCD_COLS * RPMGRAPH_PX_PER_CHAR)) / fullScale);
+    d = lcd_frame_at(1, 2);
+    for (; px >= RPMGRAPH_PX_PER_CHAR; px -= RPMGRAPH_PX_PER_CHAR) {
+        *d++ = LCD_GLYPH(RPMGRAPH_BAR_GLYPH + RPMGRAPH_PX_PER_CHAR - 1); // Case pleine
+    }
+    if (px != 0) {
+        *d = LCD_GLYPH(RPMGRAPH_BAR_GLYPH + px - 1); // Case partielle
+    }
+}
@@ -0,0 +1,63 @@
+/*
+--------------------------------------------------------
+ Fichier : RpmGraph.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Barre graphe et tendance du RPM en caracteres personnalises
+--------------------------------------------------------*/
+
+#ifndef _RPMGRAPH_H_
+#define _RPMGRAPH_H_
+
+#include <stdint.h> // Types entiers standard
+
+/*
+ * Vue graphique de la mesure visuelle :
+ *
+ *   ligne 1 : "12345 RPM /20k" puis la tendance dans les colonnes 18-20
+ *   ligne 2 : barre horizontale de 20 cases (100 niveaux) sur la pleine
+ *             echelle affichee
+ *
+ * Pleine echelle : plus petite valeur de RPMGRAPH_SCALES qui contient la
+ * tendance et la valeur courante.
+ *
+ * Tendance : RPMGRAPH_SAMPLES colonnes de pixels (une par echantillon, le
+ * plus recent a droite) dessinees dans 3 caracteres CGRAM. L'echelle
+ * verticale suit le min / max de la fenetre avec une etendue minimale de
+ * pleine echelle / RPMGRAPH_MIN_SPAN_DIV : un regime stable reste plat.
+ *
+ * CGRAM : caracteres 0-4 = barre de 1 a 5 colonnes, 5-7 = tendance. Seules
+ * les lignes de pixels modifiees partent sur le bus (lcd_frame_flush).
+ */
+
+#define RPMGRAPH_SAMPLES        15  // Echantillons de la tendance (3 x 5 pixels)
+#define RPMGRAPH_SAMPLE_MS      200 // Periode d'echantillonnage [ms] (3 s affichees)
+#define RPMGRAPH_MIN_SPAN_DIV   50  // Etendue minimale de la tendance = pleine echelle / 50
+#define RPMGRAPH_TREND_COL      18  // Premiere colonne de la tendance
+
+/**
+ * @brief Vide la tendance.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void RpmGraph_Reset(void);
+
+/**
+ * @brief Ajoute un echantillon a la tendance toutes les RPMGRAPH_SAMPLE_MS.
+ *
+ * @param rpm RPM courant
+ * @param nowMs Base de temps [ms]
+ * @return Aucun retour.
+ */
+void RpmGraph_Sample(uint32_t rpm, uint32_t nowMs);
+
+/**
+ * @brief Compose la vue graphique dans l'image de l'ecran et la CGRAM.
+ *
+ * @param rpm RPM courant
+ * @return Aucun retour.
+ */
+void RpmGraph_Render(uint32_t rpm);
+
+#endif
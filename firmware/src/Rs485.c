@@ -0,0 +1,258 @@
+/*
+--------------------------------------------------------
+ Fichier : Rs485.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Liaison RS485 : emission par DMA, reception par interruption
+--------------------------------------------------------
+*/
+// Inclusion du header RS485
+#include "Rs485.h" // Prototypes de la liaison RS485
+// Inclusion du header de tramage
+#include "SerialFrame.h" // Construction des trames
+// Inclusion de la configuration systeme
+#include "system_config.h" // Configuration systeme (broches)
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Definitions systeme (PLIB, SFR)
+
+/*
+ * Remarque materielle : la broche RG7 (TX_485_NOT_OK) n'accepte pas U2TX
+ * via le PPS. L'emission utilise donc U5TX sur RPG7, la reception reste
+ * sur U2RX (RG6). Les deux UART tournent au meme debit.
+ *
+ * Le recepteur du transceiver (RX_485_EN_, actif bas) est coupe pendant
+ * l'emission pour ne pas relire l'echo de nos propres trames.
+ */
+
+// Etats de l'emetteur
+typedef enum {
+    RS485_TX_IDLE = 0, // Aucune emission
+    RS485_TX_DMA,      // Le DMA remplit la FIFO de l'UART
+    RS485_TX_DRAIN     // Attente de la sortie du dernier bit
+} RS485_TX_STATE;
+
+// Buffer d'emission lu par le DMA (hors cache)
+static uint8_t __attribute__((coherent, aligned(16))) txBuffer[RS485_TX_BUFFER_SIZE];
+static volatile RS485_TX_STATE txState = RS485_TX_IDLE; // Etat de l'emetteur
+static Rs485_Stats stats; // Compteurs de la liaison
+static volatile uint8_t rxBuffer[RS485_RX_BUFFER_SIZE]; // Buffer circulaire de reception
+static volatile uint16_t rxHead = 0; // Index d'ecriture (ISR)
+static volatile uint16_t rxTail = 0; // Index de lecture (tache)
+
+/**
+ * @brief Initialise l'UART et le canal DMA d'emission RS485.
+ *
+ * @details
+ * UART5 : 8N1, BRGH = 1, interruption TX tant que la FIFO a de la place
+ * (declencheur du DMA). DMA0 : transfert octet par octet du buffer vers
+ * U5TXREG, interruption en fin de bloc. UART2 : reception seule, une
+ * interruption par caractere recu.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Rs485_Init(void)
+{
+    uint32_t pbclk = SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_2); // Horloge de l'UART
+
+    TX_485_ENOff(); // Driver RS485 en reception
+    RX_485_EN_Off(); // Recepteur RS485 actif
+
+    U5MODE = 0; // UART a l'arret, 8N1
+    U5STA = 0; // Emetteur et recepteur desactives
+    U5MODEbits.BRGH = 1; // Diviseur par 4
+    U5BRG = ((pbclk + (2 * RS485_BAUDRATE)) / (4 * RS485_BAUDRATE)) - 1; // Arrondi au plus proche
+    U5STAbits.UTXISEL = 0; // IRQ TX tant que la FIFO n'est pas pleine
+    U5STAbits.UTXEN = 1; // Active l'emetteur
+    U5MODEbits.ON = 1; // Active l'UART
+
+    U2MODE = 0; // UART de reception a l'arret, 8N1
+    U2STA = 0; // Emetteur et recepteur desactives
+    U2MODEbits.BRGH = 1; // Diviseur par 4
+    U2BRG = U5BRG; // Meme debit que l'emission
+    U2STAbits.URXISEL = 0; // IRQ des qu'un caractere est recu
+    U2STAbits.URXEN = 1; // Active le recepteur
+    U2MODEbits.ON = 1; // Active l'UART
+    rxHead = 0; // Buffer de reception vide
+    rxTail = 0;
+
+    DMACONSET = _DMACON_ON_MASK; // Active le controleur DMA
+    DCH0CON = 0; // Canal a l'arret
+    DCH0CONbits.CHPRI = 2; // Priorite moyenne
+    DCH0ECON = (_UART5_TX_VECTOR << _DCH0ECON_CHSIRQ_POSITION) | _DCH0ECON_SIRQEN_MASK; // Declenche par U5TX
+    DCH0DSA = KVA_TO_PA(&U5TXREG); // Destination : registre d'emission
+    DCH0DSIZ = 1; // Destination sur 1 octet
+    DCH0CSIZ = 1; // 1 octet par declenchement
+    DCH0INTCLR = 0x00FF00FF; // Efface flags et autorisations
+    DCH0INTSET = _DCH0INT_CHBCIE_MASK; // Interruption en fin de bloc
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_DMA0, INT_PRIORITY_LEVEL1); // Meme niveau que IC3 / Timer1
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_DMA0, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_DMA_0); // Efface le flag
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_DMA_0); // Active l'interruption DMA0
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_UART5_TX, INT_PRIORITY_LEVEL1); // Fin d'emission
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_UART5_TX, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_5_TRANSMIT); // Active seulement en fin de trame
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_UART2_RX, INT_PRIORITY_LEVEL1); // Reception
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_UART2_RX, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_2_RECEIVE); // Efface le flag
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_2_RECEIVE); // Active l'interruption RX
+
+    txState = RS485_TX_IDLE; // Emetteur libre
+}
+
+/**
+ * @brief Construit une trame et lance son emission par DMA.
+ *
+ * @details
+ * La trame est construite directement dans le buffer DMA. Le driver RS485
+ * est active puis le premier transfert est force, la suite est cadencee
+ * par l'UART sans intervention du CPU.
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload
+ * @param len Taille du payload
+ * @return true si l'emission est lancee, false si l'emetteur est occupe
+ */
+bool Rs485_SendFrame(uint8_t type, const uint8_t *payload, uint16_t len)
+{
+    uint16_t frameLen; // Taille de la trame construite
+
+    if (txState != RS485_TX_IDLE) {
+        stats.framesDropped++; // Emetteur occupe
+        return false;
+    }
+
+    frameLen = SerialFrame_Encode(type, payload, len, txBuffer, sizeof (txBuffer)); // Construit la trame
+    if (frameLen == 0) {
+        stats.framesDropped++; // Trame trop longue
+        return false;
+    }
+
+    txState = RS485_TX_DMA; // Emission en cours
+    RX_485_EN_On(); // Coupe le recepteur (pas d'echo)
+    TX_485_ENOn(); // Driver RS485 en emission
+    U5STAbits.UTXISEL = 0; // Le DMA suit la place libre dans la FIFO
+
+    DCH0SSA = KVA_TO_PA(txBuffer); // Source : buffer d'emission
+    DCH0SSIZ = frameLen; // Taille de la trame
+    DCH0INTCLR = _DCH0INT_CHBCIF_MASK; // Efface la fin de bloc precedente
+    DCH0CONSET = _DCH0CON_CHEN_MASK; // Active le canal
+    DCH0ECONSET = _DCH0ECON_CFORCE_MASK; // Force le premier transfert
+
+    stats.framesSent++; // Compte la trame
+    stats.bytesSent += frameLen; // Compte les octets
+    return true;
+}
+
+/**
+ * @brief Indique si une emission est en cours.
+ *
+ * @return true tant que la trame precedente n'est pas entierement sortie
+ */
+bool Rs485_IsBusy(void)
+{
+    return (txState != RS485_TX_IDLE); // Occupe tant que la trame n'est pas sortie
+}
+
+/**
+ * @brief Retourne les compteurs de la liaison.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const Rs485_Stats* Rs485_GetStats(void)
+{
+    return &stats; // Compteurs internes
+}
+
+/**
+ * @brief Callback de fin de bloc DMA (appele depuis l'ISR DMA0).
+ *
+ * @details
+ * Le dernier octet est dans la FIFO mais pas encore sur la ligne. On passe
+ * l'interruption TX de l'UART en mode "tout est emis" pour relacher le
+ * driver RS485 au bon moment.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Rs485_DmaTxCallback(void)
+{
+    DCH0INTCLR = _DCH0INT_CHBCIF_MASK; // Acquitte la fin de bloc
+    txState = RS485_TX_DRAIN; // Attente du dernier bit
+    U5STAbits.UTXISEL = 1; // IRQ quand le registre a decalage est vide
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_5_TRANSMIT); // Efface le flag
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_5_TRANSMIT); // Attend la fin d'emission
+}
+
+/**
+ * @brief Callback d'emission UART (appele depuis l'ISR TX de l'UART).
+ *
+ * @details
+ * Relache TX_485_EN une fois le dernier bit sorti, puis libere l'emetteur.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Rs485_TxCallback(void)
+{
+    if ((txState == RS485_TX_DRAIN) && U5STAbits.TRMT) {
+        PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_5_TRANSMIT); // Plus besoin de l'IRQ
+        TX_485_ENOff(); // Driver RS485 en reception
+        RX_485_EN_Off(); // Recepteur RS485 actif
+        txState = RS485_TX_IDLE; // Emetteur libre
+    }
+}
+
+/**
+ * @brief Retire un octet du buffer de reception.
+ *
+ * @details
+ * Seule la tache modifie rxTail et seule l'ISR modifie rxHead : aucun
+ * masquage d'interruption n'est necessaire.
+ *
+ * @param b Pointeur de reception de l'octet
+ * @return true si un octet etait disponible
+ */
+bool Rs485_ReadByte(uint8_t *b)
+{
+    uint16_t tail = rxTail; // Copie locale de l'index de lecture
+
+    if (tail == rxHead) {
+        return false; // Buffer vide
+    }
+    *b = rxBuffer[tail]; // Lit l'octet
+    rxTail = (tail + 1) & (RS485_RX_BUFFER_SIZE - 1); // Avance l'index
+    return true;
+}
+
+/**
+ * @brief Callback de reception UART (appele depuis l'ISR RX de l'UART).
+ *
+ * @details
+ * Vide la FIFO materielle dans le buffer circulaire. Un overrun UART est
+ * acquitte et compte comme une perte.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Rs485_RxCallback(void)
+{
+    while (U2STAbits.URXDA) {
+        uint8_t b = (uint8_t) U2RXREG; // Lit le caractere
+        uint16_t next = (rxHead + 1) & (RS485_RX_BUFFER_SIZE - 1); // Prochain index
+        if (next == rxTail) {
+            stats.rxOverflows++; // Buffer plein, octet perdu
+        } else {
+            rxBuffer[rxHead] = b; // Stocke l'octet
+            rxHead = next; // Publie l'octet
+            stats.bytesReceived++;
+        }
+    }
+    if (U2STAbits.OERR) {
+        U2STAbits.OERR = 0; // Acquitte l'overrun (vide la FIFO)
+        stats.rxOverflows++;
+    }
+}
@@ -0,0 +1,94 @@
+/*
+--------------------------------------------------------
+ Fichier : Rs485.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations pour la liaison RS485 (emission DMA, reception par IRQ)
+--------------------------------------------------------*/
+
+#ifndef _RS485_H_
+#define _RS485_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+// Debit de la liaison RS485
+#define RS485_BAUDRATE      115200
+// Taille du buffer d'emission (trame complete)
+#define RS485_TX_BUFFER_SIZE 256
+// Taille du buffer circulaire de reception (puissance de 2)
+#define RS485_RX_BUFFER_SIZE 256
+
+/**
+ * @brief Compteurs de la liaison RS485.
+ */
+typedef struct {
+    uint32_t framesSent;    // Nombre de trames emises
+    uint32_t bytesSent;     // Nombre d'octets emis
+    uint32_t framesDropped; // Trames refusees (emetteur occupe ou trop longues)
+    uint32_t bytesReceived; // Nombre d'octets recus
+    uint32_t rxOverflows;   // Octets perdus (buffer plein ou overrun UART)
+} Rs485_Stats;
+
+/**
+ * @brief Initialise l'UART et le canal DMA d'emission RS485.
+ *
+ * @details
+ * L'UART est configure en 8N1 au debit RS485_BAUDRATE. Le DMA est declenche
+ * par l'interruption d'emission de l'UART et la ligne TX_485_EN est relachee
+ * par interruption quand le dernier bit est sorti. La reception remplit un
+ * buffer circulaire par interruption.
+ *
+ * @pre SYS_PORTS_Initialize doit avoir mappe la broche TX.
+ * @post La liaison est prete a emettre.
+ */
+void Rs485_Init(void);
+
+/**
+ * @brief Construit une trame et lance son emission par DMA.
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload
+ * @param len Taille du payload
+ * @return true si l'emission est lancee, false si l'emetteur est occupe
+ */
+bool Rs485_SendFrame(uint8_t type, const uint8_t *payload, uint16_t len);
+
+/**
+ * @brief Retire un octet du buffer de reception.
+ *
+ * @param b Pointeur de reception de l'octet
+ * @return true si un octet etait disponible
+ */
+bool Rs485_ReadByte(uint8_t *b);
+
+/**
+ * @brief Indique si une emission est en cours.
+ *
+ * @return true tant que la trame precedente n'est pas entierement sortie
+ */
+bool Rs485_IsBusy(void);
+
+/**
+ * @brief Retourne les compteurs de la liaison.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const Rs485_Stats* Rs485_GetStats(void);
+
+/**
+ * @brief Callback de fin de bloc DMA (appele depuis l'ISR DMA0).
+ */
+void Rs485_DmaTxCallback(void);
+
+/**
+ * @brief Callback d'emission UART (appele depuis l'ISR TX de l'UART).
+ */
+void Rs485_TxCallback(void);
+
+/**
+ * @brief Callback de reception UART (appele depuis l'ISR RX de l'UART).
+ */
+void Rs485_RxCallback(void);
+
+#endif
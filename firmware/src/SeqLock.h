@@ -0,0 +1,91 @@
+/*
+--------------------------------------------------------
+ Fichier : SeqLock.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Verrou de sequence pour publier une structure sans masquer les interruptions
+--------------------------------------------------------*/
+
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Un seul ecrivain par verrou. Le compteur est impair pendant l'ecriture :
+ * un lecteur qui voit un compteur impair ou modifie pendant sa copie
+ * recommence. L'ecrivain n'attend jamais.
+ *
+ * Le lecteur ne doit pas pouvoir interrompre l'ecrivain (lecteur dans la
+ * boucle principale ou a une priorite inferieure a l'ecrivain) : sinon il
+ * tournerait sur un compteur impair.
+ *
+ *   Ecriture :  SeqLock_WriteBegin(&l); data = x; SeqLock_WriteEnd(&l);
+ *   Lecture  :  do { s = SeqLock_ReadBegin(&l); copie = data; }
+ *               while (SeqLock_ReadRetry(&l, s));
+ */
+
+// Barriere du compilateur : les acces ne traversent pas ce point (coeur unique)
+#define SEQLOCK_BARRIER()   __asm__ volatile ("" ::: "memory")
+
+/**
+ * @brief Verrou de sequence.
+ */
+typedef struct {
+    volatile uint32_t seq;  // Compteur de versions (impair = ecriture en cours)
+} SeqLock;
+
+/**
+ * @brief Debut d'ecriture.
+ *
+ * @param l Verrou
+ */
+static inline void SeqLock_WriteBegin(SeqLock *l)
+{
+    l->seq++; // Impair : copie en cours
+    SEQLOCK_BARRIER();
+}
+
+/**
+ * @brief Fin d'ecriture.
+ *
+ * @param l Verrou
+ */
+static inline void SeqLock_WriteEnd(SeqLock *l)
+{
+    SEQLOCK_BARRIER();
+    l->seq++; // Pair : donnees coherentes
+}
+
+/**
+ * @brief Debut de lecture.
+ *
+ * @param l Verrou
+ * @return Version lue, a repasser a SeqLock_ReadRetry
+ */
+static inline uint32_t SeqLock_ReadBegin(const SeqLock *l)
+{
+    uint32_t s; // Version
+
+    do {
+        s = l->seq;
+    } while (s & 1); // Ecriture en cours
+    SEQLOCK_BARRIER();
+    return s;
+}
+
+/**
+ * @brief Indique si la copie doit etre refaite.
+ *
+ * @param l Verrou
+ * @param s Version rendue par SeqLock_ReadBegin
+ * @return true si une ecriture a eu lieu pendant la copie
+ */
+static inline bool SeqLock_ReadRetry(const SeqLock *l, uint32_t s)
+{
+    SEQLOCK_BARRIER();
+    return (l->seq != s);
+}
+
+#endif
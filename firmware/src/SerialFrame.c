@@ -0,0 +1,245 @@
+/*
+--------------------------------------------------------
+ Fichier : SerialFrame.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Tramage binaire (entete, longueur, CRC16) des liaisons serie
+--------------------------------------------------------
+*/
+// Inclusion du header de tramage
+#include "SerialFrame.h" // Prototypes et constantes de tramage
+#include <string.h> // Pour memcpy et memset
+
+// Etapes du decodeur
+typedef enum {
+    DEC_WAIT_SOF1 = 0, // Attente de 0xA5
+    DEC_WAIT_SOF2,     // Attente de 0x5A
+    DEC_TYPE,          // Type
+    DEC_LEN_L,         // Longueur, poids faible
+    DEC_LEN_H,         // Longueur, poids fort
+    DEC_PAYLOAD,       // Payload
+    DEC_CRC_L,         // CRC, poids faible
+    DEC_CRC_H          // CRC, poids fort
+} DEC_STATE;
+
+// Table du CRC16-CCITT (poly 0x1021), evite la boucle de 8 decalages par octet
+static const uint16_t crcTable[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+/**
+ * @brief Calcule le CRC16-CCITT d'un bloc d'octets.
+ *
+ * @details
+ * Calcul par table (un acces memoire par octet). La valeur retournee peut etre
+ * repassee en parametre pour enchainer plusieurs blocs.
+ *
+ * @param crc Valeur initiale (0xFFFF pour un nouveau calcul)
+ * @param data Pointeur sur les donnees
+ * @param len Nombre d'octets
+ * @return CRC mis a jour
+ */
+uint16_t SerialFrame_Crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    while (len > 0) {
+        crc = (uint16_t) ((crc << 8) ^ crcTable[(uint8_t) ((crc >> 8) ^ *data)]); // Un octet par iteration
+        data++; // Octet suivant
+        len--; // Decremente le compteur
+    }
+    return crc; // Retourne le CRC courant
+}
+
+/**
+ * @brief Construit une trame complete dans un buffer de sortie.
+ *
+ * @details
+ * Ecrit l'entete, copie le payload puis ajoute le CRC16 calcule sur
+ * type + longueur + payload.
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload (peut etre NULL si len = 0)
+ * @param len Taille du payload
+ * @param out Buffer de sortie
+ * @param outSize Taille du buffer de sortie
+ * @return Nombre d'octets ecrits, 0 si le buffer est trop petit
+ */
+uint16_t SerialFrame_Encode(uint8_t type, const uint8_t *payload, uint16_t len,
+                            uint8_t *out, uint16_t outSize)
+{
+    uint16_t crc; // CRC de la trame
+
+    if ((len > FRAME_MAX_PAYLOAD) || ((uint32_t) len + FRAME_OVERHEAD > outSize)) {
+        return 0; // Trame trop longue pour le buffer
+    }
+
+    out[0] = FRAME_SOF1; // Synchro 1
+    out[1] = FRAME_SOF2; // Synchro 2
+    out[2] = type; // Type de trame
+    SerialFrame_PutU16(&out[3], len); // Longueur du payload
+    if (len > 0) {
+        memcpy(&out[FRAME_HEADER_SIZE], payload, len); // Copie du payload
+    }
+
+    crc = SerialFrame_Crc16(0xFFFF, &out[2], (uint16_t) (len + 3)); // CRC sur type, len et payload
+    SerialFrame_PutU16(&out[FRAME_HEADER_SIZE + len], crc); // Ajoute le CRC
+
+    return (uint16_t) (len + FRAME_OVERHEAD); // Taille totale de la trame
+}
+
+/**
+ * @brief Ecrit un entier 16 bits en little endian.
+ *
+ * @param p Destination (2 octets)
+ * @param v Valeur a ecrire
+ */
+void SerialFrame_PutU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t) v; // Octet de poids faible
+    p[1] = (uint8_t) (v >> 8); // Octet de poids fort
+}
+
+/**
+ * @brief Ecrit un entier 32 bits en little endian.
+ *
+ * @param p Destination (4 octets)
+ * @param v Valeur a ecrire
+ */
+void SerialFrame_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t) v; // Octet 0
+    p[1] = (uint8_t) (v >> 8); // Octet 1
+    p[2] = (uint8_t) (v >> 16); // Octet 2
+    p[3] = (uint8_t) (v >> 24); // Octet 3
+}
+
+/**
+ * @brief Remet un decodeur dans l'etat d'attente de synchro.
+ *
+ * @param dec Decodeur a initialiser
+ * @return Aucun retour.
+ */
+void SerialFrame_DecoderInit(SerialFrame_Decoder *dec)
+{
+    memset(dec, 0, sizeof (*dec)); // Etat et compteurs a zero
+    dec->state = DEC_WAIT_SOF1; // Attente de synchro
+}
+
+/**
+ * @brief Fait avancer le decodeur d'un octet.
+ *
+ * @details
+ * Le CRC est mis a jour a chaque octet recu, aucune recopie n'est faite en
+ * fin de trame. Une longueur superieure a FRAME_MAX_RX_PAYLOAD fait rejeter
+ * la trame des l'entete.
+ *
+ * @param dec Decodeur
+ * @param b Octet recu
+ * @return true quand une trame complete et valide vient d'etre recue
+ */
+bool SerialFrame_DecodeByte(SerialFrame_Decoder *dec, uint8_t b)
+{
+    switch (dec->state) {
+        case DEC_WAIT_SOF1:
+            if (b == FRAME_SOF1) {
+                dec->state = DEC_WAIT_SOF2; // Premier octet de synchro trouve
+            }
+            break;
+        case DEC_WAIT_SOF2:
+            if (b == FRAME_SOF2) {
+                dec->crc = 0xFFFF; // Nouveau CRC
+                dec->state = DEC_TYPE; // Entete
+            } else if (b != FRAME_SOF1) {
+                dec->state = DEC_WAIT_SOF1; // Fausse synchro
+            }
+            break;
+        case DEC_TYPE:
+            dec->type = b; // Type de trame
+            dec->crc = SerialFrame_Crc16(dec->crc, &b, 1);
+            dec->state = DEC_LEN_L;
+            break;
+        case DEC_LEN_L:
+            dec->len = b; // Longueur, poids faible
+            dec->crc = SerialFrame_Crc16(dec->crc, &b, 1);
+            dec->state = DEC_LEN_H;
+            break;
+        case DEC_LEN_H:
+            dec->len |= (uint16_t) b << 8; // Longueur, poids fort
+            dec->crc = SerialFrame_Crc16(dec->crc, &b, 1);
+            dec->index = 0;
+            if (dec->len > FRAME_MAX_RX_PAYLOAD) {
+                dec->lengthErrors++; // Trame trop longue, on la rejette
+                dec->state = DEC_WAIT_SOF1;
+            } else if (dec->len == 0) {
+                dec->state = DEC_CRC_L; // Pas de payload
+            } else {
+                dec->state = DEC_PAYLOAD;
+            }
+            break;
+        case DEC_PAYLOAD:
+            dec->payload[dec->index++] = b; // Stocke l'octet
+            dec->crc = SerialFrame_Crc16(dec->crc, &b, 1);
+            if (dec->index >= dec->len) {
+                dec->state = DEC_CRC_L; // Payload complet
+            }
+            break;
+        case DEC_CRC_L:
+            dec->crcRx = b; // CRC, poids faible
+            dec->state = DEC_CRC_H;
+            break;
+        case DEC_CRC_H:
+            dec->crcRx |= (uint16_t) b << 8; // CRC, poids fort
+            dec->state = DEC_WAIT_SOF1; // Pret pour la trame suivante
+            if (dec->crcRx == dec->crc) {
+                dec->framesOk++;
+                return true; // Trame valide
+            }
+            dec->crcErrors++; // Trame corrompue
+            break;
+        default:
+            dec->state = DEC_WAIT_SOF1; // Etat inconnu, resynchro
+            break;
+    }
+    return false;
+}
+
+/**
+ * @brief Lit un entier 16 bits little endian.
+ *
+ * @param p Source (2 octets)
+ * @return Valeur lue
+ */
+uint16_t SerialFrame_GetU16(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | ((uint16_t) p[1] << 8)); // Poids faible en premier
+}
@@ -0,0 +1,128 @@
+/*
+--------------------------------------------------------
+ Fichier : SerialFrame.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations pour le tramage binaire des liaisons serie (RS485 / USB)
+--------------------------------------------------------*/
+
+#ifndef _SERIALFRAME_H_
+#define _SERIALFRAME_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Format d'une trame (little endian) :
+ *
+ *   | 0xA5 | 0x5A | type | lenL | lenH | payload[len] | crcL | crcH |
+ *
+ * Le CRC16-CCITT (poly 0x1021, init 0xFFFF) couvre type, len et payload.
+ */
+
+// Premier octet de synchronisation
+#define FRAME_SOF1              0xA5
+// Second octet de synchronisation
+#define FRAME_SOF2              0x5A
+// Taille de l'entete (SOF1, SOF2, type, len)
+#define FRAME_HEADER_SIZE       5
+// Taille du CRC en fin de trame
+#define FRAME_CRC_SIZE          2
+// Octets ajoutes autour du payload
+#define FRAME_OVERHEAD          (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)
+// Taille maximale d'un payload
+#define FRAME_MAX_PAYLOAD       512
+
+// Taille maximale d'un payload recu (commandes)
+#define FRAME_MAX_RX_PAYLOAD    64
+
+// Types de trames
+#define FRAME_TYPE_TELEMETRY    0x01 // Paquet de telemetrie periodique
+#define FRAME_TYPE_RAW_ACC      0x20 // Bloc brut accelerometre (flux USB)
+#define FRAME_TYPE_RAW_CAPTURE  0x21 // Captures IR brutes (flux USB)
+#define FRAME_TYPE_STREAM_STATUS 0x22 // Compteurs du flux USB
+
+/**
+ * @brief Etat du decodeur de trames recues (un par liaison).
+ */
+typedef struct {
+    uint8_t state;                          // Etape de decodage courante
+    uint8_t type;                           // Type de la trame en cours
+    uint16_t len;                           // Longueur annoncee du payload
+    uint16_t index;                         // Octets de payload deja recus
+    uint16_t crc;                           // CRC calcule au fil de l'eau
+    uint16_t crcRx;                         // CRC recu
+    uint8_t payload[FRAME_MAX_RX_PAYLOAD];  // Payload de la trame
+    uint32_t framesOk;                      // Trames valides
+    uint32_t crcErrors;                     // Trames rejetees sur le CRC
+    uint32_t lengthErrors;                  // Trames rejetees sur la longueur
+} SerialFrame_Decoder;
+
+/**
+ * @brief Calcule le CRC16-CCITT d'un bloc d'octets.
+ *
+ * @param crc Valeur initiale (0xFFFF pour un nouveau calcul)
+ * @param data Pointeur sur les donnees
+ * @param len Nombre d'octets
+ * @return CRC mis a jour
+ */
+uint16_t SerialFrame_Crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Construit une trame complete dans un buffer de sortie.
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload (peut etre NULL si len = 0)
+ * @param len Taille du payload
+ * @param out Buffer de sortie
+ * @param outSize Taille du buffer de sortie
+ * @return Nombre d'octets ecrits, 0 si le buffer est trop petit
+ */
+uint16_t SerialFrame_Encode(uint8_t type, const uint8_t *payload, uint16_t len,
+                            uint8_t *out, uint16_t outSize);
+
+/**
+ * @brief Remet un decodeur dans l'etat d'attente de synchro.
+ *
+ * @param dec Decodeur a initialiser
+ */
+void SerialFrame_DecoderInit(SerialFrame_Decoder *dec);
+
+/**
+ * @brief Fait avancer le decodeur d'un octet.
+ *
+ * @details
+ * Machine d'etats non bloquante : se resynchronise sur 0xA5 0x5A apres
+ * toute erreur. Le payload reste valide jusqu'au prochain appel.
+ *
+ * @param dec Decodeur
+ * @param b Octet recu
+ * @return true quand une trame complete et valide vient d'etre recue
+ */
+bool SerialFrame_DecodeByte(SerialFrame_Decoder *dec, uint8_t b);
+
+/**
+ * @brief Lit un entier 16 bits little endian.
+ *
+ * @param p Source (2 octets)
+ * @return Valeur lue
+ */
+uint16_t SerialFrame_GetU16(const uint8_t *p);
+
+/**
+ * @brief Ecrit un entier 16 bits en little endian.
+ *
+ * @param p Destination (2 octets)
+ * @param v Valeur a ecrire
+ */
+void SerialFrame_PutU16(uint8_t *p, uint16_t v);
+
+/**
+ * @brief Ecrit un entier 32 bits en little endian.
+ *
+ * @param p Destination (4 octets)
+ * @param v Valeur a ecrire
+ */
+void SerialFrame_PutU32(uint8_t *p, uint32_t v);
+
+#endif
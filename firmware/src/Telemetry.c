@@ -0,0 +1,145 @@
+/*
+--------------------------------------------------------
+ Fichier : Telemetry.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Envoi periodique de paquets de telemetrie sur la liaison RS485
+--------------------------------------------------------
+*/
+// Inclusion du header telemetrie
+#include "Telemetry.h" // Prototypes de la telemetrie
+// Inclusion du header RS485
+#include "Rs485.h" // Emission par DMA
+// Inclusion du header de tramage
+#include "SerialFrame.h" // Types de trames et ecriture little endian
+// Inclusion du header application
+#include "app.h" // Donnees de l'application (temps)
+// Inclusion du header mesure
+#include "Mesure.h" // Instantane de mesure
+
+static uint16_t periodMs = TELEMETRY_PERIOD_DEFAULT_MS; // Periode d'emission
+static uint32_t lastSendMs = 0; // Instant du dernier envoi
+static uint16_t sequence = 0; // Numero de sequence
+static uint16_t spectrum[TELEMETRY_MAX_BINS]; // Spectre decime a envoyer
+static uint8_t spectrumBins = 0; // Nombre de raies en attente (0 = aucune)
+// Payload en construction
+static uint8_t payload[TELEMETRY_HEADER_SIZE + (2 * TELEMETRY_MAX_BINS)];
+
+/**
+ * @brief Initialise la telemetrie (sequence, periode par defaut).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Telemetry_Init(void)
+{
+    periodMs = TELEMETRY_PERIOD_DEFAULT_MS; // Periode par defaut
+    lastSendMs = appData.tickMs; // Premier envoi dans une periode
+    sequence = 0; // Repart de 0
+    spectrumBins = 0; // Pas de spectre en attente
+}
+
+/**
+ * @brief Regle la periode d'emission.
+ *
+ * @param newPeriodMs Periode en millisecondes (0 = desactive)
+ * @return Aucun retour.
+ */
+void Telemetry_SetPeriod(uint16_t newPeriodMs)
+{
+    periodMs = newPeriodMs; // Nouvelle periode
+}
+
+/**
+ * @brief Retourne la periode d'emission courante.
+ *
+ * @return Periode en millisecondes (0 = desactive)
+ */
+uint16_t Telemetry_GetPeriod(void)
+{
+    return periodMs; // Periode courante
+}
+
+/**
+ * @brief Joint un spectre au prochain paquet.
+ *
+ * @details
+ * Chaque raie envoyee est le maximum d'un groupe de raies consecutives, ce qui
+ * conserve les pics meme apres decimation.
+ *
+ * @param bins Amplitudes des raies
+ * @param nbBins Nombre de raies
+ * @return Aucun retour.
+ */
+void Telemetry_SetSpectrum(const uint16_t *bins, uint16_t nbBins)
+{
+    uint16_t factor; // Facteur de decimation
+    uint16_t i; // Index de la raie decimee
+    uint16_t j; // Index dans le groupe
+
+    if ((bins == 0) || (nbBins == 0)) {
+        spectrumBins = 0; // Rien a joindre
+        return;
+    }
+
+    factor = (uint16_t) ((nbBins + TELEMETRY_MAX_BINS - 1) / TELEMETRY_MAX_BINS); // Arrondi superieur
+    spectrumBins = 0;
+    for (i = 0; i < nbBins; i += factor) {
+        uint16_t peak = 0; // Maximum du groupe
+        for (j = i; (j < i + factor) && (j < nbBins); j++) {
+            if (bins[j] > peak) {
+                peak = bins[j]; // Garde le pic
+            }
+        }
+        spectrum[spectrumBins++] = peak; // Raie decimee
+    }
+}
+
+/**
+ * @brief Tache non bloquante d'emission, a appeler depuis APP_Tasks.
+ *
+ * @details
+ * Si la periode est ecoulee et que l'emetteur est libre, le paquet est
+ * construit puis confie au DMA. Sinon la fonction retourne immediatement.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Telemetry_Task(void)
+{
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+    uint16_t len = TELEMETRY_HEADER_SIZE; // Taille du payload
+    uint8_t i; // Index des raies
+    uint32_t rpm; // RPM borne a 16 bits
+    Mesure_Snapshot m; // Mesure courante coherente
+
+    if ((periodMs == 0) || ((uint32_t) (now - lastSendMs) < periodMs)) {
+        return; // Pas encore l'heure
+    }
+    if (Rs485_IsBusy()) {
+        return; // Trame precedente pas encore sortie
+    }
+
+    Mesure_Get(&m); // RPM, confiance et mode du meme calcul
+    rpm = m.rpm; // Copie du RPM courant
+    if (rpm > 0xFFFF) {
+        rpm = 0xFFFF; // Saturation sur 16 bits
+    }
+
+    SerialFrame_PutU16(&payload[0], sequence); // Numero de sequence
+    SerialFrame_PutU32(&payload[2], now); // Horodatage
+    SerialFrame_PutU16(&payload[6], (uint16_t) rpm); // RPM
+    payload[8] = m.confidence; // Confiance
+    payload[9] = m.mode; // Mode de mesure
+    payload[10] = spectrumBins; // Nombre de raies jointes
+    for (i = 0; i < spectrumBins; i++) {
+        SerialFrame_PutU16(&payload[len], spectrum[i]); // Raie decimee
+        len += 2;
+    }
+
+    if (Rs485_SendFrame(FRAME_TYPE_TELEMETRY, payload, len)) {
+        lastSendMs = now; // Prochaine echeance
+        sequence++; // Paquet suivant
+        spectrumBins = 0; // Spectre envoye une seule fois
+    }
+}
@@ -0,0 +1,71 @@
+/*
+--------------------------------------------------------
+ Fichier : Telemetry.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations pour l'envoi periodique de la telemetrie (RPM, spectre)
+--------------------------------------------------------*/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Payload d'un paquet FRAME_TYPE_TELEMETRY (little endian) :
+ *
+ *   seq (u16) | timestamp ms (u32) | rpm (u16) | confiance % (u8) | mode (u8)
+ *   | nbBins (u8) | bins[nbBins] (u16)
+ *
+ * nbBins vaut 0 quand aucun spectre n'est joint au paquet.
+ */
+
+// Periode d'emission par defaut [ms]
+#define TELEMETRY_PERIOD_DEFAULT_MS 100
+// Nombre maximal de raies de spectre par paquet
+#define TELEMETRY_MAX_BINS          64
+// Taille de l'entete fixe du payload
+#define TELEMETRY_HEADER_SIZE       11
+
+/**
+ * @brief Initialise la telemetrie (sequence, periode par defaut).
+ */
+void Telemetry_Init(void);
+
+/**
+ * @brief Regle la periode d'emission.
+ *
+ * @details
+ * Une periode plus courte que la duree d'une trame revient a emettre au
+ * debit de la ligne. 0 desactive l'emission.
+ *
+ * @param newPeriodMs Periode en millisecondes
+ */
+void Telemetry_SetPeriod(uint16_t newPeriodMs);
+
+/**
+ * @brief Retourne la periode d'emission courante.
+ *
+ * @return Periode en millisecondes (0 = desactive)
+ */
+uint16_t Telemetry_GetPeriod(void);
+
+/**
+ * @brief Joint un spectre au prochain paquet.
+ *
+ * @details
+ * Le spectre est decime (maximum par groupe de raies) pour tenir dans
+ * TELEMETRY_MAX_BINS. Il est envoye une seule fois.
+ *
+ * @param bins Amplitudes des raies
+ * @param nbBins Nombre de raies
+ */
+void Telemetry_SetSpectrum(const uint16_t *bins, uint16_t nbBins);
+
+/**
+ * @brief Tache non bloquante d'emission, a appeler depuis APP_Tasks.
+ */
+void Telemetry_Task(void);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+--------------------------------------------------------
+ Fichier : Timebase.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Horodatage fin base sur le Core Timer
+--------------------------------------------------------
+*/
+// Inclusion du header base de temps
+#include "Timebase.h" // Prototypes de la base de temps
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Frequence systeme
+
+static uint32_t ticksPerUs = SYS_CLK_FREQ / 2000000UL; // Core Timer = SYSCLK / 2
+static uint32_t lastLow = 0; // Derniere valeur lue du Core Timer
+static uint32_t high = 0; // Nombre de debordements du Core Timer
+
+/**
+ * @brief Memorise la frequence du Core Timer.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Timebase_Init(void)
+{
+    ticksPerUs = SYS_CLK_SystemFrequencyGet() / 2000000UL; // SYSCLK / 2 en MHz
+    if (ticksPerUs == 0) {
+        ticksPerUs = 1; // Evite une division par zero
+    }
+}
+
+/**
+ * @brief Horodatage monotone 64 bits en ticks du Core Timer.
+ *
+ * @details
+ * Un debordement est detecte quand la valeur lue est inferieure a la
+ * precedente. La lecture est faite interruptions masquees pour que
+ * l'ISR Timer1 et la boucle principale ne comptent pas deux fois le meme.
+ *
+ * @param Aucun parametre.
+ * @return Valeur du Core Timer prolongee sur 64 bits
+ */
+uint64_t Timebase_Now64(void)
+{
+    unsigned int status = __builtin_disable_interrupts(); // Lecture atomique
+    uint32_t low = _CP0_GET_COUNT(); // Partie basse
+    uint64_t now; // Resultat
+
+    if (low < lastLow) {
+        high++; // Le Core Timer a deborde
+    }
+    lastLow = low;
+    now = ((uint64_t) high << 32) | low;
+
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+    return now;
+}
+
+/**
+ * @brief Nombre de ticks du Core Timer par microseconde.
+ *
+ * @return Ticks par us
+ */
+uint32_t Timebase_TicksPerUs(void)
+{
+    return ticksPerUs;
+}
+
+/**
+ * @brief Convertit une duree en microsecondes.
+ *
+ * @param ticks Duree en ticks du Core Timer
+ * @return Duree en us
+ */
+uint32_t Timebase_TicksToUs(uint32_t ticks)
+{
+    return ticks / ticksPerUs;
+}
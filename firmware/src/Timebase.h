@@ -0,0 +1,62 @@
+/*
+--------------------------------------------------------
+ Fichier : Timebase.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Horodatage fin base sur le Core Timer (jamais remis a zero)
+--------------------------------------------------------*/
+
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+#include <xc.h> // Acces au Core Timer
+#include <stdint.h> // Types entiers standard
+
+/*
+ * Le Core Timer compte a SYSCLK / 2 et deborde sur 32 bits (~43 s a
+ * 200 MHz). Aucun module ne doit le remettre a zero : une duree se calcule
+ * par difference non signee, correcte meme au debordement.
+ *
+ * Timebase_Now64 prolonge le compteur sur 64 bits (monotone, sans
+ * debordement en pratique). Elle doit etre appelee au moins une fois par
+ * tour du Core Timer : le callback Timer1 s'en charge chaque ms.
+ */
+
+/**
+ * @brief Memorise la frequence du Core Timer.
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief Horodatage courant en ticks du Core Timer.
+ *
+ * @return Valeur du Core Timer
+ */
+static inline uint32_t Timebase_Now(void)
+{
+    return _CP0_GET_COUNT(); // Lecture d'un registre CP0, quelques cycles
+}
+
+/**
+ * @brief Horodatage monotone 64 bits en ticks du Core Timer.
+ *
+ * @return Valeur du Core Timer prolongee sur 64 bits
+ */
+uint64_t Timebase_Now64(void);
+
+/**
+ * @brief Nombre de ticks du Core Timer par microseconde.
+ *
+ * @return Ticks par us
+ */
+uint32_t Timebase_TicksPerUs(void);
+
+/**
+ * @brief Convertit une duree en microsecondes.
+ *
+ * @param ticks Duree en ticks du Core Timer
+ * @return Duree en us
+ */
+uint32_t Timebase_TicksToUs(uint32_t ticks);
+
+#endif
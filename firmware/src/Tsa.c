@@ -0,0 +1,194 @@
+/*
+--------------------------------------------------------
+ Fichier : Tsa.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Moyenne synchrone du tour (TSA) et spectre d'ordres
+--------------------------------------------------------
+*/
+// Inclusion du header moyenne synchrone
+#include "Tsa.h" // Prototypes de la moyenne synchrone
+// Inclusion du header FFT
+#include "Fft.h" // Spectre de la revolution moyenne
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaines IR et vibration
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Sensibilite de l'accelerometre
+// Inclusion du header calcul RPM
+#include "RpmCalc.h" // Frequence de la base de temps IC
+#include <math.h> // Pour sqrtf
+#include <string.h> // Pour memset
+
+static bool running = false; // Moyenne en cours
+static float mean[3][TSA_BINS]; // Revolution moyenne par axe [LSB]
+static float weight[TSA_BINS]; // Poids cumule par angle
+static uint32_t revMin = 0; // Premier tour de la moyenne (numero de capture IC3)
+static uint32_t lastRev = 0; // Tour du dernier echantillon
+static uint16_t revs = 0; // Tours integres
+static float lastRpm = 0.0f; // Regime du dernier tour
+static Fft_Cplx buf[TSA_BINS]; // Revolution puis spectre
+
+/**
+ * @brief Demarre une moyenne (angles a zero, tours a partir de maintenant).
+ *
+ * @param Aucun parametre.
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool Tsa_Start(void)
+{
+    if (!MesureEngine_IsRunning(MESURE_PIPE_IR) || !MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        return false;
+    }
+    memset(mean, 0, sizeof(mean));
+    memset(weight, 0, sizeof(weight));
+    revMin = RevSync_MarkerNow(); // Tours ouverts a partir de maintenant
+    lastRev = revMin - 1;
+    revs = 0;
+    lastRpm = 0.0f;
+    running = true;
+    return true;
+}
+
+/**
+ * @brief Arrete la moyenne (la derniere revolution moyenne reste lisible).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Tsa_Stop(void)
+{
+    running = false;
+}
+
+/**
+ * @brief Indique si la moyenne recoit des echantillons.
+ *
+ * @param Aucun parametre.
+ * @return true entre Tsa_Start et Tsa_Stop
+ */
+bool Tsa_IsRunning(void)
+{
+    return running;
+}
+
+/**
+ * @brief Ajoute une valeur ponderee a la moyenne d'un angle.
+ *
+ * @param bin Angle
+ * @param w Poids (0-1)
+ * @param xyz Axes bruts
+ * @return Aucun retour.
+ */
+static void Tsa_Splat(uint8_t bin, float w, const int16_t *xyz)
+{
+    float g; // Gain de la mise a jour
+    uint8_t k; // Axe
+
+    if (w <= 0.0f) {
+        return;
+    }
+    weight[bin] += w;
+    if (weight[bin] > TSA_MAX_WEIGHT) {
+        weight[bin] = TSA_MAX_WEIGHT; // Moyenne exponentielle
+    }
+    g = w / weight[bin];
+    for (k = 0; k < 3; k++) {
+        mean[k][bin] += g * ((float) xyz[k] - mean[k][bin]);
+    }
+}
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @param smp Echantillon date
+ * @return Aucun retour.
+ */
+void Tsa_Add(const RevSync_Sample *smp)
+{
+    float pos; // Angle de l'echantillon [angles]
+    uint8_t b0; // Angle qui precede
+    float f; // Position entre b0 et l'angle suivant
+
+    if (!running || ((int32_t) (smp->rev - revMin) < 0)) {
+        return;
+    }
+    if (smp->rev != lastRev) {
+        lastRev = smp->rev;
+        lastRpm = (60.0f * (float) RPMCALC_TIMER_FREQ) / (float) smp->period;
+        if (revs < 0xFFFF) {
+            revs++;
+        }
+    }
+
+    pos = smp->turn * (float) TSA_BINS;
+    b0 = (uint8_t) pos;
+    if (b0 >= TSA_BINS) {
+        b0 = TSA_BINS - 1; // turn arrondi a 1
+    }
+    f = pos - (float) b0;
+    Tsa_Splat(b0, 1.0f - f, smp->xyz);
+    Tsa_Splat((uint8_t) ((b0 + 1) % TSA_BINS), f, smp->xyz);
+}
+
+/**
+ * @brief Revolution moyenne d'un axe.
+ *
+ * @param axis Axe (0 = X, 1 = Y, 2 = Z)
+ * @param bins Valeur moyenne par angle [LSB], TSA_BINS valeurs
+ * @return false si un angle n'a encore recu aucune valeur
+ */
+bool Tsa_GetRevolution(uint8_t axis, float *bins)
+{
+    bool full = true; // Tous les angles remplis
+    uint8_t i; // Angle
+
+    for (i = 0; i < TSA_BINS; i++) {
+        bins[i] = mean[axis % 3][i];
+        if (weight[i] <= 0.0f) {
+            full = false;
+        }
+    }
+    return full;
+}
+
+/**
+ * @brief Spectre d'ordres de la revolution moyenne (trois FFT de TSA_BINS points).
+ *
+ * @details
+ * Amplitude crete de l'ordre k : 2 |X[k]| / TSA_BINS. Le spectre n'est
+ * valide que lorsque tous les angles ont recu une valeur.
+ *
+ * @param out Spectre d'ordres
+ * @return Aucun retour.
+ */
+void Tsa_GetOrders(Tsa_Orders *out)
+{
+    uint8_t i; // Angle ou ordre
+    uint8_t k; // Axe
+
+    memset(out, 0, sizeof(*out));
+    out->revs = revs;
+    out->rpm = lastRpm;
+    out->valid = true;
+    for (i = 0; i < TSA_BINS; i++) {
+        if (weight[i] <= 0.0f) {
+            out->valid = false; // Angle jamais atteint
+        }
+    }
+    if (!out->valid) {
+        return;
+    }
+
+    for (k = 0; k < 3; k++) {
+        for (i = 0; i < TSA_BINS; i++) {
+            buf[i].re = mean[k][i];
+            buf[i].im = 0.0f;
+        }
+        Fft_Forward(buf, TSA_BINS);
+        for (i = 0; i < TSA_ORDERS; i++) {
+            const Fft_Cplx *x = &buf[i + 1]; // Raie de l'ordre i + 1
+
+            out->ampMg[k][i] = (2.0f / (float) TSA_BINS) * sqrtf(x->re * x->re + x->im * x->im) * LIS2HH12_MG_PER_LSB;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+--------------------------------------------------------
+ Fichier : Tsa.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Moyenne synchrone du tour (TSA) et spectre d'ordres
+--------------------------------------------------------*/
+
+#ifndef _TSA_H_
+#define _TSA_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include "RevSync.h" // Echantillons dates dans leur tour
+
+/*
+ * Le tour est decoupe en TSA_BINS angles fixes. Chaque echantillon date
+ * (RevSync) est reparti sur les deux angles qui l'encadrent, avec des
+ * poids lineaires en sa position, et chaque angle tient une moyenne
+ * ponderee incrementale m += w (v - m) / W. La FIFO echantillonne a des
+ * angles differents d'un tour a l'autre : au fil des tours, tous les
+ * angles se remplissent et les vibrations non synchrones du tour
+ * decroissent en 1 / sqrt(n). Une interpolation entre echantillons
+ * successifs attenuerait les ordres eleves (moins de 10 echantillons par
+ * tour a 3000 RPM) ; la repartition sur deux angles voisins ne les
+ * attenue que de sinc^2(k / TSA_BINS).
+ *
+ * Au-dela d'un poids TSA_MAX_WEIGHT, W reste fixe et la moyenne devient
+ * exponentielle (suit une derive lente du balourd ou du regime).
+ * Memoire fixe : TSA_BINS x 3 axes. Cout fixe par echantillon : deux angles.
+ *
+ * Le spectre d'ordres est la FFT de la revolution moyenne : la raie k est
+ * l'ordre k (k fois par tour), quel que soit le regime.
+ */
+
+#define TSA_BINS        64      // Angles par tour (puissance de 2, FFT)
+#define TSA_ORDERS      16      // Ordres rapportes (1 a TSA_ORDERS)
+#define TSA_MAX_WEIGHT  64.0f   // Poids par angle au-dela duquel la moyenne devient exponentielle
+
+/**
+ * @brief Spectre d'ordres de la revolution moyenne.
+ */
+typedef struct {
+    bool valid;                         // Tous les angles ont recu une valeur
+    uint16_t revs;                      // Tours integres (sature a 65535)
+    float rpm;                          // Regime du dernier tour
+    float ampMg[3][TSA_ORDERS];         // Amplitude de l'ordre k + 1 par axe [mg]
+} Tsa_Orders;
+
+/**
+ * @brief Demarre une moyenne (angles a zero, tours a partir de maintenant).
+ *
+ * @return false si les chaines IR et vibration ne tournent pas
+ */
+bool Tsa_Start(void);
+
+/**
+ * @brief Arrete la moyenne (la derniere revolution moyenne reste lisible).
+ */
+void Tsa_Stop(void);
+
+/**
+ * @brief Indique si la moyenne recoit des echantillons.
+ *
+ * @return true entre Tsa_Start et Tsa_Stop
+ */
+bool Tsa_IsRunning(void);
+
+/**
+ * @brief Integre un echantillon date dans son tour (chaine vibration).
+ *
+ * @param smp Echantillon date
+ */
+void Tsa_Add(const RevSync_Sample *smp);
+
+/**
+ * @brief Revolution moyenne d'un axe.
+ *
+ * @param axis Axe (0 = X, 1 = Y, 2 = Z)
+ * @param bins Valeur moyenne par angle [LSB], TSA_BINS valeurs
+ * @return false si un angle n'a encore recu aucune valeur
+ */
+bool Tsa_GetRevolution(uint8_t axis, float *bins);
+
+/**
+ * @brief Spectre d'ordres de la revolution moyenne (trois FFT de TSA_BINS points).
+ *
+ * @param out Spectre d'ordres
+ */
+void Tsa_GetOrders(Tsa_Orders *out);
+
+#endif
@@ -0,0 +1,291 @@
+/*
+--------------------------------------------------------
+ Fichier : UsbStream.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Export de donnees brutes par le pont USB-UART (UART4 + DMA ping-pong)
+--------------------------------------------------------
+*/
+// Inclusion du header du flux USB
+#include "UsbStream.h" // Prototypes du flux USB
+// Inclusion du header de tramage
+#include "SerialFrame.h" // Construction des trames
+// Inclusion du header application
+#include "app.h" // Base de temps
+// Inclusion de la configuration systeme
+#include "system_config.h" // Configuration systeme (broches)
+// Inclusion des definitions systeme
+#include "system_definitions.h" // Definitions systeme (PLIB, SFR)
+
+// Buffers ping-pong lus par le DMA (hors cache)
+static uint8_t __attribute__((coherent, aligned(16))) buffers[2][USB_STREAM_BUFFER_SIZE];
+static uint8_t fillIndex = 0; // Buffer en cours de remplissage
+static uint16_t fillLen = 0; // Octets deja places dans ce buffer
+static volatile bool dmaBusy = false; // Un buffer est en cours d'emission
+static volatile bool active = false; // Flux demande par le PC (XON)
+static UsbStream_Stats stats; // Compteurs du flux
+static uint32_t lastStatusMs = 0; // Instant de la derniere trame d'etat
+
+// FIFO des captures IR : ecrite par l'ISR IC3, lue par la tache
+static volatile uint32_t captures[USB_STREAM_CAPTURE_FIFO];
+static volatile uint16_t capHead = 0; // Index d'ecriture (ISR)
+static volatile uint16_t capTail = 0; // Index de lecture (tache)
+
+/**
+ * @brief Alimente le pont USB et initialise UART4 + DMA1.
+ *
+ * @details
+ * UART4 : 8N1, BRGH = 1, emission par DMA1 declenche par U4TX, reception
+ * lue par scrutation (seulement XON / XOFF). Le flux demarre suspendu.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void UsbStream_Init(void)
+{
+    uint32_t pbclk = SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_2); // Horloge de l'UART
+
+    USB_EN_Off(); // Active le pont USB-UART (USB_EN_ actif bas)
+
+    U4MODE = 0; // UART a l'arret, 8N1
+    U4STA = 0; // Emetteur et recepteur desactives
+    U4MODEbits.BRGH = 1; // Diviseur par 4
+    U4BRG = ((pbclk + (2 * USB_STREAM_BAUDRATE)) / (4 * USB_STREAM_BAUDRATE)) - 1; // Arrondi au plus proche
+    U4STAbits.UTXISEL = 0; // IRQ TX tant que la FIFO n'est pas pleine
+    U4STAbits.UTXEN = 1; // Active l'emetteur
+    U4STAbits.URXEN = 1; // Active le recepteur (controle de flux)
+    U4MODEbits.ON = 1; // Active l'UART
+
+    DMACONSET = _DMACON_ON_MASK; // Active le controleur DMA
+    DCH1CON = 0; // Canal a l'arret
+    DCH1CONbits.CHPRI = 1; // Moins prioritaire que la liaison RS485
+    DCH1ECON = (_UART4_TX_VECTOR << _DCH1ECON_CHSIRQ_POSITION) | _DCH1ECON_SIRQEN_MASK; // Declenche par U4TX
+    DCH1DSA = KVA_TO_PA(&U4TXREG); // Destination : registre d'emission
+    DCH1DSIZ = 1; // Destination sur 1 octet
+    DCH1CSIZ = 1; // 1 octet par declenchement
+    DCH1INTCLR = 0x00FF00FF; // Efface flags et autorisations
+    DCH1INTSET = _DCH1INT_CHBCIE_MASK; // Interruption en fin de bloc
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_DMA1, INT_PRIORITY_LEVEL1); // Fin de bloc : libere le buffer, sans contrainte de latence (IsrPrio_Apply fixe ensuite le niveau com)
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_DMA1, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_DMA_1); // Efface le flag
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_DMA_1); // Active l'interruption DMA1
+
+    fillIndex = 0; // Commence par le buffer 0
+    fillLen = 0;
+    dmaBusy = false;
+    active = false; // Attente du XON du PC
+    capHead = 0;
+    capTail = 0;
+    lastStatusMs = appData.tickMs;
+}
+
+/**
+ * @brief Ajoute une trame au buffer en cours de remplissage.
+ *
+ * @details
+ * La trame est encodee directement dans le buffer ping-pong libre. Si elle
+ * ne tient plus, elle est perdue et comptee (le DMA n'est jamais attendu).
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload
+ * @param len Taille du payload
+ * @return true si la trame est placee, false si elle est perdue
+ */
+bool UsbStream_PushFrame(uint8_t type, const uint8_t *payload, uint16_t len)
+{
+    uint16_t written; // Taille de la trame encodee
+
+    if (!active) {
+        return false; // Flux non demande
+    }
+
+    written = SerialFrame_Encode(type, payload, len, &buffers[fillIndex][fillLen],
+            (uint16_t) (USB_STREAM_BUFFER_SIZE - fillLen)); // Encode en place
+    if (written == 0) {
+        stats.frameOverflows++; // Buffer plein
+        return false;
+    }
+    fillLen += written; // Avance dans le buffer
+    stats.framesQueued++;
+    return true;
+}
+
+/**
+ * @brief Exporte un bloc d'echantillons bruts de l'accelerometre.
+ *
+ * @details
+ * Payload : horodatage ms (u32), nombre d'echantillons (u8), puis X, Y, Z
+ * (int16) pour chaque echantillon.
+ *
+ * @param xyz Echantillons X, Y, Z entrelaces
+ * @param nbSamples Nombre d'echantillons
+ * @return true si le bloc est place
+ */
+bool UsbStream_PushAcc(const int16_t *xyz, uint8_t nbSamples)
+{
+    uint8_t payload[5 + (6 * 32)]; // Entete + 32 echantillons maximum
+    uint16_t len = 5; // Taille du payload
+    uint8_t i;
+
+    if (!active) {
+        return false; // Flux non demande
+    }
+    if (nbSamples > 32) {
+        nbSamples = 32; // Un bloc = une FIFO LIS2HH12
+    }
+
+    SerialFrame_PutU32(&payload[0], appData.tickMs); // Horodatage du bloc
+    payload[4] = nbSamples; // Nombre d'echantillons
+    for (i = 0; i < (uint8_t) (nbSamples * 3); i++) {
+        SerialFrame_PutU16(&payload[len], (uint16_t) xyz[i]); // Valeur brute
+        len += 2;
+    }
+    return UsbStream_PushFrame(FRAME_TYPE_RAW_ACC, payload, len);
+}
+
+/**
+ * @brief Memorise une capture IR (appele depuis l'ISR IC3).
+ *
+ * @param capture Valeur du timer 32 bits au front
+ * @return Aucun retour.
+ */
+void UsbStream_PushCaptureIsr(uint32_t capture)
+{
+    uint16_t next; // Prochain index d'ecriture
+
+    if (!active) {
+        return; // Flux non demande
+    }
+    next = (capHead + 1) & (USB_STREAM_CAPTURE_FIFO - 1);
+    if (next == capTail) {
+        stats.captureOverflows++; // FIFO pleine
+        return;
+    }
+    captures[capHead] = capture; // Stocke la capture
+    capHead = next; // Publie la capture
+}
+
+/**
+ * @brief Indique si le PC a demande le flux (XON recu).
+ *
+ * @return true si le flux est actif
+ */
+bool UsbStream_IsActive(void)
+{
+    return active;
+}
+
+/**
+ * @brief Retourne les compteurs du flux.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const UsbStream_Stats* UsbStream_GetStats(void)
+{
+    return &stats;
+}
+
+/**
+ * @brief Regroupe les captures IR en attente dans des trames.
+ *
+ * @details
+ * Payload : nombre de captures (u8) puis les valeurs du timer 10 MHz (u32).
+ * Les places de la FIFO ne sont liberees qu'une fois la trame placee : si le
+ * buffer est plein, les captures attendent et l'ISR compte celles qui ne
+ * trouvent plus de place (captureOverflows).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void UsbStream_FlushCaptures(void)
+{
+    uint8_t payload[1 + (4 * USB_STREAM_CAPTURES_PER_FRAME)]; // Trame de captures
+    uint8_t n; // Captures dans la trame
+    uint16_t tail = capTail; // Copie locale de l'index de lecture
+
+    while (tail != capHead) {
+        n = 0;
+        while ((tail != capHead) && (n < USB_STREAM_CAPTURES_PER_FRAME)) {
+            SerialFrame_PutU32(&payload[1 + (4 * n)], captures[tail]); // Capture brute
+            tail = (tail + 1) & (USB_STREAM_CAPTURE_FIFO - 1);
+            n++;
+        }
+        payload[0] = n; // Nombre de captures
+        if (!UsbStream_PushFrame(FRAME_TYPE_RAW_CAPTURE, payload, (uint16_t) (1 + (4 * n)))) {
+            break; // Buffer plein : les captures restent dans la FIFO jusqu'au prochain appel
+        }
+        capTail = tail; // Trame placee, libere les places dans la FIFO
+    }
+}
+
+/**
+ * @brief Tache non bloquante : controle de flux, captures et bascule des buffers.
+ *
+ * @details
+ * Lit XON / XOFF, emballe les captures, envoie periodiquement une trame
+ * d'etat, puis, si le DMA est libre, lui confie le buffer rempli et bascule
+ * le remplissage sur l'autre buffer.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void UsbStream_Task(void)
+{
+    uint32_t now = appData.tickMs; // Temps courant [ms]
+
+    while (U4STAbits.URXDA) {
+        uint8_t c = (uint8_t) U4RXREG; // Caractere du PC
+        if (c == USB_STREAM_XON) {
+            active = true; // Demarre le flux
+        } else if (c == USB_STREAM_XOFF) {
+            active = false; // Suspend le flux
+        }
+    }
+    if (U4STAbits.OERR) {
+        U4STAbits.OERR = 0; // Acquitte l'overrun
+    }
+
+    if (!active) {
+        capTail = capHead; // Oublie les captures en attente
+        return;
+    }
+
+    UsbStream_FlushCaptures(); // Captures IR en attente
+
+    if ((uint32_t) (now - lastStatusMs) >= USB_STREAM_STATUS_PERIOD_MS) {
+        uint8_t status[16]; // Trame d'etat
+        SerialFrame_PutU32(&status[0], stats.framesQueued);
+        SerialFrame_PutU32(&status[4], stats.bytesSent);
+        SerialFrame_PutU32(&status[8], stats.frameOverflows);
+        SerialFrame_PutU32(&status[12], stats.captureOverflows);
+        if (UsbStream_PushFrame(FRAME_TYPE_STREAM_STATUS, status, sizeof (status))) {
+            lastStatusMs = now; // Prochaine trame d'etat
+        }
+    }
+
+    if (!dmaBusy && (fillLen > 0)) {
+        dmaBusy = true; // Buffer confie au DMA
+        DCH1SSA = KVA_TO_PA(buffers[fillIndex]); // Source : buffer rempli
+        DCH1SSIZ = fillLen; // Taille a emettre
+        DCH1INTCLR = _DCH1INT_CHBCIF_MASK; // Efface la fin de bloc precedente
+        DCH1CONSET = _DCH1CON_CHEN_MASK; // Active le canal
+        DCH1ECONSET = _DCH1ECON_CFORCE_MASK; // Force le premier transfert
+        stats.bytesSent += fillLen;
+
+        fillIndex ^= 1; // Remplissage sur l'autre buffer
+        fillLen = 0;
+    }
+}
+
+/**
+ * @brief Callback de fin de bloc DMA (appele depuis l'ISR DMA1).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void UsbStream_DmaTxCallback(void)
+{
+    DCH1INTCLR = _DCH1INT_CHBCIF_MASK; // Acquitte la fin de bloc
+    dmaBusy = false; // Le buffer peut etre reutilise
+}
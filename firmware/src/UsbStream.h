@@ -0,0 +1,105 @@
+/*
+--------------------------------------------------------
+ Fichier : UsbStream.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Declarations pour l'export de donnees brutes vers le PC (pont USB)
+--------------------------------------------------------*/
+
+#ifndef _USBSTREAM_H_
+#define _USBSTREAM_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * La carte n'a pas de stack USB : le port USB passe par un pont USB-UART
+ * relie a UART4 (RB6 / RB7). Le PC voit donc un port COM virtuel.
+ *
+ * Les trames SerialFrame sont accumulees dans un buffer pendant que l'autre
+ * est emis par DMA (ping-pong). Controle de flux logiciel : le PC envoie
+ * XON (0x11) pour demarrer le flux et XOFF (0x13) pour le suspendre.
+ * Au demarrage le flux est suspendu.
+ */
+
+// Debit du pont USB-UART (BRG exact a 25 MHz, BRGH = 1)
+#define USB_STREAM_BAUDRATE     1562500
+// Taille de chaque buffer du ping-pong
+#define USB_STREAM_BUFFER_SIZE  2048
+// Taille de la FIFO des captures IR (puissance de 2)
+#define USB_STREAM_CAPTURE_FIFO 256
+// Captures par trame FRAME_TYPE_RAW_CAPTURE
+#define USB_STREAM_CAPTURES_PER_FRAME 32
+// Periode de la trame d'etat [ms]
+#define USB_STREAM_STATUS_PERIOD_MS 1000
+
+// Caracteres de controle de flux
+#define USB_STREAM_XON          0x11
+#define USB_STREAM_XOFF         0x13
+
+/**
+ * @brief Compteurs du flux USB.
+ */
+typedef struct {
+    uint32_t framesQueued;      // Trames placees dans un buffer
+    uint32_t bytesSent;         // Octets confies au DMA
+    uint32_t frameOverflows;    // Trames perdues (buffer plein)
+    uint32_t captureOverflows;  // Captures perdues (FIFO pleine)
+} UsbStream_Stats;
+
+/**
+ * @brief Alimente le pont USB et initialise UART4 + DMA1.
+ */
+void UsbStream_Init(void);
+
+/**
+ * @brief Ajoute une trame au buffer en cours de remplissage.
+ *
+ * @param type Type de la trame (FRAME_TYPE_xxx)
+ * @param payload Pointeur sur le payload
+ * @param len Taille du payload
+ * @return true si la trame est placee, false si elle est perdue
+ */
+bool UsbStream_PushFrame(uint8_t type, const uint8_t *payload, uint16_t len);
+
+/**
+ * @brief Exporte un bloc d'echantillons bruts de l'accelerometre.
+ *
+ * @param xyz Echantillons X, Y, Z entrelaces
+ * @param nbSamples Nombre d'echantillons
+ * @return true si le bloc est place
+ */
+bool UsbStream_PushAcc(const int16_t *xyz, uint8_t nbSamples);
+
+/**
+ * @brief Memorise une capture IR (appele depuis l'ISR IC3).
+ *
+ * @param capture Valeur du timer 32 bits au front
+ */
+void UsbStream_PushCaptureIsr(uint32_t capture);
+
+/**
+ * @brief Indique si le PC a demande le flux (XON recu).
+ *
+ * @return true si le flux est actif
+ */
+bool UsbStream_IsActive(void);
+
+/**
+ * @brief Retourne les compteurs du flux.
+ *
+ * @return Pointeur sur les statistiques (lecture seule)
+ */
+const UsbStream_Stats* UsbStream_GetStats(void);
+
+/**
+ * @brief Tache non bloquante : controle de flux, captures et bascule des buffers.
+ */
+void UsbStream_Task(void);
+
+/**
+ * @brief Callback de fin de bloc DMA (appele depuis l'ISR DMA1).
+ */
+void UsbStream_DmaTxCallback(void);
+
+#endif
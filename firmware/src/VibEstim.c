@@ -0,0 +1,225 @@
+/*
+--------------------------------------------------------
+ Fichier : VibEstim.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Estimateur spectral de la frequence d'allumage sur l'accelerometre
+--------------------------------------------------------
+*/
+// Inclusion du header estimateur vibration
+#include "VibEstim.h" // Prototypes de l'estimateur
+// Inclusion du header FFT
+#include "Fft.h" // FFT complexe
+#include <math.h> // Pour cosf
+#include <string.h> // Pour memset
+
+#define VIBESTIM_PI 3.14159265358979f // Pi en simple precision
+#define VIBESTIM_OVERLAP_CORR 0.167f // Correlation de deux periodogrammes Hann recouverts de moitie
+
+static int16_t ring[3][VIBESTIM_N]; // Fenetre glissante par axe
+static uint16_t writeIdx = 0; // Prochaine case ecrite (= plus ancien point)
+static uint16_t filled = 0; // Points valides dans la fenetre
+static uint16_t fresh = 0; // Points recus depuis la derniere estimation
+static float hann[VIBESTIM_N]; // Fenetre de Hann
+static Fft_Cplx buf[VIBESTIM_N]; // Echantillons puis spectre, puis tri de la mediane
+static float power[VIBESTIM_N / 2]; // Puissance moyennee des trois axes par raie
+static uint16_t frames = 0; // Spectres moyennes
+static float binHz = 0.0f; // Resolution d'une raie [Hz]
+static VibEstim_Result result; // Derniere estimation
+
+/**
+ * @brief Vide la fenetre et la moyenne, calcule la fenetre de Hann.
+ *
+ * @param sampleHz Frequence d'echantillonnage de l'accelerometre [Hz]
+ * @return Aucun retour.
+ */
+void VibEstim_Init(float sampleHz)
+{
+    uint16_t k; // Index de la fenetre
+
+    for (k = 0; k < VIBESTIM_N; k++) {
+        hann[k] = 0.5f - 0.5f * cosf((2.0f * VIBESTIM_PI * (float) k) / (float) VIBESTIM_N);
+    }
+    memset(ring, 0, sizeof(ring));
+    memset(power, 0, sizeof(power));
+    memset(&result, 0, sizeof(result));
+    writeIdx = 0;
+    filled = 0;
+    fresh = 0;
+    frames = 0;
+    binHz = sampleHz / (float) VIBESTIM_N;
+    result.binHz = binHz;
+}
+
+/**
+ * @brief Charge deux axes centres et fenetres dans le buffer de la FFT.
+ *
+ * @param re Axe place en partie reelle
+ * @param im Axe place en partie imaginaire (0 = aucun)
+ * @return Aucun retour.
+ */
+static void VibEstim_Load(const int16_t *re, const int16_t *im)
+{
+    int32_t sumRe = 0; // Somme de l'axe reel
+    int32_t sumIm = 0; // Somme de l'axe imaginaire
+    float meanRe; // Composante continue (gravite) de l'axe reel
+    float meanIm; // Composante continue de l'axe imaginaire
+    uint16_t i; // Index dans la fenetre glissante
+    uint16_t k; // Index dans le buffer (du plus ancien au plus recent)
+
+    for (k = 0; k < VIBESTIM_N; k++) {
+        sumRe += re[k];
+        if (im != 0) {
+            sumIm += im[k];
+        }
+    }
+    meanRe = (float) sumRe / (float) VIBESTIM_N;
+    meanIm = (float) sumIm / (float) VIBESTIM_N;
+
+    i = writeIdx;
+    for (k = 0; k < VIBESTIM_N; k++) {
+        buf[k].re = ((float) re[i] - meanRe) * hann[k];
+        buf[k].im = (im != 0) ? (((float) im[i] - meanIm) * hann[k]) : 0.0f;
+        i = (i + 1) % VIBESTIM_N;
+    }
+}
+
+/**
+ * @brief Degres de liberte d'une raie de bruit de la moyenne courante.
+ *
+ * @details
+ * Une moyenne exponentielle de coefficient alpha equivaut a
+ * (2 - alpha) / alpha spectres independants ; le recouvrement de moitie
+ * des fenetres de Hann les correle (facteur 1 + 2 rho sur la variance).
+ *
+ * @return Degres de liberte (2 par axe et par spectre independant)
+ */
+static float VibEstim_Dof(void)
+{
+    float span = (2.0f - VIBESTIM_AVG_ALPHA) / VIBESTIM_AVG_ALPHA; // Spectres de la moyenne etablie
+
+    if ((float) frames < span) {
+        span = (float) frames; // Moyenne cumulee
+    }
+    return 6.0f * (1.0f + (span - 1.0f) / (1.0f + 2.0f * VIBESTIM_OVERLAP_CORR));
+}
+
+/**
+ * @brief Moyenne des spectres des trois axes puis recherche de la raie.
+ *
+ * @details
+ * Pour Z = FFT(x + j y) : |X(k)|^2 + |Y(k)|^2 = (|Z(k)|^2 + |Z(N-k)|^2) / 2.
+ * Le nouveau spectre entre dans la moyenne axe par axe (la moyenne est
+ * lineaire) : aucun tableau de puissance supplementaire. La mediane de
+ * la bande est cherchee dans le buffer de la FFT, libre a ce moment.
+ * La raie est affinee par la parabole passant par ses deux voisines.
+ *
+ * @param nowMs Instant du dernier echantillon [ms]
+ * @return Aucun retour.
+ */
+static void VibEstim_Estimate(uint32_t nowMs)
+{
+    uint16_t kMin = (uint16_t) ceilf(VIBESTIM_MIN_HZ / binHz); // Premiere raie recherchee
+    uint16_t kPeak; // Raie la plus forte
+    uint16_t k; // Index de raie
+    float alpha; // Poids du nouveau spectre
+    float keep; // Poids de la moyenne precedente
+    float dof; // Degres de liberte d'une raie de bruit
+    float a, b, c; // Raie et ses voisines
+    float den; // Courbure de la parabole
+    float delta = 0.0f; // Decalage de l'extremum [raies]
+
+    if (kMin < 2) {
+        kMin = 2; // Jamais la raie continue ni sa voisine
+    }
+    if (frames < 0xFFFF) {
+        frames++;
+    }
+    alpha = 1.0f / (float) frames;
+    if (alpha < VIBESTIM_AVG_ALPHA) {
+        alpha = VIBESTIM_AVG_ALPHA; // Moyenne etablie : exponentielle
+    }
+    keep = 1.0f - alpha;
+
+    VibEstim_Load(ring[0], ring[1]); // X + j Y
+    (void) Fft_Forward(buf, VIBESTIM_N);
+    for (k = 1; k < (VIBESTIM_N / 2); k++) {
+        const Fft_Cplx *p = &buf[k];
+        const Fft_Cplx *q = &buf[VIBESTIM_N - k];
+        power[k] = (keep * power[k])
+            + (0.5f * alpha * ((p->re * p->re) + (p->im * p->im) + (q->re * q->re) + (q->im * q->im)));
+    }
+
+    VibEstim_Load(ring[2], 0); // Z seul
+    (void) Fft_Forward(buf, VIBESTIM_N);
+    for (k = 1; k < (VIBESTIM_N / 2); k++) {
+        power[k] += alpha * ((buf[k].re * buf[k].re) + (buf[k].im * buf[k].im));
+    }
+
+    kPeak = kMin;
+    for (k = kMin; k < (VIBESTIM_N / 2); k++) {
+        buf[k - kMin].re = power[k]; // Copie triee par la mediane
+        if ((k < ((VIBESTIM_N / 2) - 1)) && (power[k] > power[kPeak])) {
+            kPeak = k; // La derniere raie n'a pas de voisine haute
+        }
+    }
+
+    a = power[kPeak - 1];
+    b = power[kPeak];
+    c = power[kPeak + 1];
+    den = a - 2.0f * b + c;
+    if (den < 0.0f) {
+        delta = 0.5f * (a - c) / den; // Dans [-0.5, 0.5] pour un maximum local
+    }
+
+    dof = VibEstim_Dof();
+    result.noise = Fft_NoiseFloor(buf, (VIBESTIM_N / 2) - kMin, dof);
+    result.threshold = Fft_SnrThreshold(dof, VIBESTIM_SNR_Z);
+    result.frames = frames;
+    result.freqHz = ((float) kPeak + delta) * binHz;
+    result.snr = (result.noise > 0.0f) ? (b / result.noise) : 0.0f;
+    result.valid = (result.snr >= result.threshold);
+    result.timeMs = nowMs;
+}
+
+/**
+ * @brief Ajoute des echantillons et estime la raie si la fenetre a avance.
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param nowMs Instant du dernier echantillon [ms]
+ * @return true si une nouvelle estimation est disponible
+ */
+bool VibEstim_Push(const int16_t *xyz, uint8_t nb, uint32_t nowMs)
+{
+    uint8_t s; // Index d'echantillon
+
+    for (s = 0; s < nb; s++) {
+        ring[0][writeIdx] = xyz[3 * s];
+        ring[1][writeIdx] = xyz[3 * s + 1];
+        ring[2][writeIdx] = xyz[3 * s + 2];
+        writeIdx = (writeIdx + 1) % VIBESTIM_N;
+        if (filled < VIBESTIM_N) {
+            filled++;
+        }
+        fresh++;
+    }
+
+    if ((filled < VIBESTIM_N) || (fresh < VIBESTIM_HOP)) {
+        return false; // Fenetre incomplete ou pas assez avancee
+    }
+    fresh = 0;
+    VibEstim_Estimate(nowMs);
+    return true;
+}
+
+/**
+ * @brief Copie de la derniere estimation.
+ *
+ * @param out Copie de l'estimation
+ * @return Aucun retour.
+ */
+void VibEstim_Get(VibEstim_Result *out)
+{
+    *out = result;
+}
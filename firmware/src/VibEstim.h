@@ -0,0 +1,81 @@
+/*
+--------------------------------------------------------
+ Fichier : VibEstim.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Estimateur spectral de la frequence d'allumage sur l'accelerometre
+--------------------------------------------------------*/
+
+#ifndef _VIBESTIM_H_
+#define _VIBESTIM_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Les echantillons XYZ de la FIFO du LIS2HH12 remplissent une fenetre
+ * glissante de VIBESTIM_N points par axe. Tous les VIBESTIM_HOP nouveaux
+ * points, chaque axe est centre et pondere par une fenetre de Hann, puis
+ * les spectres de puissance des trois axes sont sommes : deux FFT
+ * complexes suffisent (X et Y dans la meme FFT, separes par symetrie).
+ *
+ * Les spectres successifs sont moyennes (Welch) directement dans le
+ * tableau de puissance : moyenne cumulee sur les premiers spectres puis
+ * exponentielle de coefficient VIBESTIM_AVG_ALPHA (constante de temps de
+ * 1 / alpha spectres, 1,3 s a 400 Hz). La variance du bruit baisse avec
+ * le nombre de spectres moyennes, pas la raie.
+ *
+ * Le plancher de bruit est la mediane de la bande, ramenee a la moyenne
+ * d'un chi-deux dont les degres de liberte suivent la moyenne (2 par axe
+ * et par spectre independant, fenetres recouvertes de moitie corrigees).
+ * La raie la plus forte au-dessus de VIBESTIM_MIN_HZ est affinee par
+ * interpolation parabolique. Elle n'est retenue que si son rapport au
+ * bruit depasse le quantile du bruit a VIBESTIM_SNR_Z ecarts : le seuil
+ * vaut 4,7 sur un spectre seul et 2,2 une fois la moyenne etablie.
+ */
+
+#define VIBESTIM_N          256     // Points par fenetre (puissance de 2)
+#define VIBESTIM_HOP        128     // Nouveaux points entre deux estimations
+#define VIBESTIM_MIN_HZ     5.0f    // Raie la plus basse recherchee [Hz]
+#define VIBESTIM_AVG_ALPHA  0.25f   // Poids du nouveau spectre une fois la moyenne etablie
+#define VIBESTIM_SNR_Z      3.7f    // Ecart normal du seuil (fausse alarme 1e-4 par raie)
+
+/**
+ * @brief Derniere estimation.
+ */
+typedef struct {
+    bool valid;             // Raie retenue
+    float freqHz;           // Frequence de la raie [Hz]
+    float binHz;            // Resolution d'une raie [Hz]
+    float snr;              // Raie / puissance moyenne du bruit
+    float threshold;        // Seuil de SNR applique
+    float noise;            // Puissance moyenne du bruit par raie
+    uint16_t frames;        // Spectres moyennes depuis l'initialisation
+    uint32_t timeMs;        // Instant du dernier echantillon de la fenetre [ms]
+} VibEstim_Result;
+
+/**
+ * @brief Vide la fenetre et la moyenne, calcule la fenetre de Hann.
+ *
+ * @param sampleHz Frequence d'echantillonnage de l'accelerometre [Hz]
+ */
+void VibEstim_Init(float sampleHz);
+
+/**
+ * @brief Ajoute des echantillons et estime la raie si la fenetre a avance.
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param nowMs Instant du dernier echantillon [ms]
+ * @return true si une nouvelle estimation est disponible
+ */
+bool VibEstim_Push(const int16_t *xyz, uint8_t nb, uint32_t nowMs);
+
+/**
+ * @brief Copie de la derniere estimation.
+ *
+ * @param out Copie de l'estimation
+ */
+void VibEstim_Get(VibEstim_Result *out);
+
+#endif
@@ -0,0 +1,389 @@
+/*
+--------------------------------------------------------
+ Fichier : Zoom.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Zoom FFT de l'accelerometre autour de la raie attendue du profil
+--------------------------------------------------------
+*/
+// Inclusion du header zoom FFT
+#include "Zoom.h" // Prototypes du zoom
+// Inclusion du header FFT
+#include "Fft.h" // FFT complexe
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Chaine vibration, tours par cycle
+// Inclusion du header filtre de fusion
+#include "RpmFusion.h" // Regime du centre en mode suivi
+// Inclusion du header capteur LIS2HH12
+#include "LIS2HH12.h" // Frequence d'echantillonnage
+// Inclusion du header application
+#include "app.h" // Profil actif (pales, cylindres)
+#include <math.h> // Pour sinf, cosf, fabsf
+#include <string.h> // Pour memset, memmove
+
+#define ZOOM_PI 3.14159265358979f // Pi en simple precision
+#define ZOOM_SIN_SIZE 256 // Points de la table sinus (puissance de 2)
+#define ZOOM_FIR_TAPS 31 // Coefficients du demi-bande
+#define ZOOM_MIN_HZ (ZOOM_BAND_HZ + 5.0f) // Centre le plus bas (image en -2 fc hors bande)
+#define ZOOM_MAX_HZ ((0.5f * (float) LIS2HH12_ODR_HZ) - ZOOM_BAND_HZ) // Centre le plus haut
+#define ZOOM_CIC_GAIN ((float) (ZOOM_CIC_R * ZOOM_CIC_R * ZOOM_CIC_R)) // Gain R^ORDER du CIC
+
+// Demi-bande (fenetre de Hamming, coupure fs / 4) : coefficients des retards impairs 1, 3, ..., 15
+static const float halfBand[8] = {
+    0.3156196f, -0.0969383f, 0.0490990f, -0.0267850f, 0.0140939f, -0.0067301f, 0.0029373f, -0.0017004f
+};
+#define ZOOM_HALFBAND_CENTER 0.5008082f // Coefficient central
+
+/**
+ * @brief Etat d'une voie (un axe, I ou Q).
+ */
+typedef struct {
+    uint32_t integ[ZOOM_CIC_ORDER]; // Integrateurs du CIC (modulo 2^32)
+    uint32_t delay[ZOOM_CIC_ORDER]; // Retards des peignes du CIC
+    float fir[ZOOM_FIR_TAPS]; // Ligne a retard du demi-bande (0 = plus recent)
+} Zoom_Channel;
+
+static bool running = false; // Zoom en cours
+static bool fixedCenter = false; // Centre impose par Zoom_Start
+static bool tuned = false; // Oscillateur local regle
+static uint8_t line = ZOOM_LINE_BLADE; // Raie suivie
+static float hzPerRpm = 0.0f; // Frequence de la raie par RPM (profil au demarrage)
+static float centerHz = 0.0f; // Centre de la bande [Hz]
+static uint32_t phase = 0; // Phase de l'oscillateur local (2^32 = un tour)
+static uint32_t phaseStep = 0; // Pas de phase par echantillon
+static int16_t sinTab[ZOOM_SIN_SIZE]; // Sinus Q15
+static bool sinReady = false; // Tables calculees
+static bool dcReady = false; // Passe-haut amorce
+static int32_t dcQ8[3]; // Composante continue par axe [LSB Q8]
+static Zoom_Channel chan[3][2]; // Voies par axe : I puis Q
+static uint8_t cicCount = 0; // Echantillons depuis la derniere sortie du CIC
+static bool firPhase = false; // Sortie du CIC qui produit un point decime
+static uint8_t settle = 0; // Points decimes ignores apres un reglage (regime transitoire)
+
+static Fft_Cplx ring[3][ZOOM_N]; // Fenetre glissante complexe par axe
+static uint16_t writeIdx = 0; // Prochaine case ecrite (= plus ancien point)
+static uint16_t filled = 0; // Points valides dans la fenetre
+static uint16_t fresh = 0; // Points recus depuis le dernier spectre
+static float hann[ZOOM_N]; // Fenetre de Hann
+static Fft_Cplx buf[ZOOM_N]; // Points puis spectre
+static float power[ZOOM_N]; // Puissance des trois axes par raie
+static Zoom_Result result; // Dernier spectre
+
+/**
+ * @brief Regle l'oscillateur local et vide la chaine de decimation.
+ *
+ * @param hz Centre de la bande [Hz]
+ * @return Aucun retour.
+ */
+static void Zoom_Tune(float hz)
+{
+    centerHz = hz;
+    phaseStep = (uint32_t) ((double) hz / (double) LIS2HH12_ODR_HZ * 4294967296.0);
+    phase = 0;
+    memset(chan, 0, sizeof(chan));
+    cicCount = 0;
+    firPhase = false;
+    settle = (ZOOM_FIR_TAPS / 2) + ZOOM_CIC_ORDER; // Lignes a retard encore vides
+    writeIdx = 0;
+    filled = 0;
+    fresh = 0;
+    tuned = true;
+}
+
+/**
+ * @brief Indique si un centre est analysable.
+ *
+ * @param hz Centre [Hz]
+ * @return true si la bande tient entre ZOOM_MIN_HZ et ZOOM_MAX_HZ
+ */
+static bool Zoom_CenterOk(float hz)
+{
+    return (hz >= ZOOM_MIN_HZ) && (hz <= ZOOM_MAX_HZ);
+}
+
+/**
+ * @brief Demarre le zoom.
+ *
+ * @param lineSel Raie suivie (ZOOM_LINE)
+ * @param centerRpm Regime du centre de la bande, 0 = regime du filtre de fusion
+ * @return false si la chaine vibration est arretee, le profil sans pale ou
+ *         cylindre, ou la raie hors de la plage analysable
+ */
+bool Zoom_Start(uint8_t lineSel, uint16_t centerRpm)
+{
+    uint16_t k; // Index de table
+
+    if (!MesureEngine_IsRunning(MESURE_PIPE_VIB)) {
+        return false;
+    }
+    if (lineSel == ZOOM_LINE_BLADE) {
+        hzPerRpm = (float) appData.nbBlades / 60.0f;
+    } else if (lineSel == ZOOM_LINE_FIRING) {
+        hzPerRpm = (float) appData.nbCylindres / (60.0f * (float) MESURE_ENGINE_REVS_PER_CYCLE);
+    } else {
+        return false; // Raie inconnue
+    }
+    if (hzPerRpm <= 0.0f) {
+        return false; // Profil sans pale ou cylindre
+    }
+    if ((centerRpm != 0) && !Zoom_CenterOk((float) centerRpm * hzPerRpm)) {
+        return false;
+    }
+
+    if (!sinReady) {
+        for (k = 0; k < ZOOM_SIN_SIZE; k++) {
+            sinTab[k] = (int16_t) (32767.0f * sinf((2.0f * ZOOM_PI * (float) k) / (float) ZOOM_SIN_SIZE));
+        }
+        for (k = 0; k < ZOOM_N; k++) {
+            hann[k] = 0.5f - 0.5f * cosf((2.0f * ZOOM_PI * (float) k) / (float) ZOOM_N);
+        }
+        sinReady = true;
+    }
+    line = lineSel;
+    memset(&result, 0, sizeof(result));
+    dcReady = false;
+    tuned = false;
+    fixedCenter = (centerRpm != 0);
+    if (fixedCenter) {
+        Zoom_Tune((float) centerRpm * hzPerRpm);
+    }
+    running = true;
+    return true;
+}
+
+/**
+ * @brief Arrete le zoom (le dernier spectre reste lisible).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Zoom_Stop(void)
+{
+    running = false;
+}
+
+/**
+ * @brief Indique si le zoom recoit des echantillons.
+ *
+ * @param Aucun parametre.
+ * @return true entre Zoom_Start et Zoom_Stop
+ */
+bool Zoom_IsRunning(void)
+{
+    return running;
+}
+
+/**
+ * @brief Integrateurs du CIC d'une voie.
+ *
+ * @param c Voie
+ * @param in Echantillon melange
+ * @return Aucun retour.
+ */
+static inline void Zoom_Integrate(Zoom_Channel *c, int32_t in)
+{
+    c->integ[0] += (uint32_t) in;
+    c->integ[1] += c->integ[0];
+    c->integ[2] += c->integ[1];
+}
+
+/**
+ * @brief Peignes du CIC puis ligne a retard du demi-bande d'une voie.
+ *
+ * @param c Voie
+ * @return Aucun retour.
+ */
+static void Zoom_Comb(Zoom_Channel *c)
+{
+    uint32_t v = c->integ[ZOOM_CIC_ORDER - 1]; // Sortie des integrateurs
+    uint32_t t; // Entree du peigne
+    uint8_t j; // Etage
+
+    for (j = 0; j < ZOOM_CIC_ORDER; j++) {
+        t = v;
+        v -= c->delay[j];
+        c->delay[j] = t;
+    }
+    memmove(&c->fir[1], &c->fir[0], (ZOOM_FIR_TAPS - 1) * sizeof(float));
+    c->fir[0] = (float) (int32_t) v / ZOOM_CIC_GAIN;
+}
+
+/**
+ * @brief Sortie du demi-bande d'une voie.
+ *
+ * @param c Voie
+ * @return Point decime
+ */
+static float Zoom_HalfBand(const Zoom_Channel *c)
+{
+    const uint8_t mid = ZOOM_FIR_TAPS / 2; // Retard central
+    float y = ZOOM_HALFBAND_CENTER * c->fir[mid]; // Terme central
+    uint8_t i; // Coefficient
+
+    for (i = 0; i < 8; i++) {
+        uint8_t m = (uint8_t) (2 * i + 1); // Retard impair
+        y += halfBand[i] * (c->fir[mid - m] + c->fir[mid + m]);
+    }
+    return y;
+}
+
+/**
+ * @brief Spectre des trois axes et recherche de la raie dans la bande.
+ *
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+static void Zoom_Estimate(uint32_t nowMs)
+{
+    const float binHz = (float) LIS2HH12_ODR_HZ / (float) (ZOOM_DECIM * ZOOM_N); // Resolution
+    int16_t kBand = (int16_t) (ZOOM_BAND_HZ / binHz); // Raies de part et d'autre du centre
+    int16_t kPeak = 0; // Raie la plus forte (relative au centre)
+    int16_t kk; // Raie relative au centre
+    uint16_t i, k; // Index dans la fenetre, dans le buffer
+    uint8_t axis; // Axe
+    float noise; // Puissance moyenne du bruit par raie
+    float a, b, c; // Raie et ses voisines
+    float den; // Courbure de la parabole
+    float delta = 0.0f; // Decalage de l'extremum [raies]
+
+    memset(power, 0, sizeof(power));
+    for (axis = 0; axis < 3; axis++) {
+        i = writeIdx;
+        for (k = 0; k < ZOOM_N; k++) {
+            buf[k].re = ring[axis][i].re * hann[k];
+            buf[k].im = ring[axis][i].im * hann[k];
+            i = (i + 1) % ZOOM_N;
+        }
+        (void) Fft_Forward(buf, ZOOM_N);
+        for (k = 0; k < ZOOM_N; k++) {
+            power[k] += (buf[k].re * buf[k].re) + (buf[k].im * buf[k].im);
+        }
+    }
+
+    for (kk = -kBand; kk <= kBand; kk++) {
+        float p = power[(uint16_t) (kk + ZOOM_N) % ZOOM_N]; // Raie kk
+
+        buf[kk + kBand].re = p; // Copie triee par la mediane
+        if (p > power[(uint16_t) (kPeak + ZOOM_N) % ZOOM_N]) {
+            kPeak = kk;
+        }
+    }
+    a = power[(uint16_t) (kPeak - 1 + ZOOM_N) % ZOOM_N];
+    b = power[(uint16_t) (kPeak + ZOOM_N) % ZOOM_N];
+    c = power[(uint16_t) (kPeak + 1 + ZOOM_N) % ZOOM_N];
+    den = a - 2.0f * b + c;
+    if (den < 0.0f) {
+        delta = 0.5f * (a - c) / den; // Dans [-0.5, 0.5] pour un maximum local
+    }
+
+    result.line = line;
+    result.centerHz = centerHz;
+    result.binHz = binHz;
+    result.freqHz = centerHz + ((float) kPeak + delta) * binHz;
+    result.rpm = result.freqHz / hzPerRpm;
+    result.rpmPerBin = binHz / hzPerRpm;
+    noise = Fft_NoiseFloor(buf, (uint16_t) (2 * kBand + 1), 6.0f); // 2 degres par axe, spectre seul
+    result.threshold = Fft_SnrThreshold(6.0f, ZOOM_SNR_Z);
+    result.snr = (noise > 0.0f) ? (b / noise) : 0.0f;
+    result.valid = (result.snr >= result.threshold);
+    result.timeMs = nowMs;
+}
+
+/**
+ * @brief Ajoute des echantillons de l'accelerometre (chaine vibration).
+ *
+ * @details
+ * En mode suivi, la bande n'est recentree que si la raie attendue au
+ * regime du filtre de fusion s'eloigne de ZOOM_RETUNE_HZ : recentrer vide
+ * la fenetre (un spectre ne melange jamais deux centres).
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param nowMs Temps courant [ms]
+ * @return Aucun retour.
+ */
+void Zoom_Push(const int16_t *xyz, uint8_t nb, uint32_t nowMs)
+{
+    uint8_t s; // Echantillon
+    uint8_t k; // Axe
+
+    if (!running) {
+        return;
+    }
+    if (!fixedCenter) {
+        RpmFusion_Output f; // Regime filtre
+        float want; // Raie attendue [Hz]
+
+        RpmFusion_Get(&f, nowMs);
+        want = f.rpm * hzPerRpm;
+        if (f.valid && Zoom_CenterOk(want) && (!tuned || (fabsf(want - centerHz) > ZOOM_RETUNE_HZ))) {
+            Zoom_Tune(want);
+        }
+    }
+    if (!tuned) {
+        return; // Aucun regime connu
+    }
+    if (!dcReady && (nb > 0)) {
+        for (k = 0; k < 3; k++) {
+            dcQ8[k] = (int32_t) xyz[k] * 256; // Amorce sur le premier echantillon
+        }
+        dcReady = true;
+    }
+
+    for (s = 0; s < nb; s++) {
+        uint8_t idx = (uint8_t) (phase >> 24); // Index de la table sinus
+        int32_t sn = sinTab[idx]; // sin(phase) Q15
+        int32_t cs = sinTab[(uint8_t) (idx + (ZOOM_SIN_SIZE / 4))]; // cos(phase) Q15
+
+        phase += phaseStep;
+        for (k = 0; k < 3; k++) {
+            int32_t x = (int32_t) xyz[3 * s + k]; // Echantillon brut
+
+            dcQ8[k] += ((x * 256) - dcQ8[k]) / 256; // Passe-haut : constante de 256 echantillons
+            x -= dcQ8[k] / 256;
+            Zoom_Integrate(&chan[k][0], (x * cs) / 32768); // I = x cos
+            Zoom_Integrate(&chan[k][1], -(x * sn) / 32768); // Q = -x sin
+        }
+
+        if (++cicCount < ZOOM_CIC_R) {
+            continue;
+        }
+        cicCount = 0;
+        for (k = 0; k < 3; k++) {
+            Zoom_Comb(&chan[k][0]);
+            Zoom_Comb(&chan[k][1]);
+        }
+        firPhase = !firPhase;
+        if (!firPhase) {
+            continue; // Demi-bande : une sortie sur deux
+        }
+        if (settle > 0) {
+            settle--;
+            continue;
+        }
+        for (k = 0; k < 3; k++) {
+            ring[k][writeIdx].re = Zoom_HalfBand(&chan[k][0]);
+            ring[k][writeIdx].im = Zoom_HalfBand(&chan[k][1]);
+        }
+        writeIdx = (writeIdx + 1) % ZOOM_N;
+        if (filled < ZOOM_N) {
+            filled++;
+        }
+        fresh++;
+        if ((filled == ZOOM_N) && (fresh >= ZOOM_HOP)) {
+            fresh = 0;
+            Zoom_Estimate(nowMs);
+        }
+    }
+}
+
+/**
+ * @brief Copie du dernier spectre.
+ *
+ * @param out Copie du spectre
+ * @return Aucun retour.
+ */
+void Zoom_Get(Zoom_Result *out)
+{
+    *out = result;
+}
@@ -0,0 +1,110 @@
+/*
+--------------------------------------------------------
+ Fichier : Zoom.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Zoom FFT de l'accelerometre autour de la raie attendue du profil
+--------------------------------------------------------*/
+
+#ifndef _ZOOM_H_
+#define _ZOOM_H_
+
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+
+/*
+ * Le profil actif donne la raie attendue pour un regime : passage de
+ * pales (RPM x pales / 60) ou allumage (RPM x cylindres / 120). La bande
+ * est centree sur cette raie au regime fixe demande, ou au regime du
+ * filtre de fusion (recentree quand la raie s'eloigne de ZOOM_RETUNE_HZ).
+ *
+ * Chaine par axe, a l'ODR de l'accelerometre :
+ *   1. composante continue (gravite) retiree par un passe-haut du 1er ordre ;
+ *   2. melange par l'oscillateur local e^(-j 2 pi fc t) (table sinus Q15,
+ *      phase sur 32 bits) : la raie attendue tombe pres de 0 Hz ;
+ *   3. CIC d'ordre ZOOM_CIC_ORDER, decimation ZOOM_CIC_R, en entiers
+ *      (debordements modulo 2^32 sans effet sur la sortie) ;
+ *   4. demi-bande FIR 31 coefficients (8 non nuls par cote), decimation 2 :
+ *      bande utile +-ZOOM_BAND_HZ a moins de 0,1 dB, repliement < -39 dB.
+ * Le flux complexe decime remplit une fenetre de ZOOM_N points ; tous
+ * les ZOOM_HOP points, les spectres des trois axes (fenetre de Hann) sont
+ * sommes et la raie la plus forte de la bande est affinee par interpolation
+ * parabolique. Elle n'est retenue que si son rapport au plancher de bruit
+ * (mediane de la bande) depasse le quantile du bruit a ZOOM_SNR_Z ecarts.
+ *
+ * A 400 Hz : 50 Hz apres decimation, 0,195 Hz par raie (5,9 RPM pour 2
+ * pales, contre 1,56 Hz pour une FFT 256 points directe) avec trois FFT
+ * de 256 points, une fenetre de 5,1 s et un nouveau spectre toutes les
+ * 1,3 s.
+ */
+
+#define ZOOM_CIC_R          4       // Decimation du CIC
+#define ZOOM_CIC_ORDER      3       // Etages du CIC
+#define ZOOM_DECIM          (2 * ZOOM_CIC_R) // Decimation totale (CIC puis demi-bande)
+#define ZOOM_N              256     // Points complexes par fenetre (puissance de 2)
+#define ZOOM_HOP            64      // Nouveaux points entre deux spectres
+#define ZOOM_BAND_HZ        20.0f   // Demi-largeur de la bande analysee [Hz]
+#define ZOOM_RETUNE_HZ      8.0f    // Ecart raie attendue / centre qui recentre la bande [Hz]
+#define ZOOM_SNR_Z          3.7f    // Ecart normal du seuil (fausse alarme 1e-4 par raie)
+
+// Raie suivie
+typedef enum {
+    ZOOM_LINE_BLADE = 0,    // Passage de pales (nbBlades par tour)
+    ZOOM_LINE_FIRING        // Allumage (nbCylindres par cycle de deux tours)
+} ZOOM_LINE;
+
+/**
+ * @brief Dernier spectre zoome.
+ */
+typedef struct {
+    bool valid;             // Raie retenue
+    uint8_t line;           // Raie suivie (ZOOM_LINE)
+    float centerHz;         // Centre de la bande [Hz]
+    float binHz;            // Resolution d'une raie [Hz]
+    float freqHz;           // Frequence de la raie retenue [Hz]
+    float rpm;              // Regime correspondant
+    float rpmPerBin;        // Resolution en regime [RPM]
+    float snr;              // Raie / puissance moyenne du bruit
+    float threshold;        // Seuil de SNR applique
+    uint32_t timeMs;        // Instant du spectre [ms]
+} Zoom_Result;
+
+/**
+ * @brief Demarre le zoom.
+ *
+ * @param lineSel Raie suivie (ZOOM_LINE)
+ * @param centerRpm Regime du centre de la bande, 0 = regime du filtre de fusion
+ * @return false si la chaine vibration est arretee, le profil sans pale ou
+ *         cylindre, ou la raie hors de la plage analysable
+ */
+bool Zoom_Start(uint8_t lineSel, uint16_t centerRpm);
+
+/**
+ * @brief Arrete le zoom (le dernier spectre reste lisible).
+ */
+void Zoom_Stop(void);
+
+/**
+ * @brief Indique si le zoom recoit des echantillons.
+ *
+ * @return true entre Zoom_Start et Zoom_Stop
+ */
+bool Zoom_IsRunning(void);
+
+/**
+ * @brief Ajoute des echantillons de l'accelerometre (chaine vibration).
+ *
+ * @param xyz Echantillons entrelaces X, Y, Z
+ * @param nb Nombre d'echantillons XYZ
+ * @param nowMs Temps courant [ms]
+ */
+void Zoom_Push(const int16_t *xyz, uint8_t nb, uint32_t nowMs);
+
+/**
+ * @brief Copie du dernier spectre.
+ *
+ * @param out Copie du spectre
+ */
+void Zoom_Get(Zoom_Result *out);
+
+#endif
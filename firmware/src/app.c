@@ -58,6 +58,23 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #include "PotControl.h"    // Inclusion du module de controle du potentiometre
 #include "menu.h"          // Inclusion du module de gestion des menus
 #include "ProfilStorage.h" // Inclusion du module de stockage des profils
+#include "Rs485.h"         // Inclusion du module de liaison RS485
+#include "Telemetry.h"     // Inclusion du module de telemetrie
+#include "CmdProtocol.h"   // Inclusion du protocole de commande a distance
+#include "UsbStream.h"     // Inclusion du flux de donnees brutes vers le PC
+#include "Battery.h"       // Inclusion de la mesure batterie
+#include "PowerMgr.h"      // Inclusion du gestionnaire d'energie
+#include "Profiler.h"      // Inclusion des sondes de temps d'execution
+#include "IsrPrio.h"       // Inclusion des priorites d'interruption
+#include "LatBench.h"      // Inclusion du banc de latence de la capture
+#include "Bench.h"         // Inclusion du banc de performance
+#include "i2c_master.h"    // Inclusion du maitre I2C sur interruptions
+#include "Mesure.h"        // Inclusion de la chaine de mesure RPM
+#include "IrCounter.h"     // Inclusion du compteur IR hybride
+#include "IrPulse.h"       // Inclusion des impulsions IR
+#include "IrCalib.h"       // Inclusion de la calibration du seuil IR
+#include "MesureEngine.h"  // Inclusion du moteur de mesure multi-capteurs
+#include "Fmt.h"           // Inclusion du formatage sans sprintf
 #include "system_config.h" // Inclusion de la configuration systeme
 
 // *****************************************************************************
@@ -86,9 +103,11 @@ APP_DATA appData = {
     .currentMenu = 0,
     .rpmCaptureActive = false,
     .captureIndex = 0,
-    .rpm = 0,
+    .captureCount = 0,
     .nbBlades = 2,
-    .refreshNeeded = true
+    .refreshNeeded = true,
+    .tickMs = 0,
+    .measureMode = MESURE_MODE_AUCUNE
 };
 
 // *****************************************************************************
@@ -118,7 +137,11 @@ void App_Timer1Callback() {
     static uint16_t WaitIteration = 0; // Variable statique qui conserve sa valeur entre appels
     static uint8_t InitDone = 0; // Flag pour indiquer si l'init est terminee
 
-    GestBtn_Update(); // Met a jour l'etat des boutons
+    PROF_BEGIN(PROF_SITE_TIMER1_ISR); // Debut de la sonde
+
+    appData.tickMs++; // Base de temps en millisecondes
+    (void) Timebase_Now64(); // Suit les debordements du Core Timer
+    PowerMgr_TickIsr(); // PWM du retroeclairage
     // Pendant les 3 premieres secondes, on incremente WaitIteration
     if ((WaitIteration <= WAIT_INIT) && (InitDone == 0)) {
         WaitIteration++; // Incremente le compteur d'attente
@@ -139,8 +162,8 @@ void App_Timer1Callback() {
             }
         }
     }
+    PROF_END(PROF_SITE_TIMER1_ISR); // Fin de la sonde
 }
-#define TIMER_FREQ_HZ 100000000UL // 100 MHz timer base (PBCLK3)
 #define PULSES_PER_REV 1          // Nombre de fronts par tour
 
 /**
@@ -148,7 +171,10 @@ void App_Timer1Callback() {
  *
  * @details
  * Cette fonction lit les valeurs capturees par l'input capture et les stocke dans un buffer circulaire
- * si la capture RPM est active.
+ * si la capture RPM est active. En mode porte du compteur IR, la capture
+ * ne sert qu'a la mesure : l'anneau ne recoit que des captures front a front.
+ * En mode deux fronts, seul le front montant d'une impulsion valide est
+ * publie, a son front descendant (parasites rejetes par IrPulse).
  *
  * @param Aucun parametre.
  * @return Aucun retour.
@@ -157,22 +183,39 @@ void App_Timer1Callback() {
  * @post Le buffer de capture est mis a jour avec la nouvelle valeur.
  */
 void DRV_IC3_Callback(void) {
+    uint32_t entryCore = Timebase_Now(); // Entree d'ISR (banc de latence)
+    uint32_t entryTmr = TMR2; // Temps IC a l'entree, lu avant tout traitement
+
     if (!appData.rpmCaptureActive) {
         return; // Si la capture n'est pas active, on quitte
     }
 
+    PROF_BEGIN(PROF_SITE_IC3_ISR); // Debut de la sonde
     if (!DRV_IC0_BufferIsEmpty()) {
         uint32_t cap = DRV_IC0_Capture32BitDataRead(); // Lit la valeur capturee
-        uint8_t i = appData.captureIndex; // Recupere l'index courant du buffer
 
-        appData.captureBuffer[i] = cap; // Stocke la valeur dans le buffer
-        i = i + 1; // Incremente l'index
-        if (i >= RPM_CAPTURE_BUFFER_SIZE) {
-            i = 0; // Revient au debut du buffer si necessaire
-        }
+        // Deux fronts : seul le front descendant d'une impulsion valide publie son front montant
+        if (!IrCounter_DualEdge() || IrPulse_EdgeIsr(&cap)) {
+            uint16_t edges = IrCounter_CaptureIsr(); // Fronts de la porte (compteur T6)
+
+            Mesure_CaptureIsr(cap, edges, appData.tickMs); // Portes pour la mesure visuelle
+            if (IrCounter_PerEdge()) {
+                uint8_t i = appData.captureIndex; // Recupere l'index courant du buffer
+
+                appData.captureBuffer[i] = cap; // Stocke la valeur dans le buffer
+                i = i + 1; // Incremente l'index
+                if (i >= RPM_CAPTURE_BUFFER_SIZE) {
+                    i = 0; // Revient au debut du buffer si necessaire
+                }
 
-        appData.captureIndex = i; // Met a jour l'index du buffer
+                appData.captureIndex = i; // Met a jour l'index du buffer
+                appData.captureCount++; // Compteur libre pour les lecteurs de l'anneau
+                UsbStream_PushCaptureIsr(cap); // Copie brute pour le PC (si flux actif)
+                LatBench_CaptureIsr(cap, entryTmr, entryCore); // Latence et gigue (si banc actif)
+            }
+        }
     }
+    PROF_END(PROF_SITE_IC3_ISR); // Fin de la sonde
 }
 // *****************************************************************************
 // *****************************************************************************
@@ -234,6 +277,43 @@ void APP_Initialize(void) {
 // #define DEBUG_MEMORY  //Si actif execute un essais d'criture en NVM
 // #define DEBUG_POT    //Si lis et affiche le 
 
+/**
+ * @brief Affiche l'ecran de demarrage une fois l'afficheur initialise.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ *
+ * @pre lcd_init_task() doit avoir renvoye true.
+ */
+static void APP_ShowSplash(void) {
+    lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
+    lcd_put_string("Capteur RPM"); // Affiche le texte sur la premiere ligne
+    lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
+    lcd_put_string("LMS"); // Affiche le texte sur la deuxieme ligne
+
+#ifdef DEBUG_POT
+    uint8_t val; // Variable pour stocker la valeur lue
+    char buf[4]; // Valeur formatee
+    if (Pot_Read(POT_INDEX_U3_WIPER0, &val)) {
+        lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
+        lcd_put_string("U3 W0: "); // Affiche le libelle
+        *Fmt_Uint(buf, val, 3) = '\0'; // Formate la valeur lue
+        lcd_put_string(buf); // Affiche la valeur lue
+    } else {
+        lcd_put_string("U3 W0: ERR"); // Affiche une erreur si la lecture echoue
+    }
+
+    lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
+    if (Pot_Read(POT_INDEX_U3_WIPER1, &val)) {
+        lcd_put_string("U3 W1: "); // Affiche le libelle
+        *Fmt_Uint(buf, val, 3) = '\0'; // Formate la valeur lue
+        lcd_put_string(buf); // Affiche la valeur lue
+    } else {
+        lcd_put_string("U3 W1: ERR"); // Affiche une erreur si la lecture echoue
+    }
+#endif
+}
+
 /**
  * @brief Fonction principale de la machine d'etat de l'application.
  *
@@ -248,9 +328,18 @@ void APP_Initialize(void) {
  * @post Les actions correspondant a l'etat courant sont executees.
  */
 void APP_Tasks(void) {
+    if (appData.state != APP_STATE_INIT) {
+        GestBtn_Task(); // Antirebond (fronts dates par l'interruption CN), GestBtn_Init faite dans APP_STATE_INIT
+        i2c_task(); // Timeout et recuperation du bus I2C
+    }
+
     switch (appData.state) {
         case APP_STATE_INIT:
         {
+            Timebase_Init(); // Frequence du Core Timer
+            Profiler_Init(); // Statistiques des sondes a zero
+            Mesure_Init(); // Instantane de mesure a zero
+            MesureEngine_Init(); // Chaines de mesure demarrees au premier creneau lent
             BL_CONTROL_On(); // Allume le retroeclairage
             EN_LDO_On(); // Active le LDO
             IR_EN_Off(); // Desactive l'emetteur IR
@@ -258,49 +347,44 @@ void APP_Tasks(void) {
             Profils_LoadFromNVM(); // Charge les profils depuis la memoire non volatile
             
             SPI_ConfigurePot(); // Configure le potentiometre via SPI
-            lcd_init(); // Initialise l'ecran LCD
+            i2c_init(true); // Maitre I2C sur interruptions, 400 kHz
+            lcd_init_start(); // Lance l'init LCD, terminee pendant l'attente de demarrage
             GestBtn_Init(); // Initialise la gestion des boutons
+            Rs485_Init(); // Initialise la liaison RS485 (UART + DMA)
+            Telemetry_Init(); // Initialise la telemetrie
+            CmdProtocol_Init(); // Initialise le decodeur de commandes
+            UsbStream_Init(); // Initialise le flux USB (suspendu jusqu'au XON)
+            Battery_Init(); // Initialise l'ADC de mesure batterie
+            PowerMgr_Init(); // Coupe les peripheriques inutilises, autorise l'IDLE
+            IsrPrio_Apply(ISR_PRIO_DEFAULT); // Priorites des interruptions
             
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Capteur RPM"); // Affiche le texte sur la premiere ligne
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            lcd_put_string("LMS"); // Affiche le texte sur la deuxieme ligne
-
             DRV_TMR0_Start(); // Demarre le timer principal
 
-            lcd_set_cursor(1, 1); // Replace le curseur sur la premiere ligne
             Pot_Write(POT_INDEX_U5_WIPER0, 70); // Definit la valeur du potentiometre U5 W0
-            Pot_Write(POT_INDEX_U3_WIPER0, 30); // Definit la valeur du potentiometre U3 W0
+            Pot_Write(POT_INDEX_U3_WIPER0, IrCalib_Wiper(appData.selectedProfil)); // Seuil IR du profil (calibre ou par defaut)
             Pot_Write(POT_INDEX_U3_WIPER1, 250); // Definit la valeur du potentiometre U3 W1
 
-#ifdef DEBUG_POT
-            uint8_t val; // Variable pour stocker la valeur lue
-            if (Pot_Read(POT_INDEX_U3_WIPER0, &val)) {
-                lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-                lcd_printf("U3 W0: %3d", val); // Affiche la valeur lue
-            } else {
-                lcd_put_string("U3 W0: ERR"); // Affiche une erreur si la lecture echoue
-            }
-
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            if (Pot_Read(POT_INDEX_U3_WIPER1, &val)) {
-                lcd_printf("U3 W1: %3d", val); // Affiche la valeur lue
-            } else {
-                lcd_put_string("U3 W1: ERR"); // Affiche une erreur si la lecture echoue
-            }
-#endif
             APP_UpdateState(APP_STATE_INIT_WAIT); // Passe a l'etat d'attente d'initialisation
             break;
         }
 
         case APP_STATE_INIT_WAIT:
         {
-            // Tout est gere par le callback Timer1
+            static bool splashShown = false; // Ecran de demarrage affiche
+            // Le passage aux taches de service est gere par le callback Timer1
+            if (!splashShown && lcd_init_task()) {
+                APP_ShowSplash(); // L'afficheur vient d'etre pret
+                splashShown = true;
+            }
             break;
         }
 
         case APP_STATE_WAIT:
         {
+            IrCalib_Task(appData.tickMs); // Balayage du seuil IR (hors creneau de la chaine IR)
+            CmdProtocol_Task(); // Traite les commandes recues
+            Telemetry_Task(); // Emission de la telemetrie si la periode est ecoulee
+            UsbStream_Task(); // Flux de donnees brutes vers le PC
             break;
         }
 
@@ -309,7 +393,19 @@ void APP_Tasks(void) {
 #ifdef DEBUG_MEMORY
             Profils_TestSaveLoad(); // Teste la sauvegarde/lecture des profils (debug)
 #endif
+            MesureEngine_Task(); // Chaines IR, audio et vibration en fond
+            Mesure_Task(); // Publie l'instantane de mesure avant l'affichage
+            PROF_BEGIN(PROF_SITE_MENU_TASK); // Debut de la sonde
             Menu_Task(); // Execute la tche du menu
+            PROF_END(PROF_SITE_MENU_TASK); // Fin de la sonde
+            IrCalib_SaveTask(); // Seuil IR calibre en NVM (si retenu)
+            CmdProtocol_Task(); // Traite les commandes recues
+            Telemetry_Task(); // Emission de la telemetrie si la periode est ecoulee
+            UsbStream_Task(); // Flux de donnees brutes vers le PC
+            Battery_Task(); // Une conversion batterie par creneau lent
+            PowerMgr_Task(); // Retroeclairage et estimation d'energie
+            LatBench_Task(); // Banc de latence (si lance)
+            Bench_Task(); // Banc de performance (si lance)
             APP_UpdateState(APP_STATE_WAIT); // Passe a l'etat d'attente
             break;
         }
@@ -97,7 +97,15 @@ extern "C" {
     } APP_STATES;
 
 #define WAIT_INIT 2999 // Nombre d'iterations approximatives pour 3 secondes
-#define RPM_CAPTURE_BUFFER_SIZE 8 // Taille du buffer de capture RPM
+#define RPM_CAPTURE_BUFFER_SIZE 32 // Taille du buffer de capture RPM (couvre un pas de la chaine vibration)
+
+    /* Modes de mesure (transmis dans la telemetrie) */
+    typedef enum {
+        MESURE_MODE_AUCUNE = 0, // Pas de mesure en cours
+        MESURE_MODE_VISUEL, // Mesure optique (IR)
+        MESURE_MODE_AUDIO, // Mesure par le microphone
+        MESURE_MODE_VIBRATION // Mesure par l'accelerometre
+    } MESURE_MODE;
 
     // *****************************************************************************
 
@@ -118,18 +126,42 @@ extern "C" {
         uint8_t state; // etat courant de l'application
         uint8_t currentMenu; // Menu courant selectionne
 
+        // Ecrits par l'ISR IC3 : la mesure se lit par Mesure_Get (instantane coherent)
         volatile bool rpmCaptureActive; // Indique si la capture RPM est active
         volatile uint32_t captureBuffer[RPM_CAPTURE_BUFFER_SIZE]; // Buffer circulaire pour les captures
         volatile uint8_t captureIndex; // Index courant dans le buffer de capture
-        uint32_t rpm; // Valeur RPM calculee
+        volatile uint32_t captureCount; // Captures depuis le demarrage (jamais remis a zero)
         uint8_t nbBlades; // Nombre de pales
         uint8_t nbCylindres; // Nombre de cylindres
         bool refreshNeeded; // Indique si un rafraichissement de l'affichage est necessaire
         uint8_t selectedProfil; // 0-3 : profil actif
+        volatile uint32_t tickMs; // Temps depuis le demarrage [ms], incremente par Timer1
+        uint8_t measureMode; // Mode de mesure courant (MESURE_MODE)
     } APP_DATA;
 
     extern APP_DATA appData; // Declaration de la variable globale des donnees de l'application
 
+    /**
+     * @brief Lit de facon coherente l'index et le compteur de l'anneau IC3.
+     *
+     * @details
+     * Lecteur unique de l'anneau appData.captureBuffer hors ISR : relit
+     * tant qu'une capture arrive entre les deux lectures.
+     *
+     * @param index Index du prochain emplacement ecrit
+     * @return Nombre de captures depuis le demarrage
+     */
+    static inline uint32_t APP_CaptureCount(uint8_t *index)
+    {
+        uint32_t count; // Compteur lu
+
+        do {
+            count = appData.captureCount;
+            *index = appData.captureIndex;
+        } while (count != appData.captureCount); // Une capture est arrivee entre les deux lectures
+        return count;
+    }
+
     // *****************************************************************************
     // Section : Routines de rappel (callbacks) de l'application
     // *****************************************************************************
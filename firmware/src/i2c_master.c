@@ -1,136 +1,381 @@
-/* i2c_user.c - I2C driver bas niveau pour PIC32 MZ EF, appelable depuis gestion LCD */
+/* i2c_master.c - maitre I2C sur interruptions pour PIC32 MZ EF, file de transactions */
 
-#include "system_config.h" // Inclusion de la configuration systeme
-#include "system_definitions.h" // Inclusion des definitions systeme
-#include <peripheral/i2c/plib_i2c.h> // Inclusion de la bibliotheque I2C PLIB
+#include "i2c_master.h" // Inclusion des prototypes du maitre I2C
+#include "Deadline.h" // Inclusion des echeances (timeout des transactions)
+#include "Mc32Delays.h" // Inclusion des delais (recuperation du bus)
 
-#define I2C_BUS I2C_ID_1 // Selection de l'ID du bus I2C utilise
-#define PBCLK_FREQ 100000000UL // Frequence du bus peripherique
+#define PBCLK_FREQ SYS_CLK_BUS_PERIPHERAL_2 // I2C1 sur PBCLK2
+#define I2C_TIMEOUT_US 1000 // Duree fixe accordee a une transaction [us]
+#define I2C_BYTE_TIMEOUT_US 100 // Duree accordee par octet (100 kHz = 90 us) [us]
+#define I2C_RECOVERY_PULSES 9 // Coups d'horloge pour liberer un esclave
+#define I2C_RECOVERY_HALF_US 5 // Demi-periode de SCL en recuperation (100 kHz)
+
+// Broches du bus (RD9 = SDA1, RD10 = SCL1)
+#define I2C_PORT PORT_CHANNEL_D
+#define I2C_SDA_BIT PORTS_BIT_POS_9
+#define I2C_SCL_BIT PORTS_BIT_POS_10
+
+// Etapes d'une transaction (evenement attendu de l'ISR)
+typedef enum {
+    I2C_STEP_IDLE = 0,      // Aucune transaction
+    I2C_STEP_START,         // Start en cours
+    I2C_STEP_ADDR_W,        // Adresse en ecriture emise
+    I2C_STEP_WRITE,         // Octet de donnee emis
+    I2C_STEP_RESTART,       // Restart en cours
+    I2C_STEP_ADDR_R,        // Adresse en lecture emise
+    I2C_STEP_READ,          // Octet en reception
+    I2C_STEP_ACK,           // ACK / NACK en cours
+    I2C_STEP_STOP           // Stop en cours
+} I2C_STEP;
+
+static I2C_Transaction queue[I2C_QUEUE_LEN]; // File des transactions (tete = en cours)
+static volatile uint8_t qHead = 0; // Transaction en cours
+static volatile uint8_t qCount = 0; // Transactions dans la file
+static volatile uint8_t step = I2C_STEP_IDLE; // Etape de la transaction en cours
+static volatile uint8_t result = I2C_RESULT_OK; // Resultat en cours
+static uint16_t xferIndex = 0; // Octet courant (ecriture ou lecture)
+static Deadline deadline = 0; // Limite de la transaction en cours
+static uint32_t i2cTimeouts = 0; // Transactions abandonnees
+static uint32_t i2cRecoveries = 0; // Recuperations du bus
 
 /**
- * @brief Initialise le module I2C avec la vitesse souhaitee.
+ * @brief Demarre la transaction en tete de file.
  *
  * @details
- * Cette fonction configure le module I2C en mode rapide (400kHz) ou standard (100kHz).
+ * Appelee interruptions masquees ou depuis l'ISR I2C.
  *
- * @param fast Si true, configure en mode rapide (400kHz), sinon standard (100kHz).
+ * @param Aucun parametre.
  * @return Aucun retour.
- *
- * @pre Aucun prerequis specifique.
- * @post Le module I2C est pret a etre utilise.
  */
-void i2c_init(bool fast)
+static void i2c_begin(void)
 {
-    PLIB_I2C_Disable(I2C_BUS); // Desactive le module I2C
+    const I2C_Transaction *t = &queue[qHead]; // Transaction a lancer
 
-    PLIB_I2C_HighFrequencyEnable(I2C_BUS); // Active la haute frequence
-    PLIB_I2C_BaudRateSet(I2C_BUS, PBCLK_FREQ, fast ? 400000 : 100000); // Definit la vitesse
-
-    PLIB_I2C_SlaveClockStretchingEnable(I2C_BUS); // Active l'etirement d'horloge pour l'esclave
-    PLIB_I2C_Enable(I2C_BUS); // Active le module I2C
+    xferIndex = 0;
+    result = I2C_RESULT_OK;
+    deadline = Deadline_InUs(I2C_TIMEOUT_US + (uint32_t) (t->wrLen + t->rdLen + 1) * I2C_BYTE_TIMEOUT_US);
+    step = I2C_STEP_START;
+    PLIB_I2C_MasterStart(I2C_BUS); // L'ISR enchaine a la fin du start
 }
 
 /**
- * @brief Genere une condition de start sur le bus I2C.
- *
- * @details
- * Cette fonction attend que le bus soit libre puis genere un start.
+ * @brief Termine la transaction en cours et lance la suivante.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
+ */
+static void i2c_finish(void)
+{
+    I2C_Transaction done = queue[qHead]; // Copie : le callback peut soumettre
+
+    qHead = (uint8_t) ((qHead + 1) % I2C_QUEUE_LEN);
+    qCount--;
+    step = I2C_STEP_IDLE;
+    if (done.callback != 0) {
+        done.callback(result, done.ctx); // Notifie l'appelant
+    }
+    if ((step == I2C_STEP_IDLE) && (qCount != 0)) {
+        i2c_begin(); // Transaction suivante
+    }
+}
+
+/**
+ * @brief Genere un stop et memorise le resultat.
  *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de start.
+ * @param res Resultat de la transaction
+ * @return Aucun retour.
  */
-void i2c_start(void)
+static void i2c_stop_with(uint8_t res)
 {
-    while (!PLIB_I2C_BusIsIdle(I2C_BUS)); // Attend que le bus soit libre
-    PLIB_I2C_MasterStart(I2C_BUS); // Genere le start
-    while (!PLIB_I2C_StartWasDetected(I2C_BUS)); // Attend la detection du start
+    result = res;
+    step = I2C_STEP_STOP;
+    PLIB_I2C_MasterStop(I2C_BUS); // L'ISR termine a la fin du stop
 }
 
 /**
- * @brief Genere une condition de stop sur le bus I2C.
+ * @brief Libere le bus : pulse SCL jusqu'a liberation de SDA puis force un stop.
  *
  * @details
- * Cette fonction attend que le bus soit libre puis genere un stop.
+ * Le module est coupe, les broches repassent en GPIO drain ouvert. Un
+ * esclave qui maintient SDA bas termine son octet en au plus 9 coups.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
+ */
+static void i2c_recover(void)
+{
+    uint8_t n; // Coups d'horloge
+
+    PLIB_I2C_Disable(I2C_BUS); // Rend les broches au port
+    PLIB_PORTS_PinOpenDrainEnable(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+    PLIB_PORTS_PinOpenDrainEnable(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    PLIB_PORTS_PinSet(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+    PLIB_PORTS_PinSet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    PLIB_PORTS_PinDirectionOutputSet(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+    PLIB_PORTS_PinDirectionInputSet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+
+    for (n = 0; n < I2C_RECOVERY_PULSES; n++) {
+        if (PLIB_PORTS_PinGet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT)) {
+            break; // SDA libere
+        }
+        PLIB_PORTS_PinClear(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+        delay_usCt(I2C_RECOVERY_HALF_US);
+        PLIB_PORTS_PinSet(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+        delay_usCt(I2C_RECOVERY_HALF_US);
+    }
+
+    // Stop : SDA monte pendant que SCL est haut
+    PLIB_PORTS_PinClear(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    PLIB_PORTS_PinDirectionOutputSet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    delay_usCt(I2C_RECOVERY_HALF_US);
+    PLIB_PORTS_PinSet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    delay_usCt(I2C_RECOVERY_HALF_US);
+
+    PLIB_PORTS_PinDirectionInputSet(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+    PLIB_PORTS_PinDirectionInputSet(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    PLIB_PORTS_PinOpenDrainDisable(PORTS_ID_0, I2C_PORT, I2C_SCL_BIT);
+    PLIB_PORTS_PinOpenDrainDisable(PORTS_ID_0, I2C_PORT, I2C_SDA_BIT);
+    PLIB_I2C_ArbitrationLossClear(I2C_BUS);
+    PLIB_I2C_Enable(I2C_BUS); // Le module reprend les broches
+    i2cRecoveries++;
+}
+
+/**
+ * @brief Abandonne la transaction en cours, recupere le bus et reprend la file.
  *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de stop.
+ * @param res Resultat rapporte (timeout ou collision)
+ * @return Aucun retour.
  */
-void i2c_stop(void)
+static void i2c_abort(uint8_t res)
 {
-    while (!PLIB_I2C_BusIsIdle(I2C_BUS)); // Attend que le bus soit libre
-    PLIB_I2C_MasterStop(I2C_BUS); // Genere le stop
-    while (!PLIB_I2C_StopWasDetected(I2C_BUS)); // Attend la detection du stop
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+    i2c_recover();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+    result = res;
+    i2c_finish(); // Callback puis transaction suivante
 }
 
 /**
- * @brief Genere une condition de restart sur le bus I2C.
+ * @brief Initialise le module I2C avec la vitesse souhaitee.
  *
  * @details
- * Cette fonction genere une condition de redemarrage sur le bus I2C.
+ * Cette fonction configure le module I2C en mode rapide (400kHz) ou standard (100kHz),
+ * vide la file et autorise les interruptions maitre et collision.
  *
- * @param Aucun parametre.
+ * @param fast Si true, configure en mode rapide (400kHz), sinon standard (100kHz).
  * @return Aucun retour.
  *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de restart.
+ * @pre Aucun prerequis specifique.
+ * @post Le module I2C est pret a recevoir des transactions.
  */
-void i2c_restart(void)
+void i2c_init(bool fast)
 {
-    PLIB_I2C_MasterStartRepeat(I2C_BUS); // Genere le restart
-    while (!PLIB_I2C_StartWasDetected(I2C_BUS)); // Attend la detection du restart
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+    PLIB_I2C_Disable(I2C_BUS); // Desactive le module I2C
+
+    qHead = 0;
+    qCount = 0;
+    step = I2C_STEP_IDLE;
+
+    PLIB_I2C_HighFrequencyEnable(I2C_BUS); // Active la haute frequence
+    PLIB_I2C_BaudRateSet(I2C_BUS, PBCLK_FREQ, fast ? 400000 : 100000); // Definit la vitesse
+
+    PLIB_I2C_SlaveClockStretchingEnable(I2C_BUS); // Active l'etirement d'horloge pour l'esclave
+    PLIB_I2C_Enable(I2C_BUS); // Active le module I2C
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_I2C1_MASTER, INT_PRIORITY_LEVEL1);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_I2C1_BUS, INT_PRIORITY_LEVEL1);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_I2C_1_BUS);
 }
 
 /**
- * @brief ecrit un octet sur le bus I2C.
+ * @brief Ajoute une transaction a la file.
  *
  * @details
- * Cette fonction envoie un octet sur le bus I2C et retourne si l'esclave a acquitte.
+ * Le descripteur est copie ; la transaction demarre immediatement si le
+ * bus est libre. Appelable depuis un callback.
  *
- * @param data Octet a envoyer.
- * @return true si acquittement reu, false sinon.
+ * @param t Transaction a executer.
+ * @return false si la file est pleine.
+ */
+bool i2c_submit(const I2C_Transaction *t)
+{
+    unsigned int status; // Etat des interruptions
+    bool ok = false; // Transaction acceptee
+
+    status = __builtin_disable_interrupts(); // File partagee avec l'ISR
+    if (qCount < I2C_QUEUE_LEN) {
+        queue[(qHead + qCount) % I2C_QUEUE_LEN] = *t;
+        qCount++;
+        ok = true;
+        if (step == I2C_STEP_IDLE) {
+            i2c_begin(); // Bus libre : demarre tout de suite
+        }
+    }
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts(); // Restaure les interruptions
+    }
+    return ok;
+}
+
+/**
+ * @brief Indique si une transaction est en cours ou en attente.
  *
- * @pre Le bus I2C doit etre en condition de start ou restart.
- * @post L'octet est envoye sur le bus.
+ * @param Aucun parametre.
+ * @return true tant que la file n'est pas vide.
  */
-bool i2c_write(uint8_t data)
+bool i2c_busy(void)
 {
-    while (!PLIB_I2C_TransmitterIsReady(I2C_BUS)); // Attend que le transmetteur soit pret
-    PLIB_I2C_TransmitterByteSend(I2C_BUS, data); // Envoie l'octet
-    while (PLIB_I2C_TransmitterIsBusy(I2C_BUS)); // Attend la fin de la transmission
-    return PLIB_I2C_TransmitterByteWasAcknowledged(I2C_BUS); // Retourne l'acquittement
+    return (qCount != 0);
 }
 
 /**
- * @brief Lit un octet sur le bus I2C.
+ * @brief Surveillance de la transaction en cours (boucle principale).
  *
  * @details
- * Cette fonction lit un octet depuis le bus I2C et envoie un ACK ou NACK selon le parametre.
+ * Abandonne la transaction qui depasse son delai et recupere le bus.
+ * Le test est refait interruptions masquees : l'ISR a pu terminer la
+ * transaction entre-temps.
  *
- * @param ack true pour envoyer un ACK, false pour NACK.
- * @return L'octet lu.
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void i2c_task(void)
+{
+    unsigned int status; // Etat des interruptions
+
+    if ((step == I2C_STEP_IDLE) || !Deadline_Expired(deadline)) {
+        return; // Rien en cours ou encore dans les temps
+    }
+    status = __builtin_disable_interrupts();
+    if ((step != I2C_STEP_IDLE) && Deadline_Expired(deadline)) {
+        i2cTimeouts++;
+        i2c_abort(I2C_RESULT_TIMEOUT);
+    }
+    if (status & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+}
+
+/**
+ * @brief Callback de l'interruption maitre I2C1.
  *
- * @pre Le bus I2C doit etre en condition de lecture.
- * @post L'octet est lu et un ACK/NACK est envoye.
+ * @details
+ * Chaque evenement du bus fait avancer la transaction d'une etape.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
  */
-uint8_t i2c_read(bool ack)
+void i2c_master_callback(void)
 {
-    uint8_t val; // Variable pour stocker l'octet lu
+    const I2C_Transaction *t = &queue[qHead]; // Transaction en cours
+
+    switch (step) {
+        case I2C_STEP_START:
+            if ((t->wrLen == 0) && (t->rdLen != 0)) {
+                step = I2C_STEP_ADDR_R; // Lecture seule
+                PLIB_I2C_TransmitterByteSend(I2C_BUS, (uint8_t) ((t->addr << 1) | 1));
+            } else {
+                step = I2C_STEP_ADDR_W;
+                PLIB_I2C_TransmitterByteSend(I2C_BUS, (uint8_t) (t->addr << 1));
+            }
+            break;
+
+        case I2C_STEP_ADDR_W:
+        case I2C_STEP_WRITE:
+            if (!PLIB_I2C_TransmitterByteWasAcknowledged(I2C_BUS)) {
+                i2c_stop_with(I2C_RESULT_NACK); // Esclave absent ou refus
+            } else if (xferIndex < t->wrLen) {
+                step = I2C_STEP_WRITE;
+                PLIB_I2C_TransmitterByteSend(I2C_BUS, t->wrBuf[xferIndex++]);
+            } else if (t->rdLen != 0) {
+                step = I2C_STEP_RESTART;
+                PLIB_I2C_MasterStartRepeat(I2C_BUS);
+            } else {
+                i2c_stop_with(I2C_RESULT_OK);
+            }
+            break;
 
-    PLIB_I2C_MasterReceiverClock1Byte(I2C_BUS); // Lance la lecture d'un octet
-    while (!PLIB_I2C_ReceivedByteIsAvailable(I2C_BUS)); // Attend que l'octet soit disponible
-    val = PLIB_I2C_ReceivedByteGet(I2C_BUS); // Recupere l'octet
+        case I2C_STEP_RESTART:
+            step = I2C_STEP_ADDR_R;
+            PLIB_I2C_TransmitterByteSend(I2C_BUS, (uint8_t) ((t->addr << 1) | 1));
+            break;
 
-    PLIB_I2C_ReceivedByteAcknowledge(I2C_BUS, ack); // Envoie ACK ou NACK
+        case I2C_STEP_ADDR_R:
+            if (!PLIB_I2C_TransmitterByteWasAcknowledged(I2C_BUS)) {
+                i2c_stop_with(I2C_RESULT_NACK);
+            } else {
+                xferIndex = 0;
+                step = I2C_STEP_READ;
+                PLIB_I2C_MasterReceiverClock1Byte(I2C_BUS);
+            }
+            break;
 
-    // Attendre que l'envoi de ACK/NACK soit termine
-    while (!PLIB_I2C_AcknowledgeHasCompleted(I2C_BUS)); // Attend la fin de l'acquittement
+        case I2C_STEP_READ:
+            t->rdBuf[xferIndex++] = PLIB_I2C_ReceivedByteGet(I2C_BUS);
+            step = I2C_STEP_ACK;
+            PLIB_I2C_ReceivedByteAcknowledge(I2C_BUS, xferIndex < t->rdLen); // NACK sur le dernier
+            break;
 
-    return val; // Retourne l'octet lu
+        case I2C_STEP_ACK:
+            if (xferIndex < t->rdLen) {
+                step = I2C_STEP_READ;
+                PLIB_I2C_MasterReceiverClock1Byte(I2C_BUS);
+            } else {
+                i2c_stop_with(I2C_RESULT_OK);
+            }
+            break;
+
+        case I2C_STEP_STOP:
+            i2c_finish(); // Callback puis transaction suivante
+            break;
+
+        default:
+            break; // Evenement hors transaction
+    }
+}
+
+/**
+ * @brief Callback de l'interruption de collision I2C1.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void i2c_bus_callback(void)
+{
+    if (step != I2C_STEP_IDLE) {
+        i2c_abort(I2C_RESULT_COLLISION); // Bus perdu : recupere et reprend
+    } else {
+        PLIB_I2C_ArbitrationLossClear(I2C_BUS);
+    }
 }
 
+/**
+ * @brief Nombre de transactions abandonnees sur timeout.
+ *
+ * @param Aucun parametre.
+ * @return Compteur de timeouts.
+ */
+uint32_t i2c_get_timeouts(void)
+{
+    return i2cTimeouts; // Compteur interne
+}
+
+/**
+ * @brief Nombre de recuperations du bus (timeout ou collision).
+ *
+ * @param Aucun parametre.
+ * @return Compteur de recuperations.
+ */
+uint32_t i2c_get_recoveries(void)
+{
+    return i2cRecoveries; // Compteur interne
+}
@@ -1,6 +1,6 @@
 /*--------------------------------------------------------*/
-/*  i2c_user.h  ? driver IC bas niveau (PLIB)            */
-/*  Adapte PIC32 MZ EF ? utilisable pour gestion LCD      */
+/*  i2c_master.h  - maitre I2C sur interruptions          */
+/*  Adapte PIC32 MZ EF - file de transactions (LCD, ...)  */
 /*--------------------------------------------------------*/
 #ifndef I2C_USER_H
 #define I2C_USER_H
@@ -12,87 +12,119 @@
 #include "system_definitions.h" // Inclusion des definitions systeme
 #include <peripheral/i2c/plib_i2c.h> // Inclusion de la bibliotheque I2C PLIB
 
+/*
+ * Le module I2C1 est pilote par son interruption maitre : chaque evenement
+ * du bus (start, octet emis, octet recu, ACK, stop) avance la machine
+ * d'etat de la transaction en cours. Les transactions attendent dans une
+ * file de I2C_QUEUE_LEN descripteurs ; le CPU ne boucle jamais sur un
+ * drapeau du bus.
+ *
+ * Une transaction = start, adresse + ecriture de wrLen octets, puis si
+ * rdLen > 0 restart, adresse + lecture de rdLen octets, stop. Les buffers
+ * doivent rester valides jusqu'a l'appel du callback.
+ *
+ * i2c_task() surveille la duree de la transaction en cours. Sur timeout
+ * ou collision, le module est coupe, SCL est pulse (9 coups au plus) pour
+ * liberer un esclave bloque, un stop est force puis le module repart.
+ */
+
 /* === Configuration du module I2C ======================= */
 #define I2C_BUS I2C_ID_1 // Selection de l'ID du bus I2C utilise
+#define I2C_QUEUE_LEN   8 // Transactions en attente au plus
+
+// Resultat d'une transaction
+typedef enum {
+    I2C_RESULT_OK = 0,      // Transaction terminee
+    I2C_RESULT_NACK,        // Adresse ou octet non acquitte
+    I2C_RESULT_TIMEOUT,     // Bus bloque : transaction abandonnee, bus recupere
+    I2C_RESULT_COLLISION    // Collision sur le bus : bus recupere
+} I2C_RESULT;
+
+/**
+ * @brief Callback de fin de transaction.
+ *
+ * @details Appele en contexte d'interruption (ISR I2C) ou depuis
+ * i2c_task() sur timeout : il doit rester court.
+ *
+ * @param result Resultat (I2C_RESULT)
+ * @param ctx Contexte fourni avec la transaction
+ */
+typedef void (*I2C_CALLBACK)(uint8_t result, void *ctx);
+
+/**
+ * @brief Descripteur de transaction (copie dans la file).
+ */
+typedef struct {
+    uint8_t addr;               // Adresse 7 bits de l'esclave
+    const uint8_t *wrBuf;       // Octets a ecrire (peut etre 0 si wrLen = 0)
+    uint16_t wrLen;             // Nombre d'octets a ecrire
+    uint8_t *rdBuf;             // Octets lus (peut etre 0 si rdLen = 0)
+    uint16_t rdLen;             // Nombre d'octets a lire
+    I2C_CALLBACK callback;      // Fin de transaction (peut etre 0)
+    void *ctx;                  // Contexte du callback
+} I2C_Transaction;
 
 /* === Prototypes des fonctions ========================== */
 /**
  * @brief Initialise le module I2C avec la vitesse souhaitee.
  *
  * @details
- * Cette fonction configure le module I2C en mode rapide (400kHz) ou standard (100kHz).
+ * Cette fonction configure le module I2C en mode rapide (400kHz) ou standard (100kHz),
+ * vide la file et autorise les interruptions maitre et collision.
  *
  * @param fast Si true, configure en mode rapide (400kHz), sinon standard (100kHz).
  * @return Aucun retour.
  *
  * @pre Aucun prerequis specifique.
- * @post Le module I2C est pret a etre utilise.
+ * @post Le module I2C est pret a recevoir des transactions.
  */
 void     i2c_init(bool fast);
 /**
- * @brief Genere une condition de start sur le bus I2C.
+ * @brief Ajoute une transaction a la file.
  *
  * @details
- * Cette fonction attend que le bus soit libre puis genere un start.
+ * Le descripteur est copie ; la transaction demarre immediatement si le
+ * bus est libre. Appelable depuis un callback.
  *
- * @param Aucun parametre.
- * @return Aucun retour.
- *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de start.
+ * @param t Transaction a executer.
+ * @return false si la file est pleine.
  */
-void     i2c_start(void);
+bool     i2c_submit(const I2C_Transaction *t);
 /**
- * @brief Genere une condition de stop sur le bus I2C.
- *
- * @details
- * Cette fonction attend que le bus soit libre puis genere un stop.
- *
- * @param Aucun parametre.
- * @return Aucun retour.
+ * @brief Indique si une transaction est en cours ou en attente.
  *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de stop.
+ * @return true tant que la file n'est pas vide.
  */
-void     i2c_stop(void);
+bool     i2c_busy(void);
 /**
- * @brief Genere une condition de restart sur le bus I2C.
+ * @brief Surveillance de la transaction en cours (boucle principale).
  *
  * @details
- * Cette fonction genere une condition de redemarrage sur le bus I2C.
+ * Abandonne la transaction qui depasse son delai et recupere le bus.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
- *
- * @pre Le module I2C doit etre initialise.
- * @post Le bus I2C est en condition de restart.
  */
-void     i2c_restart(void);
+void     i2c_task(void);
 /**
- * @brief ecrit un octet sur le bus I2C.
- *
- * @details
- * Cette fonction envoie un octet sur le bus I2C et retourne si l'esclave a acquitte.
- *
- * @param data Octet a envoyer.
- * @return true si acquittement reu, false sinon.
- *
- * @pre Le bus I2C doit etre en condition de start ou restart.
- * @post L'octet est envoye sur le bus.
+ * @brief Callback de l'interruption maitre I2C1 (appele par l'ISR).
  */
-bool     i2c_write(uint8_t data);
+void     i2c_master_callback(void);
 /**
- * @brief Lit un octet sur le bus I2C.
- *
- * @details
- * Cette fonction lit un octet depuis le bus I2C et envoie un ACK ou NACK selon le parametre.
+ * @brief Callback de l'interruption de collision I2C1 (appele par l'ISR).
+ */
+void     i2c_bus_callback(void);
+/**
+ * @brief Nombre de transactions abandonnees sur timeout.
  *
- * @param ack true pour envoyer un ACK, false pour NACK.
- * @return L'octet lu.
+ * @return Compteur de timeouts.
+ */
+uint32_t i2c_get_timeouts(void);
+/**
+ * @brief Nombre de recuperations du bus (timeout ou collision).
  *
- * @pre Le bus I2C doit etre en condition de lecture.
- * @post L'octet est lu et un ACK/NACK est envoye.
+ * @return Compteur de recuperations.
  */
-uint8_t  i2c_read(bool ack);
+uint32_t i2c_get_recoveries(void);
 
 #endif /* I2C_USER_H */
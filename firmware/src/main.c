@@ -59,6 +59,7 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #include <stdbool.h>                    // Defines true
 #include <stdlib.h>                     // Defines EXIT_FAILURE
 #include "system/common/sys_module.h"   // SYS function prototypes
+#include "PowerMgr.h"                   // CPU en IDLE entre les ticks
 
 
 // *****************************************************************************
@@ -78,6 +79,8 @@ int main ( void )
         /* Maintain state machines of all polled MPLAB Harmony modules. */
         SYS_Tasks ( );
 
+        /* Sleep (IDLE) until the next interrupt when no task is pending. */
+        PowerMgr_Idle ( );
 
 
     }
@@ -12,384 +12,681 @@
 #include "GestBtn.h" // Fonctions de gestion des boutons
 // Inclusion du header menu
 #include "menu.h" // Prototypes des fonctions menu
-#include <stdio.h> // Pour les fonctions d'affichage
+// Inclusion du header formatage
+#include "Fmt.h" // Champs numeriques sans sprintf
+// Inclusion du header graphe RPM
+#include "RpmGraph.h" // Vue graphique de la mesure visuelle
 // Inclusion du header application
 #include "app.h" // Definitions de l'application
 // Inclusion des definitions systeme
 #include "system_definitions.h" // Definitions systeme
 // Inclusion du header stockage profil
 #include "ProfilStorage.h" // Fonctions de gestion des profils
-// Inclusion du header capteur LIS2HH12
-#include "LIS2HH12.h" // Fonctions du capteur LIS2HH12
+// Inclusion du header calibration IR
+#include "IrCalib.h" // Seuil IR du profil
+// Inclusion du header batterie
+#include "Battery.h" // Tension et etat de charge
+// Inclusion du header gestion d'energie
+#include "PowerMgr.h" // Capteurs et retroeclairage
+// Inclusion du header profiler
+#include "Profiler.h" // Sondes de temps d'execution
+// Inclusion du header mesure
+#include "Mesure.h" // Instantane de mesure coherent
+// Inclusion du header moteur de mesure
+#include "MesureEngine.h" // Resultats des chaines de mesure
+// Inclusion du header equilibrage
+#include "Balance.h" // Equilibrage de l'helice
 
-static MenuState currentMenu = MENU_WELCOME;
-static uint8_t profilIndex = 0; // 0 a 4 (4 = Nouveau)
-static uint8_t saveIndex = 0; // 0 a 3
-static uint8_t curseurParametre = 0;
-static uint8_t curseurBatterie = 0;
+/**
+ * @brief Element selectionnable d'un ecran.
+ *
+ * @details
+ * Le marqueur de selection ('>' ou ' ') s'affiche a la colonne col - 1.
+ * Sur OK, action() est appelee si elle existe, sinon l'ecran passe a target.
+ */
+typedef struct {
+    uint8_t col; // Colonne du libelle (2-20)
+    uint8_t row; // Ligne du libelle (1-2)
+    const char *label; // Libelle fixe (0 = ecrit par render())
+    MenuState target; // Ecran suivant sur OK (MENU_NONE = aucun)
+    void (*action)(uint8_t item); // Action sur OK (0 = aller a target)
+} MenuItem;
 
 /**
- * @brief Affiche le menu courant sur l'ecran LCD.
+ * @brief Description constante d'un ecran.
  *
  * @details
- * Cette fonction met a jour l'affichage LCD selon l'etat courant du menu.
- * Elle gere tous les ecrans principaux, la selection de profil, la sauvegarde,
- * la configuration des pales et cylindres, et les ecrans de mesure.
+ * SELECT avance le curseur sur les elements ; apres le dernier il passe a
+ * selectTarget ou revient au premier si selectTarget vaut MENU_NONE.
+ * Sans element, OK passe a okTarget. Les crochets (0 = absent) remplacent
+ * ces comportements ou completent l'affichage.
+ */
+typedef struct {
+    const char *text[LCD_ROWS]; // Lignes fixes (0 = vide)
+    const MenuItem *items; // Elements selectionnables
+    uint8_t nbItems; // Nombre d'elements
+    uint8_t mode; // Mode de mesure de l'ecran (MESURE_MODE)
+    MenuState selectTarget; // Ecran suivant sur SELECT
+    MenuState okTarget; // Ecran suivant sur OK (sans element)
+    void (*onSelect)(void); // Remplace le traitement de SELECT
+    void (*onOk)(void); // Remplace le traitement de OK
+    void (*render)(void); // Champs variables de l'ecran
+    void (*enter)(void); // Entree dans l'ecran
+    void (*leave)(void); // Sortie de l'ecran
+    void (*poll)(void); // Appelee a chaque Menu_Task
+} MenuScreen;
+
+static MenuState currentMenu = MENU_WELCOME;
+static uint8_t menuCursor = 0; // Element selectionne (ou index de l'ecran)
+static bool visuelGraph = false; // Vue graphique de la mesure visuelle (OK bascule)
+
+static void Menu_Go(MenuState next);
+
+/* -------------------------------------------------------------------------- */
+/* Crochets des ecrans                                                        */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Ecran d'accueil : passe directement au choix du profil.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
  */
-void Menu_Display(void) {
-    lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-    lcd_put_string("                    "); // Efface la premiere ligne
-    lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-    lcd_put_string("                    "); // Efface la deuxieme ligne
-
-    switch (currentMenu) {
-        /** @brief Ecran d'accueil */
-        case MENU_WELCOME:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Capteur RPM"); // Affiche le titre
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            lcd_put_string("ETML-ES  LMS"); // Affiche le sous-titre
-            break;
-        /** @brief Ecran batterie et gestion profils */
-        case MENU_BATTERIE:
-            if (curseurBatterie == 0) {
-                lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-                lcd_put_string(">Batterie = XXX"); // Affiche la batterie selectionnee
-                lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-                lcd_put_string(" Gestion profils"); // Affiche l'option de gestion de profils
-            } else {
-                lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-                lcd_put_string(" Batterie = XXX"); // Affiche la batterie non selectionnee
-                lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-                lcd_put_string(">Gestion profils"); // Affiche la gestion de profils selectionnee
-            }
-            break;
-        /** @brief Ecran parametres */
-        case MENU_PARAMETRE:
-            if (curseurParametre == 0) {
-                lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-                lcd_put_string(">Parametre"); // Affiche l'option parametre selectionnee
-                lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-                lcd_put_string("  Eteindre"); // Affiche l'option eteindre non selectionnee
-            } else {
-                lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-                lcd_put_string(" Parametre"); // Affiche l'option parametre non selectionnee
-                lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-                lcd_put_string(">Eteindre"); // Affiche l'option eteindre selectionnee
+static void Menu_WelcomePoll(void) {
+    Menu_Go(MENU_CHOIX_PROFIL); // Passe au menu choix profil
+}
+
+/**
+ * @brief Etat de charge de la batterie.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_BatterieRender(void) {
+    char *d = Fmt_Str(lcd_frame_at(2, 1), "Batterie = ", 0); // Libelle du premier element
+    if (Battery_IsValid()) {
+        d = Fmt_Uint(d, Battery_GetPercent(), 3); // Etat de charge
+        (void) Fmt_Str(d, "%", 0);
+    } else {
+        (void) Fmt_Str(d, "--", 0); // Pas encore de mesure
+    }
+}
+
+/**
+ * @brief Eteint l'appareil.
+ *
+ * @param item Element selectionne (inutilise)
+ * @return Aucun retour.
+ */
+static void Menu_Eteindre(uint8_t item) {
+    (void) item;
+    PowerMgr_Shutdown(); // Coupe les charges puis le regulateur
+}
+
+/**
+ * @brief Charge un profil existant ou prepare un nouveau profil.
+ *
+ * @param item Profil choisi (0-3) ou 4 pour un nouveau profil
+ * @return Aucun retour.
+ */
+static void Menu_ChoisirProfil(uint8_t item) {
+    Profil *p; // Pointeur sur le profil
+    uint8_t i;
+
+    if (item == NB_PROFILS) {
+        uint8_t slot = 0xFF; // Slot pour nouveau profil
+        for (i = 0; i < NB_PROFILS; i++) {
+            p = Profils_Get(i); // Recupere le profil
+            if (p == 0 || p->validFlag != PROFIL_VALID_FLAG) {
+                slot = i; // Trouve un slot libre
+                break;
             }
+        }
+        if (slot == 0xFF) {
+            slot = 0; // Si aucun slot libre, prend le premier
+        }
+        appData.selectedProfil = slot; // Selectionne le profil
+        Menu_Go(MENU_CONF_NB_pale); // Passe a la config pales
+        return;
+    }
+    appData.selectedProfil = item; // Selectionne le profil existant
+    p = Profils_Get(item); // Recupere le profil
+    if (p != 0 && p->validFlag == PROFIL_VALID_FLAG) {
+        appData.nbBlades = p->nbBlades; // Charge le nombre de pales
+        appData.nbCylindres = p->nbCylindres; // Charge le nombre de cylindres
+    }
+    IrCalib_Apply(); // Seuil IR du profil
+    Menu_Go(MENU_MESURE_VISUEL); // Passe a la mesure visuelle
+}
+
+/**
+ * @brief Propose le profil courant comme destination.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_SauvegardeEnter(void) {
+    menuCursor = appData.selectedProfil; // Le curseur porte l'index de sauvegarde
+}
+
+/**
+ * @brief Change le profil de destination.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_SauvegardeSelect(void) {
+    menuCursor = (menuCursor + 1) % NB_PROFILS; // Incremente l'index de sauvegarde
+}
+
+/**
+ * @brief Sauvegarde le profil puis passe a la mesure.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_SauvegardeOk(void) {
+    Profils_SaveToNVM(menuCursor, appData.nbBlades, appData.nbCylindres); // Sauvegarde le profil
+    appData.selectedProfil = menuCursor; // Selectionne le profil sauvegarde
+    IrCalib_Apply(); // Seuil IR du profil sauvegarde
+    Menu_Go(MENU_MESURE_VISUEL); // Passe a la mesure visuelle
+}
+
+/**
+ * @brief Profil de destination et configuration a sauver.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_SauvegardeRender(void) {
+    char *d = Fmt_Str(lcd_frame_at(1, 2), ">P", 0); // ">P1  (2H 4C)"
+    d = Fmt_Uint(d, menuCursor + 1, 0);
+    d = Fmt_Str(d, "  (", 0);
+    d = Fmt_Uint(d, appData.nbBlades, 0);
+    d = Fmt_Str(d, "H ", 0);
+    d = Fmt_Uint(d, appData.nbCylindres, 0);
+    (void) Fmt_Str(d, "C)", 0);
+}
+
+/**
+ * @brief Nombre de pales suivant (1 a 4).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_PalesSelect(void) {
+    appData.nbBlades = (appData.nbBlades % MENU_MAX_PALES) + 1; /* 1->2->3->4->1   */
+}
+
+/**
+ * @brief Nombre de pales.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_PalesRender(void) {
+    (void) Fmt_Uint(Fmt_Str(lcd_frame_at(1, 2), "> ", 0), appData.nbBlades, 0); // Affiche la valeur
+}
+
+/**
+ * @brief Nombre de cylindres suivant (4 a 7).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_CylindresSelect(void) {
+    if (++appData.nbCylindres > MENU_MAX_CYLINDRES)
+        appData.nbCylindres = MENU_MIN_CYLINDRES; // Remet a 4 si depasse 7
+}
+
+/**
+ * @brief Nombre de cylindres.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_CylindresRender(void) {
+    (void) Fmt_Uint(Fmt_Str(lcd_frame_at(1, 2), "> ", 0), appData.nbCylindres, 0); // Affiche la valeur
+}
+
+/**
+ * @brief Repart d'une tendance vide en entrant dans la mesure visuelle.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_VisuelEnter(void) {
+    RpmGraph_Reset(); // Pas de tendance d'une mesure precedente
+}
+
+/**
+ * @brief Bascule entre la vue chiffree et la vue graphique.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_VisuelOk(void) {
+    visuelGraph = !visuelGraph;
+}
+
+/**
+ * @brief Echantillonne la tendance de la mesure visuelle.
+ *
+ * @details
+ * La capture IR tourne en fond dans le moteur de mesure.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_VisuelPoll(void) {
+    Mesure_Snapshot m; // Dernier instantane
+
+    Mesure_Get(&m);
+    RpmGraph_Sample(m.rpm, appData.tickMs); // Tendance prete meme en vue chiffree
+}
+
+/**
+ * @brief RPM et profil du dernier instantane, ou vue graphique.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_VisuelRender(void) {
+    char *d; // Position d'ecriture dans l'image
+    Profil *p; // Pointeur sur le profil
+    Mesure_Snapshot m; // RPM et profil du meme calcul
+
+    Mesure_Get(&m);
+    if (visuelGraph) {
+        RpmGraph_Render(m.rpm); // Barre et tendance
+        return;
+    }
+    p = Profils_Get(m.profil); // Recupere le profil
+    d = Fmt_Str(lcd_frame_at(1, 1), "Visuel : ", 0); // "Visuel : 12345 RPM"
+    d = Fmt_Uint(d, m.rpm, 5); // Valeur RPM (***** au-dela de 99999)
+    (void) Fmt_Str(d, " RPM", 0);
+    d = Fmt_Str(lcd_frame_at(1, 2), "Profil", 0); // "Profil1 : 2H  4C"
+    d = Fmt_Uint(d, m.profil + 1, 0); // Numero du profil
+    d = Fmt_Str(d, " : ", 0);
+    if (p != 0 && p->validFlag == PROFIL_VALID_FLAG) {
+        d = Fmt_Uint(d, p->nbBlades, 0); // Affiche les infos du profil
+        d = Fmt_Str(d, "H  ", 0);
+        d = Fmt_Uint(d, p->nbCylindres, 0);
+        (void) Fmt_Str(d, "C", 0);
+    } else {
+        (void) Fmt_Str(d, "--   --", 0); // Affiche des tirets si profil non valide
+    }
+}
+
+/**
+ * @brief RPM d'une chaine du moteur de mesure sur la deuxieme ligne.
+ *
+ * @details
+ * "12345 RPM  4 cyl." si la chaine est verrouillee, "----- RPM" sinon
+ * (capteur absent ou raie sous le seuil de bruit).
+ *
+ * @param pipe Chaine affichee (MESURE_PIPE)
+ * @return Aucun retour.
+ */
+static void Menu_PipeRender(uint8_t pipe) {
+    MesureEngine_Status st; // Resultat de la chaine
+    char *d = lcd_frame_at(1, 2); // Debut de la deuxieme ligne
+
+    if (MesureEngine_GetStatus(pipe, &st) && st.locked) {
+        d = Fmt_Uint(d, st.rpm, 5); // Valeur RPM (***** au-dela de 99999)
+    } else {
+        d = Fmt_Str(d, "-----", 0); // Pas de resultat
+    }
+    d = Fmt_Str(d, " RPM  ", 0);
+    d = Fmt_Uint(d, appData.nbCylindres, 0); // Cylindres utilises pour le calcul
+    (void) Fmt_Str(d, " cyl.", 0);
+}
+
+/**
+ * @brief Resultat de la chaine audio.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_AudioRender(void) {
+    Menu_PipeRender(MESURE_PIPE_AUDIO);
+}
+
+/**
+ * @brief Resultat de la chaine vibration.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_VibrationRender(void) {
+    Menu_PipeRender(MESURE_PIPE_VIB);
+}
+
+/**
+ * @brief Etape suivante de l'equilibrage.
+ *
+ * @details
+ * Un refus (chaine IR ou vibration arretee) s'affiche via les indicateurs.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_EquilibrageOk(void) {
+    (void) Balance_Next();
+}
+
+/**
+ * @brief Progression du run, vibration 1x ou correction.
+ *
+ * @details
+ * "Ref.   12/64 tours" / "1x  123.4mg 215deg" pendant un run,
+ * "Corr.  135% essai" / "a 212deg sens rot." a la fin ('!' en colonne 20
+ * si les regimes different ou si la masse d'essai est sans effet).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_EquilibrageRender(void) {
+    Balance_Result b; // Etat de l'equilibrage
+    const Balance_Run *r; // Run affiche
+    char *d; // Position d'ecriture dans l'image
+
+    Balance_Get(&b);
+    switch (b.state) {
+        case BALANCE_REF:
+        case BALANCE_TRIAL:
+            r = (b.state == BALANCE_REF) ? &b.ref : &b.trial;
+            d = Fmt_Str(lcd_frame_at(1, 1), (b.state == BALANCE_REF) ? "Ref. " : "Essai", 0);
+            d = Fmt_Uint(d, r->revs, 4); // Tours integres
+            d = Fmt_Str(d, "/", 0);
+            d = Fmt_Uint(d, BALANCE_REVS, 0);
+            (void) Fmt_Str(d, " tours", 0);
+            d = Fmt_Str(lcd_frame_at(1, 2), "1x ", 0);
+            d = Fmt_Fixed(d, (int32_t) (r->ampMg[b.axis] * 10.0f + 0.5f), 1, 6); // Amplitude [mg]
+            d = Fmt_Str(d, "mg ", 0);
+            d = Fmt_Uint(d, (uint32_t) (r->phaseDeg[b.axis] + 0.5f) % 360, 3); // Phase [deg]
+            (void) Fmt_Str(d, "deg", 0);
             break;
-        /** @brief Choix du profil utilisateur */
-        case MENU_CHOIX_PROFIL:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Choisir Profil"); // Affiche le titre
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            switch (profilIndex) {
-                /** @brief Profil 1 selectionne */
-                case 0: lcd_put_string(">1 2 3 4 Nouveau"); break; // Affiche la selection sur le profil 1
-                /** @brief Profil 2 selectionne */
-                case 1: lcd_put_string(" 1>2 3 4 Nouveau"); break; // Affiche la selection sur le profil 2
-                /** @brief Profil 3 selectionne */
-                case 2: lcd_put_string(" 1 2>3 4 Nouveau"); break; // Affiche la selection sur le profil 3
-                /** @brief Profil 4 selectionne */
-                case 3: lcd_put_string(" 1 2 3>4 Nouveau"); break; // Affiche la selection sur le profil 4
-                /** @brief Nouveau profil selectionne */
-                case 4: lcd_put_string(" 1 2 3 4>Nouveau"); break; // Affiche la selection sur nouveau profil
-            }
+
+        case BALANCE_WAIT_TRIAL:
+            (void) Fmt_Str(lcd_frame_at(1, 1), "Masse essai sur", 0);
+            (void) Fmt_Str(lcd_frame_at(1, 2), "pale repere puis OK", 0);
             break;
-        /** @brief Ecran de sauvegarde de profil */
-        case MENU_SAUVEGARDE:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Sauvegarder sous"); // Affiche le titre
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            switch (saveIndex) {
-                /** @brief Sauvegarde dans P1 */
-                case 0: lcd_put_string(">1 2 3 4"); break; // Affiche la selection sur P1
-                /** @brief Sauvegarde dans P2 */
-                case 1: lcd_put_string(" 1>2 3 4"); break; // Affiche la selection sur P2
-                /** @brief Sauvegarde dans P3 */
-                case 2: lcd_put_string(" 1 2>3 4"); break; // Affiche la selection sur P3
-                /** @brief Sauvegarde dans P4 */
-                case 3: lcd_put_string(" 1 2 3>4"); break; // Affiche la selection sur P4
+
+        case BALANCE_DONE:
+            d = Fmt_Str(lcd_frame_at(1, 1), "Corr. ", 0);
+            d = Fmt_Uint(d, (uint32_t) (b.corrRatio * 100.0f + 0.5f), 4); // Masse / masse d'essai [%]
+            (void) Fmt_Str(d, "% essai", 0);
+            if (b.flags & (BALANCE_FLAG_RPM_MISMATCH | BALANCE_FLAG_NO_EFFECT)) {
+                (void) Fmt_Str(lcd_frame_at(20, 1), "!", 0); // Resultat douteux
             }
+            d = Fmt_Str(lcd_frame_at(1, 2), "a ", 0);
+            d = Fmt_Uint(d, (uint32_t) (b.corrDeg + 0.5f) % 360, 3); // Angle [deg]
+            (void) Fmt_Str(d, "deg sens rot.", 0);
             break;
-        /** @brief Configuration du nombre de pales */
-        case MENU_CONF_NB_pale: {
-            char buf[21]; // Buffer pour l'affichage
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Nbr pales :"); // Affiche le texte
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            sprintf(buf, "> %d", appData.nbBlades); // Prepare la valeur
-            lcd_put_string(buf); // Affiche la valeur
-            break;
-        }
-        /** @brief Configuration du nombre de cylindres */
-        case MENU_CONF_NB_CYLINDRE: {
-            char buf[21]; // Buffer pour l'affichage
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Nbr Cylindres:"); // Affiche le texte
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            sprintf(buf, "> %d", appData.nbCylindres); // Prepare la valeur
-            lcd_put_string(buf); // Affiche la valeur
+
+        default:
+            (void) Fmt_Str(lcd_frame_at(1, 1), "Equilibrage", 0);
+            (void) Fmt_Str(lcd_frame_at(1, 2), (b.flags & BALANCE_FLAG_NO_SENSOR) ? "Capteurs arretes" : "OK : reference", 0);
             break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Tables des ecrans                                                          */
+/* -------------------------------------------------------------------------- */
+static const MenuItem itemsBatterie[] = {
+    { 2, 1, 0, MENU_PARAMETRE, 0 }, // Libelle ecrit par Menu_BatterieRender
+    { 2, 2, "Gestion profils", MENU_CHOIX_PROFIL, 0 }
+};
+
+static const MenuItem itemsParametre[] = {
+    { 2, 1, "Parametre", MENU_BATTERIE, 0 },
+    { 2, 2, "Eteindre", MENU_NONE, Menu_Eteindre }
+};
+
+static const MenuItem itemsChoixProfil[] = {
+    { 2, 2, "1", MENU_NONE, Menu_ChoisirProfil },
+    { 4, 2, "2", MENU_NONE, Menu_ChoisirProfil },
+    { 6, 2, "3", MENU_NONE, Menu_ChoisirProfil },
+    { 8, 2, "4", MENU_NONE, Menu_ChoisirProfil },
+    { 10, 2, "Nouveau", MENU_NONE, Menu_ChoisirProfil }
+};
+
+#define MENU_ITEMS(t) (t), (uint8_t) (sizeof(t) / sizeof((t)[0]))
+
+static const MenuScreen screens[MENU_COUNT] = {
+    [MENU_WELCOME] = {
+        .text = { "Capteur RPM", "ETML-ES  LMS" },
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_NONE,
+        .poll = Menu_WelcomePoll
+    },
+    [MENU_BATTERIE] = {
+        .items = MENU_ITEMS(itemsBatterie),
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_NONE,
+        .render = Menu_BatterieRender
+    },
+    [MENU_PARAMETRE] = {
+        .items = MENU_ITEMS(itemsParametre),
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_MESURE_VISUEL, .okTarget = MENU_NONE
+    },
+    [MENU_CHOIX_PROFIL] = {
+        .text = { "Choisir Profil", 0 },
+        .items = MENU_ITEMS(itemsChoixProfil),
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_NONE
+    },
+    [MENU_SAUVEGARDE] = {
+        .text = { "Sauver dans P1-4", 0 },
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_NONE,
+        .onSelect = Menu_SauvegardeSelect, .onOk = Menu_SauvegardeOk,
+        .render = Menu_SauvegardeRender, .enter = Menu_SauvegardeEnter
+    },
+    [MENU_CONF_NB_pale] = {
+        .text = { "Nbr pales :", 0 },
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_CONF_NB_CYLINDRE,
+        .onSelect = Menu_PalesSelect, .render = Menu_PalesRender
+    },
+    [MENU_CONF_NB_CYLINDRE] = {
+        .text = { "Nbr Cylindres:", 0 },
+        .mode = MESURE_MODE_AUCUNE,
+        .selectTarget = MENU_NONE, .okTarget = MENU_SAUVEGARDE,
+        .onSelect = Menu_CylindresSelect, .render = Menu_CylindresRender
+    },
+    [MENU_MESURE_VISUEL] = {
+        .mode = MESURE_MODE_VISUEL,
+        .selectTarget = MENU_MESURE_AUDIO, .okTarget = MENU_NONE,
+        .onOk = Menu_VisuelOk, .render = Menu_VisuelRender, .enter = Menu_VisuelEnter,
+        .poll = Menu_VisuelPoll
+    },
+    [MENU_MESURE_AUDIO] = {
+        .text = { "Mesure Audio", 0 },
+        .mode = MESURE_MODE_AUDIO,
+        .selectTarget = MENU_MESURE_VIBRATION, .okTarget = MENU_NONE,
+        .render = Menu_AudioRender
+    },
+    [MENU_MESURE_VIBRATION] = {
+        .text = { "Mesure Vibration", 0 },
+        .mode = MESURE_MODE_VIBRATION,
+        .selectTarget = MENU_EQUILIBRAGE, .okTarget = MENU_NONE,
+        .render = Menu_VibrationRender
+    },
+    [MENU_EQUILIBRAGE] = {
+        .mode = MESURE_MODE_VIBRATION,
+        .selectTarget = MENU_PARAMETRE, .okTarget = MENU_NONE,
+        .onOk = Menu_EquilibrageOk, .render = Menu_EquilibrageRender
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/* Interpreteur                                                               */
+/* -------------------------------------------------------------------------- */
+/**
+ * @brief Change d'ecran : sortie de l'ancien, entree dans le nouveau.
+ *
+ * @param next Nouvel ecran
+ * @return Aucun retour.
+ */
+static void Menu_Go(MenuState next) {
+    if ((next >= MENU_COUNT) || (next == currentMenu)) {
+        return; // Rien a changer
+    }
+    if (screens[currentMenu].leave != 0) {
+        screens[currentMenu].leave(); // Sortie de l'ecran courant
+    }
+    currentMenu = next; // Nouvel ecran
+    menuCursor = 0; // Premier element
+    if (screens[currentMenu].enter != 0) {
+        screens[currentMenu].enter(); // Entree dans le nouvel ecran
+    }
+}
+
+/**
+ * @brief Compose l'image de l'ecran courant et envoie les cases modifiees.
+ *
+ * @details
+ * L'image complete est recomposee a chaque appel depuis la table ;
+ * lcd_frame_flush() ne met en file que les cases qui ont change, donc un
+ * ecran stable ne coute aucune transaction I2C.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+void Menu_Display(void) {
+    const MenuScreen *scr = &screens[currentMenu]; // Ecran courant
+    uint8_t i;
+
+    lcd_frame_clear(); // Image vierge
+    for (i = 0; i < LCD_ROWS; i++) {
+        if (scr->text[i] != 0) {
+            lcd_frame_write(1, i + 1, scr->text[i]); // Ligne fixe
         }
-        /** @brief Ecran de mesure visuelle */
-        case MENU_MESURE_VISUEL: {
-            char buf[21]; // Buffer pour l'affichage
-            uint8_t profilNum; // Numero du profil
-            Profil *p; // Pointeur sur le profil
-            profilNum = appData.selectedProfil + 1; // Calcule le numero du profil
-            p = Profils_Get(appData.selectedProfil); // Recupere le profil
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            sprintf(buf, "Visuel : %5u RPM", (uint16_t) appData.rpm); // Prepare la chaine RPM
-            lcd_put_string(buf); // Affiche la valeur RPM
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            if (p != 0 && p->validFlag == PROFIL_VALID_FLAG) {
-                sprintf(buf, "Profil%d : %dH  %dC", profilNum, p->nbBlades, p->nbCylindres); // Affiche les infos du profil
-            } else {
-                sprintf(buf, "Profil%d : --   --", profilNum); // Affiche des tirets si profil non valide
-            }
-            lcd_put_string(buf); // Affiche la ligne profil
-            break;
+    }
+    for (i = 0; i < scr->nbItems; i++) {
+        const MenuItem *it = &scr->items[i]; // Element
+        lcd_frame_write(it->col - 1, it->row, (i == menuCursor) ? ">" : " "); // Marqueur
+        if (it->label != 0) {
+            lcd_frame_write(it->col, it->row, it->label); // Libelle fixe
         }
-        /** @brief Ecran de mesure audio */
-        case MENU_MESURE_AUDIO:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Mesure Audio"); // Affiche le texte
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            lcd_put_string("xxxx RPM / Cyl."); // Affiche la ligne info
-            break;
-        /** @brief Ecran de mesure vibration */
-        case MENU_MESURE_VIBRATION:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Mesure Vibration"); // Affiche le texte
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            lcd_put_string("xxxx RPM / Cyl."); // Affiche la ligne info
-            break;
     }
+    if (scr->render != 0) {
+        scr->render(); // Champs variables
+    }
+    (void) lcd_frame_flush(); // Cases modifiees seulement
+}
+
+/**
+ * @brief Force le passage a un ecran (commande distante).
+ *
+ * @details
+ * Passe par la sortie de l'ecran courant. Les chaines de mesure tournent
+ * en fond quel que soit l'ecran : seul le resultat affiche change.
+ *
+ * @param menu Ecran a afficher
+ * @return Aucun retour.
+ */
+void Menu_GoTo(MenuState menu) {
+    Menu_Go(menu);
 }
 
-#define TIMER_FREQ 10000000UL  // 10 MHz
+/**
+ * @brief Action de SELECT sur l'ecran courant.
+ *
+ * @param repeat true pour un appui long ou une repetition
+ * @return Aucun retour.
+ */
+static void Menu_Select(bool repeat) {
+    const MenuScreen *scr = &screens[currentMenu]; // Ecran courant
+
+    if (scr->onSelect != 0) {
+        scr->onSelect(); // Reglage d'une valeur : defile tant que SELECT est tenu
+    } else if (repeat) {
+        return; // Navigation : un ecran par appui
+    } else if ((menuCursor + 1) < scr->nbItems) {
+        menuCursor++; // Element suivant
+    } else if (scr->selectTarget != MENU_NONE) {
+        Menu_Go(scr->selectTarget); // Ecran suivant
+    } else {
+        menuCursor = 0; // Retour au premier element
+    }
+}
+
+/**
+ * @brief Action de OK sur l'ecran courant.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Menu_Ok(void) {
+    const MenuScreen *scr = &screens[currentMenu]; // Ecran courant
+
+    if (scr->onOk != 0) {
+        scr->onOk(); // Traitement propre a l'ecran
+    } else if (scr->nbItems != 0) {
+        const MenuItem *it = &scr->items[menuCursor]; // Element selectionne
+        if (it->action != 0) {
+            it->action(menuCursor); // Action de l'element
+        } else {
+            Menu_Go(it->target); // Ecran de l'element
+        }
+    } else {
+        Menu_Go(scr->okTarget); // Ecran suivant
+    }
+}
 
 /**
  * @brief Gere la logique de navigation et d'action des menus.
  *
  * @details
- * Cette fonction gere les entrees utilisateur (boutons), la navigation entre les differents
- * menus, la gestion des profils, la configuration, et les mesures. Elle met a jour l'etat
- * courant du menu et declenche l'affichage si necessaire.
+ * Interprete la table de l'ecran courant : crochets, evenements boutons
+ * (SELECT tenu fait defiler les valeurs, OK + SELECT ramene a l'accueil),
+ * mode de mesure, puis compose l'image. Aucune ecriture directe sur l'afficheur :
+ * seules les cases modifiees partent dans la file I2C.
  *
  * @param Aucun parametre.
  * @return Aucun retour.
  */
 void Menu_Task(void) {
-    uint8_t btn = GestBtn_Scan(); // Lit l'etat des boutons
-    static uint8_t RefreshNeeded = 0; // Flag pour rafraichir l'affichage
-    static bool captureStarted = false; // Etat de la capture RPM
-    static uint16_t lastRpm; // Dernier RPM affiche
-    static uint8_t accInitDone = 0; // Flag d'init acc
-    static uint16_t accTick = 0; // Compteur pour lecture acc
-    static int16_t accX = 0; // Acceleration X
-    static int16_t accY = 0; // Acceleration Y
-    static int16_t accZ = 0; // Acceleration Z
-    static uint8_t accID = 0; // ID du capteur
-    switch (currentMenu) {
-        /** @brief Logique d'entree : passage a la selection de profil */
-        case MENU_WELCOME:
-            RefreshNeeded = true; // Demande un rafraichissement
-            currentMenu = MENU_CHOIX_PROFIL; // Passe au menu choix profil
-            break;
-        /** @brief Gestion du menu batterie et navigation profils */
-        case MENU_BATTERIE:
-            if (btn & GESTBTN_SELECT) {
-                curseurBatterie ^= 1; // Change la selection
-                RefreshNeeded = true; // Rafraichit l'affichage
-            } else if (btn & GESTBTN_OK) {
-                if (curseurBatterie == 0) {
-                    currentMenu = MENU_PARAMETRE; // Va au menu parametre
-                    curseurParametre = 0; // Reset le curseur
-                } else {
-                    currentMenu = MENU_CHOIX_PROFIL; // Retour au choix profil
-                }
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Gestion du menu parametres */
-        case MENU_PARAMETRE:
-            if (btn & GESTBTN_SELECT) {
-                if (curseurParametre == 0) {
-                    curseurParametre = 1; // Change la selection
-                    RefreshNeeded = true; // Rafraichit l'affichage
-                } else {
-                    currentMenu = MENU_MESURE_VISUEL; // Va a la mesure visuelle
-                    RefreshNeeded = true; // Rafraichit l'affichage
-                }
-            } else if (btn & GESTBTN_OK) {
-                if (curseurParametre == 0) {
-                    currentMenu = MENU_BATTERIE; // Retour au menu batterie
-                } else {
-                    BL_CONTROL_Off(); // Eteint le retroeclairage
-                    EN_LDO_Off(); // Eteint le regulateur
-                }
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Logique de selection ou creation de profil */
-        case MENU_CHOIX_PROFIL:
-            if (btn & GESTBTN_SELECT) {
-                profilIndex = (profilIndex + 1) % 5; // Incremente l'index de profil
-                RefreshNeeded = true; // Rafraichit l'affichage
-            } else if (btn & GESTBTN_OK) {
-                if (profilIndex == 4) {
-                    uint8_t slot = 0xFF; // Slot pour nouveau profil
-                    uint8_t i;
-                    for (i = 0; i < NB_PROFILS; i++) {
-                        Profil *p = Profils_Get(i); // Recupere le profil
-                        if (p == 0 || p->validFlag != PROFIL_VALID_FLAG) {
-                            slot = i; // Trouve un slot libre
-                            break;
-                        }
-                    }
-                    if (slot == 0xFF) {
-                        slot = 0; // Si aucun slot libre, prend le premier
-                    }
-                    appData.selectedProfil = slot; // Selectionne le profil
-                    currentMenu = MENU_CONF_NB_pale; // Passe a la config pales
+    GestBtn_Event ev; // Evenement bouton
+
+    if (screens[currentMenu].poll != 0) {
+        screens[currentMenu].poll(); // Traitement periodique de l'ecran
+    }
+
+    while (GestBtn_GetEvent(&ev)) {
+        PowerMgr_NotifyActivity(); // Retroeclairage plein
+        switch (ev.type) {
+            case GESTBTN_EV_PRESS:
+                if (ev.buttons & GESTBTN_SELECT) {
+                    Menu_Select(false);
                 } else {
-                    Profil *p;
-                    appData.selectedProfil = profilIndex; // Selectionne le profil existant
-                    p = Profils_Get(profilIndex); // Recupere le profil
-                    if (p != 0 && p->validFlag == PROFIL_VALID_FLAG) {
-                        appData.nbBlades = p->nbBlades; // Charge le nombre de pales
-                        appData.nbCylindres = p->nbCylindres; // Charge le nombre de cylindres
-                    }
-                    currentMenu = MENU_MESURE_VISUEL; // Passe a la mesure visuelle
-                }
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Logique de sauvegarde de profil */
-        case MENU_SAUVEGARDE:
-            lcd_set_cursor(1, 1); // Place le curseur sur la premiere ligne
-            lcd_put_string("Sauver dans P1-4"); // Affiche le titre
-            lcd_set_cursor(1, 2); // Place le curseur sur la deuxieme ligne
-            {
-                char buf[21]; // Buffer pour l'affichage
-                sprintf(buf, ">P%d  (%dH %dC)", saveIndex + 1, appData.nbBlades, appData.nbCylindres); // Prepare la chaine
-                lcd_put_string(buf); // Affiche la ligne
-            }
-            if (btn & GESTBTN_SELECT) {
-                saveIndex = (saveIndex + 1) % NB_PROFILS; // Incremente l'index de sauvegarde
-                RefreshNeeded = true; // Rafraichit l'affichage
-            } else if (btn & GESTBTN_OK) {
-                Profils_SaveToNVM(saveIndex, appData.nbBlades, appData.nbCylindres); // Sauvegarde le profil
-                appData.selectedProfil = saveIndex; // Selectionne le profil sauvegarde
-                currentMenu = MENU_MESURE_VISUEL; // Passe a la mesure visuelle
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Reglage du nombre de pales */
-        case MENU_CONF_NB_pale:
-            if (btn & GESTBTN_SELECT) { /* bouton SELECT      */
-                appData.nbBlades = (appData.nbBlades % 4) + 1; /* 1->2->3->4->1   */
-                RefreshNeeded = true; /* rafraichir ecran   */
-            } else if (btn & GESTBTN_OK) { /* bouton OK          */
-                currentMenu = MENU_CONF_NB_CYLINDRE; /* etape suivante     */
-                RefreshNeeded = true;
-            }
-            break;
-        /** @brief Reglage du nombre de cylindres */
-        case MENU_CONF_NB_CYLINDRE:
-            if (btn & GESTBTN_SELECT) {
-                if (++appData.nbCylindres > 7)
-                    appData.nbCylindres = 4; // Remet a 4 si depasse 7
-                RefreshNeeded = 1; // Rafraichit l'affichage
-            } else if (btn & GESTBTN_OK) {
-                currentMenu = MENU_SAUVEGARDE; // Passe a la sauvegarde
-                saveIndex = appData.selectedProfil; // Propose le profil courant
-                RefreshNeeded = 1; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Mesure visuelle du RPM */
-        case MENU_MESURE_VISUEL:
-            if (!captureStarted) {
-                captureStarted = true; // Demarre la capture
-                appData.captureIndex = 0; // Reset l'index de capture
-                appData.rpmCaptureActive = true; // Active la capture
-                CFGCONbits.ICACLK = 0; // Configure le timer
-                DRV_TMR1_Start(); // Demarre le timer
-                DRV_IC0_Start(); // Demarre la capture
-            }
-            static uint16_t lostCaptureCounter = 0; // Compteur de perte de capture
-            static uint8_t lastCaptureIndex = 0; // Dernier index de capture
-            uint8_t i = appData.captureIndex; // Index courant
-            uint8_t j = (i + RPM_CAPTURE_BUFFER_SIZE - 1) % RPM_CAPTURE_BUFFER_SIZE; // Index precedent
-            uint8_t k = (j + RPM_CAPTURE_BUFFER_SIZE - 1) % RPM_CAPTURE_BUFFER_SIZE; // Index encore precedent
-            uint32_t delta = appData.captureBuffer[j] - appData.captureBuffer[k]; // Difference de temps
-            if (delta != 0 && appData.nbBlades != 0) {
-                appData.rpm = (60UL * TIMER_FREQ) / (delta * appData.nbBlades); // Calcule le RPM
-            }
-            if (i == lastCaptureIndex) {
-                lostCaptureCounter = lostCaptureCounter + 1; // Incremente le compteur de perte
-                if (lostCaptureCounter > 100) {
-                    if (appData.rpm != 0) {
-                        appData.rpm = 0; // Met le RPM a zero si perte
-                        RefreshNeeded = true; // Rafraichit l'affichage
-                    }
+                    Menu_Ok();
                 }
-            } else {
-                lostCaptureCounter = 0; // Reset le compteur de perte
-                lastCaptureIndex = i; // Met a jour l'index
-            }
-            if ((uint16_t) appData.rpm != lastRpm) {
-                lastRpm = (uint16_t) appData.rpm; // Met a jour le dernier RPM
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            if (btn & GESTBTN_SELECT) {
-                captureStarted = false; // Arrete la capture
-                appData.rpmCaptureActive = false; // Desactive la capture
-                DRV_IC0_Stop(); // Arrete la capture
-                DRV_TMR1_Stop(); // Arrete le timer
-                currentMenu = MENU_MESURE_AUDIO; // Passe a la mesure audio
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Mesure audio du RPM */
-        case MENU_MESURE_AUDIO:
-            if (btn & GESTBTN_SELECT) {
-                currentMenu = MENU_MESURE_VIBRATION; // Passe a la mesure vibration
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        /** @brief Mesure vibration du RPM */
-        case MENU_MESURE_VIBRATION:
-            if (accInitDone == 0) {
-                SPI_ConfigureAcc(); // Configure l'accelerometre
-                LIS2HH12_Init(); // Initialise le capteur
-                accID = LIS2HH12_ReadID(); // Lit l'ID du capteur
-                if (accID == 0x41) {
-                    LIFE_LED_Toggle(); // Indique la detection
+                break;
+            case GESTBTN_EV_LONG:
+            case GESTBTN_EV_REPEAT:
+                if (ev.buttons & GESTBTN_SELECT) {
+                    Menu_Select(true); // Defilement rapide des valeurs
                 }
-                accInitDone = 1; // Marque l'init comme faite
-            }
-            accTick = accTick + 1; // Incremente le compteur
-            if (accTick >= 50) { // Lecture toutes les 50 iterations
-                LIS2HH12_ReadXYZ(&accX, &accY, &accZ); // Lit les axes
-                accTick = 0; // Reset le compteur
-            }
-            if (btn & GESTBTN_SELECT) {
-                currentMenu = MENU_PARAMETRE; // Retour au menu parametre
-                curseurParametre = 0; // Reset le curseur
-                RefreshNeeded = true; // Rafraichit l'affichage
-            }
-            break;
-        default:
-            break;
+                break;
+            case GESTBTN_EV_CHORD:
+                Menu_Go(MENU_CHOIX_PROFIL); // Retour a l'accueil depuis n'importe quel ecran
+                break;
+            default:
+                break;
+        }
     }
-    if (RefreshNeeded) {
-        Menu_Display(); // Rafraichit l'affichage
-        RefreshNeeded = false; // Reset le flag
+
+    appData.measureMode = screens[currentMenu].mode; // Mode transmis dans la telemetrie
+    PowerMgr_SetMeasureMode(appData.measureMode); // Mode retenu pour la reduction du retroeclairage
+
+    if (lcd_is_ready()) {
+        PROF_BEGIN(PROF_SITE_MENU_DISPLAY); // Debut de la sonde
+        Menu_Display(); // Compose l'image et envoie les differences
+        PROF_END(PROF_SITE_MENU_DISPLAY); // Fin de la sonde
     }
 }
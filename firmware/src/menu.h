@@ -20,13 +20,22 @@ typedef enum {
     MENU_CONF_NB_CYLINDRE,
     MENU_MESURE_VISUEL,
     MENU_MESURE_AUDIO,
-    MENU_MESURE_VIBRATION
+    MENU_MESURE_VIBRATION,
+    MENU_EQUILIBRAGE,
+    MENU_COUNT // Nombre d'ecrans
 } MenuState;
 
+#define MENU_NONE   MENU_COUNT // Pas d'ecran suivant
+
+#define MENU_MAX_PALES      4 // Pales maximum selectionnables
+#define MENU_MIN_CYLINDRES  4 // Cylindres minimum selectionnables
+#define MENU_MAX_CYLINDRES  7 // Cylindres maximum selectionnables
+
 /**
- * @brief Initialise et affiche le contenu du menu courant.
+ * @brief Compose l'image du menu courant et envoie les cases modifiees.
  * 
- * Doit etre appelee au demarrage et aprs tout changement d'etat de menu.
+ * Appelee par Menu_Task a chaque passage : un ecran stable ne coute
+ * aucune transaction I2C.
  */
 void Menu_Display(void);
 
@@ -37,4 +46,13 @@ void Menu_Display(void);
  */
 void Menu_Task(void);
 
+/**
+ * @brief Force le passage a un ecran (commande distante).
+ * 
+ * Les chaines de mesure continuent en fond : seul l'ecran change.
+ *
+ * @param menu Ecran a afficher
+ */
+void Menu_GoTo(MenuState menu);
+
 
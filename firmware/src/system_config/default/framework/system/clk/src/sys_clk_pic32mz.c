@@ -94,26 +94,26 @@ void SYS_CLK_Initialize( const SYS_CLK_INIT const * clkInit )
     PLIB_OSC_FRCDivisorSelect( OSC_ID_0, OSC_FRC_DIV_1);
 
     /* Enable Peripheral Bus 1 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 0, 2 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 0, SYS_CLK_PB1_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 0 );
 
     /* Enable Peripheral Bus 2 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 1, 4 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 1, SYS_CLK_PB2_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 1 );
     /* Enable Peripheral Bus 3 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 2, 10 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 2, SYS_CLK_PB3_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 2 );
     /* Enable Peripheral Bus 4 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 3, 2 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 3, SYS_CLK_PB4_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 3 );
     /* Enable Peripheral Bus 5 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 4, 2 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 4, SYS_CLK_PB5_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 4 );
     /* Enable Peripheral Bus 7 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 6, 1 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 6, SYS_CLK_PB7_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 6 );
     /* Enable Peripheral Bus 8 */
-    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 7, 2 );
+    PLIB_OSC_PBClockDivisorSet (OSC_ID_0, 7, SYS_CLK_PB8_DIV );
     PLIB_OSC_PBOutputClockEnable (OSC_ID_0, 7 );
   
  
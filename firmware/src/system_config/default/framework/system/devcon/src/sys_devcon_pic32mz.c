@@ -55,6 +55,11 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #include "peripheral/int/plib_int.h"
 #include "peripheral/pcache/plib_pcache.h"
 
+/* Mode de prefetch (defini par le profil de performance de system_config.h) */
+#ifndef SYS_DEVCON_PREFETCH_MODE
+#define SYS_DEVCON_PREFETCH_MODE PLIB_PCACHE_PREFETCH_ENABLE_ALL
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: File Scope or Global Constants
@@ -132,7 +137,7 @@ void __attribute__((nomips16)) SYS_DEVCON_PerformanceConfig( unsigned int sysclk
     #if defined(PLIB_PCACHE_ExistsPrefetchEnable)
     if (PLIB_PCACHE_ExistsPrefetchEnable(PCACHE_ID_0))
     {
-        PLIB_PCACHE_PrefetchEnableSet(PCACHE_ID_0, PLIB_PCACHE_PREFETCH_ENABLE_ALL);
+        PLIB_PCACHE_PrefetchEnableSet(PCACHE_ID_0, SYS_DEVCON_PREFETCH_MODE);
     }
     #endif
     
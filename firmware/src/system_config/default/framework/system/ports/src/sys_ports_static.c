@@ -139,10 +139,13 @@ void SYS_PORTS_Initialize(void)
     PLIB_PORTS_RemapInput(PORTS_ID_0, INPUT_FUNC_U1RX, INPUT_PIN_RPG8 );
     PLIB_PORTS_RemapInput(PORTS_ID_0, INPUT_FUNC_U4RX, INPUT_PIN_RPB6 );
     PLIB_PORTS_RemapInput(PORTS_ID_0, INPUT_FUNC_IC3, INPUT_PIN_RPF4 );
+    PLIB_PORTS_RemapInput(PORTS_ID_0, INPUT_FUNC_T6CK, INPUT_PIN_RPF4 );
 
     /* PPS Output Remapping */
     PLIB_PORTS_RemapOutput(PORTS_ID_0, OUTPUT_FUNC_SDO1, OUTPUT_PIN_RPF1 );
     PLIB_PORTS_RemapOutput(PORTS_ID_0, OUTPUT_FUNC_U4TX, OUTPUT_PIN_RPB7 );
+    PLIB_PORTS_RemapOutput(PORTS_ID_0, OUTPUT_FUNC_U5TX, OUTPUT_PIN_RPG7 );
+    PLIB_PORTS_RemapOutput(PORTS_ID_0, OUTPUT_FUNC_OC4, OUTPUT_PIN_RPF5 );
 
     
 }
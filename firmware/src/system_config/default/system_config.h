@@ -81,14 +81,45 @@ extern "C" {
 // *****************************************************************************
 /* Clock System Service Configuration Options
 */
+/* Profil de performance :
+ *   PERF_PROFILE_ECO  : SYSCLK 100 MHz (FPLLODIV = DIV_4)
+ *   PERF_PROFILE_FULL : SYSCLK 200 MHz (FPLLODIV = DIV_2, system_init.c)
+ * Les diviseurs PBCLK suivent SYSCLK : les frequences peripheriques (UART,
+ * SPI, I2C, Timer1, capture) sont identiques dans les deux profils. Seuls
+ * le CPU, le Core Timer (SYSCLK / 2) et PBCLK7 changent. Les attentes
+ * flash sont calculees par SYS_DEVCON_PerformanceConfig. */
+#define PERF_PROFILE_ECO                    0
+#define PERF_PROFILE_FULL                   1
+#ifndef PERF_PROFILE
+#define PERF_PROFILE                        PERF_PROFILE_FULL
+#endif
+
+#if (PERF_PROFILE == PERF_PROFILE_FULL)
+#define SYS_CLK_FREQ                        200000000ul
+#define SYS_CLK_PB_SCALE                    2
+#define SYS_CLK_BUS_PERIPHERAL_7            200000000ul
+#else
 #define SYS_CLK_FREQ                        100000000ul
+#define SYS_CLK_PB_SCALE                    1
+#define SYS_CLK_BUS_PERIPHERAL_7            100000000ul
+#endif
 #define SYS_CLK_BUS_PERIPHERAL_1            50000000ul
 #define SYS_CLK_BUS_PERIPHERAL_2            25000000ul
 #define SYS_CLK_BUS_PERIPHERAL_3            10000000ul
 #define SYS_CLK_BUS_PERIPHERAL_4            50000000ul
 #define SYS_CLK_BUS_PERIPHERAL_5            50000000ul
-#define SYS_CLK_BUS_PERIPHERAL_7            100000000ul
 #define SYS_CLK_BUS_PERIPHERAL_8            50000000ul
+// Diviseurs PBCLK (PBCLK7 = horloge CPU, toujours / 1)
+#define SYS_CLK_PB1_DIV                     (2 * SYS_CLK_PB_SCALE)
+#define SYS_CLK_PB2_DIV                     (4 * SYS_CLK_PB_SCALE)
+#define SYS_CLK_PB3_DIV                     (10 * SYS_CLK_PB_SCALE)
+#define SYS_CLK_PB4_DIV                     (2 * SYS_CLK_PB_SCALE)
+#define SYS_CLK_PB5_DIV                     (2 * SYS_CLK_PB_SCALE)
+#define SYS_CLK_PB7_DIV                     1
+#define SYS_CLK_PB8_DIV                     (2 * SYS_CLK_PB_SCALE)
+// Cache L1 (kseg0) et prefetch flash
+#define SYS_DEVCON_CACHE_COHERENCY          SYS_CACHE_WRITEBACK_WRITEALLOCATE
+#define SYS_DEVCON_PREFETCH_MODE            PLIB_PCACHE_PREFETCH_ENABLE_ALL
 #define SYS_CLK_CONFIG_PRIMARY_XTAL         8000000ul
 #define SYS_CLK_CONFIG_SECONDARY_XTAL       32768ul
    
@@ -117,9 +148,9 @@ extern "C" {
 #define SYS_PORT_D_CNPD         0x0000
 #define SYS_PORT_D_CNEN         0x0000
 
-#define SYS_PORT_E_ANSEL        0xFF10
-#define SYS_PORT_E_TRIS         0xFF17
-#define SYS_PORT_E_LAT          0x0000
+#define SYS_PORT_E_ANSEL        0xFF00
+#define SYS_PORT_E_TRIS         0xFF03
+#define SYS_PORT_E_LAT          0x0004
 #define SYS_PORT_E_ODC          0x0000
 #define SYS_PORT_E_CNPU         0x0000
 #define SYS_PORT_E_CNPD         0x0000
@@ -133,7 +164,7 @@ extern "C" {
 #define SYS_PORT_F_CNPD         0x0000
 #define SYS_PORT_F_CNEN         0x0000
 
-#define SYS_PORT_G_ANSEL        0xFEBF
+#define SYS_PORT_G_ANSEL        0xFE3F
 #define SYS_PORT_G_TRIS         0xFFFF
 #define SYS_PORT_G_LAT          0x0000
 #define SYS_PORT_G_ODC          0x0000
@@ -214,6 +245,20 @@ extern "C" {
 #define TX_485_ENStateGet() PLIB_PORTS_PinGetLatched(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_5)
 #define TX_485_ENStateSet(Value) PLIB_PORTS_PinWrite(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_5, Value)
 
+/*** Functions for RX_485_EN_ pin ***/
+#define RX_485_EN_Toggle() PLIB_PORTS_PinToggle(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_4)
+#define RX_485_EN_On() PLIB_PORTS_PinSet(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_4)
+#define RX_485_EN_Off() PLIB_PORTS_PinClear(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_4)
+#define RX_485_EN_StateGet() PLIB_PORTS_PinGetLatched(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_4)
+#define RX_485_EN_StateSet(Value) PLIB_PORTS_PinWrite(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_4, Value)
+
+/*** Functions for BAT_SENS_EN_ pin ***/
+#define BAT_SENS_EN_Toggle() PLIB_PORTS_PinToggle(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_2)
+#define BAT_SENS_EN_On() PLIB_PORTS_PinSet(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_2)
+#define BAT_SENS_EN_Off() PLIB_PORTS_PinClear(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_2)
+#define BAT_SENS_EN_StateGet() PLIB_PORTS_PinGetLatched(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_2)
+#define BAT_SENS_EN_StateSet(Value) PLIB_PORTS_PinWrite(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_2, Value)
+
 /*** Functions for EN_LDO_ pin ***/
 #define EN_LDO_Toggle() PLIB_PORTS_PinToggle(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_6)
 #define EN_LDO_On() PLIB_PORTS_PinSet(PORTS_ID_0, PORT_CHANNEL_E, PORTS_BIT_POS_6)
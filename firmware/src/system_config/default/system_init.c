@@ -97,7 +97,11 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #pragma config FPLLRNG =    RANGE_5_10_MHZ
 #pragma config FPLLICLK =   PLL_POSC
 #pragma config FPLLMULT =   MUL_50
+#if (PERF_PROFILE == PERF_PROFILE_FULL)
+#pragma config FPLLODIV =   DIV_2
+#else
 #pragma config FPLLODIV =   DIV_4
+#endif
 #pragma config UPLLFSEL =   FREQ_24MHZ
 /*** DEVCFG3 ***/
 
@@ -105,7 +109,7 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #pragma config FMIIEN =     ON
 #pragma config FETHIO =     ON
 #pragma config PGL1WAY =    ON
-#pragma config PMDL1WAY =   ON
+#pragma config PMDL1WAY =   OFF
 #pragma config IOL1WAY =    ON
 #pragma config FUSBIDIO =   ON
 
@@ -168,6 +172,7 @@ void SYS_Initialize ( void* data )
     SYS_CLK_Initialize( NULL );
     SYS_DEVCON_Initialize(SYS_DEVCON_INDEX_0, (SYS_MODULE_INIT*)NULL);
     SYS_DEVCON_PerformanceConfig(SYS_CLK_SystemFrequencyGet());
+    SYS_DEVCON_CacheCoherencySet(SYS_DEVCON_CACHE_COHERENCY);
 
     /* Initialize Drivers */
     DRV_I2C0_Initialize();
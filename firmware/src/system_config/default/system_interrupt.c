@@ -61,6 +61,12 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 
 #include "system/common/sys_common.h"
 #include "app.h"
+#include "Rs485.h"
+#include "UsbStream.h"
+#include "LatBench.h"
+#include "Bench.h"
+#include "i2c_master.h"
+#include "GestBtn.h"
 #include "system_definitions.h"
 
 // *****************************************************************************
@@ -92,6 +98,60 @@ void __ISR(_INPUT_CAPTURE_3_ERROR_VECTOR, ipl1AUTO) _IntHandlerDrvICErrorInstanc
 {
     PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_INPUT_CAPTURE_3_ERROR);
 }
+
+void __ISR(_DMA0_VECTOR, ipl1AUTO) _IntHandlerRs485DmaTx(void)
+{
+    Rs485_DmaTxCallback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_DMA_0);
+}
+
+void __ISR(_UART5_TX_VECTOR, ipl1AUTO) _IntHandlerRs485Tx(void)
+{
+    Rs485_TxCallback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_5_TRANSMIT);
+}
+
+void __ISR(_UART2_RX_VECTOR, ipl1AUTO) _IntHandlerRs485Rx(void)
+{
+    Rs485_RxCallback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_2_RECEIVE);
+}
+
+void __ISR(_DMA1_VECTOR, ipl1AUTO) _IntHandlerUsbStreamDmaTx(void)
+{
+    UsbStream_DmaTxCallback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_DMA_1);
+}
+
+void __ISR(_OUTPUT_COMPARE_4_VECTOR, ipl1AUTO) _IntHandlerLatBenchOc4(void)
+{
+    LatBench_Oc4Callback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_OUTPUT_COMPARE_4);
+}
+
+void __ISR(_CORE_SOFTWARE_0_VECTOR, ipl1AUTO) _IntHandlerBenchSw0(void)
+{
+    Bench_SwIsrCallback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_SOFTWARE_0);
+}
+
+void __ISR(_I2C1_MASTER_VECTOR, ipl1AUTO) _IntHandlerI2c1Master(void)
+{
+    i2c_master_callback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_MASTER);
+}
+
+void __ISR(_I2C1_BUS_VECTOR, ipl1AUTO) _IntHandlerI2c1Bus(void)
+{
+    i2c_bus_callback();
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_I2C_1_BUS);
+}
+
+void __ISR(_CHANGE_NOTICE_E_VECTOR, ipl1AUTO) _IntHandlerChangeNotification_PortE(void)
+{
+    GestBtn_ChangeIsr(); // Lit le port avant d'effacer le drapeau
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_CHANGE_NOTICE_E);
+}
  /*******************************************************************************
  End of File
 */
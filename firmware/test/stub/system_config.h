@@ -0,0 +1,12 @@
+/*
+--------------------------------------------------------
+ Fichier : system_config.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Remplacant vide de l'entete Harmony pour les tests sur PC
+--------------------------------------------------------*/
+
+#ifndef _SYSTEM_CONFIG_H
+#define _SYSTEM_CONFIG_H
+
+#endif
@@ -0,0 +1,17 @@
+/*
+--------------------------------------------------------
+ Fichier : xc.h
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Remplacant de l'entete du compilateur XC32 pour les tests sur PC
+--------------------------------------------------------*/
+
+#ifndef _XC_H_
+#define _XC_H_
+
+#include <stdint.h> // Types entiers standard
+
+// Compteur du coeur (fourni par le test qui en a besoin)
+uint32_t _CP0_GET_COUNT(void);
+
+#endif
@@ -0,0 +1,411 @@
+/*
+--------------------------------------------------------
+ Fichier : test_cmdprotocol.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Test sur PC du protocole commande / reponse en boucle locale
+--------------------------------------------------------
+*/
+#include "CmdProtocol.h" // Module teste
+#include "SerialFrame.h" // Encodage des commandes
+#include "Rs485.h" // Liaison remplacee par la boucle locale
+#include "Telemetry.h" // Periode d'emission
+#include "app.h" // Donnees de l'application
+#include "menu.h" // Changement d'ecran
+#include "ProfilStorage.h" // Profils
+#include "PotControl.h" // Wipers
+#include "LIS2HH12.h" // Configuration SPI
+#include "PowerMgr.h" // Compteurs d'energie
+#include "Profiler.h" // Sondes de temps
+#include "Timebase.h" // Base de temps
+#include "LatBench.h" // Banc de latence
+#include "IsrPrio.h" // Niveaux d'interruption
+#include "Mesure.h" // Instantane de mesure
+#include "MesureEngine.h" // Chaines de mesure
+#include "Balance.h" // Equilibrage
+#include "Tsa.h" // Moyenne synchrone
+#include "OrderTrack.h" // Suivi d'ordres
+#include "Zoom.h" // Zoom FFT
+#include "IrPulse.h" // Impulsions IR
+#include "IrCounter.h" // Compteur IR
+#include "IrCalib.h" // Calibration IR
+#include "Bench.h" // Banc de performance
+#include <stdio.h> // Pour printf
+#include <string.h> // Pour memset et memcmp
+
+static int checks = 0; // Verifications faites
+static int failures = 0; // Verifications en echec
+
+// Compte une verification et signale l'echec avec la ligne
+#define CHECK(cond) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        printf("ECHEC %s:%d : %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+// Taille du buffer de reception simule
+#define RX_SIZE     512
+
+// Boucle locale : octets a recevoir et reponses emises
+static uint8_t rxBuf[RX_SIZE]; // Octets en attente de lecture
+static uint16_t rxHead = 0; // Prochaine ecriture
+static uint16_t rxTail = 0; // Prochaine lecture
+static bool txBusy = false; // Emetteur occupe
+static uint8_t txType = 0; // Type de la derniere reponse
+static uint16_t txLen = 0; // Taille de la derniere reponse
+static uint8_t txPayload[1 + FRAME_MAX_RX_PAYLOAD]; // Derniere reponse (statut compris)
+static uint32_t txFrames = 0; // Reponses emises
+static Rs485_Stats rsStats; // Compteurs de la liaison
+
+// Traces des modules remplaces
+static Profil profils[NB_PROFILS]; // Profils en memoire
+static uint32_t saveCalls = 0; // Appels a Profils_SaveToNVM
+static uint8_t saveArgs[3]; // Derniers arguments sauves
+static MenuState lastMenu = MENU_CHOIX_PROFIL; // Dernier ecran demande
+static uint16_t telemetryMs = 0; // Derniere periode de telemetrie
+
+APP_DATA appData; // Donnees de l'application
+
+/* ---- Remplacants de la liaison RS485 ---- */
+
+const Rs485_Stats* Rs485_GetStats(void)
+{
+    return &rsStats; // Compteurs a zero
+}
+
+bool Rs485_IsBusy(void)
+{
+    return txBusy; // Etat impose par le test
+}
+
+bool Rs485_ReadByte(uint8_t *b)
+{
+    if (rxTail == rxHead) {
+        return false; // Rien a lire
+    }
+    *b = rxBuf[rxTail++]; // Octet suivant
+    return true;
+}
+
+bool Rs485_SendFrame(uint8_t type, const uint8_t *payload, uint16_t len)
+{
+    if (txBusy || (len > sizeof (txPayload))) {
+        return false; // Refus, comme la liaison occupee
+    }
+    txType = type; // Trace de la reponse
+    txLen = len;
+    memcpy(txPayload, payload, len);
+    txFrames++;
+    return true;
+}
+
+/* ---- Remplacants des modules appeles par le dispatcher ---- */
+
+Profil* Profils_Get(uint8_t index)
+{
+    return (index < NB_PROFILS) ? &profils[index] : 0; // Profil ou hors limites
+}
+
+void Profils_SaveToNVM(uint8_t index, uint8_t blades, uint8_t cyl)
+{
+    saveCalls++; // Trace de l'appel
+    saveArgs[0] = index;
+    saveArgs[1] = blades;
+    saveArgs[2] = cyl;
+}
+
+void Menu_GoTo(MenuState menu) { lastMenu = menu; }
+void Telemetry_SetPeriod(uint16_t newPeriodMs) { telemetryMs = newPeriodMs; }
+void Pot_Write(uint8_t index, uint8_t value) { (void) index; (void) value; }
+void SPI_ConfigureAcc(void) { }
+void SPI_ConfigurePot(void) { }
+const PowerMgr_Stats* PowerMgr_GetStats(void) { static PowerMgr_Stats s; return &s; }
+void Profiler_Clear(uint8_t site) { (void) site; }
+bool Profiler_Snapshot(uint8_t site, Profiler_Site *out) { (void) site; memset(out, 0, sizeof (*out)); return false; }
+uint32_t Timebase_TicksPerUs(void) { return 100; }
+const IsrPrio_Config* IsrPrio_Get(uint8_t config) { static IsrPrio_Config c; (void) config; return &c; }
+bool LatBench_GetResult(uint8_t cfg, LatBench_Result *out) { (void) cfg; memset(out, 0, sizeof (*out)); return false; }
+uint8_t LatBench_GetState(uint16_t *freqHz) { *freqHz = 0; return 0; }
+bool LatBench_Start(uint16_t freqHz) { (void) freqHz; return false; }
+void Mesure_Get(Mesure_Snapshot *out) { memset(out, 0, sizeof (*out)); }
+bool MesureEngine_IsRunning(uint8_t pipe) { (void) pipe; return false; }
+void MesureEngine_Release(uint8_t pipe) { (void) pipe; }
+void Balance_Cancel(void) { }
+void Balance_Get(Balance_Result *out) { memset(out, 0, sizeof (*out)); }
+bool Balance_Next(void) { return false; }
+bool Tsa_Start(void) { return false; }
+void Tsa_Stop(void) { }
+void Tsa_GetOrders(Tsa_Orders *out) { memset(out, 0, sizeof (*out)); }
+bool OrderTrack_Start(void) { return false; }
+void OrderTrack_Stop(void) { }
+void OrderTrack_Get(OrderTrack_Result *out) { memset(out, 0, sizeof (*out)); }
+bool Zoom_Start(uint8_t lineSel, uint16_t centerRpm) { (void) lineSel; (void) centerRpm; return false; }
+void Zoom_Stop(void) { }
+void Zoom_Get(Zoom_Result *out) { memset(out, 0, sizeof (*out)); }
+void IrPulse_Get(IrPulse_Stats *out) { memset(out, 0, sizeof (*out)); }
+bool IrCounter_DualEdge(void) { return false; }
+bool IrCalib_Start(void) { return false; }
+void IrCalib_Cancel(void) { }
+void IrCalib_Get(IrCalib_Result *out) { memset(out, 0, sizeof (*out)); }
+bool Bench_Start(void) { return false; }
+void Bench_GetResult(Bench_Result *out) { memset(out, 0, sizeof (*out)); }
+uint32_t _CP0_GET_COUNT(void) { return 0; }
+
+/* ---- Outils du test ---- */
+
+/**
+ * @brief Ajoute des octets bruts au buffer de reception.
+ *
+ * @param data Octets recus
+ * @param len Nombre d'octets
+ * @return Aucun retour.
+ */
+static void RxPush(const uint8_t *data, uint16_t len)
+{
+    uint16_t i; // Indice d'octet
+
+    for (i = 0; (i < len) && (rxHead < RX_SIZE); i++) {
+        rxBuf[rxHead++] = data[i]; // Copie lineaire, le test reste petit
+    }
+}
+
+/**
+ * @brief Trame une commande et l'ajoute au buffer de reception.
+ *
+ * @param type Code de la commande
+ * @param payload Payload de la commande
+ * @param len Taille du payload
+ * @return Aucun retour.
+ */
+static void RxCommand(uint8_t type, const uint8_t *payload, uint16_t len)
+{
+    uint8_t frame[FRAME_MAX_RX_PAYLOAD + 8 + FRAME_OVERHEAD]; // Commande tramee
+
+    RxPush(frame, SerialFrame_Encode(type, payload, len, frame, sizeof (frame)));
+}
+
+/**
+ * @brief Remet la boucle locale et le protocole a zero.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Reset(void)
+{
+    rxHead = 0;
+    rxTail = 0;
+    txBusy = false;
+    txFrames = 0;
+    saveCalls = 0;
+    CmdProtocol_Init(); // Cote carte
+}
+
+/**
+ * @brief Fait tourner la tache jusqu'a vider le buffer de reception.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Run(void)
+{
+    int guard; // Borne du nombre d'appels
+
+    for (guard = 0; (guard < 64) && (rxTail != rxHead); guard++) {
+        CmdProtocol_Task(); // Une commande par appel au plus
+    }
+    CmdProtocol_Task(); // Emet une reponse restee en attente
+}
+
+/**
+ * @brief Envoie une commande et verifie le type et le statut de la reponse.
+ *
+ * @param type Code de la commande
+ * @param payload Payload de la commande
+ * @param len Taille du payload
+ * @param status Statut attendu
+ * @return true si la reponse est conforme
+ */
+static bool Exchange(uint8_t type, const uint8_t *payload, uint16_t len, uint8_t status)
+{
+    uint32_t before = txFrames; // Reponses deja emises
+
+    RxCommand(type, payload, len);
+    Run();
+    return (txFrames == before + 1) && (txType == (type | CMD_RESPONSE_FLAG))
+        && (txLen >= 1) && (txPayload[0] == status);
+}
+
+/* ---- Tests ---- */
+
+/**
+ * @brief Echo de CMD_PING et refus des commandes inconnues.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_PingUnknown(void)
+{
+    uint8_t echo[FRAME_MAX_RX_PAYLOAD]; // Payload de PING
+    uint16_t i; // Indice d'octet
+
+    Reset();
+    for (i = 0; i < sizeof (echo); i++) {
+        echo[i] = (uint8_t) (0xA5 ^ i); // Octets de synchro compris
+    }
+    CHECK(Exchange(CMD_PING, echo, sizeof (echo), CMD_STATUS_OK));
+    CHECK(txLen == 1 + sizeof (echo)); // Statut + echo complet
+    CHECK(memcmp(&txPayload[1], echo, sizeof (echo)) == 0); // Echo complet
+    CHECK(Exchange(CMD_PING, NULL, 0, CMD_STATUS_OK));
+    CHECK(txLen == 1);
+    CHECK(Exchange(0x7F, NULL, 0, CMD_STATUS_UNKNOWN));
+}
+
+/**
+ * @brief Controle de longueur et de bornes de CMD_SET_PROFIL.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_SetProfil(void)
+{
+    const uint8_t ok[3] = { 1, 2, 4 }; // Profil 1, 2 pales, 4 cylindres
+    const uint8_t badIdx[3] = { NB_PROFILS, 2, 4 }; // Profil inexistant
+    const uint8_t noBlade[3] = { 0, 0, 4 }; // Zero pale
+    const uint8_t manyBlades[3] = { 0, MENU_MAX_PALES + 1, 4 }; // Trop de pales
+    const uint8_t noCyl[3] = { 0, 2, 0 }; // Zero cylindre
+    const uint8_t manyCyl[3] = { 0, 2, MENU_MAX_CYLINDRES + 1 }; // Trop de cylindres
+    const uint8_t maxi[3] = { NB_PROFILS - 1, MENU_MAX_PALES, MENU_MAX_CYLINDRES }; // Bornes hautes
+
+    Reset();
+    CHECK(Exchange(CMD_SET_PROFIL, ok, 2, CMD_STATUS_BAD_LENGTH));
+    CHECK(Exchange(CMD_SET_PROFIL, badIdx, 3, CMD_STATUS_BAD_ARG));
+    CHECK(Exchange(CMD_SET_PROFIL, noBlade, 3, CMD_STATUS_BAD_ARG));
+    CHECK(Exchange(CMD_SET_PROFIL, manyBlades, 3, CMD_STATUS_BAD_ARG));
+    CHECK(Exchange(CMD_SET_PROFIL, noCyl, 3, CMD_STATUS_BAD_ARG));
+    CHECK(Exchange(CMD_SET_PROFIL, manyCyl, 3, CMD_STATUS_BAD_ARG));
+    CHECK(saveCalls == 0); // Rien d'ecrit en NVM
+
+    CHECK(Exchange(CMD_SET_PROFIL, ok, 3, CMD_STATUS_OK));
+    CHECK(saveCalls == 1 && memcmp(saveArgs, ok, 3) == 0);
+    CHECK(Exchange(CMD_SET_PROFIL, maxi, 3, CMD_STATUS_OK));
+    CHECK(saveCalls == 2 && memcmp(saveArgs, maxi, 3) == 0);
+}
+
+/**
+ * @brief Commandes a argument : mode, telemetrie, lecture de profil.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Args(void)
+{
+    const uint8_t modeVib = MESURE_MODE_VIBRATION; // Mode accelerometre
+    const uint8_t modeBad = 0x55; // Mode inconnu
+    const uint8_t period[2] = { 0xF4, 0x01 }; // 500 ms
+    const uint8_t idx = 2; // Profil lu
+
+    Reset();
+    CHECK(Exchange(CMD_SET_MODE, &modeVib, 1, CMD_STATUS_OK));
+    CHECK(lastMenu == MENU_MESURE_VIBRATION);
+    CHECK(Exchange(CMD_SET_MODE, &modeBad, 1, CMD_STATUS_BAD_ARG));
+    CHECK(lastMenu == MENU_MESURE_VIBRATION); // Ecran inchange
+    CHECK(Exchange(CMD_SET_TELEMETRY, period, 2, CMD_STATUS_OK));
+    CHECK(telemetryMs == 500);
+    CHECK(Exchange(CMD_SET_TELEMETRY, period, 1, CMD_STATUS_BAD_LENGTH));
+
+    profils[idx].nbBlades = 3;
+    profils[idx].nbCylindres = 6;
+    profils[idx].validFlag = PROFIL_VALID_FLAG;
+    CHECK(Exchange(CMD_GET_PROFIL, &idx, 1, CMD_STATUS_OK));
+    CHECK(txLen == 5);
+    CHECK(txPayload[1] == idx && txPayload[2] == 3 && txPayload[3] == 6 && txPayload[4] == 1);
+}
+
+/**
+ * @brief Lit un entier 32 bits little endian dans une reponse.
+ *
+ * @param p Source (4 octets)
+ * @return Valeur lue
+ */
+static uint32_t GetU32(const uint8_t *p)
+{
+    return (uint32_t) SerialFrame_GetU16(p) | ((uint32_t) SerialFrame_GetU16(&p[2]) << 16); // Poids faible en premier
+}
+
+/**
+ * @brief Commandes noyees dans des parasites, corrompues ou trop longues.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Stream(void)
+{
+    const uint8_t garbage[] = { 0x00, 0xA5, 0xA5, 0x13, 0xFF, 0x5A }; // Parasites
+    uint8_t frame[FRAME_MAX_RX_PAYLOAD + 1 + FRAME_OVERHEAD]; // Commande tramee
+    uint8_t big[FRAME_MAX_RX_PAYLOAD + 1]; // Payload trop long pour la carte
+    uint8_t stats[40]; // Reponse de CMD_GET_STATS
+    uint16_t n; // Taille de trame
+
+    Reset();
+    RxPush(garbage, sizeof (garbage));
+    n = SerialFrame_Encode(CMD_PING, (const uint8_t *) "ab", 2, frame, sizeof (frame));
+    frame[FRAME_HEADER_SIZE] ^= 0x01; // Commande corrompue
+    RxPush(frame, n);
+    memset(big, 0x11, sizeof (big));
+    RxCommand(CMD_PING, big, sizeof (big)); // Rejetee a l'entete
+    RxCommand(CMD_PING, (const uint8_t *) "ok", 2); // Seule commande valide
+    Run();
+    CHECK(txFrames == 1); // Une seule reponse
+    CHECK(txType == (CMD_PING | CMD_RESPONSE_FLAG) && txLen == 3);
+    CHECK(memcmp(&txPayload[1], "ok", 2) == 0);
+
+    CHECK(Exchange(CMD_GET_STATS, NULL, 0, CMD_STATUS_OK));
+    CHECK(txLen == 1 + sizeof (stats));
+    memcpy(stats, &txPayload[1], sizeof (stats));
+    CHECK(GetU32(&stats[24]) == 2); // PING et GET_STATS decodees
+    CHECK(GetU32(&stats[28]) == 1); // Une erreur CRC
+    CHECK(GetU32(&stats[32]) == 1); // Une erreur de longueur
+    CHECK(GetU32(&stats[36]) == 1); // Commandes executees avant GET_STATS
+}
+
+/**
+ * @brief Emetteur occupe : aucune lecture tant que la reponse attend.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Busy(void)
+{
+    Reset();
+    RxCommand(CMD_PING, (const uint8_t *) "1", 1);
+    RxCommand(CMD_PING, (const uint8_t *) "2", 1);
+    txBusy = true;
+    CmdProtocol_Task(); // Execute la premiere, reponse en attente
+    CmdProtocol_Task(); // Emetteur occupe : rien de plus
+    CHECK(txFrames == 0);
+    CHECK(rxTail == 1 + FRAME_OVERHEAD); // Seconde commande pas encore lue
+
+    txBusy = false;
+    CmdProtocol_Task(); // Emet la premiere reponse puis traite la seconde
+    CHECK(txFrames == 2 && txPayload[1] == '2');
+    CHECK(rxTail == rxHead); // Tout est lu
+}
+
+/**
+ * @brief Lance les tests du protocole.
+ *
+ * @return 0 si tous les tests passent
+ */
+int main(void)
+{
+    Test_PingUnknown();
+    Test_SetProfil();
+    Test_Args();
+    Test_Stream();
+    Test_Busy();
+
+    printf("CmdProtocol : %d verifications, %d echecs\n", checks, failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+--------------------------------------------------------
+ Fichier : test_latbench.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Test sur PC du banc de latence par injection de fronts simules
+--------------------------------------------------------
+*/
+#include <stdint.h> // Types entiers standard
+#include <stdbool.h> // Type bool
+#include <stdio.h> // Pour printf
+
+/*
+ * Le banc est compile ici avec ses variables statiques : le test remplace
+ * OC4, le timer T2/T3 et le controleur d'interruptions, puis joue le role
+ * de l'ISR IC3 (DRV_IC3_Callback) avec des latences connues par
+ * configuration de priorites.
+ */
+
+/* ---- Remplacants des registres et drivers utilises par LatBench ---- */
+
+static struct { unsigned OC32, OCTSEL, OCM, ON; } OC4CONbits; // Mode de OC4
+static uint32_t OC4CON; // Registre de controle de OC4
+static uint32_t OC4R; // Comparaison de OC4
+static struct { unsigned ICACLK; } CFGCONbits; // Horloge des captures
+static uint64_t simTicks = 0; // Temps simule [ticks IC, 10 MHz]
+
+#define INT_ID_0                        0
+#define INT_SOURCE_OUTPUT_COMPARE_4     0
+#define INT_VECTOR_OC4                  0
+#define INT_PRIORITY_LEVEL1             1
+#define INT_SUBPRIORITY_LEVEL0          0
+#define PORTS_ID_0                      0
+#define PORT_CHANNEL_F                  0
+#define PORTS_BIT_POS_5                 5
+#define PLIB_INT_SourceDisable(id, src)             ((void) 0)
+#define PLIB_INT_SourceEnable(id, src)              ((void) 0)
+#define PLIB_INT_SourceFlagClear(id, src)           ((void) 0)
+#define PLIB_INT_VectorPrioritySet(id, v, p)        ((void) 0)
+#define PLIB_INT_VectorSubPrioritySet(id, v, p)     ((void) 0)
+#define PLIB_PORTS_PinDirectionInputSet(id, ch, b)  ((void) 0)
+#define PLIB_PORTS_PinDirectionOutputSet(id, ch, b) ((void) 0)
+#define DRV_IC0_Start()                 ((void) 0)
+#define DRV_IC0_Stop()                  ((void) 0)
+#define DRV_TMR1_Start()                ((void) 0)
+#define DRV_TMR1_Stop()                 ((void) 0)
+#define DRV_TMR1_CounterValueGet()      ((uint32_t) simTicks)
+#define __builtin_disable_interrupts()  1u
+#define __builtin_enable_interrupts()   ((void) 0)
+
+#include "LatBench.c" // Module teste, statiques compris
+
+static int checks = 0; // Verifications faites
+static int failures = 0; // Verifications en echec
+
+// Compte une verification et signale l'echec avec la ligne
+#define CHECK(cond) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        printf("ECHEC %s:%d : %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define SIM_TICKS_PER_MS    (RPMCALC_TIMER_FREQ / 1000UL) // Ticks IC par ms
+#define SIM_CORE_PER_TICK   10      // Ticks Core Timer (100 MHz) par tick IC
+#define SIM_START           (0x100000000ULL - 20000000ULL) // T2/T3 deborde pendant le banc
+#define SIM_SERVICE_MS      11      // Periode du creneau SERVICE_TASKS [ms]
+#define SIM_HIT_EVERY       7       // Un front sur 7 tombe pendant une ISR concurrente
+
+APP_DATA appData; // Donnees de l'application
+static uint8_t appliedConfig = 0xFF; // Derniere configuration appliquee
+
+// Latence injectee par configuration [ticks IC] : seule, puis front pendant une ISR concurrente
+static const uint16_t latBase[ISR_PRIO_COUNT] = { 14, 9, 9, 14 };
+static const uint16_t latHit[ISR_PRIO_COUNT] = { 60, 9, 25, 140 };
+// Fronts retires par configuration (un sur N, 0 = aucun)
+static const uint16_t dropEvery[ISR_PRIO_COUNT] = { 0, 0, 0, 401 };
+
+// Valeurs attendues, accumulees par l'injection pendant les fenetres ouvertes
+static uint32_t expEdges[ISR_PRIO_COUNT]; // Captures traitees
+static uint32_t expMissed[ISR_PRIO_COUNT]; // Fronts retires
+
+/* ---- Remplacants des modules appeles par LatBench ---- */
+
+bool IsrPrio_Apply(uint8_t cfg) { appliedConfig = cfg; return true; }
+uint32_t Timebase_TicksPerUs(void) { return SIM_CORE_PER_TICK * LATBENCH_TICKS_PER_US; }
+uint32_t _CP0_GET_COUNT(void) { return 0; }
+
+/**
+ * @brief Front genere par OC4 : capture, puis entree dans l'ISR IC3 apres la latence.
+ *
+ * @param edge Instant du front [ticks IC, 64 bits]
+ * @param lat Latence front -> entree ISR [ticks IC]
+ * @return Aucun retour.
+ */
+static void InjectEdge(uint64_t edge, uint16_t lat)
+{
+    uint32_t cap = (uint32_t) edge; // Capture 32 bits
+    uint64_t entry = edge + lat; // Entree dans l'ISR
+    uint8_t i = appData.captureIndex; // Comme DRV_IC3_Callback
+
+    appData.captureBuffer[i] = cap;
+    appData.captureIndex = (uint8_t) ((i + 1) % RPM_CAPTURE_BUFFER_SIZE);
+    appData.captureCount++;
+    LatBench_CaptureIsr(cap, (uint32_t) entry, (uint32_t) (entry * SIM_CORE_PER_TICK));
+}
+
+/**
+ * @brief Fait tourner le banc avec ou sans signal jusqu'a la fin du balayage.
+ *
+ * @param freqHz Frequence du signal de test
+ * @param wired false si le cavalier RF5 -> RF4 est absent
+ * @return Aucun retour.
+ */
+static void Simulate(uint16_t freqHz, bool wired)
+{
+    uint64_t nextEdge; // Prochain front de OC4
+    uint32_t k = 0; // Numero du front
+    uint32_t ms; // Temps simule [ms]
+
+    simTicks = SIM_START;
+    appData.tickMs = 0;
+    for (ms = 0; ms < ISR_PRIO_COUNT; ms++) {
+        expEdges[ms] = 0;
+        expMissed[ms] = 0;
+    }
+    CHECK(LatBench_Start(freqHz));
+    nextEdge = SIM_START + (uint32_t) (OC4R - (uint32_t) SIM_START); // Premier front programme
+
+    for (ms = 1; running && (ms < 20000); ms++) {
+        uint64_t end = SIM_START + (uint64_t) ms * SIM_TICKS_PER_MS; // Fin de la milliseconde
+
+        while (wired && (nextEdge + 2 * halfPeriod <= end)) {
+            uint8_t c = config; // Configuration mesuree
+            bool drop = (dropEvery[c] != 0) && ((k % dropEvery[c]) == 0); // Front perdu
+            uint16_t lat = ((k % SIM_HIT_EVERY) == 0) ? latHit[c] : latBase[c]; // Latence du front
+
+            nextEdge += 2 * halfPeriod; // IC3 capture un front sur deux (fronts montants)
+            k++;
+            if (!drop) {
+                InjectEdge(nextEdge, lat);
+            }
+            if (measuring) {
+                expEdges[c] += drop ? 0 : 1; // Capture vue par le banc
+                expMissed[c] += drop ? 1 : 0; // Front que le banc doit compter perdu
+            }
+        }
+        simTicks = end;
+        appData.tickMs = ms; // Timer1
+        if ((ms % SIM_SERVICE_MS) == 0) {
+            LatBench_Task(); // Creneau SERVICE_TASKS
+        }
+    }
+}
+
+/**
+ * @brief Balayage complet : latences, gigue, fronts perdus et RPM par configuration.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Sweep(void)
+{
+    const uint16_t freqHz = 1000; // Un front par ms
+    uint16_t f = 0; // Frequence rendue
+    LatBench_Result r; // Resultats d'une configuration
+    uint8_t c; // Configuration
+
+    appData.rpmCaptureActive = false;
+    Simulate(freqHz, true);
+    CHECK(LatBench_GetState(&f) == LATBENCH_DONE);
+    CHECK(f == freqHz);
+    CHECK(!appData.rpmCaptureActive); // Capture rendue
+    CHECK(appliedConfig == ISR_PRIO_DEFAULT); // Priorites de production remises
+
+    for (c = 0; c < ISR_PRIO_COUNT; c++) {
+        uint32_t jitterTicks = (uint32_t) (latHit[c] - latBase[c]) * SIM_CORE_PER_TICK; // Gigue injectee
+
+        CHECK(LatBench_GetResult(c, &r));
+        printf("  config %u : %u fronts, %u perdus, latence %u-%u ticks (moy %u), gigue max %u, RPM %u ppm, capture -> RPM %u us\n",
+            c, (unsigned) r.edges, (unsigned) r.missed, r.latMin, r.latMax,
+            (unsigned) (r.latSum / r.edges), (unsigned) r.jitterMax, (unsigned) r.rpmErrMaxPpm,
+            (unsigned) r.e2eMaxUs);
+        CHECK(r.edges == expEdges[c]);
+        CHECK(r.edges > (LATBENCH_WINDOW_MS - 2 * SIM_SERVICE_MS) * freqHz / 1000 - r.missed); // Fenetre complete
+        CHECK(r.missed == expMissed[c]);
+        CHECK(r.latMin == latBase[c]);
+        CHECK(r.latMax == latHit[c]);
+        CHECK(r.jitterMax == jitterTicks);
+        CHECK(r.rpmSamples > 0);
+        CHECK(r.e2eMaxUs <= 1000000UL / freqHz); // Derniere capture au plus une periode avant le calcul
+        if (dropEvery[c] == 0) {
+            CHECK(r.rpmErrMaxPpm == 0); // 10 000 ticks par periode : RPM exact
+        }
+    }
+}
+
+/**
+ * @brief Cavalier absent : le banc s'arrete apres la premiere fenetre.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_NoSignal(void)
+{
+    appData.rpmCaptureActive = true;
+    CHECK(!LatBench_Start(1000)); // Capture deja prise par la mesure visuelle
+    appData.rpmCaptureActive = false;
+    CHECK(!LatBench_Start(LATBENCH_FREQ_MAX + 1)); // Hors limites
+
+    Simulate(1000, false);
+    CHECK(LatBench_GetState(0) == LATBENCH_NO_SIGNAL);
+    CHECK(!appData.rpmCaptureActive);
+    CHECK(appData.tickMs < LATBENCH_SETTLE_MS + LATBENCH_WINDOW_MS + 2 * SIM_SERVICE_MS); // Une seule fenetre
+}
+
+/**
+ * @brief Lance les tests du banc de latence.
+ *
+ * @return 0 si tous les tests passent
+ */
+int main(void)
+{
+    Test_Sweep();
+    Test_NoSignal();
+
+    printf("LatBench : %d verifications, %d echecs\n", checks, failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+--------------------------------------------------------
+ Fichier : test_ordertrack.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Test sur PC du suivi d'ordres sur des variations de regime
+--------------------------------------------------------
+*/
+#include "OrderTrack.h" // Module teste
+#include "Fft.h" // FFT en temps de reference
+#include "Bench.h" // Signal de synthese du banc (BENCH_OT_xxx)
+#include "LIS2HH12.h" // Frequence d'echantillonnage
+#include "MesureEngine.h" // Chaines de mesure
+#include <math.h> // Pour floor, sinf, cosf, fabsf
+#include <stdio.h> // Pour printf
+
+static int checks = 0; // Verifications faites
+static int failures = 0; // Verifications en echec
+
+// Compte une verification et signale l'echec avec la ligne
+#define CHECK(cond) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        printf("ECHEC %s:%d : %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+static Fft_Cplx fftBuf[256]; // FFT en temps de reference
+
+/* ---- Remplacants des modules appeles par OrderTrack ---- */
+
+bool MesureEngine_IsRunning(uint8_t pipe) { (void) pipe; return true; }
+uint32_t RevSync_MarkerNow(void) { return 0; }
+
+/**
+ * @brief Angle d'un regime lineaire en temps.
+ *
+ * @param t Temps depuis le debut [s]
+ * @param rpm0 Regime de depart
+ * @param rate Acceleration [RPM/s]
+ * @return Angle [tours]
+ */
+static double Turns(double t, double rpm0, double rate)
+{
+    return (rpm0 * t + 0.5 * rate * t * t) / 60.0;
+}
+
+/**
+ * @brief Signal de l'ordre BENCH_OT_ORDER, comme Bench_OtSignal.
+ *
+ * @param turns Angle [tours]
+ * @return Echantillon [LSB]
+ */
+static float Signal(double turns)
+{
+    float frac = (float) (turns - floor(turns)); // Position dans le tour
+
+    return BENCH_OT_AMP * sinf(2.0f * 3.14159265f * (float) BENCH_OT_ORDER * frac);
+}
+
+/**
+ * @brief Part de la puissance dans la raie dominante et ses deux voisines, comme Bench_PeakPct.
+ *
+ * @param n Taille de la FFT contenue dans fftBuf
+ * @return Part [%]
+ */
+static unsigned PeakPct(uint16_t n)
+{
+    float p[3] = {0.0f, 0.0f, 0.0f}; // Raies k - 1, k, k + 1
+    float best = 0.0f; // Meilleure somme de trois raies
+    float sum = 0.0f; // Puissance totale
+    uint16_t k; // Index de raie
+
+    for (k = 1; k < (n / 2); k++) {
+        p[0] = p[1];
+        p[1] = p[2];
+        p[2] = (fftBuf[k].re * fftBuf[k].re) + (fftBuf[k].im * fftBuf[k].im);
+        sum += p[2];
+        if ((p[0] + p[1] + p[2]) > best) {
+            best = p[0] + p[1] + p[2];
+        }
+    }
+    return (sum > 0.0f) ? (unsigned) ((100.0f * best) / sum) : 0;
+}
+
+/**
+ * @brief Compare le suivi d'ordres a une FFT en temps de 256 points.
+ *
+ * @param rpm0 Regime de depart
+ * @param rate Acceleration [RPM/s]
+ * @param otMin Part minimale de la raie dans le spectre d'ordres [%]
+ * @param fftMax Part maximale de la raie dans la FFT en temps [%]
+ * @param orderTol Ecart maximal de l'ordre retenu
+ * @return Aucun retour.
+ */
+static void Sweep(double rpm0, double rate, unsigned otMin, unsigned fftMax, float orderTol)
+{
+    const double ts = 1.0 / (double) LIS2HH12_ODR_HZ; // Periode d'echantillonnage [s]
+    float xyz[3] = {0.0f, 0.0f, 0.0f}; // Axes de synthese (X seul)
+    OrderTrack_Result r; // Spectre d'ordres
+    unsigned fftPct; // Part de la raie dans la FFT en temps
+    bool ready = false; // Premier spectre calcule
+    uint16_t i; // Echantillon
+
+    for (i = 0; i < 256; i++) {
+        float hannK = 0.5f - 0.5f * cosf((2.0f * 3.14159265f * (float) i) / 256.0f); // Fenetre de Hann
+
+        fftBuf[i].re = Signal(Turns((double) i * ts, rpm0, rate)) * hannK;
+        fftBuf[i].im = 0.0f;
+    }
+    (void) Fft_Forward(fftBuf, 256);
+    fftPct = PeakPct(256);
+
+    OrderTrack_Reset();
+    for (i = 0; (i < BENCH_OT_MAX_SAMPLES) && !ready; i++) {
+        double t = (double) i * ts; // Instant de l'echantillon [s]
+
+        xyz[0] = Signal(Turns(t, rpm0, rate));
+        ready = OrderTrack_Feed(xyz, Turns(t, rpm0, rate), (float) (rpm0 + rate * t), true);
+    }
+    OrderTrack_Get(&r);
+
+    printf("  %5.0f RPM %+6.0f RPM/s : ordres %3u %% (ordre %.3f, %.0f-%.0f RPM), FFT en temps %3u %%\n",
+        rpm0, rate, r.peakPct, r.peakOrder, r.rpmMin, r.rpmMax, fftPct);
+    CHECK(ready); // Un spectre dans BENCH_OT_MAX_SAMPLES
+    CHECK(r.valid);
+    CHECK(fabsf(r.peakOrder - (float) BENCH_OT_ORDER) <= orderTol);
+    CHECK(r.peakPct >= otMin);
+    CHECK(fftPct <= fftMax);
+}
+
+/**
+ * @brief Lance le suivi d'ordres sur la montee du banc, un regime stable et une descente.
+ *
+ * @return 0 si tous les tests passent
+ */
+int main(void)
+{
+    Fft_Init();
+    Sweep(BENCH_OT_RPM0, BENCH_OT_RATE, 95, 20, 0.05f); // Montee du banc : la raie s'etale en temps
+    Sweep(3000.0, 0.0, 95, 100, 0.05f); // Regime stable : les deux spectres concentrent la raie
+    Sweep(6000.0, -6000.0, 85, 20, 0.10f); // Descente rapide
+
+    printf("OrderTrack : %d verifications, %d echecs\n", checks, failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/*
+--------------------------------------------------------
+ Fichier : test_serialframe.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Test sur PC du tramage (encodage, decodage, CRC, resynchro)
+--------------------------------------------------------
+*/
+#include "SerialFrame.h" // Module teste
+#include <stdio.h> // Pour printf
+#include <string.h> // Pour memcmp et memset
+
+static int checks = 0; // Verifications faites
+static int failures = 0; // Verifications en echec
+
+// Compte une verification et signale l'echec avec la ligne
+#define CHECK(cond) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        printf("ECHEC %s:%d : %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+/**
+ * @brief Passe un bloc d'octets au decodeur.
+ *
+ * @param dec Decodeur
+ * @param data Octets a decoder
+ * @param len Nombre d'octets
+ * @param lastAt Indice de l'octet qui a complete la derniere trame (-1 si aucune)
+ * @return Nombre de trames valides recues
+ */
+static int Feed(SerialFrame_Decoder *dec, const uint8_t *data, uint16_t len, int *lastAt)
+{
+    int frames = 0; // Trames completees
+    uint16_t i; // Indice d'octet
+
+    *lastAt = -1; // Aucune trame pour l'instant
+    for (i = 0; i < len; i++) {
+        if (SerialFrame_DecodeByte(dec, data[i])) {
+            frames++; // Trame valide
+            *lastAt = i; // Octet qui l'a completee
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Valeur de controle du CRC16-CCITT (init 0xFFFF).
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Crc(void)
+{
+    const uint8_t ref[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' }; // Vecteur de reference
+
+    CHECK(SerialFrame_Crc16(0xFFFF, ref, 9) == 0x29B1); // CRC-16/CCITT-FALSE
+    CHECK(SerialFrame_Crc16(SerialFrame_Crc16(0xFFFF, ref, 4), &ref[4], 5) == 0x29B1); // Calcul en deux blocs
+}
+
+/**
+ * @brief Aller-retour encodage / decodage pour plusieurs longueurs.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_RoundTrip(void)
+{
+    static const uint16_t lens[] = { 0, 1, 17, FRAME_MAX_RX_PAYLOAD }; // Longueurs testees
+    uint8_t payload[FRAME_MAX_RX_PAYLOAD]; // Payload emis
+    uint8_t frame[FRAME_MAX_RX_PAYLOAD + FRAME_OVERHEAD]; // Trame encodee
+    SerialFrame_Decoder dec; // Decodeur
+    uint16_t n; // Taille de la trame
+    unsigned k; // Indice de longueur
+    uint16_t i; // Indice d'octet
+    int lastAt; // Octet qui complete la trame
+
+    SerialFrame_DecoderInit(&dec);
+    for (k = 0; k < sizeof (lens) / sizeof (lens[0]); k++) {
+        for (i = 0; i < lens[k]; i++) {
+            payload[i] = (uint8_t) (i * 37 + k); // Contenu variable (SOF compris)
+        }
+        n = SerialFrame_Encode((uint8_t) (0x10 + k), payload, lens[k], frame, sizeof (frame));
+        CHECK(n == lens[k] + FRAME_OVERHEAD); // Taille attendue
+        CHECK(frame[0] == FRAME_SOF1 && frame[1] == FRAME_SOF2); // Synchro
+        CHECK(SerialFrame_GetU16(&frame[3]) == lens[k]); // Longueur little endian
+
+        CHECK(Feed(&dec, frame, n, &lastAt) == 1); // Une seule trame
+        CHECK(lastAt == n - 1); // Completee au dernier octet du CRC
+        CHECK(dec.type == 0x10 + k); // Type restitue
+        CHECK(dec.len == lens[k]); // Longueur restituee
+        CHECK(memcmp(dec.payload, payload, lens[k]) == 0); // Payload restitue
+    }
+    CHECK(dec.framesOk == k); // Toutes les trames comptees
+    CHECK(dec.crcErrors == 0 && dec.lengthErrors == 0); // Aucune erreur
+}
+
+/**
+ * @brief Trame corrompue : rejet sur le CRC puis trame suivante acceptee.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_BadCrc(void)
+{
+    const uint8_t payload[4] = { 0x01, 0x02, 0x03, 0x04 }; // Payload emis
+    uint8_t frame[2 * (4 + FRAME_OVERHEAD)]; // Trame corrompue suivie d'une trame saine
+    SerialFrame_Decoder dec; // Decodeur
+    uint16_t n; // Taille d'une trame
+    int lastAt; // Octet qui complete la trame
+
+    n = SerialFrame_Encode(0x30, payload, 4, frame, sizeof (frame));
+    memcpy(&frame[n], frame, n); // Copie saine a la suite
+    frame[FRAME_HEADER_SIZE + 2] ^= 0x40; // Un bit faux dans le payload de la premiere
+
+    SerialFrame_DecoderInit(&dec);
+    CHECK(Feed(&dec, frame, n, &lastAt) == 0); // Trame rejetee
+    CHECK(dec.crcErrors == 1); // Comptee en erreur CRC
+    CHECK(Feed(&dec, &frame[n], n, &lastAt) == 1); // La suivante passe
+    CHECK(dec.framesOk == 1);
+
+    SerialFrame_DecoderInit(&dec);
+    frame[FRAME_HEADER_SIZE + 2] ^= 0x40; // Payload remis
+    frame[n - 1] ^= 0x01; // CRC recu faux
+    CHECK(Feed(&dec, frame, n, &lastAt) == 0); // Trame rejetee
+    CHECK(dec.crcErrors == 1);
+}
+
+/**
+ * @brief Longueur annoncee au-dela de FRAME_MAX_RX_PAYLOAD : rejet a l'entete.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Length(void)
+{
+    uint8_t payload[FRAME_MAX_RX_PAYLOAD + 1]; // Un octet de trop
+    uint8_t frame[2 * (FRAME_MAX_RX_PAYLOAD + 1 + FRAME_OVERHEAD)]; // Trame trop longue puis trame courte
+    SerialFrame_Decoder dec; // Decodeur
+    uint16_t n; // Taille de la trame trop longue
+    uint16_t m; // Taille de la trame courte
+    int lastAt; // Octet qui complete la trame
+
+    memset(payload, 0x11, sizeof (payload)); // Sans octet de synchro
+    n = SerialFrame_Encode(0x31, payload, sizeof (payload), frame, sizeof (frame));
+    CHECK(n == sizeof (payload) + FRAME_OVERHEAD); // L'emetteur accepte jusqu'a FRAME_MAX_PAYLOAD
+    m = SerialFrame_Encode(0x32, payload, 2, &frame[n], (uint16_t) (sizeof (frame) - n));
+
+    SerialFrame_DecoderInit(&dec);
+    CHECK(Feed(&dec, frame, (uint16_t) (n + m), &lastAt) == 1); // Seule la trame courte passe
+    CHECK(lastAt == n + m - 1);
+    CHECK(dec.type == 0x32);
+    CHECK(dec.lengthErrors == 1); // Rejet compte une fois
+    CHECK(dec.crcErrors == 0); // Le payload ignore ne fausse pas de CRC
+}
+
+/**
+ * @brief Resynchronisation apres des octets parasites et une fausse entete.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_Resync(void)
+{
+    // Parasites : SOF1 isoles, SOF1 repete puis octet quelconque
+    const uint8_t garbage[] = { 0x00, 0xA5, 0x00, 0xFF, 0xA5, 0xA5, 0x13, 0x5A, 0x5A };
+    // Fausse entete complete (len 2) avec un CRC faux
+    const uint8_t fake[] = { FRAME_SOF1, FRAME_SOF2, 0x40, 0x02, 0x00, 0x12, 0x34, 0xDE, 0xAD };
+    const uint8_t payload[3] = { FRAME_SOF1, FRAME_SOF2, 0x77 }; // Synchro dans le payload
+    uint8_t frame[3 + FRAME_OVERHEAD]; // Trame saine
+    SerialFrame_Decoder dec; // Decodeur
+    uint16_t n; // Taille de la trame saine
+    int lastAt; // Octet qui complete la trame
+
+    n = SerialFrame_Encode(0x33, payload, 3, frame, sizeof (frame));
+
+    SerialFrame_DecoderInit(&dec);
+    CHECK(Feed(&dec, garbage, sizeof (garbage), &lastAt) == 0); // Rien de valide
+    CHECK(Feed(&dec, frame, n, &lastAt) == 1); // Trame saine retrouvee
+    CHECK(memcmp(dec.payload, payload, 3) == 0);
+
+    CHECK(Feed(&dec, fake, sizeof (fake), &lastAt) == 0); // Fausse trame rejetee
+    CHECK(dec.crcErrors == 1);
+    CHECK(Feed(&dec, frame, n, &lastAt) == 1); // Resynchro sur la suivante
+    CHECK(dec.framesOk == 2);
+}
+
+/**
+ * @brief Refus d'encodage : buffer trop petit ou payload trop long.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_EncodeLimits(void)
+{
+    uint8_t payload[8] = { 0 }; // Payload emis
+    uint8_t frame[8 + FRAME_OVERHEAD]; // Juste assez pour 8 octets
+
+    CHECK(SerialFrame_Encode(0x34, payload, 8, frame, sizeof (frame)) == sizeof (frame)); // Taille exacte
+    CHECK(SerialFrame_Encode(0x34, payload, 8, frame, sizeof (frame) - 1) == 0); // Un octet de moins
+    CHECK(SerialFrame_Encode(0x34, payload, FRAME_MAX_PAYLOAD + 1, frame, 0xFFFF) == 0); // Payload trop long
+    CHECK(SerialFrame_Encode(0x34, NULL, 0, frame, FRAME_OVERHEAD) == FRAME_OVERHEAD); // Trame vide
+}
+
+/**
+ * @brief Trames du flux USB : payloads au-dela de FRAME_MAX_RX_PAYLOAD
+ * encodes bout a bout dans un buffer ping-pong, relus cote PC.
+ *
+ * @param Aucun parametre.
+ * @return Aucun retour.
+ */
+static void Test_StreamPacking(void)
+{
+    static uint8_t buffer[2048]; // Taille de USB_STREAM_BUFFER_SIZE
+    static uint8_t payload[FRAME_MAX_PAYLOAD]; // Bloc brut
+    const uint16_t accLen = 5 + (6 * 32); // Bloc accelerometre complet (UsbStream_PushAcc)
+    uint16_t fill = 0; // Octets places
+    uint16_t written; // Taille de la derniere trame
+    uint16_t frames = 0; // Trames placees
+    uint16_t pos; // Position de relecture
+    uint16_t len; // Longueur relue
+    uint16_t i; // Indice d'octet
+
+    for (i = 0; i < sizeof (payload); i++) {
+        payload[i] = (uint8_t) (i ^ (i >> 8)); // Contenu variable
+    }
+
+    // Remplissage comme UsbStream_PushFrame jusqu'au refus
+    do {
+        written = SerialFrame_Encode(FRAME_TYPE_RAW_ACC, payload, accLen, &buffer[fill],
+                (uint16_t) (sizeof (buffer) - fill));
+        fill += written;
+        frames += (written > 0) ? 1 : 0;
+    } while (written > 0);
+    CHECK(frames == sizeof (buffer) / (accLen + FRAME_OVERHEAD)); // Buffer rempli au maximum
+    CHECK(SerialFrame_Encode(FRAME_TYPE_STREAM_STATUS, payload, 16, &buffer[fill],
+            (uint16_t) (sizeof (buffer) - fill)) == 0); // Le reste ne suffit plus
+
+    // Relecture cote PC : synchro, longueur et CRC de chaque trame
+    for (pos = 0, i = 0; i < frames; i++) {
+        CHECK(buffer[pos] == FRAME_SOF1 && buffer[pos + 1] == FRAME_SOF2);
+        CHECK(buffer[pos + 2] == FRAME_TYPE_RAW_ACC);
+        len = SerialFrame_GetU16(&buffer[pos + 3]);
+        CHECK(len == accLen);
+        CHECK(SerialFrame_Crc16(0xFFFF, &buffer[pos + 2], (uint16_t) (len + 3))
+            == SerialFrame_GetU16(&buffer[pos + FRAME_HEADER_SIZE + len]));
+        CHECK(memcmp(&buffer[pos + FRAME_HEADER_SIZE], payload, len) == 0);
+        pos += len + FRAME_OVERHEAD; // Trame suivante
+    }
+    CHECK(pos == fill); // Aucun octet en trop
+
+    // Payload maximal : encode, mais refuse par le decodeur de commandes
+    written = SerialFrame_Encode(FRAME_TYPE_RAW_CAPTURE, payload, FRAME_MAX_PAYLOAD, buffer, sizeof (buffer));
+    CHECK(written == FRAME_MAX_PAYLOAD + FRAME_OVERHEAD);
+    CHECK(SerialFrame_Crc16(0xFFFF, &buffer[2], FRAME_MAX_PAYLOAD + 3)
+        == SerialFrame_GetU16(&buffer[FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD]));
+}
+
+/**
+ * @brief Lance les tests du tramage.
+ *
+ * @return 0 si tous les tests passent
+ */
+int main(void)
+{
+    Test_Crc();
+    Test_RoundTrip();
+    Test_BadCrc();
+    Test_Length();
+    Test_Resync();
+    Test_EncodeLimits();
+    Test_StreamPacking();
+
+    printf("SerialFrame : %d verifications, %d echecs\n", checks, failures);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/*
+--------------------------------------------------------
+ Fichier : test_zoom.c
+ Auteur  : leo mendes
+ Date    : 2024
+ Role    : Test sur PC du zoom FFT autour de la raie de passage de pales
+--------------------------------------------------------
+*/
+#include "Zoom.h" // Module teste
+#include "MesureEngine.h" // Chaines de mesure
+#include "RpmFusion.h" // Regime du centre en mode suivi
+#include "LIS2HH12.h" // Frequence d'echantillonnage
+#include "app.h" // Profil actif
+#include <math.h> // Pour sin, fabsf
+#include <stdio.h> // Pour printf
+
+static int checks = 0; // Verifications faites
+static int failures = 0; // Verifications en echec
+
+// Compte une verification et signale l'echec avec la ligne
+#define CHECK(cond) do { \
+    checks++; \
+    if (!(cond)) { \
+        failures++; \
+        printf("ECHEC %s:%d : %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+// Echantillons par bloc, comme une lecture de FIFO partielle
+#define BLOCK       17
+// Blocs injectes (17 s a 400 Hz)
+#define BLOCKS      400
+
+#define PI_D        3.14159265358979
+
+APP_DATA appData; // Profil actif (pales, cylindres)
+static float fusionRpm = 0.0f; // Regime rendu par le filtre de fusion
+static uint32_t noiseState = 1; // Etat du generateur de bruit
+
+/* ---- Remplacants des modules appeles par Zoom ---- */
+
+bool MesureEngine_IsRunning(uint8_t pipe) { (void) pipe; return true; }
+
+void RpmFusion_Get(RpmFusion_Output *out, uint32_t nowMs)
+{
+    out->valid = true; // Regime toujours disponible
+    out->rpm = fusionRpm;
+    out->rate = 0.0f;
+    out->sigma = 1.0f;
+    out->updateMs = nowMs;
+    out->sources = 1;
+}
+
+/**
+ * @brief Bruit uniforme reproductible.
+ *
+ * @return Valeur dans [-1, 1]
+ */
+static double Noise(void)
+{
+    noiseState = noiseState * 1664525u + 1013904223u; // Congruence lineaire
+    return ((double) (noiseState >> 8) / 8388608.0) - 1.0;
+}
+
+/**
+ * @brief Injecte une raie et une voisine bruitees puis verifie la raie retenue.
+ *
+ * @param lineHz Frequence de la raie [Hz]
+ * @param centerRpm Regime du centre (0 = filtre de fusion)
+ * @param tolHz Ecart maximal de la frequence retenue [Hz]
+ * @return Aucun retour.
+ */
+static void Run(double lineHz, uint16_t centerRpm, float tolHz)
+{
+    int16_t xyz[3 * BLOCK]; // Bloc X, Y, Z entrelaces
+    Zoom_Result r; // Spectre zoome
+    uint32_t n = 0; // Echantillon courant
+    uint16_t blk; // Bloc courant
+    uint8_t i; // Echantillon du bloc
+
+    noiseState = 1; // Meme bruit pour chaque cas
+    CHECK(Zoom_Start(ZOOM_LINE_BLADE, centerRpm));
+    for (blk = 0; blk < BLOCKS; blk++) {
+        for (i = 0; i < BLOCK; i++, n++) {
+            double t = (double) n / (double) LIS2HH12_ODR_HZ; // Instant [s]
+            double s = 300.0 * sin(2.0 * PI_D * lineHz * t)
+                + 200.0 * sin(2.0 * PI_D * (lineHz + 3.1) * t)
+                + 400.0 * Noise(); // Raie, voisine a +3,1 Hz et bruit
+
+            xyz[3 * i] = (int16_t) s;
+            xyz[3 * i + 1] = (int16_t) (0.5 * s + 50.0 * sin(2.0 * PI_D * 37.0 * t)); // Raie hors bande
+            xyz[3 * i + 2] = (int16_t) (16000.0 + 50.0 * Noise()); // Gravite
+        }
+        Zoom_Push(xyz, BLOCK, (uint32_t) ((n * 1000u) / LIS2HH12_ODR_HZ));
+    }
+    Zoom_Get(&r);
+    Zoom_Stop();
+
+    printf("  raie %.3f Hz, centre %.3f Hz : retenue %.3f Hz (%.1f RPM), %.3f Hz par raie, SNR %.1f\n",
+        lineHz, r.centerHz, r.freqHz, r.rpm, r.binHz, r.snr);
+    CHECK(r.valid);
+    CHECK(fabsf(r.freqHz - (float) lineHz) <= tolHz);
+    CHECK(fabsf(r.binHz - (float) LIS2HH12_ODR_HZ / (ZOOM_DECIM * ZOOM_N)) < 1e-4f);
+}
+
+/**
+ * @brief Lance le zoom sur un centre fixe puis en suivi du filtre de fusion.
+ *
+ * @return 0 si tous les tests passent
+ */
+int main(void)
+{
+    appData.nbBlades = 2; // Raie de passage de pales = RPM / 30
+    appData.nbCylindres = 4;
+
+    Run(80.0, 2350, 0.02f); // Centre fixe a 78,3 Hz
+    fusionRpm = 2400.0f;
+    Run(80.37, 0, 0.02f); // Centre du filtre de fusion (80 Hz), raie entre deux raies
+    Run(95.0, 2400, 0.02f); // Raie a 15 Hz du centre, dans la bande
+
+    printf("Zoom : %d verifications, %d echecs\n", checks, failures);
+    return (failures == 0) ? 0 : 1;
+}